@@ -0,0 +1,119 @@
+﻿#include "Common/Net/Buffer.h"
+#include "Common/Util/ProducerConsumerQueue.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <string>
+
+namespace
+{
+    struct PacketHeader
+    {
+        uint16_t length;
+        uint16_t msgId;
+        uint32_t sequence;
+    };
+} // namespace
+
+// 按协议包的方式写入包头与负载，range(0)为负载字节数
+static void BM_MessageBufferWrite(benchmark::State &state)
+{
+    const std::string payload(static_cast<size_t>(state.range(0)), 'x');
+    for (auto _ : state)
+    {
+        Net::MessageBuffer buffer;
+        buffer << PacketHeader {static_cast<uint16_t>(payload.size()), 1, 2};
+        buffer.Write(payload);
+        benchmark::DoNotOptimize(buffer.GetReadPointer());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(sizeof(PacketHeader) + payload.size()));
+}
+BENCHMARK(BM_MessageBufferWrite)->Arg(16)->Arg(256)->Arg(4096);
+
+// 读出包头与负载，与HttpSession中ReadAllAsString的用法一致
+static void BM_MessageBufferRead(benchmark::State &state)
+{
+    const std::string payload(static_cast<size_t>(state.range(0)), 'x');
+    Net::MessageBuffer source;
+    source << PacketHeader {static_cast<uint16_t>(payload.size()), 1, 2};
+    source.Write(payload);
+
+    for (auto _ : state)
+    {
+        Net::MessageBuffer buffer(source);
+        PacketHeader       header {};
+        buffer >> header;
+        std::string body = buffer.ReadAllAsString();
+        benchmark::DoNotOptimize(body);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(sizeof(PacketHeader) + payload.size()));
+}
+BENCHMARK(BM_MessageBufferRead)->Arg(16)->Arg(256)->Arg(4096);
+
+// 流式收包：每次写入一段、读出大半，剩余部分靠MakeSpace前移或扩容，range(0)为每段字节数
+static void BM_MessageBufferStream(benchmark::State &state)
+{
+    const std::string  chunk(static_cast<size_t>(state.range(0)), 'x');
+    Net::MessageBuffer buffer;
+    uint8_t            sink[8192];
+    for (auto _ : state)
+    {
+        buffer.EnsureWritableBytes(chunk.size());
+        std::memcpy(buffer.GetWritPointer(), chunk.data(), chunk.size());
+        buffer.WriteDone(chunk.size());
+
+        const size_t readBytes = buffer.ReadableBytes() * 3 / 4;
+        buffer.Read(sink, readBytes);
+        benchmark::DoNotOptimize(sink);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(chunk.size()));
+}
+BENCHMARK(BM_MessageBufferStream)->Arg(64)->Arg(1024)->Arg(4096);
+
+// 可写空间不足时扩容，range(0)为最终大小
+static void BM_MessageBufferGrow(benchmark::State &state)
+{
+    const size_t targetSize = static_cast<size_t>(state.range(0));
+    for (auto _ : state)
+    {
+        Net::MessageBuffer buffer;
+        while (buffer.ReadableBytes() < targetSize)
+        {
+            buffer.EnsureFreeSpace();
+            buffer.WriteDone(buffer.WritableBytes());
+        }
+        benchmark::DoNotOptimize(buffer.GetBasePointer());
+    }
+}
+BENCHMARK(BM_MessageBufferGrow)->Arg(16 << 10)->Arg(1 << 20);
+
+// 会话收发队列的单线程开销：网络线程入队、逻辑线程出队
+static void BM_ProducerConsumerQueuePushPop(benchmark::State &state)
+{
+    ProducerConsumerQueue<Net::MessageBuffer> queue(256);
+    const int64_t                             batch = state.range(0);
+    for (auto _ : state)
+    {
+        for (int64_t i = 0; i < batch; ++i)
+        {
+            Net::MessageBuffer buffer(64);
+            buffer.WriteDone(64);
+            if (!queue.Push(std::move(buffer)))
+            {
+                state.SkipWithError("队列已满");
+                return;
+            }
+        }
+
+        Net::MessageBuffer buffer;
+        while (queue.Pop(buffer))
+        {
+            benchmark::DoNotOptimize(buffer.GetReadPointer());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_ProducerConsumerQueuePushPop)->Arg(1)->Arg(16)->Arg(256);
+
+BENCHMARK_MAIN();
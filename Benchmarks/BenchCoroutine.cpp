@@ -0,0 +1,126 @@
+﻿#include "Common/Coroutine/FrameAllocator.h"
+#include "Common/Coroutine/ThreadPool.h"
+#include "Common/Coroutine/WhenAll.hpp"
+
+#include "asio.hpp"
+#include <benchmark/benchmark.h>
+
+#include <future>
+
+namespace
+{
+    constexpr int FAN_OUT_TASK_COUNT = 1000;
+
+    // 模拟寻路、AI评估等计算密集任务
+    uint64_t Compute(uint64_t seed, int64_t iterations)
+    {
+        for (int64_t i = 0; i < iterations; ++i)
+        {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+        }
+        return seed;
+    }
+
+    Coroutine::Task<uint64_t> ComputeTask(Coroutine::ThreadPool &pool, uint64_t seed, int64_t iterations)
+    {
+        co_await pool.Schedule();
+        co_return Compute(seed, iterations);
+    }
+
+    asio::awaitable<uint64_t> ComputeAwaitable(uint64_t seed, int64_t iterations)
+    {
+        co_return Compute(seed, iterations);
+    }
+
+    Coroutine::Task<int> Leaf(int value)
+    {
+        co_return value + 1;
+    }
+
+    Coroutine::Task<int> Nested(int depth)
+    {
+        if (0 == depth)
+        {
+            co_return co_await Leaf(depth);
+        }
+        co_return co_await Nested(depth - 1) + 1;
+    }
+} // namespace
+
+// 线程池上的Task扇出，range(0)为线程数，range(1)为每个任务的计算量
+static void BM_ThreadPoolWhenAll(benchmark::State &state)
+{
+    Coroutine::ThreadPool pool(static_cast<uint32_t>(state.range(0)));
+    const int64_t         iterations = state.range(1);
+    for (auto _ : state)
+    {
+        std::vector<Coroutine::Task<uint64_t>> tasks;
+        tasks.reserve(FAN_OUT_TASK_COUNT);
+        for (int i = 0; i < FAN_OUT_TASK_COUNT; ++i)
+        {
+            tasks.emplace_back(ComputeTask(pool, i + 1, iterations));
+        }
+
+        benchmark::DoNotOptimize(Coroutine::SyncWait(Coroutine::WhenAll(std::move(tasks))));
+    }
+    state.SetItemsProcessed(state.iterations() * FAN_OUT_TASK_COUNT);
+}
+BENCHMARK(BM_ThreadPoolWhenAll)->ArgsProduct({{1, 4, 8}, {0, 1000}})->UseRealTime();
+
+// 同样的扇出由asio::co_spawn投递到asio::thread_pool
+static void BM_AsioCoSpawn(benchmark::State &state)
+{
+    asio::thread_pool pool(static_cast<std::size_t>(state.range(0)));
+    const int64_t     iterations = state.range(1);
+    for (auto _ : state)
+    {
+        std::vector<uint64_t> results(FAN_OUT_TASK_COUNT);
+        std::atomic<int>      remaining {FAN_OUT_TASK_COUNT};
+        std::promise<void>    done;
+        for (int i = 0; i < FAN_OUT_TASK_COUNT; ++i)
+        {
+            asio::co_spawn(pool,
+                           ComputeAwaitable(i + 1, iterations),
+                           [&results, &remaining, &done, i](std::exception_ptr, uint64_t result) {
+                               results[i] = result;
+                               if (1 == remaining.fetch_sub(1, std::memory_order_acq_rel))
+                               {
+                                   done.set_value();
+                               }
+                           });
+        }
+
+        done.get_future().wait();
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.SetItemsProcessed(state.iterations() * FAN_OUT_TASK_COUNT);
+}
+BENCHMARK(BM_AsioCoSpawn)->ArgsProduct({{1, 4, 8}, {0, 1000}})->UseRealTime();
+
+// 同步完成的嵌套调用，衡量每层co_await的开销
+// range(1)为帧缓存上限，0时每个帧都向全局new申请，HeapAllocs为每次迭代的堆分配数
+// 调用链深度超过缓存上限时，超出部分的帧仍需堆分配
+static void BM_TaskChain(benchmark::State &state)
+{
+    const auto depth = static_cast<int>(state.range(0));
+    Coroutine::FrameAllocator::SetThreadCacheCapacity(static_cast<std::size_t>(state.range(1)));
+    benchmark::DoNotOptimize(Coroutine::SyncWait(Nested(depth)));
+
+    const uint64_t heapAllocations = Coroutine::FrameAllocator::GetThreadStats().heapAllocations;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(Coroutine::SyncWait(Nested(depth)));
+    }
+    state.SetItemsProcessed(state.iterations() * (depth + 1));
+    state.counters["HeapAllocs"] =
+        benchmark::Counter(static_cast<double>(Coroutine::FrameAllocator::GetThreadStats().heapAllocations -
+                                               heapAllocations),
+                           benchmark::Counter::kAvgIterations);
+
+    Coroutine::FrameAllocator::SetThreadCacheCapacity(Coroutine::DEFAULT_FRAME_CACHE_CAPACITY);
+}
+BENCHMARK(BM_TaskChain)->ArgsProduct({{1, 16, 256}, {0, Coroutine::DEFAULT_FRAME_CACHE_CAPACITY, 1024}});
+
+BENCHMARK_MAIN();
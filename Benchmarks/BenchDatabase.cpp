@@ -0,0 +1,192 @@
+﻿#include "Common/Database/DatabaseImpl/LoginDatabase.h"
+#include "Common/Database/MySqlConnection.h"
+#include "Common/Database/QueryResult.h"
+#include "Common/Util/Log.h"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdlib>
+#include <format>
+#include <memory>
+#include <string>
+
+namespace
+{
+    constexpr int64_t BENCH_TABLE_ROWS = 1000;
+
+    // 连接信息来自环境变量BENCH_MYSQL，格式为"host;port;user;password;database"，未设置时跳过
+    struct BenchConnectionInfo
+    {
+        std::array<std::string, 5> parts;
+
+        Database::MySqlConnectionInfo ToConnectionInfo() const
+        {
+            return {parts[2], parts[3], parts[4], parts[0], parts[1]};
+        }
+    };
+
+    Database::IMySqlConnection *OpenConnection()
+    {
+        const char *pEnv = std::getenv("BENCH_MYSQL");
+        if (nullptr == pEnv)
+        {
+            return nullptr;
+        }
+
+        static BenchConnectionInfo benchInfo;
+        std::string_view           env = pEnv;
+        for (std::string &part : benchInfo.parts)
+        {
+            const size_t pos = env.find(';');
+            part             = env.substr(0, pos);
+            env              = pos == std::string_view::npos ? std::string_view {} : env.substr(pos + 1);
+        }
+
+        static Database::MySqlConnectionInfo     connectionInfo = benchInfo.ToConnectionInfo();
+        static Database::LoginDatabaseConnection connection(connectionInfo,
+                                                            Database::MySqlConnectionType::Sync);
+        if (0 != connection.Open())
+        {
+            return nullptr;
+        }
+
+        // 临时表只在本连接可见，断开时自动删除
+        const std::string fillSql =
+            std::format("INSERT INTO bench_field "
+                        "WITH RECURSIVE seq(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM seq WHERE n < {}) "
+                        "SELECT n, n % 100, n * 100000, CONCAT('player', n), REPEAT('x', 64) FROM seq",
+                        BENCH_TABLE_ROWS);
+        if (!connection.Execute("CREATE TEMPORARY TABLE bench_field (id INT UNSIGNED, level SMALLINT, "
+                                "gold BIGINT, name VARCHAR(32), intro VARCHAR(255))")
+            || !connection.Execute(fillSql))
+        {
+            return nullptr;
+        }
+
+        return &connection;
+    }
+
+    Database::IMySqlConnection *GetConnection(benchmark::State &state)
+    {
+        static Database::IMySqlConnection *pConnection = OpenConnection();
+        if (nullptr == pConnection)
+        {
+            state.SkipWithError("未设置BENCH_MYSQL或连接失败，格式：host;port;user;password;database");
+        }
+        return pConnection;
+    }
+} // namespace
+
+// 读取当前行各列，列类型与读取类型一致，走直接拷贝本机字节的快速路径
+static void BM_FieldGetNative(benchmark::State &state)
+{
+    Database::IMySqlConnection *pConnection = GetConnection(state);
+    if (nullptr == pConnection)
+    {
+        return;
+    }
+
+    Database::QueryResultSetPtr pResult =
+        pConnection->Query("SELECT id, level, gold, name, intro FROM bench_field LIMIT 1");
+    if (nullptr == pResult || !pResult->NextRow())
+    {
+        state.SkipWithError("查询失败");
+        return;
+    }
+
+    Database::Field *pFields = pResult->Fetch();
+    for (auto _ : state)
+    {
+        uint32_t         id    = pFields[0];
+        int16_t          level = pFields[1];
+        int64_t          gold  = pFields[2];
+        std::string_view name  = pFields[3];
+        std::string_view intro = pFields[4];
+        benchmark::DoNotOptimize(id);
+        benchmark::DoNotOptimize(level);
+        benchmark::DoNotOptimize(gold);
+        benchmark::DoNotOptimize(name);
+        benchmark::DoNotOptimize(intro);
+    }
+    state.SetItemsProcessed(state.iterations() * 5);
+}
+BENCHMARK(BM_FieldGetNative);
+
+// 列类型与读取类型不一致，走类型检查与转换的路径
+static void BM_FieldGetConverted(benchmark::State &state)
+{
+    Database::IMySqlConnection *pConnection = GetConnection(state);
+    if (nullptr == pConnection)
+    {
+        return;
+    }
+
+    Database::QueryResultSetPtr pResult =
+        pConnection->Query("SELECT id, level, name FROM bench_field LIMIT 1");
+    if (nullptr == pResult || !pResult->NextRow())
+    {
+        state.SkipWithError("查询失败");
+        return;
+    }
+
+    Database::Field *pFields = pResult->Fetch();
+    for (auto _ : state)
+    {
+        uint64_t    id    = pFields[0];
+        int32_t     level = pFields[1];
+        std::string name  = pFields[2];
+        benchmark::DoNotOptimize(id);
+        benchmark::DoNotOptimize(level);
+        benchmark::DoNotOptimize(name);
+    }
+    state.SetItemsProcessed(state.iterations() * 3);
+}
+BENCHMARK(BM_FieldGetConverted);
+
+// 查询并逐行读取，包含一次往返与文本协议数值列的解析，range(0)为行数
+static void BM_QueryResultScan(benchmark::State &state)
+{
+    Database::IMySqlConnection *pConnection = GetConnection(state);
+    if (nullptr == pConnection)
+    {
+        return;
+    }
+
+    const std::string sql =
+        std::format("SELECT id, level, gold, name FROM bench_field LIMIT {}", state.range(0));
+    for (auto _ : state)
+    {
+        Database::QueryResultSetPtr pResult = pConnection->Query(sql);
+        if (nullptr == pResult)
+        {
+            state.SkipWithError("查询失败");
+            return;
+        }
+
+        int64_t total = 0;
+        while (pResult->NextRow())
+        {
+            Database::Field *pFields = pResult->Fetch();
+            total += static_cast<uint32_t>(pFields[0]) + static_cast<int64_t>(pFields[2]);
+            benchmark::DoNotOptimize(static_cast<std::string_view>(pFields[3]));
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QueryResultScan)->Arg(1)->Arg(100)->Arg(BENCH_TABLE_ROWS)->UseRealTime();
+
+int main(int argc, char **argv)
+{
+    Log::CLogger::GetLogger().SetLevel(static_cast<size_t>(spdlog::level::warn));
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,151 @@
+﻿#include "Common/Net/Http/HttpParser.h"
+#include "Common/Net/Http/HttpRequest.h"
+#include "Common/Net/Http/HttpResponse.h"
+#include "Common/Net/Http/HttpRouter.h"
+#include "Common/Util/CachedClock.h"
+#include "Common/Util/Log.h"
+
+#include <benchmark/benchmark.h>
+
+#include <format>
+#include <string>
+
+namespace
+{
+    // 浏览器发出的典型请求
+    constexpr std::string_view BROWSER_REQUEST =
+        "GET /user?id=10086&name=harold&lang=zh-CN HTTP/1.1\r\n"
+        "Host: 127.0.0.1:10007\r\n"
+        "Connection: keep-alive\r\n"
+        "Cache-Control: max-age=0\r\n"
+        "Upgrade-Insecure-Requests: 1\r\n"
+        "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) "
+        "Chrome/120.0.0.0 Safari/537.36\r\n"
+        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;q=0.8\r\n"
+        "Accept-Encoding: gzip, deflate, br\r\n"
+        "Accept-Language: zh-CN,zh;q=0.9,en;q=0.8\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n";
+
+    // 压测工具发出的最小请求
+    constexpr std::string_view MINIMAL_REQUEST = "GET / HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+
+    Http::HttpRouter MakeRouter()
+    {
+        Http::HttpRouter router;
+        for (int i = 0; i < 16; ++i)
+        {
+            router.AddHttpHandler(Http::HttpMethod::Get,
+                                  std::format("/api/v1/resource{}", i),
+                                  [](const Http::HttpRequest & /*req*/, Http::HttpResponse &resp) {
+                                      resp.SetStatusCode(Http::StatusCode::Ok);
+                                  });
+        }
+
+        router.AddHttpHandler(Http::HttpMethod::Get,
+                              "/",
+                              [](const Http::HttpRequest & /*req*/, Http::HttpResponse &resp) {
+                                  resp.FillResponse(Http::StatusCode::Ok,
+                                                    Http::ContentType::String,
+                                                    "Hello 你好!");
+                              });
+        router.AddHttpHandler(Http::HttpMethod::Get,
+                              "/user",
+                              [](const Http::HttpRequest &req, Http::HttpResponse &resp) {
+                                  resp.FillResponse(Http::StatusCode::Ok,
+                                                    Http::ContentType::Json,
+                                                    std::format(R"({{"host":"{}"}})", req.GetHeader("host")));
+                              });
+        return router;
+    }
+
+    std::string_view SelectRequest(int64_t index)
+    {
+        return 0 == index ? MINIMAL_REQUEST : BROWSER_REQUEST;
+    }
+} // namespace
+
+// range(0)：0为最小请求，1为浏览器请求
+static void BM_HttpParseRequest(benchmark::State &state)
+{
+    const std::string_view request = SelectRequest(state.range(0));
+    Http::HttpParser       parser;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(parser.ParseRequest(request));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(request.size()));
+}
+BENCHMARK(BM_HttpParseRequest)->Arg(0)->Arg(1);
+
+static void BM_HttpGetHeader(benchmark::State &state)
+{
+    Http::HttpRequest request;
+    request.Parse(BROWSER_REQUEST);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(request.GetHeader("content-length"));
+    }
+}
+BENCHMARK(BM_HttpGetHeader);
+
+// range(0)：0为命中，1为未注册的路径
+static void BM_HttpRouterRoute(benchmark::State &state)
+{
+    Http::HttpRouter  router = MakeRouter();
+    Http::HttpRequest request;
+    request.Parse(0 == state.range(0) ? MINIMAL_REQUEST : "GET /missing HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+    for (auto _ : state)
+    {
+        Http::HttpResponse response;
+        router.Route(request, response);
+        benchmark::DoNotOptimize(response);
+    }
+}
+BENCHMARK(BM_HttpRouterRoute)->Arg(0)->Arg(1);
+
+// range(0)为响应体字节数
+static void BM_HttpResponsePayload(benchmark::State &state)
+{
+    const std::string content(static_cast<size_t>(state.range(0)), 'x');
+    for (auto _ : state)
+    {
+        Http::HttpResponse response;
+        response.FillResponse(Http::StatusCode::Ok, Http::ContentType::Json, content);
+        benchmark::DoNotOptimize(response.GetPayload());
+    }
+}
+BENCHMARK(BM_HttpResponsePayload)->Arg(16)->Arg(1024)->Arg(64 << 10);
+
+// 与HttpSession::OnMessageReceived相同的完整处理：解析、路由、生成响应
+static void BM_HttpHandleRequest(benchmark::State &state)
+{
+    Http::HttpRouter       router  = MakeRouter();
+    const std::string_view content = SelectRequest(state.range(0));
+    for (auto _ : state)
+    {
+        Http::HttpRequest  request;
+        Http::HttpResponse response;
+        request.Parse(content);
+        router.Route(request, response);
+        response.SetHeader("Date", TimeUtil::CachedClock::GetHttpDate());
+        benchmark::DoNotOptimize(response.GetPayload());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HttpHandleRequest)->Arg(0)->Arg(1);
+
+int main(int argc, char **argv)
+{
+    // 路由未命中等路径会输出日志，基准中只保留严重错误
+    Log::CLogger::GetLogger().SetLevel(static_cast<size_t>(spdlog::level::critical));
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,82 @@
+﻿#include "Common/Util/Log.h"
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <mutex>
+
+namespace
+{
+    std::string GetBenchLogFile(std::string_view fileName)
+    {
+        return (std::filesystem::temp_directory_path() / fileName).string();
+    }
+
+    // 异步日志只能初始化一次，首个用到的基准负责初始化
+    void InitAsyncLoggerOnce()
+    {
+        static std::once_flag initFlag;
+        std::call_once(initFlag, []() {
+            Log::AsyncLogConfig config;
+            config.bConsoleOutput = false;
+            Log::CLogger::GetLogger().InitAsyncLogger(GetBenchLogFile("BenchLog.html"), 0, 64, 2, config);
+        });
+    }
+} // namespace
+
+// 模块等级不满足时的开销：一次原子读和一次分支，参数不求值
+static void BM_LogFiltered(benchmark::State &state)
+{
+    Log::CLogger::GetLogger().SetModuleLevel(Log::LogModule::Net, static_cast<size_t>(spdlog::level::err));
+    int64_t sessionId = 10086;
+    for (auto _ : state)
+    {
+        LOG_DEBUG(Net, "会话{}收到{}字节", sessionId, state.iterations());
+        benchmark::ClobberMemory();
+    }
+    Log::CLogger::GetLogger().SetModuleLevel(Log::LogModule::Net, 0);
+}
+BENCHMARK(BM_LogFiltered);
+
+// 异步日志：调用线程格式化并入队，队列满时阻塞，结果反映写线程可持续的吞吐
+static void BM_LogAsync(benchmark::State &state)
+{
+    InitAsyncLoggerOnce();
+    int64_t playerId = 10086 + state.thread_index();
+    for (auto _ : state)
+    {
+        Log::Info("玩家{}进入场景{}，坐标({:.2f}, {:.2f})", playerId, 1001, 12.5, -3.25);
+    }
+
+    if (0 == state.thread_index())
+    {
+        Log::CLogger::GetLogger().Flush();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogAsync)->Threads(1)->Threads(4)->UseRealTime();
+
+// 二进制日志：只编码原始参数写入映射文件，开启后所有日志都写入二进制文件，因此放在最后
+static void BM_LogBinary(benchmark::State &state)
+{
+    if (0 == state.thread_index()
+        && !Log::CLogger::GetLogger().InitBinaryLogger(GetBenchLogFile("BenchLog.blog"), 0, 64))
+    {
+        state.SkipWithError("打开二进制日志文件失败");
+    }
+
+    int64_t playerId = 10086 + state.thread_index();
+    for (auto _ : state)
+    {
+        Log::Info("玩家{}进入场景{}，坐标({:.2f}, {:.2f})", playerId, 1001, 12.5, -3.25);
+    }
+
+    if (0 == state.thread_index())
+    {
+        Log::BinaryLogger::GetInstance().Close();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogBinary)->Threads(1)->Threads(4)->UseRealTime();
+
+BENCHMARK_MAIN();
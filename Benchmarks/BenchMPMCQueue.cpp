@@ -0,0 +1,145 @@
+﻿#include "Common/Util/MPMCQueue.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <barrier>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr int64_t     ITEM_COUNT     = 1 << 16; // 每次迭代传递的元素数，可被1~16整除
+    constexpr std::size_t QUEUE_CAPACITY = 1024;
+
+    // 原ProducerConsumerQueue的实现方式：互斥锁保护的std::queue加条件变量，作为对照
+    template <typename T>
+    class MutexQueue
+    {
+    public:
+        explicit MutexQueue(std::size_t /*capacity*/)
+        {
+        }
+
+        bool WaitAndPush(T value)
+        {
+            {
+                std::lock_guard<std::mutex> lock(_queueLock);
+                _queue.push(std::move(value));
+            }
+            _condition.notify_one();
+            return true;
+        }
+
+        bool WaitAndPop(T &value)
+        {
+            std::unique_lock<std::mutex> lock(_queueLock);
+            _condition.wait(lock, [this] {
+                return !_queue.empty();
+            });
+            value = std::move(_queue.front());
+            _queue.pop();
+            return true;
+        }
+
+    private:
+        std::mutex              _queueLock;
+        std::queue<T>           _queue;
+        std::condition_variable _condition;
+    };
+
+    // range(0)个生产者与range(1)个消费者，工作线程在迭代之间保持存活，只统计传递元素的时间
+    template <typename QueueType>
+    void RunProducerConsumer(benchmark::State &state)
+    {
+        const auto producerCount = static_cast<int>(state.range(0));
+        const auto consumerCount = static_cast<int>(state.range(1));
+
+        QueueType    queue(QUEUE_CAPACITY);
+        std::barrier sync(producerCount + consumerCount + 1);
+        bool         bStop = false;
+
+        std::vector<std::jthread> threads;
+        for (int i = 0; i < producerCount; ++i)
+        {
+            threads.emplace_back([&] {
+                while (true)
+                {
+                    sync.arrive_and_wait();
+                    if (bStop)
+                    {
+                        return;
+                    }
+                    for (int64_t value = 0; value < ITEM_COUNT / producerCount; ++value)
+                    {
+                        queue.WaitAndPush(value);
+                    }
+                    sync.arrive_and_wait();
+                }
+            });
+        }
+        for (int i = 0; i < consumerCount; ++i)
+        {
+            threads.emplace_back([&] {
+                int64_t value = 0;
+                int64_t sum   = 0;
+                while (true)
+                {
+                    sync.arrive_and_wait();
+                    if (bStop)
+                    {
+                        benchmark::DoNotOptimize(sum);
+                        return;
+                    }
+                    for (int64_t count = 0; count < ITEM_COUNT / consumerCount; ++count)
+                    {
+                        queue.WaitAndPop(value);
+                        sum += value;
+                    }
+                    sync.arrive_and_wait();
+                }
+            });
+        }
+
+        for (auto _ : state)
+        {
+            sync.arrive_and_wait();
+            sync.arrive_and_wait();
+        }
+        bStop = true;
+        sync.arrive_and_wait();
+
+        state.SetItemsProcessed(state.iterations() * ITEM_COUNT);
+    }
+} // namespace
+
+static void BM_MPMCQueue(benchmark::State &state)
+{
+    RunProducerConsumer<MPMCQueue<int64_t>>(state);
+}
+BENCHMARK(BM_MPMCQueue)->ArgsProduct({{1, 2, 4, 8, 16}, {1, 2, 4, 8, 16}})->UseRealTime();
+
+static void BM_MutexQueue(benchmark::State &state)
+{
+    RunProducerConsumer<MutexQueue<int64_t>>(state);
+}
+BENCHMARK(BM_MutexQueue)->ArgsProduct({{1, 2, 4, 8, 16}, {1, 2, 4, 8, 16}})->UseRealTime();
+
+// 单线程无竞争时一次入队加出队的开销
+static void BM_MPMCQueueTryPushPop(benchmark::State &state)
+{
+    MPMCQueue<int64_t> queue(QUEUE_CAPACITY);
+    int64_t            value = 0;
+    for (auto _ : state)
+    {
+        queue.TryPush(value);
+        queue.TryPop(value);
+        benchmark::DoNotOptimize(value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MPMCQueueTryPushPop);
+
+BENCHMARK_MAIN();
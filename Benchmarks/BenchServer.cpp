@@ -0,0 +1,280 @@
+﻿#include "Common/Net/Http/HttpRequest.h"
+#include "Common/Net/Http/HttpResponse.h"
+#include "Common/Net/Http/HttpRouter.h"
+#include "Common/Net/Server.h"
+#include "Common/Util/CachedClock.h"
+#include "Common/Util/Log.h"
+#include "Common/Util/Util.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr size_t ECHO_MESSAGE_SIZE = 64;
+
+    constexpr std::string_view HTTP_REQUEST =
+        "GET / HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: keep-alive\r\n\r\n";
+
+    // 原样回显，衡量网络线程收发、队列与逻辑帧调度的开销
+    class EchoSession final : public Net::ISession
+    {
+    public:
+        using Net::ISession::ISession;
+
+    protected:
+        void OnMessageReceived(Net::MessageBuffer &buffer) override
+        {
+            SendMessage(buffer);
+        }
+    };
+
+    // 与HttpSession相同的处理流程，每个请求使用新的请求与响应对象
+    class BenchHttpSession final : public Net::ISession
+    {
+    public:
+        BenchHttpSession(Asio::socket &&socket, Http::HttpRouter &router)
+            : Net::ISession(std::move(socket))
+            , _router(router)
+        {
+        }
+
+    protected:
+        void OnMessageReceived(Net::MessageBuffer &buffer) override
+        {
+            const std::string  content = buffer.ReadAllAsString();
+            Http::HttpRequest  request;
+            Http::HttpResponse response;
+            if (request.Parse(content) != Http::StatusCode::Ok)
+            {
+                CloseSession();
+                return;
+            }
+
+            // 各会话都在逻辑线程上处理消息，共用服务器的路由
+            _router.Route(request, response);
+            response.SetHeader("Date", TimeUtil::CachedClock::GetHttpDate());
+            std::string_view   payload = response.GetPayload();
+            Net::MessageBuffer sendBuffer(payload.size());
+            sendBuffer.Write(payload);
+            SendMessage(sendBuffer);
+        }
+
+    private:
+        Http::HttpRouter &_router;
+    };
+
+    class BenchServer final : public Net::IServer
+    {
+    public:
+        // 端口为0，由系统分配空闲端口
+        explicit BenchServer(bool bHttp)
+            : Net::IServer("127.0.0.1", 0)
+            , _bHttp(bHttp)
+        {
+            _router.AddHttpHandler(
+                Http::HttpMethod::Get,
+                "/",
+                [](const Http::HttpRequest & /*req*/, Http::HttpResponse &resp) {
+                    resp.FillResponse(Http::StatusCode::Ok, Http::ContentType::String, "Hello");
+                });
+        }
+
+        uint16_t GetPort() const
+        {
+            return _acceptor.local_endpoint().port();
+        }
+
+    protected:
+        std::shared_ptr<Net::ISession> CreateSession(Asio::socket &&socket) override
+        {
+            if (_bHttp)
+            {
+                return std::make_shared<BenchHttpSession>(std::move(socket), _router);
+            }
+            return std::make_shared<EchoSession>(std::move(socket));
+        }
+
+    private:
+        bool             _bHttp;
+        Http::HttpRouter _router;
+    };
+
+    // 在后台线程运行服务器，析构时停止
+    class ServerRunner
+    {
+    public:
+        explicit ServerRunner(bool bHttp)
+            : _server(bHttp)
+            , _thread([this]() {
+                _server.Start();
+            })
+        {
+        }
+
+        ~ServerRunner()
+        {
+            _server.Stop();
+            _thread.join();
+        }
+
+        ServerRunner(const ServerRunner &)            = delete;
+        ServerRunner &operator=(const ServerRunner &) = delete;
+
+        uint16_t GetPort() const
+        {
+            return _server.GetPort();
+        }
+
+    private:
+        BenchServer _server;
+        std::thread _thread;
+    };
+
+    std::vector<asio::ip::tcp::socket> Connect(asio::io_context &ioCtx, uint16_t port, int64_t count)
+    {
+        const asio::ip::tcp::endpoint      endpoint(asio::ip::make_address("127.0.0.1"), port);
+        std::vector<asio::ip::tcp::socket> sockets;
+        sockets.reserve(static_cast<size_t>(count));
+        for (int64_t i = 0; i < count; ++i)
+        {
+            asio::ip::tcp::socket socket(ioCtx);
+            socket.connect(endpoint);
+            socket.set_option(asio::ip::tcp::no_delay(true));
+            sockets.push_back(std::move(socket));
+        }
+        return sockets;
+    }
+
+    // 读取一个完整的Http响应，多读的部分留在buffer中，返回响应字节数
+    size_t ReadHttpResponse(asio::ip::tcp::socket &socket, std::string &buffer)
+    {
+        constexpr std::string_view CONTENT_LENGTH = "Content-Length:";
+
+        const size_t           headerLen = asio::read_until(socket, asio::dynamic_buffer(buffer), "\r\n\r\n");
+        const std::string_view header(buffer.data(), headerLen);
+        size_t                 contentLen = 0;
+        if (const size_t pos = header.find(CONTENT_LENGTH); pos != std::string_view::npos)
+        {
+            const size_t           begin = pos + CONTENT_LENGTH.size();
+            const std::string_view value = header.substr(begin, header.find("\r\n", begin) - begin);
+            contentLen                   = Util::StringTo<size_t>(Util::TrimSpace(value)).value_or(0);
+        }
+
+        const size_t responseLen = headerLen + contentLen;
+        if (buffer.size() < responseLen)
+        {
+            asio::read(socket,
+                       asio::dynamic_buffer(buffer),
+                       asio::transfer_exactly(responseLen - buffer.size()));
+        }
+        buffer.erase(0, responseLen);
+        return responseLen;
+    }
+} // namespace
+
+// 每个连接发送一条消息并等待回显，range(0)为连接数；服务器每个逻辑帧(1ms)处理一次收到的消息
+static void BM_ServerEchoRoundTrip(benchmark::State &state)
+{
+    ServerRunner     runner(false);
+    asio::io_context ioCtx;
+    try
+    {
+        std::vector<asio::ip::tcp::socket> sockets = Connect(ioCtx, runner.GetPort(), state.range(0));
+        const std::string                  message(ECHO_MESSAGE_SIZE, 'x');
+        std::string                        reply(ECHO_MESSAGE_SIZE, '\0');
+        for (auto _ : state)
+        {
+            for (asio::ip::tcp::socket &socket : sockets)
+            {
+                asio::write(socket, asio::buffer(message));
+            }
+
+            for (asio::ip::tcp::socket &socket : sockets)
+            {
+                asio::read(socket, asio::buffer(reply));
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        state.SkipWithError(e.what());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<int64_t>(ECHO_MESSAGE_SIZE));
+}
+BENCHMARK(BM_ServerEchoRoundTrip)->Arg(1)->Arg(16)->Arg(128)->UseRealTime();
+
+// 长连接上的Http请求，每个连接同时只有一个请求，range(0)为连接数
+static void BM_ServerHttpKeepAlive(benchmark::State &state)
+{
+    ServerRunner     runner(true);
+    asio::io_context ioCtx;
+    try
+    {
+        std::vector<asio::ip::tcp::socket> sockets = Connect(ioCtx, runner.GetPort(), state.range(0));
+        std::vector<std::string>           buffers(sockets.size());
+        int64_t                            responseBytes = 0;
+        for (auto _ : state)
+        {
+            for (asio::ip::tcp::socket &socket : sockets)
+            {
+                asio::write(socket, asio::buffer(HTTP_REQUEST));
+            }
+
+            for (size_t i = 0; i < sockets.size(); ++i)
+            {
+                responseBytes += static_cast<int64_t>(ReadHttpResponse(sockets[i], buffers[i]));
+            }
+        }
+        state.SetBytesProcessed(responseBytes);
+    }
+    catch (const std::exception &e)
+    {
+        state.SkipWithError(e.what());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ServerHttpKeepAlive)->Arg(1)->Arg(16)->Arg(128)->UseRealTime();
+
+// 短连接：建立连接、一次回显、断开，衡量接受连接与会话创建销毁的开销
+static void BM_ServerConnectEcho(benchmark::State &state)
+{
+    ServerRunner     runner(false);
+    asio::io_context ioCtx;
+    try
+    {
+        const std::string message(ECHO_MESSAGE_SIZE, 'x');
+        std::string       reply(ECHO_MESSAGE_SIZE, '\0');
+        for (auto _ : state)
+        {
+            std::vector<asio::ip::tcp::socket> sockets = Connect(ioCtx, runner.GetPort(), 1);
+            asio::write(sockets.front(), asio::buffer(message));
+            asio::read(sockets.front(), asio::buffer(reply));
+        }
+    }
+    catch (const std::exception &e)
+    {
+        state.SkipWithError(e.what());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ServerConnectEcho)->UseRealTime();
+
+int main(int argc, char **argv)
+{
+    // 客户端断开时服务器会输出错误日志，基准中只保留严重错误
+    Log::CLogger::GetLogger().SetLevel(static_cast<size_t>(spdlog::level::critical));
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
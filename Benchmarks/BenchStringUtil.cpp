@@ -0,0 +1,212 @@
+﻿#include "Common/Util/StringUtil.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // 原Util::StringEqual，作为对照
+    bool LegacyStringEqual(std::string_view strLeft, std::string_view strRight)
+    {
+        return std::equal(strLeft.begin(),
+                          strLeft.end(),
+                          strRight.begin(),
+                          strRight.end(),
+                          [](char left, char right) {
+                              return std::tolower(left) == std::tolower(right);
+                          });
+    }
+
+    // 原HttpParser::TrimSpace
+    std::string_view LegacyTrimSpace(std::string_view str)
+    {
+        str.remove_prefix((std::min)(str.find_first_not_of(' '), str.size()));
+        str.remove_suffix((std::min)(str.size() - str.find_last_not_of(' ') - 1, str.size()));
+
+        return str;
+    }
+
+    template <typename T>
+    std::optional<T> LegacyParse(std::string_view str)
+    {
+        T value {};
+        auto [ptr, errc] = std::from_chars(str.data(), str.data() + str.length(), value);
+        if (ptr == str.data() + str.length() && errc == std::errc {})
+        {
+            return value;
+        }
+
+        return std::nullopt;
+    }
+
+    // 常见请求头名，查找时用小写的键与原样的头名比较
+    const std::vector<std::string> HEADER_NAMES = {"Host",
+                                                   "User-Agent",
+                                                   "Accept",
+                                                   "Accept-Language",
+                                                   "Accept-Encoding",
+                                                   "Connection",
+                                                   "Upgrade-Insecure-Requests",
+                                                   "Sec-Fetch-Dest",
+                                                   "Content-Type",
+                                                   "Content-Length"};
+
+    std::string MakeQuery(int64_t paramCount)
+    {
+        std::string query;
+        for (int64_t i = 0; i < paramCount; ++i)
+        {
+            query += (i == 0 ? "" : "&");
+            query += "parameter_" + std::to_string(i) + "=value_of_parameter_" + std::to_string(i * 7919);
+        }
+
+        return query;
+    }
+
+    std::vector<std::string> MakeNumbers(int64_t digits)
+    {
+        std::vector<std::string> numbers;
+        for (int i = 0; i < 64; ++i)
+        {
+            std::string number(static_cast<size_t>(digits), '0');
+            for (char &chr : number)
+            {
+                chr = static_cast<char>('0' + (i * 7 + (&chr - number.data()) * 3) % 10);
+            }
+            number[0] = static_cast<char>('1' + i % 9);
+            numbers.push_back(std::move(number));
+        }
+
+        return numbers;
+    }
+
+    // 在所有头名中查找content-length，与HttpParser::GetHeaderValue的访问模式一致
+    template <typename Equal>
+    void HeaderLookup(benchmark::State &state, Equal equal)
+    {
+        for (auto _ : state)
+        {
+            for (const std::string &name : HEADER_NAMES)
+            {
+                benchmark::DoNotOptimize(equal(name, "content-length"));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(HEADER_NAMES.size()));
+    }
+
+    template <typename Find>
+    void QueryScan(benchmark::State &state, Find find)
+    {
+        const std::string query = MakeQuery(state.range(0));
+        for (auto _ : state)
+        {
+            size_t count = 0;
+            for (size_t i = find(query, 0); i != std::string_view::npos; i = find(query, i + 1))
+            {
+                ++count;
+            }
+            benchmark::DoNotOptimize(count);
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(query.length()));
+    }
+
+    template <typename Parse>
+    void ParseNumbers(benchmark::State &state, Parse parse)
+    {
+        const std::vector<std::string> numbers = MakeNumbers(state.range(0));
+        for (auto _ : state)
+        {
+            for (const std::string &number : numbers)
+            {
+                benchmark::DoNotOptimize(parse(number));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(numbers.size()));
+    }
+} // namespace
+
+static void BM_HeaderEqualLegacy(benchmark::State &state)
+{
+    HeaderLookup(state, LegacyStringEqual);
+}
+BENCHMARK(BM_HeaderEqualLegacy);
+
+static void BM_HeaderEqualAscii(benchmark::State &state)
+{
+    HeaderLookup(state, Util::EqualIgnoreCaseAscii);
+}
+BENCHMARK(BM_HeaderEqualAscii);
+
+static void BM_HeaderHashAscii(benchmark::State &state)
+{
+    HeaderLookup(state, [](std::string_view name, std::string_view /*key*/) {
+        return Util::HashIgnoreCaseAscii(name);
+    });
+}
+BENCHMARK(BM_HeaderHashAscii);
+
+// 原ParseQuery逐字节判断'='和'&'
+static void BM_QueryScanLegacy(benchmark::State &state)
+{
+    QueryScan(state, [](std::string_view query, size_t pos) {
+        for (; pos < query.length(); ++pos)
+        {
+            if (query[pos] == '=' || query[pos] == '&')
+            {
+                return pos;
+            }
+        }
+        return std::string_view::npos;
+    });
+}
+BENCHMARK(BM_QueryScanLegacy)->Arg(1)->Arg(8)->Arg(64);
+
+static void BM_QueryScanFindFirstOf(benchmark::State &state)
+{
+    QueryScan(state, [](std::string_view query, size_t pos) {
+        return Util::FindFirstOf(query, '=', '&', pos);
+    });
+}
+BENCHMARK(BM_QueryScanFindFirstOf)->Arg(1)->Arg(8)->Arg(64);
+
+static void BM_TrimSpaceLegacy(benchmark::State &state)
+{
+    const std::string padding(static_cast<size_t>(state.range(0)), ' ');
+    const std::string str = padding + "value" + padding;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(LegacyTrimSpace(str));
+    }
+}
+BENCHMARK(BM_TrimSpaceLegacy)->Arg(0)->Arg(4)->Arg(64);
+
+static void BM_TrimSpaceAscii(benchmark::State &state)
+{
+    const std::string padding(static_cast<size_t>(state.range(0)), ' ');
+    const std::string str = padding + "value" + padding;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(Util::TrimSpace(str));
+    }
+}
+BENCHMARK(BM_TrimSpaceAscii)->Arg(0)->Arg(4)->Arg(64);
+
+// 参数为数字位数：Content-Length、端口号、数据库文本行中的id与时间戳
+static void BM_ParseIntFromChars(benchmark::State &state)
+{
+    ParseNumbers(state, LegacyParse<int64_t>);
+}
+BENCHMARK(BM_ParseIntFromChars)->Arg(2)->Arg(5)->Arg(10)->Arg(18);
+
+static void BM_ParseIntDecimal(benchmark::State &state)
+{
+    ParseNumbers(state, Util::ParseDecimal<int64_t>);
+}
+BENCHMARK(BM_ParseIntDecimal)->Arg(2)->Arg(5)->Arg(10)->Arg(18);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,97 @@
+﻿#include "Common/Util/CachedClock.h"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <format>
+#include <string>
+
+// 原GetGMTTimeStr：每个HTTP响应都用std::format格式化当前时间
+static void BM_FormatHttpDateStd(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        std::string date = std::format("{:%a, %d %b %Y %H:%M:%OS GMT}", std::chrono::system_clock::now());
+        benchmark::DoNotOptimize(date);
+    }
+}
+BENCHMARK(BM_FormatHttpDateStd);
+
+// 每秒一次的格式化本身
+static void BM_FormatHttpDate(benchmark::State &state)
+{
+    char    date[TimeUtil::CachedClock::HTTP_DATE_LENGTH];
+    int64_t unixSecond = 1716862537;
+    for (auto _ : state)
+    {
+        TimeUtil::CachedClock::FormatHttpDate(unixSecond++, date);
+        benchmark::DoNotOptimize(date);
+    }
+}
+BENCHMARK(BM_FormatHttpDate);
+
+// 热路径：读取缓存的Date并拷贝到响应头
+static void BM_CachedHttpDate(benchmark::State &state)
+{
+    TimeUtil::CachedClock::Update();
+    for (auto _ : state)
+    {
+        std::string date(TimeUtil::CachedClock::GetHttpDate());
+        benchmark::DoNotOptimize(date);
+    }
+}
+BENCHMARK(BM_CachedHttpDate);
+
+// 原日志文件名：每次都查找时区并格式化本地时间
+static void BM_FormatFileTimestampStd(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        std::string timestamp = std::format(
+            "{:%Y_%m_%d_%H_%M_%OS}",
+            std::chrono::zoned_time {std::chrono::current_zone(), std::chrono::system_clock::now()});
+        benchmark::DoNotOptimize(timestamp);
+    }
+}
+BENCHMARK(BM_FormatFileTimestampStd);
+
+static void BM_CachedFileTimestamp(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        TimeUtil::CachedClock::Update();
+        benchmark::DoNotOptimize(TimeUtil::CachedClock::GetFileTimestamp());
+    }
+}
+BENCHMARK(BM_CachedFileTimestamp);
+
+// 逻辑帧的刷新开销，同一秒内只读取两个时钟
+static void BM_CachedClockUpdate(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        TimeUtil::CachedClock::Update();
+    }
+}
+BENCHMARK(BM_CachedClockUpdate);
+
+static void BM_SystemClockNow(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(std::chrono::system_clock::now());
+    }
+}
+BENCHMARK(BM_SystemClockNow);
+
+static void BM_CachedUnixMillis(benchmark::State &state)
+{
+    TimeUtil::CachedClock::Update();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(TimeUtil::CachedClock::GetUnixMillis());
+    }
+}
+BENCHMARK(BM_CachedUnixMillis);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,77 @@
+add_requires("benchmark")
+
+-- 性能测试需在release模式下构建：xmake f -m release
+-- 全部运行：xmake build -g Benchmarks && xmake run -g Benchmarks
+-- xmake run 时结果以json格式输出到 build/benchmarks/<提交号>/<目标名>.json，
+-- 可用google benchmark自带的 tools/compare.py benchmarks a.json b.json 比较不同提交
+-- BenchDatabase需设置环境变量 BENCH_MYSQL="host;port;user;password;database"，未设置时跳过
+rule("BenchmarkRule")
+    on_load(function (target) 
+        target:add("deps", "Common")
+        target:add("packages", "benchmark")
+        target:set("targetdir", target:targetdir().."/Benchmarks")
+        target:set("group", "Benchmarks")
+    end)
+
+    on_run(function (target)
+        import("core.base.option")
+
+        local commit = try { function ()
+            return os.iorunv("git", {"rev-parse", "--short", "HEAD"}, {curdir = os.projectdir()}):trim()
+        end } or "unknown"
+        local outdir = path.join(os.projectdir(), "build", "benchmarks", commit)
+        os.mkdir(outdir)
+
+        local args = {
+            "--benchmark_out=" .. path.join(outdir, target:name() .. ".json"),
+            "--benchmark_out_format=json"
+        }
+        table.join2(args, option.get("arguments") or {})
+        os.execv(target:targetfile(), args, {curdir = target:rundir()})
+    end)
+rule_end()
+
+target("BenchCoroutine")
+    set_kind("binary")
+    add_rules("BenchmarkRule", "CommonRule")
+    add_files("BenchCoroutine.cpp")
+
+target("BenchMPMCQueue")
+    set_kind("binary")
+    add_rules("BenchmarkRule", "CommonRule")
+    add_files("BenchMPMCQueue.cpp")
+
+target("BenchTimeUtil")
+    set_kind("binary")
+    add_rules("BenchmarkRule", "CommonRule")
+    add_files("BenchTimeUtil.cpp")
+
+target("BenchStringUtil")
+    set_kind("binary")
+    add_rules("BenchmarkRule", "CommonRule")
+    add_files("BenchStringUtil.cpp")
+
+target("BenchBuffer")
+    set_kind("binary")
+    add_rules("BenchmarkRule", "CommonRule")
+    add_files("BenchBuffer.cpp")
+
+target("BenchHttp")
+    set_kind("binary")
+    add_rules("BenchmarkRule", "CommonRule")
+    add_files("BenchHttp.cpp")
+
+target("BenchLog")
+    set_kind("binary")
+    add_rules("BenchmarkRule", "CommonRule")
+    add_files("BenchLog.cpp")
+
+target("BenchDatabase")
+    set_kind("binary")
+    add_rules("BenchmarkRule", "CommonRule")
+    add_files("BenchDatabase.cpp")
+
+target("BenchServer")
+    set_kind("binary")
+    add_rules("BenchmarkRule", "CommonRule")
+    add_files("BenchServer.cpp")
\ No newline at end of file
@@ -0,0 +1,91 @@
+﻿/*************************************************************************
+> File Name       : CancellationToken.h
+> Brief           : 协作式取消
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年05月06日  10时18分44秒
+************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace Coroutine
+{
+    class OperationCancelled : public std::exception
+    {
+    public:
+        const char *what() const noexcept override
+        {
+            return "operation cancelled";
+        }
+    };
+
+    /**
+     * @brief 取消令牌，由任务在合适的位置检查，取消不会打断正在执行的代码
+     *        默认构造的令牌永远不会被取消
+     */
+    class CancellationToken
+    {
+    public:
+        CancellationToken() = default;
+
+        [[nodiscard]] bool IsCancellationRequested() const noexcept
+        {
+            return _pCancelled != nullptr && _pCancelled->load(std::memory_order_acquire);
+        }
+
+        [[nodiscard]] bool CanBeCancelled() const noexcept
+        {
+            return _pCancelled != nullptr;
+        }
+
+        void ThrowIfCancellationRequested() const
+        {
+            if (IsCancellationRequested())
+            {
+                throw OperationCancelled {};
+            }
+        }
+
+    private:
+        friend class CancellationSource;
+
+        explicit CancellationToken(std::shared_ptr<const std::atomic<bool>> pCancelled)
+            : _pCancelled(std::move(pCancelled))
+        {
+        }
+
+        std::shared_ptr<const std::atomic<bool>> _pCancelled;
+    };
+
+    // 发出取消请求的一方，拷贝的对象共享同一状态
+    class CancellationSource
+    {
+    public:
+        CancellationSource()
+            : _pCancelled(std::make_shared<std::atomic<bool>>(false))
+        {
+        }
+
+        [[nodiscard]] CancellationToken GetToken() const
+        {
+            return CancellationToken {_pCancelled};
+        }
+
+        void Cancel() noexcept
+        {
+            _pCancelled->store(true, std::memory_order_release);
+        }
+
+        [[nodiscard]] bool IsCancellationRequested() const noexcept
+        {
+            return _pCancelled->load(std::memory_order_acquire);
+        }
+
+    private:
+        std::shared_ptr<std::atomic<bool>> _pCancelled;
+    };
+} // namespace Coroutine
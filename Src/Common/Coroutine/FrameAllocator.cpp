@@ -0,0 +1,166 @@
+﻿/*************************************************************************
+> File Name       : FrameAllocator.cpp
+> Brief           : 协程帧分配器
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年05月08日  14时26分13秒
+************************************************************************/
+#include "FrameAllocator.h"
+
+#include <array>
+
+namespace Coroutine::FrameAllocator
+{
+    namespace
+    {
+        // 空闲帧的前几个字节用作链表指针
+        struct FreeFrame
+        {
+            FreeFrame *pNext;
+        };
+
+        struct FrameSizeClass
+        {
+            FreeFrame  *pHead {nullptr};
+            std::size_t count {0};
+        };
+
+        struct FrameCache
+        {
+            std::array<FrameSizeClass, FRAME_SIZE_CLASS_COUNT> sizeClasses;
+            std::size_t                                        capacity {DEFAULT_FRAME_CACHE_CAPACITY};
+            FrameAllocatorStats                                stats;
+
+            void Trim(std::size_t keepCount) noexcept
+            {
+                for (FrameSizeClass &sizeClass : sizeClasses)
+                {
+                    while (sizeClass.count > keepCount)
+                    {
+                        FreeFrame *pFrame = sizeClass.pHead;
+                        sizeClass.pHead   = pFrame->pNext;
+                        --sizeClass.count;
+                        --stats.cachedFrames;
+                        ::operator delete(pFrame);
+                    }
+                }
+            }
+
+            ~FrameCache();
+        };
+
+        // 线程退出时缓存析构后，其他线程局部对象析构中释放的帧直接归还全局
+        thread_local constinit bool tCacheDestroyed = false;
+        thread_local FrameCache     tCache;
+
+        FrameCache::~FrameCache()
+        {
+            Trim(0);
+            tCacheDestroyed = true;
+        }
+
+        constexpr std::size_t GetSizeClassIndex(std::size_t size) noexcept
+        {
+            return (size + FRAME_SIZE_GRANULARITY - 1) / FRAME_SIZE_GRANULARITY - 1;
+        }
+
+        constexpr std::size_t GetSizeClassBytes(std::size_t index) noexcept
+        {
+            return (index + 1) * FRAME_SIZE_GRANULARITY;
+        }
+
+        static_assert(sizeof(FreeFrame) <= FRAME_SIZE_GRANULARITY);
+        static_assert(GetSizeClassIndex(1) == 0 && GetSizeClassIndex(FRAME_SIZE_GRANULARITY) == 0);
+        static_assert(GetSizeClassIndex(MAX_POOLED_FRAME_SIZE) == FRAME_SIZE_CLASS_COUNT - 1);
+    } // namespace
+
+    void *Allocate(std::size_t size)
+    {
+        if (tCacheDestroyed) [[unlikely]]
+        {
+            return ::operator new(size);
+        }
+
+        FrameCache &cache = tCache;
+        if (size == 0 || size > MAX_POOLED_FRAME_SIZE) [[unlikely]]
+        {
+            ++cache.stats.heapAllocations;
+            ++cache.stats.oversizeFrames;
+            return ::operator new(size);
+        }
+
+        const std::size_t index     = GetSizeClassIndex(size);
+        FrameSizeClass   &sizeClass = cache.sizeClasses[index];
+        if (FreeFrame *pFrame = sizeClass.pHead; nullptr != pFrame) [[likely]]
+        {
+            sizeClass.pHead = pFrame->pNext;
+            --sizeClass.count;
+            --cache.stats.cachedFrames;
+            ++cache.stats.reusedFrames;
+            return pFrame;
+        }
+
+        // 按级别上限申请，同级别的任意大小都可以复用
+        ++cache.stats.heapAllocations;
+        return ::operator new(GetSizeClassBytes(index));
+    }
+
+    void Deallocate(void *pFrame, std::size_t size) noexcept
+    {
+        if (nullptr == pFrame)
+        {
+            return;
+        }
+
+        if (tCacheDestroyed || size == 0 || size > MAX_POOLED_FRAME_SIZE) [[unlikely]]
+        {
+            ::operator delete(pFrame);
+            return;
+        }
+
+        FrameCache     &cache     = tCache;
+        FrameSizeClass &sizeClass = cache.sizeClasses[GetSizeClassIndex(size)];
+        if (sizeClass.count >= cache.capacity) [[unlikely]]
+        {
+            ::operator delete(pFrame);
+            return;
+        }
+
+        auto *pFreeFrame  = ::new (pFrame) FreeFrame {sizeClass.pHead};
+        sizeClass.pHead   = pFreeFrame;
+        ++sizeClass.count;
+        ++cache.stats.cachedFrames;
+    }
+
+    void SetThreadCacheCapacity(std::size_t capacity) noexcept
+    {
+        if (tCacheDestroyed)
+        {
+            return;
+        }
+
+        tCache.capacity = capacity;
+        tCache.Trim(capacity);
+    }
+
+    void TrimThreadCache() noexcept
+    {
+        if (tCacheDestroyed)
+        {
+            return;
+        }
+
+        tCache.Trim(0);
+    }
+
+    FrameAllocatorStats GetThreadStats() noexcept
+    {
+        if (tCacheDestroyed)
+        {
+            return {};
+        }
+
+        return tCache.stats;
+    }
+} // namespace Coroutine::FrameAllocator
@@ -0,0 +1,120 @@
+﻿/*************************************************************************
+> File Name       : FrameAllocator.h
+> Brief           : 协程帧分配器
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年05月08日  14时26分13秒
+************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+
+namespace Coroutine
+{
+    constexpr std::size_t FRAME_SIZE_GRANULARITY       = 32;   // 大小级别的粒度
+    constexpr std::size_t MAX_POOLED_FRAME_SIZE        = 1024; // 超过此大小的帧直接使用全局new
+    constexpr std::size_t FRAME_SIZE_CLASS_COUNT       = MAX_POOLED_FRAME_SIZE / FRAME_SIZE_GRANULARITY;
+    constexpr std::size_t DEFAULT_FRAME_CACHE_CAPACITY = 64; // 每个线程每个大小级别缓存的空闲帧上限
+
+    // 当前线程的分配统计
+    struct FrameAllocatorStats
+    {
+        uint64_t heapAllocations {0}; // 向全局new申请的次数(含超大帧)
+        uint64_t reusedFrames {0};    // 从缓存中复用的次数
+        uint64_t oversizeFrames {0};  // 超过MAX_POOLED_FRAME_SIZE的帧数
+        uint64_t cachedFrames {0};    // 当前缓存中的空闲帧数
+    };
+
+    /**
+     * @brief 按大小级别回收协程帧的线程本地缓存，Task调用链逐层创建、销毁的帧在稳定后不再产生堆分配
+     *        帧在哪个线程释放就进入哪个线程的缓存(如经ThreadPool::Schedule切换线程的任务)，
+     *        每个级别的缓存有上限，线程退出时归还全部缓存
+     */
+    namespace FrameAllocator
+    {
+        /**
+         * @brief 分配协程帧，按大小级别从当前线程的缓存中取，缓存为空时向全局new申请
+         *
+         * @param size 帧大小
+         * @return 至少__STDCPP_DEFAULT_NEW_ALIGNMENT__对齐的内存
+         */
+        [[nodiscard]] void *Allocate(std::size_t size);
+
+        /**
+         * @brief 释放协程帧，放回当前线程的缓存，缓存已满时归还全局
+         *
+         * @param pFrame Allocate返回的内存，可以在其他线程分配
+         * @param size 与Allocate时相同的大小
+         */
+        void Deallocate(void *pFrame, std::size_t size) noexcept;
+
+        // 设置当前线程每个大小级别缓存的上限，0表示不缓存，超出新上限的缓存立即归还
+        void SetThreadCacheCapacity(std::size_t capacity) noexcept;
+
+        // 归还当前线程缓存的全部空闲帧
+        void TrimThreadCache() noexcept;
+
+        [[nodiscard]] FrameAllocatorStats GetThreadStats() noexcept;
+    } // namespace FrameAllocator
+
+    // 协程的promise_type继承此类，使协程帧经由FrameAllocator分配
+    struct PooledFrame
+    {
+        static void *operator new(std::size_t size)
+        {
+            return FrameAllocator::Allocate(size);
+        }
+
+        static void operator delete(void *pFrame, std::size_t size) noexcept
+        {
+            FrameAllocator::Deallocate(pFrame, size);
+        }
+    };
+
+    /**
+     * @brief 基于FrameAllocator的标准分配器，用于asio协程的可选接入
+     *        例：asio::co_spawn(executor,
+     *                           Loop(),
+     *                           asio::bind_allocator(FrameRecyclingAllocator<void> {}, asio::detached));
+     *        co_spawn的状态与完成回调经由该分配器分配
+     */
+    template <typename T>
+    class FrameRecyclingAllocator
+    {
+    public:
+        using value_type = T;
+
+        FrameRecyclingAllocator() noexcept = default;
+
+        template <typename U>
+        FrameRecyclingAllocator(const FrameRecyclingAllocator<U> & /*unused*/) noexcept
+        {
+        }
+
+        T *allocate(std::size_t count)
+        {
+            static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "不支持超对齐类型");
+
+            if (count > (std::numeric_limits<std::size_t>::max)() / sizeof(T))
+            {
+                throw std::bad_array_new_length();
+            }
+            return static_cast<T *>(FrameAllocator::Allocate(count * sizeof(T)));
+        }
+
+        void deallocate(T *pObject, std::size_t count) noexcept
+        {
+            FrameAllocator::Deallocate(pObject, count * sizeof(T));
+        }
+
+        template <typename U>
+        bool operator==(const FrameRecyclingAllocator<U> & /*unused*/) const noexcept
+        {
+            return true;
+        }
+    };
+} // namespace Coroutine
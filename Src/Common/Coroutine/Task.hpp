@@ -12,7 +12,10 @@
 #include <concepts>
 #include <exception>
 #include <semaphore>
+#include <stdexcept>
+#include <type_traits>
 #include <variant>
+#include "Common/Coroutine/FrameAllocator.h"
 #include "Common/Util/Log.h"
 
 namespace Coroutine
@@ -20,7 +23,8 @@ namespace Coroutine
 
     namespace detail
     {
-        class PromiseTypeBase
+        // 协程帧经由FrameAllocator分配，深层调用链稳定后不再产生堆分配
+        class PromiseTypeBase : public PooledFrame
         {
             struct FinalAwaitable
             {
@@ -32,7 +36,9 @@ namespace Coroutine
                 template <std::derived_from<PromiseTypeBase> PromiseType>
                 std::coroutine_handle<> await_suspend(std::coroutine_handle<PromiseType> coroutine) noexcept
                 {
-                    return coroutine.promise()._continueCoro;
+                    // 没有等待者时(如被直接resume)返回空句柄是未定义行为，交还给恢复它的调用方
+                    std::coroutine_handle<> continueCoro = coroutine.promise()._continueCoro;
+                    return continueCoro != nullptr ? continueCoro : std::noop_coroutine();
                 }
 
                 inline constexpr void await_resume() noexcept
@@ -80,7 +86,7 @@ namespace Coroutine
                 requires std::convertible_to<ValueType &&, T>
             void return_value(ValueType &&value) noexcept(std::is_nothrow_constructible_v<T, ValueType &&>)
             {
-                _result.template emplace<ValueType>(std::forward<ValueType>(value));
+                _result.template emplace<T>(std::forward<ValueType>(value));
             }
 
             T &result() &
@@ -196,13 +202,13 @@ namespace Coroutine
 
                 decltype(auto) await_resume()
                 {
-                    if (_coroutine == nullptr)
+                    if (this->_coroutine == nullptr)
                     {
                         Log::Error("Broken Promise");
                         throw std::logic_error("broken promise");
                     }
 
-                    return _coroutine.promise().result();
+                    return this->_coroutine.promise().result();
                 }
             };
 
@@ -218,12 +224,20 @@ namespace Coroutine
 
                 decltype(auto) await_resume()
                 {
-                    if (_coroutine == nullptr)
+                    if (this->_coroutine == nullptr)
                     {
                         Log::Error("Broken Promise");
+                        throw std::logic_error("broken promise");
                     }
 
-                    return std::move(_coroutine.promise().result());
+                    if constexpr (std::is_void_v<T>)
+                    {
+                        return this->_coroutine.promise().result();
+                    }
+                    else
+                    {
+                        return std::move(this->_coroutine.promise().result());
+                    }
                 }
             };
 
@@ -277,10 +291,146 @@ namespace Coroutine
         std::coroutine_handle<promise_type> _coroutine;
     };
 
+    namespace detail
+    {
+        // 只等待任务完成，不取结果，结果与异常留在任务的promise中
+        template <typename PromiseType>
+        struct ReadyAwaiter
+        {
+            std::coroutine_handle<PromiseType> _coroutine;
+
+            bool await_ready() const noexcept
+            {
+                return _coroutine == nullptr || _coroutine.done();
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaitCoroutine) const noexcept
+            {
+                _coroutine.promise().SetContinuation(awaitCoroutine);
+                return _coroutine;
+            }
+
+            constexpr void await_resume() const noexcept
+            {
+            }
+        };
+
+        // SyncWait使用的外层协程，完成时释放信号量唤醒等待线程
+        class SyncWaitTask
+        {
+        public:
+            struct promise_type : PooledFrame
+            {
+                std::binary_semaphore *_pSemaphore {nullptr};
+
+                SyncWaitTask get_return_object() noexcept
+                {
+                    return SyncWaitTask {std::coroutine_handle<promise_type>::from_promise(*this)};
+                }
+
+                std::suspend_always initial_suspend() noexcept
+                {
+                    return {};
+                }
+
+                auto final_suspend() noexcept
+                {
+                    struct FinalAwaitable
+                    {
+                        bool await_ready() noexcept
+                        {
+                            return false;
+                        }
+
+                        // 协程已挂起，等待线程被唤醒后可以立即销毁协程帧
+                        void await_suspend(std::coroutine_handle<promise_type> coroutine) noexcept
+                        {
+                            coroutine.promise()._pSemaphore->release();
+                        }
+
+                        void await_resume() noexcept
+                        {
+                        }
+                    };
+
+                    return FinalAwaitable {};
+                }
+
+                void return_void() noexcept
+                {
+                }
+
+                // 协程体只等待ReadyAwaiter，不会抛出异常
+                void unhandled_exception() noexcept
+                {
+                    std::terminate();
+                }
+            };
+
+            explicit SyncWaitTask(std::coroutine_handle<promise_type> coroutine) noexcept
+                : _coroutine(coroutine)
+            {
+            }
+
+            SyncWaitTask(const SyncWaitTask &)            = delete;
+            SyncWaitTask &operator=(const SyncWaitTask &) = delete;
+
+            ~SyncWaitTask()
+            {
+                if (_coroutine != nullptr)
+                {
+                    _coroutine.destroy();
+                }
+            }
+
+            void Start(std::binary_semaphore &semaphore) noexcept
+            {
+                _coroutine.promise()._pSemaphore = &semaphore;
+                _coroutine.resume();
+            }
+
+        private:
+            std::coroutine_handle<promise_type> _coroutine;
+        };
+
+        template <typename PromiseType>
+        SyncWaitTask MakeSyncWaitTask(std::coroutine_handle<PromiseType> coroutine)
+        {
+            co_await ReadyAwaiter<PromiseType> {coroutine};
+        }
+    } // namespace detail
+
+    /**
+     * @brief 在当前线程上启动任务并阻塞至其完成，任务可在执行中切换到其他线程(如ThreadPool::Schedule)
+     *        不能在任务最终恢复所在的线程上调用，否则会死锁
+     *
+     * @param task 尚未开始的任务
+     * @return 任务的结果，任务抛出的异常在此重新抛出
+     */
     template <typename TaskType>
-    auto SyncWait(TaskType &&task)
+    auto SyncWait(TaskType &&task) -> typename std::remove_cvref_t<TaskType>::value_type
     {
-        std::binary_semaphore cond(0);
+        using ValueType = typename std::remove_cvref_t<TaskType>::value_type;
+
+        auto coroutine = task.get();
+        if (coroutine == nullptr)
+        {
+            throw std::logic_error("broken promise");
+        }
+
+        std::binary_semaphore semaphore(0);
+        auto                  waitTask = detail::MakeSyncWaitTask(coroutine);
+        waitTask.Start(semaphore);
+        semaphore.acquire();
+
+        if constexpr (std::is_void_v<ValueType>)
+        {
+            coroutine.promise().result();
+        }
+        else
+        {
+            return ValueType(std::move(coroutine.promise()).result());
+        }
     }
 
 } // namespace Coroutine
\ No newline at end of file
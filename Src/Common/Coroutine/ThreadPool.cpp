@@ -0,0 +1,149 @@
+﻿/*************************************************************************
+> File Name       : ThreadPool.cpp
+> Brief           : 协程线程池
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年05月06日  10时18分44秒
+************************************************************************/
+#include "ThreadPool.h"
+#include "Common/Util/Profiler.h"
+
+#include <algorithm>
+#include <format>
+
+namespace Coroutine
+{
+    namespace
+    {
+        thread_local const ThreadPool *t_pCurrentPool = nullptr;
+        thread_local uint32_t          t_workerIndex  = 0;
+    } // namespace
+
+    ThreadPool::ThreadPool(uint32_t threadCount)
+    {
+        threadCount = std::max<uint32_t>(threadCount, 1);
+        _queues.reserve(threadCount);
+        for (uint32_t i = 0; i < threadCount; ++i)
+        {
+            _queues.emplace_back(std::make_unique<WorkerQueue>());
+        }
+
+        _threads.reserve(threadCount);
+        for (uint32_t i = 0; i < threadCount; ++i)
+        {
+            _threads.emplace_back([this, i]() {
+                WorkerLoop(i);
+            });
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        Shutdown();
+    }
+
+    void ThreadPool::Post(std::coroutine_handle<> coroutine)
+    {
+        const auto     queueCount = static_cast<uint32_t>(_queues.size());
+        const uint32_t index =
+            IsInPool() ? t_workerIndex : _nextQueue.fetch_add(1, std::memory_order_relaxed) % queueCount;
+        {
+            WorkerQueue    &queue = *_queues[index];
+            std::lock_guard lock(queue.mutex);
+            queue.coroutines.emplace_back(coroutine);
+        }
+
+        // 与WorkerLoop中的检查顺序相反，两者均为seq_cst，保证不会同时错过对方
+        _pendingCount.fetch_add(1);
+        if (_sleepingCount.load() > 0)
+        {
+            {
+                std::lock_guard lock(_idleMutex);
+            }
+            _idleCondition.notify_one();
+        }
+    }
+
+    void ThreadPool::Shutdown()
+    {
+        {
+            std::lock_guard lock(_idleMutex);
+            _bStop.store(true);
+        }
+        _idleCondition.notify_all();
+
+        for (auto &thread : _threads)
+        {
+            if (thread.joinable())
+            {
+                thread.join();
+            }
+        }
+    }
+
+    bool ThreadPool::IsInPool() const noexcept
+    {
+        return t_pCurrentPool == this;
+    }
+
+    bool ThreadPool::TryPop(uint32_t index, std::coroutine_handle<> &coroutine)
+    {
+        const auto queueCount = static_cast<uint32_t>(_queues.size());
+        for (uint32_t i = 0; i < queueCount; ++i)
+        {
+            WorkerQueue    &queue = *_queues[(index + i) % queueCount];
+            std::lock_guard lock(queue.mutex);
+            if (queue.coroutines.empty())
+            {
+                continue;
+            }
+
+            if (0 == i)
+            {
+                coroutine = queue.coroutines.front();
+                queue.coroutines.pop_front();
+            }
+            else
+            {
+                coroutine = queue.coroutines.back();
+                queue.coroutines.pop_back();
+            }
+
+            _pendingCount.fetch_sub(1);
+            return true;
+        }
+
+        return false;
+    }
+
+    void ThreadPool::WorkerLoop(uint32_t index)
+    {
+        t_pCurrentPool = this;
+        t_workerIndex  = index;
+        Profiler::SetThreadName(std::format("Worker {}", index));
+
+        while (true)
+        {
+            std::coroutine_handle<> coroutine;
+            if (TryPop(index, coroutine))
+            {
+                coroutine.resume();
+                continue;
+            }
+
+            std::unique_lock lock(_idleMutex);
+            _sleepingCount.fetch_add(1);
+            _idleCondition.wait(lock, [this]() {
+                return _pendingCount.load() > 0 || _bStop.load();
+            });
+            _sleepingCount.fetch_sub(1);
+
+            // 停止后继续执行已投递的协程，全部执行完再退出
+            if (_bStop.load() && _pendingCount.load() <= 0)
+            {
+                return;
+            }
+        }
+    }
+} // namespace Coroutine
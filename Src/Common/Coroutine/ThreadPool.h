@@ -0,0 +1,115 @@
+﻿/*************************************************************************
+> File Name       : ThreadPool.h
+> Brief           : 协程线程池
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年05月06日  10时18分44秒
+************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Coroutine
+{
+    /**
+     * @brief 调度协程的线程池，每个工作线程有自己的队列，空闲时从其他线程的队列尾部窃取
+     *        用于把逻辑线程上的计算密集任务(寻路、AI评估等)分散到多个核心
+     *        例：co_await pool.Schedule(); 之后的代码在线程池中执行
+     */
+    class ThreadPool
+    {
+    public:
+        class ScheduleAwaitable
+        {
+        public:
+            explicit ScheduleAwaitable(ThreadPool &pool) noexcept
+                : _pool(pool)
+            {
+            }
+
+            constexpr bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> coroutine) const
+            {
+                _pool.Post(coroutine);
+            }
+
+            constexpr void await_resume() const noexcept
+            {
+            }
+
+        private:
+            ThreadPool &_pool;
+        };
+
+        ThreadPool(const ThreadPool &)            = delete;
+        ThreadPool(ThreadPool &&)                 = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+        ThreadPool &operator=(ThreadPool &&)      = delete;
+
+        explicit ThreadPool(uint32_t threadCount = std::thread::hardware_concurrency());
+        ~ThreadPool();
+
+        // 挂起当前协程，由线程池中的某个线程恢复
+        [[nodiscard]] ScheduleAwaitable Schedule() noexcept
+        {
+            return ScheduleAwaitable {*this};
+        }
+
+        /**
+         * @brief 投递协程，工作线程上投递的协程进入本线程队列，其他线程投递的轮流分配
+         *
+         * @param coroutine 已挂起的协程
+         */
+        void Post(std::coroutine_handle<> coroutine);
+
+        /**
+         * @brief 停止线程池，执行完已投递的协程后线程退出，不能在工作线程上调用
+         */
+        void Shutdown();
+
+        [[nodiscard]] uint32_t GetThreadCount() const noexcept
+        {
+            return static_cast<uint32_t>(_threads.size());
+        }
+
+        // 当前线程是否为本线程池的工作线程
+        [[nodiscard]] bool IsInPool() const noexcept;
+
+    private:
+        struct alignas(64) WorkerQueue
+        {
+            std::mutex                          mutex;
+            std::deque<std::coroutine_handle<>> coroutines;
+        };
+
+        void WorkerLoop(uint32_t index);
+
+        // 先取本线程队列头部，再依次从其他线程队列尾部窃取
+        bool TryPop(uint32_t index, std::coroutine_handle<> &coroutine);
+
+    private:
+        std::vector<std::unique_ptr<WorkerQueue>> _queues;
+        std::vector<std::thread>                  _threads;
+        std::atomic<uint32_t>                     _nextQueue {0};
+
+        // 入队后才计数，出队可能先于计数，短暂为负
+        std::atomic<int64_t>    _pendingCount {0};
+        std::atomic<uint32_t>   _sleepingCount {0};
+        std::atomic<bool>       _bStop {false};
+        std::mutex              _idleMutex;
+        std::condition_variable _idleCondition;
+    };
+} // namespace Coroutine
@@ -0,0 +1,420 @@
+﻿/*************************************************************************
+> File Name       : WhenAll.hpp
+> Brief           : 并发等待多个任务
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年05月06日  10时18分44秒
+************************************************************************/
+#pragma once
+
+#include "CancellationToken.h"
+#include "Task.hpp"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Coroutine
+{
+    namespace detail
+    {
+        // 计数从任务数+1开始，等待方挂起时再减一，避免任务同步完成时过早恢复等待方
+        class WhenAllLatch
+        {
+        public:
+            explicit WhenAllLatch(std::size_t count) noexcept
+                : _count(count + 1)
+            {
+            }
+
+            // 返回false表示所有任务已经完成，等待方不需要挂起
+            bool TryAwait(std::coroutine_handle<> awaitCoroutine) noexcept
+            {
+                _awaitCoroutine = awaitCoroutine;
+                return _count.fetch_sub(1, std::memory_order_acq_rel) > 1;
+            }
+
+            // 最后一个完成的任务返回等待方，由调用方对称转移
+            std::coroutine_handle<> NotifyCompleted() noexcept
+            {
+                if (_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    return _awaitCoroutine;
+                }
+                return std::noop_coroutine();
+            }
+
+        private:
+            std::atomic<std::size_t> _count;
+            std::coroutine_handle<>  _awaitCoroutine;
+        };
+
+        template <typename T>
+        struct TaskResultSlot
+        {
+            std::optional<T>   value;
+            std::exception_ptr exception;
+        };
+
+        template <>
+        struct TaskResultSlot<void>
+        {
+            std::exception_ptr exception;
+        };
+
+        // 包装单个子任务，完成时通知WhenAllLatch
+        class WhenAllTask
+        {
+        public:
+            struct promise_type : PooledFrame
+            {
+                WhenAllLatch *_pLatch {nullptr};
+
+                WhenAllTask get_return_object() noexcept
+                {
+                    return WhenAllTask {std::coroutine_handle<promise_type>::from_promise(*this)};
+                }
+
+                std::suspend_always initial_suspend() noexcept
+                {
+                    return {};
+                }
+
+                auto final_suspend() noexcept
+                {
+                    struct FinalAwaitable
+                    {
+                        bool await_ready() noexcept
+                        {
+                            return false;
+                        }
+
+                        std::coroutine_handle<>
+                        await_suspend(std::coroutine_handle<promise_type> coroutine) noexcept
+                        {
+                            return coroutine.promise()._pLatch->NotifyCompleted();
+                        }
+
+                        void await_resume() noexcept
+                        {
+                        }
+                    };
+
+                    return FinalAwaitable {};
+                }
+
+                void return_void() noexcept
+                {
+                }
+
+                // 子任务的异常已在协程体内捕获
+                void unhandled_exception() noexcept
+                {
+                    std::terminate();
+                }
+            };
+
+            explicit WhenAllTask(std::coroutine_handle<promise_type> coroutine) noexcept
+                : _coroutine(coroutine)
+            {
+            }
+
+            WhenAllTask(WhenAllTask &&right) noexcept
+                : _coroutine(std::exchange(right._coroutine, nullptr))
+            {
+            }
+
+            WhenAllTask(const WhenAllTask &)            = delete;
+            WhenAllTask &operator=(const WhenAllTask &) = delete;
+            WhenAllTask &operator=(WhenAllTask &&)      = delete;
+
+            ~WhenAllTask()
+            {
+                if (_coroutine != nullptr)
+                {
+                    _coroutine.destroy();
+                }
+            }
+
+            void Start(WhenAllLatch &latch) noexcept
+            {
+                _coroutine.promise()._pLatch = &latch;
+                _coroutine.resume();
+            }
+
+        private:
+            std::coroutine_handle<promise_type> _coroutine;
+        };
+
+        template <typename T>
+        WhenAllTask MakeWhenAllTask(Task<T> task, TaskResultSlot<T> &slot)
+        {
+            try
+            {
+                if constexpr (std::is_void_v<T>)
+                {
+                    co_await std::move(task);
+                }
+                else
+                {
+                    slot.value.emplace(co_await std::move(task));
+                }
+            }
+            catch (...)
+            {
+                slot.exception = std::current_exception();
+            }
+        }
+
+        // 在等待方挂起前依次启动所有子任务，子任务各自运行到第一个挂起点
+        class WhenAllAwaitable
+        {
+        public:
+            explicit WhenAllAwaitable(std::vector<WhenAllTask> &tasks) noexcept
+                : _tasks(tasks)
+                , _latch(tasks.size())
+            {
+            }
+
+            bool await_ready() const noexcept
+            {
+                return _tasks.empty();
+            }
+
+            bool await_suspend(std::coroutine_handle<> awaitCoroutine) noexcept
+            {
+                for (auto &task : _tasks)
+                {
+                    task.Start(_latch);
+                }
+                return _latch.TryAwait(awaitCoroutine);
+            }
+
+            void await_resume() const noexcept
+            {
+            }
+
+        private:
+            std::vector<WhenAllTask> &_tasks;
+            WhenAllLatch              _latch;
+        };
+
+        // 自行销毁的协程，用于WhenAny中不再被等待的子任务
+        struct DetachedTask
+        {
+            struct promise_type : PooledFrame
+            {
+                DetachedTask get_return_object() noexcept
+                {
+                    return {};
+                }
+
+                std::suspend_never initial_suspend() noexcept
+                {
+                    return {};
+                }
+
+                std::suspend_never final_suspend() noexcept
+                {
+                    return {};
+                }
+
+                void return_void() noexcept
+                {
+                }
+
+                void unhandled_exception() noexcept
+                {
+                    std::terminate();
+                }
+            };
+        };
+
+        template <typename T>
+        struct WhenAnyState
+        {
+            std::atomic<bool>       bWinnerChosen {false};
+            std::atomic<bool>       bHandshake {false}; // 胜出的子任务与挂起的等待方中后到的一方负责恢复等待方
+            std::coroutine_handle<> awaitCoroutine;
+            std::size_t             index {0};
+            TaskResultSlot<T>       result;
+            CancellationSource      source;
+        };
+
+        template <typename T>
+        DetachedTask RunWhenAnyTask(Task<T> task, std::size_t index, std::shared_ptr<WhenAnyState<T>> pState)
+        {
+            TaskResultSlot<T> slot;
+            try
+            {
+                if constexpr (std::is_void_v<T>)
+                {
+                    co_await std::move(task);
+                }
+                else
+                {
+                    slot.value.emplace(co_await std::move(task));
+                }
+            }
+            catch (...)
+            {
+                slot.exception = std::current_exception();
+            }
+
+            if (pState->bWinnerChosen.exchange(true, std::memory_order_acq_rel))
+            {
+                co_return;
+            }
+
+            pState->index  = index;
+            pState->result = std::move(slot);
+            pState->source.Cancel();
+            if (pState->bHandshake.exchange(true, std::memory_order_acq_rel))
+            {
+                pState->awaitCoroutine.resume();
+            }
+        }
+
+        template <typename T>
+        class WhenAnyAwaitable
+        {
+        public:
+            WhenAnyAwaitable(std::vector<Task<T>> &tasks, std::shared_ptr<WhenAnyState<T>> pState) noexcept
+                : _tasks(tasks)
+                , _pState(std::move(pState))
+            {
+            }
+
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            bool await_suspend(std::coroutine_handle<> awaitCoroutine)
+            {
+                _pState->awaitCoroutine = awaitCoroutine;
+                for (std::size_t i = 0; i < _tasks.size(); ++i)
+                {
+                    RunWhenAnyTask(std::move(_tasks[i]), i, _pState);
+                }
+                return !_pState->bHandshake.exchange(true, std::memory_order_acq_rel);
+            }
+
+            void await_resume() const noexcept
+            {
+            }
+
+        private:
+            std::vector<Task<T>>            &_tasks;
+            std::shared_ptr<WhenAnyState<T>> _pState;
+        };
+    } // namespace detail
+
+    /**
+     * @brief 并发执行所有任务，全部完成后返回按原顺序排列的结果
+     *        子任务在等待方所在线程上依次启动，需要并行时子任务应先co_await ThreadPool::Schedule()
+     *
+     * @param tasks 尚未开始的任务
+     * @return 各任务的结果，任一任务抛出异常时在全部完成后重新抛出第一个异常
+     */
+    template <typename T>
+        requires(!std::is_void_v<T>)
+    Task<std::vector<T>> WhenAll(std::vector<Task<T>> tasks)
+    {
+        std::vector<detail::TaskResultSlot<T>> slots(tasks.size());
+        std::vector<detail::WhenAllTask>       wrappers;
+        wrappers.reserve(tasks.size());
+        for (std::size_t i = 0; i < tasks.size(); ++i)
+        {
+            wrappers.emplace_back(detail::MakeWhenAllTask(std::move(tasks[i]), slots[i]));
+        }
+
+        co_await detail::WhenAllAwaitable {wrappers};
+
+        std::vector<T> results;
+        results.reserve(slots.size());
+        for (auto &slot : slots)
+        {
+            if (slot.exception != nullptr)
+            {
+                std::rethrow_exception(slot.exception);
+            }
+            results.emplace_back(std::move(*slot.value));
+        }
+
+        co_return results;
+    }
+
+    inline Task<void> WhenAll(std::vector<Task<void>> tasks)
+    {
+        std::vector<detail::TaskResultSlot<void>> slots(tasks.size());
+        std::vector<detail::WhenAllTask>          wrappers;
+        wrappers.reserve(tasks.size());
+        for (std::size_t i = 0; i < tasks.size(); ++i)
+        {
+            wrappers.emplace_back(detail::MakeWhenAllTask(std::move(tasks[i]), slots[i]));
+        }
+
+        co_await detail::WhenAllAwaitable {wrappers};
+
+        for (auto &slot : slots)
+        {
+            if (slot.exception != nullptr)
+            {
+                std::rethrow_exception(slot.exception);
+            }
+        }
+    }
+
+    /**
+     * @brief 并发执行所有任务，第一个完成的任务决定结果，并通过source请求取消其余任务
+     *        其余任务在后台继续执行至完成，其结果被丢弃，任务应检查source的令牌以尽早结束
+     *
+     * @param tasks 尚未开始的任务，不能为空
+     * @param source 第一个任务完成时调用Cancel
+     * @return 第一个完成的任务的下标及结果，该任务抛出的异常在此重新抛出
+     */
+    template <typename T>
+        requires(!std::is_void_v<T>)
+    Task<std::pair<std::size_t, T>> WhenAny(std::vector<Task<T>> tasks, CancellationSource source = {})
+    {
+        if (tasks.empty())
+        {
+            throw std::invalid_argument("WhenAny需要至少一个任务");
+        }
+
+        auto pState    = std::make_shared<detail::WhenAnyState<T>>();
+        pState->source = std::move(source);
+        co_await detail::WhenAnyAwaitable<T> {tasks, pState};
+
+        if (pState->result.exception != nullptr)
+        {
+            std::rethrow_exception(pState->result.exception);
+        }
+
+        co_return std::pair<std::size_t, T> {pState->index, std::move(*pState->result.value)};
+    }
+
+    inline Task<std::size_t> WhenAny(std::vector<Task<void>> tasks, CancellationSource source = {})
+    {
+        if (tasks.empty())
+        {
+            throw std::invalid_argument("WhenAny需要至少一个任务");
+        }
+
+        auto pState    = std::make_shared<detail::WhenAnyState<void>>();
+        pState->source = std::move(source);
+        co_await detail::WhenAnyAwaitable<void> {tasks, pState};
+
+        if (pState->result.exception != nullptr)
+        {
+            std::rethrow_exception(pState->result.exception);
+        }
+
+        co_return pState->index;
+    }
+} // namespace Coroutine
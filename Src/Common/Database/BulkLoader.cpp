@@ -0,0 +1,24 @@
+﻿/*************************************************************************
+> File Name       : BulkLoader.cpp
+> Brief           : 启动时按主键范围并行加载大表
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月08日  14时05分37秒
+************************************************************************/
+#include "BulkLoader.h"
+
+#include "Common/Util/Log.h"
+
+namespace Database
+{
+    void LogBulkLoadStats(uint32_t stmtID, const BulkLoadStats &stats)
+    {
+        Log::Info("预处理语句：{} 批量加载{}行，共{}块，耗时{}，{:.0f}行/秒",
+                  stmtID,
+                  stats.rowCount,
+                  stats.chunkCount,
+                  std::chrono::duration_cast<std::chrono::milliseconds>(stats.elapsed),
+                  stats.RowsPerSecond());
+    }
+} // namespace Database
@@ -0,0 +1,120 @@
+﻿/*************************************************************************
+> File Name       : BulkLoader.h
+> Brief           : 启动时按主键范围并行加载大表
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月08日  14时05分37秒
+************************************************************************/
+#pragma once
+
+#include "TypedStatement.h"
+
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Database
+{
+    // 每块至少包含的主键个数，避免小表被拆得过碎
+    constexpr uint64_t DEFAULT_BULK_LOAD_MIN_CHUNK_SIZE = 4096;
+
+    struct BulkLoadOptions
+    {
+        uint32_t chunkCount {0}; // 拆分的块数，为0时取异步连接数的两倍
+        uint64_t minChunkSize {DEFAULT_BULK_LOAD_MIN_CHUNK_SIZE};
+    };
+
+    struct BulkLoadStats
+    {
+        uint64_t                            rowCount {0};
+        uint32_t                            chunkCount {0};
+        std::chrono::steady_clock::duration elapsed {};
+
+        [[nodiscard]] double RowsPerSecond() const
+        {
+            const double seconds = std::chrono::duration<double>(elapsed).count();
+            return seconds > 0 ? static_cast<double>(rowCount) / seconds : 0;
+        }
+    };
+
+    namespace Detail
+    {
+        template <typename StmtType>
+        using BulkLoadKeyType = std::tuple_element_t<0, typename StmtType::ParamTuple>;
+
+        template <typename StmtType>
+        using BulkLoadRangeType = std::tuple<BulkLoadKeyType<StmtType>, BulkLoadKeyType<StmtType>>;
+    } // namespace Detail
+
+    /**
+     * @brief 批量加载的语句约束
+     *        范围语句无参数，返回主键的最小值与最大值，例：select min(id), max(id) from item；
+     *        分块语句以闭区间的两端为参数，例：select ... from item where id between ? and ?
+     */
+    template <typename RangeStmtType, typename ChunkStmtType>
+    concept BulkLoadStmts =
+        ChunkStmtType::PARAM_COUNT == 2 && std::integral<Detail::BulkLoadKeyType<ChunkStmtType>> &&
+        std::is_same_v<typename ChunkStmtType::ParamTuple, Detail::BulkLoadRangeType<ChunkStmtType>> &&
+        RangeStmtType::PARAM_COUNT == 0 &&
+        std::is_same_v<typename RangeStmtType::RowType, typename ChunkStmtType::ParamTuple>;
+
+    /**
+     * @brief 将主键闭区间[first, last]拆分为若干个相邻的闭区间
+     *
+     * @param first 最小主键
+     * @param last 最大主键
+     * @param chunkCount 期望的块数
+     * @param minChunkSize 每块至少包含的主键个数
+     * @return 按主键升序的各块区间，first大于last时为空
+     */
+    template <std::integral Key>
+    std::vector<std::pair<Key, Key>>
+    SplitKeyRange(Key first, Key last, uint32_t chunkCount, uint64_t minChunkSize)
+    {
+        std::vector<std::pair<Key, Key>> chunks;
+        if (first > last)
+        {
+            return chunks;
+        }
+
+        // 以无符号数计算区间宽度，有符号主键跨越0或取满值域时也不会溢出
+        using UnsignedKey        = std::make_unsigned_t<Key>;
+        const uint64_t firstBits = static_cast<UnsignedKey>(first);
+        const uint64_t width     = static_cast<UnsignedKey>(static_cast<UnsignedKey>(last) - firstBits);
+
+        uint64_t count = std::max<uint64_t>(chunkCount, 1);
+        if (minChunkSize > 1)
+        {
+            count = std::min(count, width / minChunkSize + 1);
+        }
+
+        // 主键个数为width + 1，取满值域时会溢出，因此分开计算
+        if (width < count)
+        {
+            count = width + 1;
+        }
+
+        // 前count-1块各含step个主键，余下的全部归入最后一块
+        const uint64_t step = width / count + (width % count + 1 == count ? 1 : 0);
+        chunks.reserve(count);
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            const auto chunkFirst = static_cast<Key>(firstBits + i * step);
+            const auto chunkLast =
+                (i + 1 == count) ? last : static_cast<Key>(firstBits + (i + 1) * step - 1);
+            chunks.emplace_back(chunkFirst, chunkLast);
+        }
+
+        return chunks;
+    }
+
+    // 输出批量加载的行数与速度
+    void LogBulkLoadStats(uint32_t stmtID, const BulkLoadStats &stats);
+} // namespace Database
@@ -8,8 +8,11 @@
 ************************************************************************/
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <future>
+#include <functional>
 
 using MySqlHandle = struct MYSQL;
 using MySqlResult = struct MYSQL_RES;
@@ -44,22 +47,67 @@ namespace Database
         Async_Sync = 0x1 | 0x2,
     };
 
+    // 类型化预处理语句的参数绑定描述，数据由调用方持有，绑定时不拷贝
+    struct SqlBindValue
+    {
+        SqlArgType  type;
+        const void *pData;
+        uint32_t    length;
+    };
+
+    // 类型化预处理语句的结果列绑定描述
+    // String对应std::string*，Binary对应std::vector<uint8_t>*，其余为定长值的地址
+    struct SqlResultBind
+    {
+        SqlArgType type;
+        void      *pData;
+        uint32_t   length;
+    };
+
+    // 连接断开期间，已排队的异步请求的处理策略
+    enum class OutagePolicy : uint8_t
+    {
+        FailFast, // 立即返回失败
+        Park,     // 在连接的工作线程上等待重连，超过等待时长后失败
+    };
+
+    constexpr std::chrono::milliseconds MIN_RECONNECT_DELAY {500};      // 首次重连延迟
+    constexpr std::chrono::milliseconds MAX_RECONNECT_DELAY {30'000};   // 重连延迟上限，每次失败翻倍
+    constexpr std::chrono::milliseconds DEFAULT_PARK_TIMEOUT {5'000};   // Park策略下最长等待时长
+    constexpr std::chrono::seconds      DEFAULT_KEEPALIVE_INTERVAL {60}; // 空闲连接保活间隔
+
+    // 执行耗时超过该值的语句连同参数记录到日志
+    constexpr std::chrono::milliseconds DEFAULT_SLOW_QUERY_THRESHOLD {200};
+
     struct SqlStmtData
     {
         std::string_view        sql;
         std::vector<SqlArgType> argtypes;
         MySqlConnectionType     connectionType;
+        bool                    bReadOnly; // 只读语句，配置了从库时路由到从库执行
 
         constexpr SqlStmtData(std::string_view                  sql,
                               std::initializer_list<SqlArgType> types,
-                              MySqlConnectionType               connType)
+                              MySqlConnectionType               connType,
+                              bool                              bReadOnly = false)
             : sql(sql)
             , argtypes(types)
             , connectionType(connType)
+            , bReadOnly(bReadOnly)
         {
         }
     };
 
+    class PreparedStatementBase;
+
+    // 析构时将语句对象归还到PreparedStatementPool
+    struct PreparedStatementDeleter
+    {
+        void operator()(PreparedStatementBase *pStmt) const;
+    };
+
+    using PreparedStatementPtr = std::unique_ptr<PreparedStatementBase, PreparedStatementDeleter>;
+
     class QueryResultSet;
     using QueryResultSetPtr = std::shared_ptr<QueryResultSet>;
 
@@ -72,6 +120,9 @@ namespace Database
     class PreparedQueryResultSet;
     using PreparedQueryResultSetPtr = std::shared_ptr<PreparedQueryResultSet>;
 
+    // 只读的共享结果集，用于查询结果缓存
+    using PreparedQueryResultSnapshot = std::shared_ptr<const PreparedQueryResultSet>;
+
     template <typename... Args>
     inline PreparedQueryResultSetPtr MakePreparedQueryResultSetPtr(Args &&...args)
     {
@@ -84,4 +135,18 @@ namespace Database
     using PreparedQueryResultFuture  = std::future<PreparedQueryResultSetPtr>;
     using PreparedQueryResultPromise = std::future<PreparedQueryResultSetPtr>;
 
+    // 流式查询回调，返回false时停止拉取剩余数据；每批结果集自持数据与列信息，可在回调之外保留
+    using QueryRowCallback   = std::function<bool(QueryResultSet &)>;
+    using QueryBatchCallback = std::function<bool(PreparedQueryResultSetPtr)>;
+
+    // 流式查询每批默认行数
+    constexpr uint32_t DEFAULT_STREAM_BATCH_SIZE = 1024;
+
+    // 异步sql写语句合并发送：达到最小条数才合并，单次请求的条数与字节数上限，
+    // 连接断开时同一条语句的最多执行次数
+    constexpr std::size_t MIN_SQL_PIPELINE_SIZE  = 4;
+    constexpr std::size_t MAX_SQL_PIPELINE_SIZE  = 64;
+    constexpr std::size_t MAX_SQL_PIPELINE_BYTES = 1024 * 1024;
+    constexpr uint32_t    MAX_SQL_PIPELINE_RETRY = 3;
+
 } // namespace Database
\ No newline at end of file
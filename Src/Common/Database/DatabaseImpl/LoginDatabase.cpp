@@ -26,7 +26,10 @@ namespace Database
         {
             PrepareStatement(Util::ToUnderlying(sqlStmt.first),
                              sqlStmt.second.sql,
-                             sqlStmt.second.connectionType);
+                             sqlStmt.second.connectionType,
+                             sqlStmt.second.bReadOnly);
         }
+
+        CheckTypedStatement<LoginSelAccountByEmail>(g_LoginDatabaseStmts.at(LOGIN_SEL_ACCOUNT_BY_EMAIL));
     }
 } // namespace Database
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include "Common/Database/DatabaseWorkerPool.h"
 #include "Common/Database/MySqlConnection.h"
 #include "Common/Database/PreparedStatement.h"
+#include "Common/Database/TypedStatement.h"
 
 #include <string_view>
 #include <vector>
@@ -34,7 +35,8 @@ namespace Database
                 LoginDatabaseSqlID::LOGIN_SEL_ACCOUNT_BY_EMAIL,
                 {"select id, name, email, age, intro from account where email = ?",
                  {SqlArgType::String},
-                 MySqlConnectionType::Async_Sync}
+                 MySqlConnectionType::Async_Sync,
+                 true}
                 //
             },
 
@@ -42,12 +44,18 @@ namespace Database
                 LoginDatabaseSqlID::LOGIN_SEL_ACCOUNT_BY_EMAIL2,
                 {"select id, name, email, age, intro from account where email = ?",
                  {SqlArgType::String},
-                 MySqlConnectionType::Async}
+                 MySqlConnectionType::Async,
+                 true}
                 //
             },
             //
     };
 
+    // 类型化语句定义，参数与结果列类型须与上面的sql一致
+    using LoginSelAccountByEmail = Stmt<LOGIN_SEL_ACCOUNT_BY_EMAIL,
+                                        Params<std::string_view>,
+                                        Row<uint32_t, std::string, std::string, uint32_t, std::string>>;
+
     class LoginDatabaseConnection : public IMySqlConnection
     {
     public:
@@ -15,35 +15,86 @@
 
 #include "Common/Database/DatabaseImpl/LoginDatabase.h"
 
+#include <algorithm>
+
 namespace Database
 {
     template <typename ConnectionType>
-    DatabaseWorkerPool<ConnectionType>::DatabaseWorkerPool()
+    DatabaseWorkerPool<ConnectionType>::DatabaseWorkerPool() : _syncWaitHistogram(Metrics::MICROSECOND_UNIT)
     {
         Assert(mysql_thread_safe(), "数据库不是线程安全的");
     }
 
+    template <typename ConnectionType>
+    DatabaseWorkerPool<ConnectionType>::~DatabaseWorkerPool()
+    {
+        StopHealthCheck();
+
+        // 连接关闭时可能回调断线处理并投递到健康检查的io_context，须先于其释放
+        for (auto &connections : _typeConnections)
+        {
+            connections.clear();
+        }
+
+        _drainingConnections.clear();
+
+        for (const auto &pReplica : _replicas)
+        {
+            pReplica->connections[EConnectionTypeIndex_Async].clear();
+            pReplica->connections[EConnectionTypeIndex_Sync].clear();
+        }
+    }
+
     template <typename ConnectionType>
     uint32_t DatabaseWorkerPool<ConnectionType>::Open(const MySqlConnectionInfo &info,
                                                       uint8_t                    syncThreadCount,
                                                       uint8_t                    asyncThreadCount)
     {
-        _pConnectionInfo  = std::make_unique<MySqlConnectionInfo>(info);
-        _syncThreadCount  = syncThreadCount;
-        _asyncThreadCount = asyncThreadCount;
+        DatabasePoolConfig config;
+        config.minSyncConnections  = syncThreadCount;
+        config.maxSyncConnections  = syncThreadCount;
+        config.minAsyncConnections = asyncThreadCount;
+        config.maxAsyncConnections = asyncThreadCount;
+        return Open(info, config);
+    }
+
+    template <typename ConnectionType>
+    uint32_t DatabaseWorkerPool<ConnectionType>::Open(const MySqlConnectionInfo &info,
+                                                      const DatabasePoolConfig  &config)
+    {
+        _pConnectionInfo = std::make_unique<MySqlConnectionInfo>(info);
+        _config          = config;
+        _scalers[EConnectionTypeIndex_Async].emplace(config.minAsyncConnections,
+                                                     config.maxAsyncConnections,
+                                                     config);
+        _scalers[EConnectionTypeIndex_Sync].emplace(config.minSyncConnections,
+                                                    config.maxSyncConnections,
+                                                    config);
+
+        for (const auto type : {EConnectionTypeIndex_Async, EConnectionTypeIndex_Sync})
+        {
+            const std::string labels = std::format(R"(database="{}",type="{}")",
+                                                   _pConnectionInfo->database,
+                                                   EConnectionTypeIndex_Async == type ? "async" : "sync");
+            _pQueueDepthGauges[type] =
+                &Metrics::GetGauge("db_queue_depth", "异步连接排队的任务数或等待同步连接的线程数", labels);
+            _pConnectionGauges[type] = &Metrics::GetGauge("db_connections", "数据库连接数", labels);
+        }
 
-        Log::Info("开始连接数据库：{} 同步方式连接数：{}  异步方式连接数：{}",
+        Log::Info("开始连接数据库：{} 同步方式连接数：{}~{}  异步方式连接数：{}~{}",
                   _pConnectionInfo->database,
-                  _syncThreadCount,
-                  _asyncThreadCount);
+                  _scalers[EConnectionTypeIndex_Sync]->GetMinConnections(),
+                  _scalers[EConnectionTypeIndex_Sync]->GetMaxConnections(),
+                  _scalers[EConnectionTypeIndex_Async]->GetMinConnections(),
+                  _scalers[EConnectionTypeIndex_Async]->GetMaxConnections());
 
-        uint32_t errcode = OpenConnections(EConnectionTypeIndex_Async, _asyncThreadCount);
+        uint32_t errcode = OpenConnections(EConnectionTypeIndex_Async, config.minAsyncConnections);
         if (0 != errcode)
         {
             return errcode;
         }
 
-        errcode = OpenConnections(EConnectionTypeIndex_Sync, _syncThreadCount);
+        errcode = OpenConnections(EConnectionTypeIndex_Sync, config.minSyncConnections);
         if (0 != errcode)
         {
             return errcode;
@@ -51,10 +102,16 @@ namespace Database
 
         for (const auto &pConnection : _typeConnections[EConnectionTypeIndex_Async])
         {
-            //std::unique_ptr<asio::io_context> pIoCtx = std::make_unique<asio::io_context>(1);
             pConnection->StartWorkerThread();
         }
 
+        for (const auto &pReplica : _replicas)
+        {
+            OpenReplica(*pReplica);
+        }
+
+        StartHealthCheck();
+
         Log::Info("数据库工作池连接成功：{} 当前连接数：{}",
                   _pConnectionInfo->database,
                   (_typeConnections[EConnectionTypeIndex_Sync].size()
@@ -67,52 +124,163 @@ namespace Database
     {
         Log::Info("关闭数据库工作池：{}", _pConnectionInfo->database);
 
+        // 先停止健康检查，避免关闭过程中仍在重连、心跳或伸缩
+        StopHealthCheck();
+
+        std::unique_lock lock(_connectionsMutex);
         _typeConnections[EConnectionTypeIndex_Async].clear();
 
         _typeConnections[EConnectionTypeIndex_Sync].clear();
+
+        _drainingConnections.clear();
+
+        for (const auto &pReplica : _replicas)
+        {
+            pReplica->connections[EConnectionTypeIndex_Async].clear();
+            pReplica->connections[EConnectionTypeIndex_Sync].clear();
+        }
     }
 
     template <typename ConnectionType>
-    bool DatabaseWorkerPool<ConnectionType>::PrepareStatements()
+    PoolScalingMetrics DatabaseWorkerPool<ConnectionType>::GetSyncScalingMetrics() const
     {
-        for (auto &connections : _typeConnections)
-        {
-            for (auto &&pConnection : connections)
+        std::lock_guard lock(_metricsMutex);
+        return _scalingMetrics[EConnectionTypeIndex_Sync];
+    }
+
+    template <typename ConnectionType>
+    PoolScalingMetrics DatabaseWorkerPool<ConnectionType>::GetAsyncScalingMetrics() const
+    {
+        std::lock_guard lock(_metricsMutex);
+        return _scalingMetrics[EConnectionTypeIndex_Async];
+    }
+
+    template <typename ConnectionType>
+    std::vector<StatementLatencySnapshot> DatabaseWorkerPool<ConnectionType>::GetStatementLatency() const
+    {
+        std::vector<StatementLatencySnapshot> snapshots;
+        auto mergeConnections = [&snapshots](const ConnectionLists &connectionLists) {
+            for (const auto &connections : connectionLists)
             {
-                pConnection->Lock();
-                if (!pConnection->PrepareStatements())
+                for (const auto &pConnection : connections)
                 {
-                    pConnection->UnLock();
-                    Close();
-                    return false;
+                    const StatementMetrics *pMetrics = pConnection->GetStatementMetrics();
+                    if (nullptr != pMetrics)
+                    {
+                        pMetrics->MergeInto(snapshots);
+                    }
                 }
+            }
+        };
 
-                pConnection->UnLock();
+        std::shared_lock lock(_connectionsMutex);
+        mergeConnections(_typeConnections);
+        for (const auto &pReplica : _replicas)
+        {
+            mergeConnections(pReplica->connections);
+        }
+
+        return snapshots;
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::SetSlowQueryThreshold(std::chrono::milliseconds threshold)
+    {
+        _slowQueryThreshold = threshold;
+
+        std::shared_lock lock(_connectionsMutex);
+        for (const auto &connections : _typeConnections)
+        {
+            for (const auto &pConnection : connections)
+            {
+                pConnection->SetSlowQueryThreshold(threshold);
+            }
+        }
 
-                const size_t preparedSize = pConnection->_stmts.size();
-                if (_preparedStmtParamCount.size() < preparedSize)
+        for (const auto &pReplica : _replicas)
+        {
+            for (const auto &connections : pReplica->connections)
+            {
+                for (const auto &pConnection : connections)
                 {
-                    _preparedStmtParamCount.resize(preparedSize);
+                    pConnection->SetSlowQueryThreshold(threshold);
                 }
+            }
+        }
+    }
 
-                for (size_t i = 0; i < preparedSize; ++i)
+    template <typename ConnectionType>
+    bool DatabaseWorkerPool<ConnectionType>::PrepareStatements()
+    {
+        bool bRet = true;
+        {
+            std::shared_lock lock(_connectionsMutex);
+            for (auto &connections : _typeConnections)
+            {
+                for (auto &&pConnection : connections)
                 {
-                    if (_preparedStmtParamCount[i] > 0)
+                    pConnection->Lock();
+                    bRet = pConnection->PrepareStatements();
+                    pConnection->UnLock();
+                    if (!bRet)
                     {
-                        continue;
+                        break;
+                    }
+
+                    const size_t preparedSize = pConnection->_stmts.size();
+                    if (_preparedStmtParamCount.size() < preparedSize)
+                    {
+                        _preparedStmtParamCount.resize(preparedSize);
+                        _readOnlyStmts.resize(preparedSize);
+                    }
+
+                    for (size_t i = 0; i < preparedSize; ++i)
+                    {
+                        if (_preparedStmtParamCount[i] > 0)
+                        {
+                            continue;
+                        }
+
+                        if (MySqlPreparedStatement *pStmt = pConnection->_stmts[i].get(); pStmt != nullptr)
+                        {
+                            const uint32_t paramCount = pStmt->GetParameterCount();
+                            Assert(paramCount < std::numeric_limits<uint8_t>::max());
+                            _preparedStmtParamCount[i] = static_cast<uint8_t>(paramCount);
+                            _readOnlyStmts[i]          = pStmt->IsReadOnly();
+                        }
                     }
+                }
+
+                if (!bRet)
+                {
+                    break;
+                }
+            }
 
-                    if (MySqlPreparedStatement *pStmt = pConnection->_stmts[i].get(); pStmt != nullptr)
+            // 从库与主库使用相同的预处理语句
+            for (const auto &pReplica : _replicas)
+            {
+                for (auto &connections : pReplica->connections)
+                {
+                    for (auto &&pConnection : connections)
                     {
-                        const uint32_t paramCount = pStmt->GetParameterCount();
-                        Assert(paramCount < std::numeric_limits<uint8_t>::max());
-                        _preparedStmtParamCount[i] = static_cast<uint8_t>(paramCount);
+                        pConnection->Lock();
+                        bRet = bRet && pConnection->PrepareStatements();
+                        pConnection->UnLock();
                     }
                 }
             }
+
+            // 在锁内置位，之后扩容的连接由GrowConnections自行处理预处理语句
+            _bStatementsPrepared = bRet;
         }
 
-        return true;
+        if (!bRet)
+        {
+            Close();
+        }
+
+        return bRet;
     }
 
     template <typename ConnectionType>
@@ -127,13 +295,27 @@ namespace Database
     }
 
     template <typename ConnectionType>
-    void DatabaseWorkerPool<ConnectionType>::AsyncExecute(PreparedStatementBase *pStmt)
+    void DatabaseWorkerPool<ConnectionType>::AsyncExecute(PreparedStatementPtr pStmt)
     {
         if (nullptr == pStmt)
         {
             return;
         }
-        GetFreeAsyncConnection()->AsyncExecute(pStmt);
+
+        const uint32_t stmtID = pStmt->GetIndex();
+        if (!_queryCache.HasInvalidation(stmtID))
+        {
+            GetFreeAsyncConnection()->AsyncExecute(std::move(pStmt));
+            return;
+        }
+
+        // 提交时失效一次，避免之后的读取命中旧结果；
+        // 执行完成后再失效一次，丢弃执行期间由其他读取回填的旧结果
+        _queryCache.OnExecute(stmtID);
+        GetFreeAsyncConnection()->Post(stmtID, [this, p = std::move(pStmt)](IMySqlConnection &connection) {
+            connection.Execute(p.get());
+            _queryCache.OnExecute(p->GetIndex());
+        });
     }
 
     template <typename ConnectionType>
@@ -145,6 +327,11 @@ namespace Database
         }
 
         auto pConnection = GetFreeConnectionAndLock();
+        if (nullptr == pConnection)
+        {
+            return;
+        }
+
         pConnection->Execute(sql);
         pConnection->UnLock();
     }
@@ -158,8 +345,29 @@ namespace Database
         }
 
         auto pConnection = GetFreeConnectionAndLock();
+        if (nullptr == pConnection)
+        {
+            return;
+        }
+
         pConnection->Execute(pStmt);
         pConnection->UnLock();
+
+        _queryCache.OnExecute(pStmt->GetIndex());
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::AsyncExecute(PreparedStatementPtr pStmt, ReadSession &session)
+    {
+        session.OnWrite();
+        AsyncExecute(std::move(pStmt));
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::SyncExecute(PreparedStatementBase *pStmt, ReadSession &session)
+    {
+        session.OnWrite();
+        SyncExecute(pStmt);
     }
 
     template <typename ConnectionType>
@@ -169,9 +377,24 @@ namespace Database
     }
 
     template <typename ConnectionType>
-    QueryCallback DatabaseWorkerPool<ConnectionType>::AsyncQuery(PreparedStatementBase *pStmt)
+    QueryCallback DatabaseWorkerPool<ConnectionType>::AsyncQuery(PreparedStatementPtr pStmt)
     {
-        return QueryCallback(std::move(GetFreeAsyncConnection()->AsyncQuery(pStmt)));
+        return AsyncQuery(std::move(pStmt), nullptr);
+    }
+
+    template <typename ConnectionType>
+    QueryCallback DatabaseWorkerPool<ConnectionType>::AsyncQuery(PreparedStatementPtr pStmt,
+                                                                 const ReadSession   &session)
+    {
+        return AsyncQuery(std::move(pStmt), &session);
+    }
+
+    template <typename ConnectionType>
+    QueryCallback DatabaseWorkerPool<ConnectionType>::AsyncQuery(PreparedStatementPtr pStmt,
+                                                                 const ReadSession   *pSession)
+    {
+        const uint32_t stmtID = pStmt->GetIndex();
+        return QueryCallback(GetReadAsyncConnection(stmtID, pSession)->AsyncQuery(std::move(pStmt)));
     }
 
     template <typename ConnectionType>
@@ -182,8 +405,13 @@ namespace Database
             return nullptr;
         }
 
-        auto              pConnection = GetFreeConnectionAndLock();
-        QueryResultSetPtr pResult     = pConnection->Query(sql);
+        auto pConnection = GetFreeConnectionAndLock();
+        if (nullptr == pConnection)
+        {
+            return nullptr;
+        }
+
+        QueryResultSetPtr pResult = pConnection->Query(sql);
         pConnection->UnLock();
 
         return pResult;
@@ -191,35 +419,125 @@ namespace Database
 
     template <typename ConnectionType>
     PreparedQueryResultSetPtr DatabaseWorkerPool<ConnectionType>::SyncQuery(PreparedStatementBase *pStmt)
+    {
+        return SyncQuery(pStmt, nullptr);
+    }
+
+    template <typename ConnectionType>
+    PreparedQueryResultSetPtr DatabaseWorkerPool<ConnectionType>::SyncQuery(PreparedStatementBase *pStmt,
+                                                                            const ReadSession     &session)
+    {
+        return SyncQuery(pStmt, &session);
+    }
+
+    template <typename ConnectionType>
+    PreparedQueryResultSetPtr DatabaseWorkerPool<ConnectionType>::SyncQuery(PreparedStatementBase *pStmt,
+                                                                            const ReadSession     *pSession)
     {
         if (nullptr == pStmt)
         {
             return nullptr;
         }
 
-        auto                      pConnection = GetFreeConnectionAndLock();
-        PreparedQueryResultSetPtr pResult     = pConnection->Query(pStmt);
+        const auto queryBegin  = std::chrono::steady_clock::now();
+        Replica   *pReplica    = nullptr;
+        auto       pConnection = GetReadConnectionAndLock(pStmt->GetIndex(), pSession, pReplica);
+        if (nullptr == pConnection)
+        {
+            return nullptr;
+        }
+
+        PreparedQueryResultSetPtr pResult = pConnection->Query(pStmt);
         pConnection->UnLock();
 
+        RecordReplicaLatency(pReplica, queryBegin);
         return pResult;
     }
 
     template <typename ConnectionType>
-    uint32_t DatabaseWorkerPool<ConnectionType>::OpenConnections(EConnectionTypeIndex type,
-                                                                 uint8_t              openConnectionCount)
+    PreparedQueryResultSetPtr
+    DatabaseWorkerPool<ConnectionType>::SyncQueryCached(PreparedStatementBase *pStmt)
     {
-        for (uint8_t i = 0; i < openConnectionCount; ++i)
+        if (nullptr == pStmt)
+        {
+            return nullptr;
+        }
+
+        uint64_t generation = 0;
+        if (PreparedQueryResultSnapshot pCached = _queryCache.Get(pStmt, generation); nullptr != pCached)
+        {
+            // 缓存的结果集可能被多个线程同时读取，每次命中使用独立的行游标
+            return std::make_shared<PreparedQueryResultSet>(std::move(pCached));
+        }
+
+        PreparedQueryResultSetPtr pResult = SyncQuery(pStmt);
+        _queryCache.Put(pStmt, generation, pResult);
+        return pResult;
+    }
+
+    template <typename ConnectionType>
+    bool DatabaseWorkerPool<ConnectionType>::SyncStreamQuery(std::string_view        sql,
+                                                             const QueryRowCallback &callback)
+    {
+        if (sql.empty())
+        {
+            return false;
+        }
+
+        auto pConnection = GetFreeConnectionAndLock();
+        if (nullptr == pConnection)
+        {
+            return false;
+        }
+
+        bool bRet = pConnection->StreamQuery(sql, callback);
+        pConnection->UnLock();
+
+        return bRet;
+    }
+
+    template <typename ConnectionType>
+    bool DatabaseWorkerPool<ConnectionType>::SyncStreamQuery(PreparedStatementBase    *pStmt,
+                                                             const QueryBatchCallback &callback,
+                                                             uint32_t                  batchSize)
+    {
+        if (nullptr == pStmt)
         {
-            constexpr std::array<MySqlConnectionType, EConnectionTypeIndex_Max> connectionTypes {
-                MySqlConnectionType::Async,
-                MySqlConnectionType::Sync};
+            return false;
+        }
+
+        Replica *pReplica    = nullptr;
+        auto     pConnection = GetReadConnectionAndLock(pStmt->GetIndex(), nullptr, pReplica);
+        if (nullptr == pConnection)
+        {
+            return false;
+        }
 
-            std::shared_ptr<ConnectionType> pConnection =
-                std::make_shared<ConnectionType>(*_pConnectionInfo, connectionTypes[type]);
+        bool bRet = pConnection->StreamQuery(pStmt, batchSize, callback);
+        pConnection->UnLock();
+
+        return bRet;
+    }
 
-            Assert(nullptr != pConnection);
+    template <typename ConnectionType>
+    std::future<bool> DatabaseWorkerPool<ConnectionType>::AsyncStreamQuery(PreparedStatementPtr pStmt,
+                                                                           QueryBatchCallback   callback,
+                                                                           uint32_t             batchSize)
+    {
+        const uint32_t stmtID = pStmt->GetIndex();
+        return GetReadAsyncConnection(stmtID, nullptr)
+            ->AsyncStreamQuery(std::move(pStmt), batchSize, std::move(callback));
+    }
 
-            if (uint32_t errcode = pConnection->Open(); errcode != 0)
+    template <typename ConnectionType>
+    uint32_t DatabaseWorkerPool<ConnectionType>::OpenConnections(EConnectionTypeIndex type,
+                                                                 uint8_t              openConnectionCount)
+    {
+        for (uint8_t i = 0; i < openConnectionCount; ++i)
+        {
+            uint32_t                        errcode     = 0;
+            std::shared_ptr<ConnectionType> pConnection = CreateConnection(type, *_pConnectionInfo, errcode);
+            if (nullptr == pConnection)
             {
                 _typeConnections[type].clear();
                 return errcode;
@@ -231,43 +549,718 @@ namespace Database
         return 0;
     }
 
+    template <typename ConnectionType>
+    std::shared_ptr<ConnectionType>
+    DatabaseWorkerPool<ConnectionType>::CreateConnection(EConnectionTypeIndex type,
+                                                         MySqlConnectionInfo &info,
+                                                         uint32_t            &errcode)
+    {
+        constexpr std::array<MySqlConnectionType, EConnectionTypeIndex_Max> connectionTypes {
+            MySqlConnectionType::Async,
+            MySqlConnectionType::Sync};
+
+        std::shared_ptr<ConnectionType> pConnection =
+            std::make_shared<ConnectionType>(info, connectionTypes[type]);
+
+        Assert(nullptr != pConnection);
+
+        errcode = pConnection->Open();
+        if (0 != errcode)
+        {
+            return nullptr;
+        }
+
+        // 断开时把重连调度到健康检查线程，发现断开的线程不做任何等待
+        std::weak_ptr<ConnectionType> pWeakConnection = pConnection;
+        pConnection->SetOutagePolicy(_outagePolicy, _parkTimeout);
+        pConnection->SetSlowQueryThreshold(_slowQueryThreshold);
+        pConnection->SetDisconnectHandler([this, pWeakConnection]() {
+            asio::post(_healthIoCtx, [this, pWeakConnection]() {
+                ScheduleReconnect(pWeakConnection, MIN_RECONNECT_DELAY);
+            });
+        });
+
+        return pConnection;
+    }
+
     template <typename ConnectionType>
     std::shared_ptr<ConnectionType> DatabaseWorkerPool<ConnectionType>::GetFreeConnectionAndLock()
     {
-        const auto                      connectionCount = _typeConnections[EConnectionTypeIndex_Sync].size();
-        std::shared_ptr<ConnectionType> pConnection     = nullptr;
-        uint8_t                         index           = 0;
-        while (nullptr == pConnection)
+        // 等待中的调用者数与等待时长供伸缩策略判断同步连接是否不足
+        const auto waitBegin = std::chrono::steady_clock::now();
+        ++_syncWaiterCount;
+
+        while (true)
+        {
+            bool bAnyConnected = false;
+            {
+                // 每轮扫描后释放共享锁，使扩容可以插入新连接
+                std::shared_lock lock(_connectionsMutex);
+                for (const auto &pConnection : _typeConnections[EConnectionTypeIndex_Sync])
+                {
+                    if (!pConnection->IsConnected())
+                    {
+                        continue;
+                    }
+
+                    bAnyConnected = true;
+                    if (!pConnection->TryLock())
+                    {
+                        continue;
+                    }
+
+                    // 加锁期间连接可能已被心跳检测判定为断开
+                    if (pConnection->IsConnected())
+                    {
+                        --_syncWaiterCount;
+                        _syncWaitHistogram.Record(std::chrono::steady_clock::now() - waitBegin);
+                        return pConnection;
+                    }
+
+                    pConnection->UnLock();
+                }
+            }
+
+            if (!bAnyConnected)
+            {
+                --_syncWaiterCount;
+                Log::Error("数据库：{} 没有可用的同步连接", _pConnectionInfo->database);
+                return nullptr;
+            }
+
+            std::this_thread::yield();
+        }
+    }
+
+    template <typename ConnectionType>
+    std::shared_ptr<ConnectionType> DatabaseWorkerPool<ConnectionType>::GetFreeAsyncConnection()
+    {
+        // 全部断开时仍返回一个连接，由连接按断线策略处理请求
+        std::shared_lock lock(_connectionsMutex);
+        const auto      &connections = _typeConnections[EConnectionTypeIndex_Async];
+        Assert(!connections.empty(), "没有异步连接");
+        return *std::min_element(connections.begin(), connections.end(), IsLessLoaded);
+    }
+
+    template <typename ConnectionType>
+    bool DatabaseWorkerPool<ConnectionType>::IsLessLoaded(const std::shared_ptr<ConnectionType> &lhs,
+                                                          const std::shared_ptr<ConnectionType> &rhs)
+    {
+        if (lhs->IsConnected() != rhs->IsConnected())
+        {
+            return lhs->IsConnected();
+        }
+
+        return lhs->GetAsyncTaskCount() < rhs->GetAsyncTaskCount();
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::AddReplica(const MySqlConnectionInfo &info,
+                                                        uint8_t                    syncConnectionCount,
+                                                        uint8_t                    asyncConnectionCount)
+    {
+        Assert(nullptr == _pHealthThread, "须在Open之前添加从库");
+        Assert(syncConnectionCount > 0, "从库至少需要一个同步连接用于探测复制延迟");
+
+        auto pReplica                  = std::make_unique<Replica>();
+        pReplica->index                = _replicaBalancer.AddReplica();
+        pReplica->pConnectionInfo      = std::make_unique<MySqlConnectionInfo>(info);
+        pReplica->syncConnectionCount  = syncConnectionCount;
+        pReplica->asyncConnectionCount = asyncConnectionCount;
+        _replicas.emplace_back(std::move(pReplica));
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::OpenReplica(Replica &replica)
+    {
+        const std::array<uint8_t, EConnectionTypeIndex_Max> connectionCounts {replica.asyncConnectionCount,
+                                                                              replica.syncConnectionCount};
+        for (uint8_t type = 0; type < EConnectionTypeIndex_Max; ++type)
+        {
+            for (uint8_t i = 0; i < connectionCounts[type]; ++i)
+            {
+                uint32_t errcode     = 0;
+                auto     pConnection =
+                    CreateConnection(EConnectionTypeIndex(type), *replica.pConnectionInfo, errcode);
+                if (nullptr == pConnection)
+                {
+                    // 从库不可用时只读查询回退到主库，不影响工作池启动
+                    Log::Error("连接从库：{}:{} 失败：{}",
+                               replica.pConnectionInfo->host,
+                               replica.pConnectionInfo->port,
+                               errcode);
+                    replica.connections[EConnectionTypeIndex_Async].clear();
+                    replica.connections[EConnectionTypeIndex_Sync].clear();
+                    return;
+                }
+
+                replica.connections[type].emplace_back(std::move(pConnection));
+            }
+        }
+
+        for (const auto &pConnection : replica.connections[EConnectionTypeIndex_Async])
+        {
+            pConnection->StartWorkerThread();
+        }
+    }
+
+    template <typename ConnectionType>
+    typename DatabaseWorkerPool<ConnectionType>::Replica *
+    DatabaseWorkerPool<ConnectionType>::SelectReplica(uint32_t stmtID, const ReadSession *pSession)
+    {
+        if (_replicas.empty() || stmtID >= _readOnlyStmts.size() || !_readOnlyStmts[stmtID])
+        {
+            return nullptr;
+        }
+
+        // 会话刚写入过，从库可能尚未同步
+        if (nullptr != pSession && pSession->IsSticky(_stickyWindow))
+        {
+            return nullptr;
+        }
+
+        const std::optional<std::size_t> index = _replicaBalancer.SelectReplica();
+        return index.has_value() ? _replicas[*index].get() : nullptr;
+    }
+
+    template <typename ConnectionType>
+    std::shared_ptr<ConnectionType>
+    DatabaseWorkerPool<ConnectionType>::GetReadConnectionAndLock(uint32_t           stmtID,
+                                                                 const ReadSession *pSession,
+                                                                 Replica          *&pReplica)
+    {
+        pReplica = SelectReplica(stmtID, pSession);
+        if (nullptr != pReplica)
+        {
+            // 从库连接数固定，无需加锁遍历
+            const auto &connections = pReplica->connections[EConnectionTypeIndex_Sync];
+            while (true)
+            {
+                bool bAnyConnected = false;
+                for (const auto &pConnection : connections)
+                {
+                    if (!pConnection->IsConnected())
+                    {
+                        continue;
+                    }
+
+                    bAnyConnected = true;
+                    if (pConnection->TryLock())
+                    {
+                        if (pConnection->IsConnected())
+                        {
+                            return pConnection;
+                        }
+
+                        pConnection->UnLock();
+                    }
+                }
+
+                if (!bAnyConnected)
+                {
+                    break;
+                }
+
+                std::this_thread::yield();
+            }
+        }
+
+        pReplica = nullptr;
+        return GetFreeConnectionAndLock();
+    }
+
+    template <typename ConnectionType>
+    std::shared_ptr<ConnectionType>
+    DatabaseWorkerPool<ConnectionType>::GetReadAsyncConnection(uint32_t stmtID, const ReadSession *pSession)
+    {
+        if (Replica *pReplica = SelectReplica(stmtID, pSession); nullptr != pReplica)
+        {
+            const auto &connections = pReplica->connections[EConnectionTypeIndex_Async];
+            if (!connections.empty())
+            {
+                auto pConnection = *std::min_element(connections.begin(), connections.end(), IsLessLoaded);
+                if (pConnection->IsConnected())
+                {
+                    return pConnection;
+                }
+            }
+        }
+
+        return GetFreeAsyncConnection();
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::RecordReplicaLatency(Replica *pReplica,
+                                                                  std::chrono::steady_clock::time_point begin)
+    {
+        if (nullptr != pReplica)
         {
-            pConnection = _typeConnections[EConnectionTypeIndex_Sync][index++ % connectionCount];
-            if (pConnection->TryLock())
+            _replicaBalancer.RecordLatency(pReplica->index, std::chrono::steady_clock::now() - begin);
+        }
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::ScheduleReplicaProbe()
+    {
+        _pReplicaProbeTimer->expires_after(DEFAULT_REPLICA_PROBE_INTERVAL);
+        _pReplicaProbeTimer->async_wait([this](const std::error_code &errcode) {
+            if (errcode)
+            {
+                return;
+            }
+
+            ProbeReplicas();
+            ScheduleReplicaProbe();
+        });
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::ProbeReplicas()
+    {
+        const auto now = std::chrono::steady_clock::now();
+        for (const auto &pReplica : _replicas)
+        {
+            // 退避期间不探测，从库保持不可用
+            if (now < pReplica->nextProbeTime)
+            {
+                continue;
+            }
+
+            bool bAnyConnected = false;
+            for (const auto &pConnection : pReplica->connections[EConnectionTypeIndex_Sync])
             {
+                if (!pConnection->IsConnected())
+                {
+                    continue;
+                }
+
+                // 连接均被占用时保留上次的探测结果
+                bAnyConnected = true;
+                if (!pConnection->TryLock())
+                {
+                    continue;
+                }
+
+                std::optional<std::chrono::seconds> lag;
+                uint32_t                            errcode    = 0;
+                const auto                          probeBegin = std::chrono::steady_clock::now();
+                const bool                          bRet       = pConnection->QueryReplicaLag(lag, errcode);
+                pConnection->UnLock();
+
+                if (bRet)
+                {
+                    RecordReplicaLatency(pReplica.get(), probeBegin);
+                    pReplica->probeFailures = 0;
+                }
+                else
+                {
+                    OnReplicaProbeFailed(*pReplica, errcode);
+                }
+
+                UpdateReplicaLag(*pReplica, lag);
                 break;
             }
+
+            if (!bAnyConnected)
+            {
+                UpdateReplicaLag(*pReplica, std::nullopt);
+            }
         }
+    }
 
-        return pConnection;
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::UpdateReplicaLag(Replica                            &replica,
+                                                              std::optional<std::chrono::seconds> lag)
+    {
+        _replicaBalancer.UpdateLag(replica.index, lag);
+
+        // 只在可用状态变化时输出日志
+        const bool bAvailable = lag.has_value() && *lag <= _replicaBalancer.GetMaxLag();
+        if (bAvailable == replica.bAvailable)
+        {
+            return;
+        }
+
+        replica.bAvailable = bAvailable;
+        if (bAvailable)
+        {
+            Log::Info("从库：{}:{} 恢复可用，复制延迟：{}s",
+                      replica.pConnectionInfo->host,
+                      replica.pConnectionInfo->port,
+                      lag->count());
+        }
+        else
+        {
+            Log::Warn("从库：{}:{} 复制延迟过大、复制中断或连接断开，只读查询回退到主库",
+                      replica.pConnectionInfo->host,
+                      replica.pConnectionInfo->port);
+        }
     }
 
     template <typename ConnectionType>
-    std::shared_ptr<ConnectionType> DatabaseWorkerPool<ConnectionType>::GetFreeAsyncConnection()
+    void DatabaseWorkerPool<ConnectionType>::OnReplicaProbeFailed(Replica &replica, uint32_t errcode)
     {
-        auto connections = _typeConnections[EConnectionTypeIndex_Async];
-        std::make_heap(
-            connections.begin(),
-            connections.end(),
-            [](const std::shared_ptr<ConnectionType> lhs, const std::shared_ptr<ConnectionType> rhs) {
-                return lhs->GetAsyncTaskCount() < rhs->GetAsyncTaskCount();
-            });
-        std::pop_heap(connections.begin(), connections.end());
+        // 权限不足等持续性错误每次都会失败，间隔逐次倍增，日志随之限频
+        const uint32_t shift   = std::min<uint32_t>(replica.probeFailures, 6);
+        const auto     backoff = std::min<std::chrono::seconds>(DEFAULT_REPLICA_PROBE_INTERVAL * (1 << shift),
+                                                                MAX_REPLICA_PROBE_BACKOFF);
+        ++replica.probeFailures;
+        replica.nextProbeTime = std::chrono::steady_clock::now() + backoff;
+
+        Log::Warn("从库：{}:{} 探测复制延迟失败，错误码：{}，连续失败{}次，{}s后重试",
+                  replica.pConnectionInfo->host,
+                  replica.pConnectionInfo->port,
+                  errcode,
+                  replica.probeFailures,
+                  backoff.count());
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::SetOutagePolicy(OutagePolicy              policy,
+                                                             std::chrono::milliseconds parkTimeout)
+    {
+        _outagePolicy = policy;
+        _parkTimeout  = parkTimeout;
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::StartHealthCheck()
+    {
+        _healthWork = asio::require(_healthIoCtx.get_executor(), asio::execution::outstanding_work.tracked);
+        _pKeepaliveTimer = std::make_unique<asio::steady_timer>(_healthIoCtx);
+        _pScaleTimer     = std::make_unique<asio::steady_timer>(_healthIoCtx);
+        ScheduleKeepalive();
+        ScheduleScaling();
+
+        if (!_replicas.empty())
+        {
+            _pReplicaProbeTimer = std::make_unique<asio::steady_timer>(_healthIoCtx);
+            ProbeReplicas();
+            ScheduleReplicaProbe();
+        }
+
+        _pHealthThread = std::make_unique<std::thread>([this] {
+            try
+            {
+                _healthIoCtx.run();
+            }
+            catch (std::exception &e)
+            {
+                Log::Error("数据库健康检查线程发生异常:{}", e.what());
+            }
+        });
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::StopHealthCheck()
+    {
+        if (nullptr == _pHealthThread)
+        {
+            return;
+        }
+
+        _healthWork = asio::any_io_executor();
+        _healthIoCtx.stop();
+        if (_pHealthThread->joinable())
+        {
+            _pHealthThread->join();
+        }
+
+        _pHealthThread.reset();
+        _pKeepaliveTimer.reset();
+        _pScaleTimer.reset();
+        _pReplicaProbeTimer.reset();
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::ScheduleReconnect(std::weak_ptr<ConnectionType> pWeakConnection,
+                                                               std::chrono::milliseconds     delay)
+    {
+        auto pTimer = std::make_shared<asio::steady_timer>(_healthIoCtx);
+        pTimer->expires_after(delay);
+        pTimer->async_wait([this, pTimer, pWeakConnection, delay](const std::error_code &errcode) {
+            std::shared_ptr<ConnectionType> pConnection = pWeakConnection.lock();
+            if (errcode || nullptr == pConnection || pConnection->Reconnect())
+            {
+                return;
+            }
+
+            // 指数退避，避免数据库不可用期间频繁重连
+            const std::chrono::milliseconds nextDelay = std::min(delay * 2, MAX_RECONNECT_DELAY);
+            Log::Warn("数据库：{} 重连失败，{}ms后重试", _pConnectionInfo->database, nextDelay.count());
+            ScheduleReconnect(pWeakConnection, nextDelay);
+        });
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::ScheduleKeepalive()
+    {
+        _pKeepaliveTimer->expires_after(_keepaliveInterval);
+        _pKeepaliveTimer->async_wait([this](const std::error_code &errcode) {
+            if (errcode)
+            {
+                return;
+            }
+
+            KeepaliveConnections();
+            ScheduleKeepalive();
+        });
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::KeepaliveConnections()
+    {
+        {
+            std::shared_lock lock(_connectionsMutex);
+            KeepaliveConnections(_typeConnections);
+        }
+
+        for (const auto &pReplica : _replicas)
+        {
+            KeepaliveConnections(pReplica->connections);
+        }
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::KeepaliveConnections(const ConnectionLists &connections)
+    {
+        // 异步连接的句柄只能在其工作线程上使用，心跳同样投递过去；有排队任务的连接无需心跳
+        for (const auto &pConnection : connections[EConnectionTypeIndex_Async])
+        {
+            if (pConnection->IsConnected() && 0 == pConnection->GetAsyncTaskCount()
+                && pConnection->GetIdleTime() >= _keepaliveInterval)
+            {
+                pConnection->Post([](auto &connection) {
+                    connection.Ping();
+                });
+            }
+        }
+
+        // 正在被使用的同步连接直接跳过
+        for (const auto &pConnection : connections[EConnectionTypeIndex_Sync])
+        {
+            if (pConnection->IsConnected() && pConnection->GetIdleTime() >= _keepaliveInterval
+                && pConnection->TryLock())
+            {
+                pConnection->Ping();
+                pConnection->UnLock();
+            }
+        }
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::ScheduleScaling()
+    {
+        _pScaleTimer->expires_after(_config.scaleInterval);
+        _pScaleTimer->async_wait([this](const std::error_code &errcode) {
+            if (errcode)
+            {
+                return;
+            }
+
+            ScaleConnections();
+            ScheduleScaling();
+        });
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::ScaleConnections()
+    {
+        ReapDrainingConnections();
+
+        const auto now = std::chrono::steady_clock::now();
+        ScaleConnections(EConnectionTypeIndex_Async, now);
+        ScaleConnections(EConnectionTypeIndex_Sync, now);
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::ScaleConnections(EConnectionTypeIndex                  type,
+                                                              std::chrono::steady_clock::time_point now)
+    {
+        PoolLoadSample sample;
+        {
+            std::shared_lock lock(_connectionsMutex);
+            sample.connectionCount = _typeConnections[type].size();
+            if (EConnectionTypeIndex_Async == type)
+            {
+                for (const auto &pConnection : _typeConnections[type])
+                {
+                    sample.queueDepth += pConnection->GetAsyncTaskCount();
+                    sample.waitTime.Merge(pConnection->TakeQueueWaitSnapshot());
+                }
+            }
+        }
+
+        if (EConnectionTypeIndex_Sync == type)
+        {
+            sample.queueDepth = _syncWaiterCount.load(std::memory_order_relaxed);
+            sample.waitTime   = _syncWaitHistogram.TakeSnapshot();
+        }
+
+        const ScaleDecision decision = _scalers[type]->Evaluate(sample, now);
+        bool                bScaled  = false;
+        if (ScaleDecision::Grow == decision)
+        {
+            bScaled = GrowConnections(type);
+        }
+        else if (ScaleDecision::Shrink == decision)
+        {
+            bScaled = ShrinkConnections(type);
+        }
+
+        std::size_t connectionCount = 0;
+        {
+            std::shared_lock lock(_connectionsMutex);
+            connectionCount = _typeConnections[type].size();
+        }
+
+        PoolScalingMetrics &metrics = _scalingMetrics[type];
+        {
+            std::lock_guard lock(_metricsMutex);
+            metrics.connectionCount = static_cast<uint32_t>(connectionCount);
+            metrics.drainingCount   = static_cast<uint32_t>(_drainingConnections.size());
+            metrics.queueDepth      = sample.queueDepth;
+            metrics.waitP50         = std::chrono::microseconds(sample.waitTime.GetPercentile(50));
+            metrics.waitP90         = std::chrono::microseconds(sample.waitTime.GetPercentile(90));
+            metrics.waitP99         = std::chrono::microseconds(sample.waitTime.GetPercentile(99));
+            metrics.lastDecision    = decision;
+            if (bScaled && ScaleDecision::Grow == decision)
+            {
+                ++metrics.growCount;
+            }
+            else if (bScaled && ScaleDecision::Shrink == decision)
+            {
+                ++metrics.shrinkCount;
+            }
+        }
+
+        _pQueueDepthGauges[type]->Set(static_cast<int64_t>(sample.queueDepth));
+        _pConnectionGauges[type]->Set(static_cast<int64_t>(connectionCount));
+
+        if (bScaled)
+        {
+            Log::Info("数据库：{} {}连接{}至{}个 排队：{} 等待p90：{}us",
+                      _pConnectionInfo->database,
+                      EConnectionTypeIndex_Async == type ? "异步" : "同步",
+                      ScaleDecision::Grow == decision ? "扩容" : "缩容",
+                      connectionCount,
+                      sample.queueDepth,
+                      metrics.waitP90.count());
+        }
+    }
+
+    template <typename ConnectionType>
+    bool DatabaseWorkerPool<ConnectionType>::GrowConnections(EConnectionTypeIndex type)
+    {
+        uint32_t                        errcode     = 0;
+        std::shared_ptr<ConnectionType> pConnection = CreateConnection(type, *_pConnectionInfo, errcode);
+        if (nullptr == pConnection)
+        {
+            Log::Warn("数据库：{} 扩容连接失败：{}", _pConnectionInfo->database, errcode);
+            return false;
+        }
+
+        // 新连接尚未加入池中，无需加锁；PrepareStatements与扩容并发时在插入前补做
+        bool bPrepared = false;
+        if (_bStatementsPrepared)
+        {
+            if (!pConnection->PrepareStatements())
+            {
+                return false;
+            }
+
+            bPrepared = true;
+        }
+
+        std::unique_lock lock(_connectionsMutex);
+        if (_bStatementsPrepared && !bPrepared && !pConnection->PrepareStatements())
+        {
+            return false;
+        }
+
+        if (EConnectionTypeIndex_Async == type)
+        {
+            pConnection->StartWorkerThread();
+        }
+
+        _typeConnections[type].emplace_back(std::move(pConnection));
+        return true;
+    }
+
+    template <typename ConnectionType>
+    bool DatabaseWorkerPool<ConnectionType>::ShrinkConnections(EConnectionTypeIndex type)
+    {
+        std::shared_ptr<ConnectionType> pConnection;
+        {
+            std::unique_lock lock(_connectionsMutex);
+            auto            &connections = _typeConnections[type];
+            if (connections.size() <= _scalers[type]->GetMinConnections())
+            {
+                return false;
+            }
+
+            // 异步连接移出排队任务最少的一个；同步连接只移出空闲且能锁定的一个，
+            // 调用者在持有连接列表的共享锁时才锁定连接，移出后不会再被取走
+            auto iter = connections.end();
+            if (EConnectionTypeIndex_Async == type)
+            {
+                iter = std::min_element(connections.begin(),
+                                        connections.end(),
+                                        [](const std::shared_ptr<ConnectionType> &lhs,
+                                           const std::shared_ptr<ConnectionType> &rhs) {
+                                            return lhs->GetAsyncTaskCount() < rhs->GetAsyncTaskCount();
+                                        });
+            }
+            else
+            {
+                auto reverseIter = std::find_if(connections.rbegin(),
+                                                connections.rend(),
+                                                [](const std::shared_ptr<ConnectionType> &pConnection) {
+                                                    return pConnection->TryLock();
+                                                });
+                if (reverseIter == connections.rend())
+                {
+                    return false;
+                }
+
+                iter = std::prev(reverseIter.base());
+            }
+
+            pConnection = std::move(*iter);
+            connections.erase(iter);
+        }
+
+        if (EConnectionTypeIndex_Async == type)
+        {
+            _drainingConnections.emplace_back(std::move(pConnection));
+            return true;
+        }
+
+        // 持有连接的锁关闭，此时没有其他使用者
+        pConnection->Close();
+        pConnection->UnLock();
+        return true;
+    }
+
+    template <typename ConnectionType>
+    void DatabaseWorkerPool<ConnectionType>::ReapDrainingConnections()
+    {
+        // 移出后至少经过一个伸缩周期才关闭，移出前已被选中的请求此时均已入队
+        std::erase_if(_drainingConnections, [](const std::shared_ptr<ConnectionType> &pConnection) {
+            if (0 != pConnection->GetAsyncTaskCount())
+            {
+                return false;
+            }
 
-        return connections.back();
+            pConnection->Close();
+            return true;
+        });
     }
 
     template <typename ConnectionType>
-    PreparedStatementBase *DatabaseWorkerPool<ConnectionType>::GetPrepareStatement(uint32_t stmtID) const
+    PreparedStatementPtr DatabaseWorkerPool<ConnectionType>::GetPrepareStatement(uint32_t stmtID) const
     {
-        return new PreparedStatementBase(stmtID, _preparedStmtParamCount[stmtID]);
+        return PreparedStatementPool::Acquire(stmtID, _preparedStmtParamCount[stmtID]);
     }
 
     template class DatabaseWorkerPool<LoginDatabaseConnection>;
@@ -10,12 +10,24 @@
 
 #include "asio.hpp"
 
+#include "BulkLoader.h"
 #include "DatabaseEnv.h"
+#include "PoolScaler.h"
 #include "QueryCallback.h"
+#include "QueryResultCache.h"
+#include "ReplicaBalancer.h"
+#include "StatementMetrics.h"
+#include "TypedStatement.h"
+#include "Common/Util/Metrics.h"
 
 #include <array>
+#include <chrono>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
 
 namespace Database
 {
@@ -42,40 +54,483 @@ namespace Database
         DatabaseWorkerPool &operator=(DatabaseWorkerPool &&)      = delete;
 
         DatabaseWorkerPool();
-        ~DatabaseWorkerPool() = default;
+        ~DatabaseWorkerPool();
 
+        // 固定连接数，不做伸缩
         uint32_t Open(const MySqlConnectionInfo &info, uint8_t syncThreadCount, uint8_t asyncThreadCount);
+
+        /**
+         * @brief 打开连接池，启动时按下限创建连接，运行期间由健康检查线程按负载在上下限之间伸缩
+         *        缩容的异步连接先从池中移出，执行完已排队的任务后再关闭
+         *
+         * @param info 连接信息
+         * @param config 连接数上下限及伸缩阈值
+         * @return 错误码，0为成功
+         */
+        uint32_t Open(const MySqlConnectionInfo &info, const DatabasePoolConfig &config);
         void     Close();
 
+        [[nodiscard]] PoolScalingMetrics GetSyncScalingMetrics() const;
+        [[nodiscard]] PoolScalingMetrics GetAsyncScalingMetrics() const;
+
+        /**
+         * @brief 汇总主库与从库所有连接上各预处理语句的排队、执行及解析耗时
+         *        统计自连接创建起累计，缩容关闭的连接上的样本不再计入
+         *
+         * @return 有样本的语句，按语句索引升序
+         */
+        [[nodiscard]] std::vector<StatementLatencySnapshot> GetStatementLatency() const;
+
+        /**
+         * @brief 设置慢查询阈值，对已有连接及之后创建的连接生效
+         *
+         * @param threshold 阈值，为0时不记录慢查询
+         */
+        void SetSlowQueryThreshold(std::chrono::milliseconds threshold);
+
+        /**
+         * @brief 添加从库，须在Open之前调用
+         *        标记为只读的预处理语句查询路由到复制延迟未超限且耗时最低的从库，没有可用从库时回退到主库。
+         *        从库连接数固定，不参与伸缩；同步连接同时用于定期探测复制延迟，因此至少需要一个
+         *
+         * @param info 从库连接信息
+         * @param syncConnectionCount 同步连接数
+         * @param asyncConnectionCount 异步连接数，为0时异步只读查询走主库
+         */
+        void AddReplica(const MySqlConnectionInfo &info,
+                        uint8_t                    syncConnectionCount,
+                        uint8_t                    asyncConnectionCount);
+
+        void SetMaxReplicaLag(std::chrono::seconds maxLag)
+        {
+            _replicaBalancer.SetMaxLag(maxLag);
+        }
+
+        // 设置读己之写的时长，须在Open之前调用
+        void SetStickyWindow(std::chrono::milliseconds window)
+        {
+            _stickyWindow = window;
+        }
+
+        [[nodiscard]] std::vector<ReplicaStats> GetReplicaStats() const
+        {
+            return _replicaBalancer.GetStats();
+        }
+
+        /**
+         * @brief 设置断线期间异步请求的处理策略，须在Open之前调用
+         *        FailFast：立即失败；Park：在工作线程上等待重连，超过parkTimeout后失败。
+         *        同步请求总是立即失败，不阻塞业务线程
+         *
+         * @param policy 策略
+         * @param parkTimeout Park策略下的最长等待时长
+         */
+        void SetOutagePolicy(OutagePolicy              policy,
+                             std::chrono::milliseconds parkTimeout = DEFAULT_PARK_TIMEOUT);
+
+        /**
+         * @brief 设置空闲连接的心跳间隔，须在Open之前调用
+         *        空闲超过该时长的连接会被ping一次，以便在使用前发现断开的连接
+         */
+        void SetKeepaliveInterval(std::chrono::seconds interval)
+        {
+            _keepaliveInterval = interval;
+        }
+
         bool PrepareStatements();
 
         void AsyncExecute(std::string_view sql);
-        void AsyncExecute(PreparedStatementBase *pStmt);
+        void AsyncExecute(PreparedStatementPtr pStmt);
 
         void SyncExecute(std::string_view sql);
         void SyncExecute(PreparedStatementBase *pStmt);
 
+        // 写入并标记会话，之后该会话的只读查询在一段时间内走主库
+        void AsyncExecute(PreparedStatementPtr pStmt, ReadSession &session);
+        void SyncExecute(PreparedStatementBase *pStmt, ReadSession &session);
+
         QueryCallback AsyncQuery(std::string_view sql);
-        QueryCallback AsyncQuery(PreparedStatementBase *pStmt);
+        QueryCallback AsyncQuery(PreparedStatementPtr pStmt);
+        QueryCallback AsyncQuery(PreparedStatementPtr pStmt, const ReadSession &session);
 
         QueryResultSetPtr         SyncQuery(std::string_view sql);
         PreparedQueryResultSetPtr SyncQuery(PreparedStatementBase *pStmt);
+        PreparedQueryResultSetPtr SyncQuery(PreparedStatementBase *pStmt, const ReadSession &session);
+
+        /**
+         * @brief 经由结果缓存的同步查询，语句未开启缓存时等同于SyncQuery
+         *        命中时返回的结果集与其他调用者共享只读的结果数据，行游标各自独立
+         */
+        PreparedQueryResultSetPtr SyncQueryCached(PreparedStatementBase *pStmt);
+
+        QueryResultCache &GetQueryCache()
+        {
+            return _queryCache;
+        }
+
+        /**
+         * @brief 流式查询，用于启动时加载大表，内存占用只与批大小有关
+         *        回调在调用线程上执行，执行期间占用一个同步连接
+         */
+        bool SyncStreamQuery(std::string_view sql, const QueryRowCallback &callback);
+        bool SyncStreamQuery(PreparedStatementBase    *pStmt,
+                             const QueryBatchCallback &callback,
+                             uint32_t                  batchSize = DEFAULT_STREAM_BATCH_SIZE);
+
+        /**
+         * @brief 异步流式查询，回调在数据库工作线程上执行
+         */
+        std::future<bool> AsyncStreamQuery(PreparedStatementPtr pStmt,
+                                           QueryBatchCallback   callback,
+                                           uint32_t             batchSize = DEFAULT_STREAM_BATCH_SIZE);
+
+        /**
+         * @brief 从对象池获取语句对象，离开作用域或异步执行完成后自动归还
+         *        同步接口只借用语句对象，异步接口接管其所有权
+         */
+        PreparedStatementPtr GetPrepareStatement(uint32_t stmtID) const;
+
+        /**
+         * @brief 同步执行类型化预处理语句，参数直接绑定，不经过PreparedStatementBase
+         *        例：g_LoginDatabase.SyncExecute<LoginUpdAccountAge>(age, email);
+         *
+         * @param args 参数，个数与类型须与语句定义一致
+         * @return 执行是否成功
+         */
+        template <typename StmtType, typename... Args>
+            requires StmtInvocable<StmtType, Args...>
+        bool SyncExecute(Args &&...args)
+        {
+            const typename StmtType::ParamTuple params {std::forward<Args>(args)...};
+            const auto                          bindValues = Detail::MakeBindValues(params);
+
+            auto pConnection = GetFreeConnectionAndLock();
+            if (nullptr == pConnection)
+            {
+                return false;
+            }
+
+            bool bRet = pConnection->Execute(StmtType::ID, bindValues);
+            pConnection->UnLock();
+
+            _queryCache.OnExecute(StmtType::ID);
+            return bRet;
+        }
+
+        /**
+         * @brief 异步执行类型化预处理语句，参数由任务持有
+         *
+         * @param args 参数，个数与类型须与语句定义一致
+         */
+        template <typename StmtType, typename... Args>
+            requires StmtInvocable<StmtType, Args...>
+        void AsyncExecute(Args &&...args)
+        {
+            using OwnedParamTuple = typename StmtType::OwnedParamTuple;
+
+            _queryCache.OnExecute(StmtType::ID);
+            GetFreeAsyncConnection()->Post(
+                StmtType::ID,
+                [this, params = OwnedParamTuple {std::forward<Args>(args)...}](auto &connection) {
+                    const auto bindValues = Detail::MakeBindValues(params);
+                    connection.Execute(StmtType::ID, bindValues);
+                    _queryCache.OnExecute(StmtType::ID);
+                });
+        }
+
+        /**
+         * @brief 同步查询类型化预处理语句，结果直接解码为ResultType，不经过Field
+         *        例：auto rows = g_LoginDatabase.SyncQuery<LoginSelAccountByEmail, Account>(email);
+         *
+         * @param args 参数，个数与类型须与语句定义一致
+         * @return 查询失败时为空，否则为所有结果行
+         */
+        template <typename StmtType, typename ResultType = typename StmtType::RowType, typename... Args>
+            requires StmtInvocable<StmtType, Args...> && StmtRowMappable<StmtType, ResultType>
+        std::optional<std::vector<ResultType>> SyncQuery(Args &&...args)
+        {
+            const typename StmtType::ParamTuple params {std::forward<Args>(args)...};
+            const auto                          bindValues = Detail::MakeBindValues(params);
+
+            typename StmtType::RowType row {};
+            const auto                 resultBinds = Detail::MakeResultBinds(row);
+
+            std::vector<ResultType> rows;
+
+            const auto queryBegin  = std::chrono::steady_clock::now();
+            Replica   *pReplica    = nullptr;
+            auto       pConnection = GetReadConnectionAndLock(StmtType::ID, nullptr, pReplica);
+            if (nullptr == pConnection)
+            {
+                return std::nullopt;
+            }
+
+            bool bRet = pConnection->Query(StmtType::ID, bindValues, resultBinds, [&rows, &row]() {
+                if constexpr (std::is_same_v<ResultType, typename StmtType::RowType>)
+                {
+                    rows.emplace_back(std::move(row));
+                }
+                else
+                {
+                    rows.emplace_back(std::make_from_tuple<ResultType>(std::move(row)));
+                }
+            });
+            pConnection->UnLock();
+            RecordReplicaLatency(pReplica, queryBegin);
 
-        PreparedStatementBase *GetPrepareStatement(uint32_t stmtID) const;
+            if (!bRet)
+            {
+                return std::nullopt;
+            }
+
+            return rows;
+        }
+
+        /**
+         * @brief 启动时加载大表：按主键范围拆分为若干块，分发到各异步连接上并行查询，结果直接解码为ResultType
+         *        调用线程阻塞至全部块完成，分块语句须在异步连接上预处理
+         *        例：auto rows = g_LoginDatabase.BulkLoad<AccountIdRange, AccountByIdRange, Account>();
+         *
+         * @param options 拆分选项
+         * @param pStats 不为空时写入加载的行数、块数及耗时
+         * @return 任意一块查询失败时为空，否则为按主键升序的所有结果行
+         */
+        template <typename RangeStmtType,
+                  typename ChunkStmtType,
+                  typename ResultType = typename ChunkStmtType::RowType>
+            requires BulkLoadStmts<RangeStmtType, ChunkStmtType> && StmtRowMappable<ChunkStmtType, ResultType>
+        std::optional<std::vector<ResultType>> BulkLoad(const BulkLoadOptions &options = {},
+                                                        BulkLoadStats         *pStats  = nullptr)
+        {
+            const auto beginTime = std::chrono::steady_clock::now();
+
+            const auto range = SyncQuery<RangeStmtType>();
+            if (!range.has_value() || range->empty())
+            {
+                return std::nullopt;
+            }
+
+            uint32_t chunkCount = options.chunkCount;
+            if (0 == chunkCount)
+            {
+                std::shared_lock lock(_connectionsMutex);
+                chunkCount = static_cast<uint32_t>(_typeConnections[EConnectionTypeIndex_Async].size() * 2);
+            }
+
+            // 空表的最小、最大值均为NULL，解码为0，分块查询不会返回任何行
+            const auto [firstKey, lastKey] = range->front();
+            const auto chunks = SplitKeyRange(firstKey, lastKey, chunkCount, options.minChunkSize);
+
+            // 每块写入各自的结果，等待全部完成后按块顺序合并，任务只在等待期间引用局部变量，
+            // 因此任务内的异常也须转交给future，且须等待所有任务结束后才能返回或重新抛出
+            std::vector<std::vector<ResultType>> chunkRows(chunks.size());
+            std::vector<std::future<bool>>       futures;
+            futures.reserve(chunks.size());
+            try
+            {
+                for (std::size_t i = 0; i < chunks.size(); ++i)
+                {
+                    auto pPromise = std::make_shared<std::promise<bool>>();
+                    futures.emplace_back(pPromise->get_future());
+                    auto &rows  = chunkRows[i];
+                    auto &chunk = chunks[i];
+                    GetFreeAsyncConnection()->Post([&rows, &chunk, pPromise](auto &connection) {
+                        try
+                        {
+                            const typename ChunkStmtType::ParamTuple params {chunk.first, chunk.second};
+                            const auto bindValues = Detail::MakeBindValues(params);
+
+                            typename ChunkStmtType::RowType row {};
+                            const auto                      resultBinds = Detail::MakeResultBinds(row);
+                            pPromise->set_value(
+                                connection.Query(ChunkStmtType::ID, bindValues, resultBinds, [&rows, &row]() {
+                                    if constexpr (std::is_same_v<ResultType, typename ChunkStmtType::RowType>)
+                                    {
+                                        rows.emplace_back(std::move(row));
+                                    }
+                                    else
+                                    {
+                                        rows.emplace_back(std::make_from_tuple<ResultType>(std::move(row)));
+                                    }
+                                }));
+                        }
+                        catch (...)
+                        {
+                            pPromise->set_exception(std::current_exception());
+                        }
+                    });
+                }
+            }
+            catch (...)
+            {
+                // 投递失败时已投递的任务仍在引用局部变量
+                for (auto &future : futures)
+                {
+                    future.wait();
+                }
+                throw;
+            }
+
+            bool               bRet = true;
+            std::exception_ptr pException;
+            for (auto &future : futures)
+            {
+                try
+                {
+                    bRet = future.get() && bRet;
+                }
+                catch (...)
+                {
+                    bRet = false;
+                    if (nullptr == pException)
+                    {
+                        pException = std::current_exception();
+                    }
+                }
+            }
+
+            if (nullptr != pException)
+            {
+                std::rethrow_exception(pException);
+            }
+
+            if (!bRet)
+            {
+                return std::nullopt;
+            }
+
+            std::size_t rowCount = 0;
+            for (const auto &rows : chunkRows)
+            {
+                rowCount += rows.size();
+            }
+
+            std::vector<ResultType> result;
+            result.reserve(rowCount);
+            for (auto &rows : chunkRows)
+            {
+                std::move(rows.begin(), rows.end(), std::back_inserter(result));
+            }
+
+            BulkLoadStats stats;
+            stats.rowCount   = rowCount;
+            stats.chunkCount = static_cast<uint32_t>(chunks.size());
+            stats.elapsed    = std::chrono::steady_clock::now() - beginTime;
+            LogBulkLoadStats(ChunkStmtType::ID, stats);
+            if (nullptr != pStats)
+            {
+                *pStats = stats;
+            }
+
+            return result;
+        }
 
     private:
+        using ConnectionList  = std::vector<std::shared_ptr<ConnectionType>>;
+        using ConnectionLists = std::array<ConnectionList, EConnectionTypeIndex_Max>;
+
+        struct Replica
+        {
+            std::size_t                          index {0}; // 在ReplicaBalancer中的索引
+            std::unique_ptr<MySqlConnectionInfo> pConnectionInfo;
+            uint8_t                              syncConnectionCount {0};
+            uint8_t                              asyncConnectionCount {0};
+            ConnectionLists                      connections; // Open之后不再修改
+            bool                                 bAvailable {false}; // 仅健康检查线程访问，用于输出状态变化
+
+            // 探测连续失败的次数及退避结束时间，仅健康检查线程访问
+            uint32_t                              probeFailures {0};
+            std::chrono::steady_clock::time_point nextProbeTime;
+        };
+
+        QueryCallback             AsyncQuery(PreparedStatementPtr pStmt, const ReadSession *pSession);
+        PreparedQueryResultSetPtr SyncQuery(PreparedStatementBase *pStmt, const ReadSession *pSession);
+
         uint32_t OpenConnections(EConnectionTypeIndex type, uint8_t openConnectionCount);
 
+        // 创建并打开一个连接，失败时返回nullptr
+        std::shared_ptr<ConnectionType>
+        CreateConnection(EConnectionTypeIndex type, MySqlConnectionInfo &info, uint32_t &errcode);
+
+        void OpenReplica(Replica &replica);
+
+        // 只读语句选择从库，返回nullptr表示走主库
+        Replica *SelectReplica(uint32_t stmtID, const ReadSession *pSession);
+
+        // 获取并锁定执行只读查询的同步连接，pReplica为所选从库，走主库时为nullptr
+        std::shared_ptr<ConnectionType>
+        GetReadConnectionAndLock(uint32_t stmtID, const ReadSession *pSession, Replica *&pReplica);
+
+        std::shared_ptr<ConnectionType> GetReadAsyncConnection(uint32_t stmtID, const ReadSession *pSession);
+
+        void RecordReplicaLatency(Replica *pReplica, std::chrono::steady_clock::time_point begin);
+
+        static bool IsLessLoaded(const std::shared_ptr<ConnectionType> &lhs,
+                                 const std::shared_ptr<ConnectionType> &rhs);
+
+        // 获取并锁定一个可用的同步连接，所有同步连接均已断开时返回nullptr
         std::shared_ptr<ConnectionType> GetFreeConnectionAndLock();
 
+        // 获取任务最少的异步连接，优先选择未断开的连接
         std::shared_ptr<ConnectionType> GetFreeAsyncConnection();
 
+        // 健康检查线程：负责断线重连与空闲连接心跳，不占用业务线程与数据库工作线程
+        void StartHealthCheck();
+        void StopHealthCheck();
+        void ScheduleReconnect(std::weak_ptr<ConnectionType> pWeakConnection,
+                               std::chrono::milliseconds     delay);
+        void ScheduleKeepalive();
+        void KeepaliveConnections();
+        void KeepaliveConnections(const ConnectionLists &connections);
+        void ScheduleReplicaProbe();
+        void ProbeReplicas();
+        void UpdateReplicaLag(Replica &replica, std::optional<std::chrono::seconds> lag);
+        void OnReplicaProbeFailed(Replica &replica, uint32_t errcode);
+        void ScheduleScaling();
+        void ScaleConnections();
+        void ScaleConnections(EConnectionTypeIndex type, std::chrono::steady_clock::time_point now);
+        bool GrowConnections(EConnectionTypeIndex type);
+        bool ShrinkConnections(EConnectionTypeIndex type);
+        void ReapDrainingConnections();
+
     private:
-        std::array<std::vector<std::shared_ptr<ConnectionType>>, EConnectionTypeIndex_Max> _typeConnections;
-        std::atomic<size_t>                                                                _queueSize;
-        std::unique_ptr<MySqlConnectionInfo>                                               _pConnectionInfo;
+        ConnectionLists                      _typeConnections;
+        std::atomic<size_t>                  _queueSize;
+        std::unique_ptr<MySqlConnectionInfo> _pConnectionInfo;
         std::vector<uint8_t> _preparedStmtParamCount;
-        uint8_t              _asyncThreadCount {0};
-        uint8_t              _syncThreadCount {0};
+        QueryResultCache     _queryCache;
+
+        // 连接列表在伸缩时由健康检查线程修改，其余线程读取时加共享锁
+        mutable std::shared_mutex                                       _connectionsMutex;
+        DatabasePoolConfig                                              _config;
+        std::array<std::optional<PoolScaler>, EConnectionTypeIndex_Max> _scalers;
+        std::array<PoolScalingMetrics, EConnectionTypeIndex_Max>        _scalingMetrics;
+        mutable std::mutex                                              _metricsMutex;
+        // 仅健康检查线程访问
+        ConnectionList                                                  _drainingConnections;
+        Metrics::Histogram                                              _syncWaitHistogram;
+        std::atomic<std::size_t>                                        _syncWaiterCount {0};
+        std::atomic<bool>                                               _bStatementsPrepared {false};
+
+        // 导出的排队深度与连接数，由健康检查线程在每个伸缩周期更新
+        std::array<Metrics::Gauge *, EConnectionTypeIndex_Max> _pQueueDepthGauges {};
+        std::array<Metrics::Gauge *, EConnectionTypeIndex_Max> _pConnectionGauges {};
+
+        std::vector<std::unique_ptr<Replica>> _replicas; // Open之后不再修改
+        ReplicaBalancer                       _replicaBalancer;
+        std::vector<bool>                     _readOnlyStmts;
+        std::chrono::milliseconds             _stickyWindow {DEFAULT_STICKY_WINDOW};
+
+        asio::io_context                    _healthIoCtx;
+        asio::any_io_executor               _healthWork;
+        std::unique_ptr<std::thread>        _pHealthThread;
+        std::unique_ptr<asio::steady_timer> _pKeepaliveTimer;
+        std::unique_ptr<asio::steady_timer> _pScaleTimer;
+        std::unique_ptr<asio::steady_timer> _pReplicaProbeTimer;
+        std::chrono::seconds                _keepaliveInterval {DEFAULT_KEEPALIVE_INTERVAL};
+        OutagePolicy                        _outagePolicy {OutagePolicy::FailFast};
+        std::chrono::milliseconds           _parkTimeout {DEFAULT_PARK_TIMEOUT};
+
+        std::atomic<std::chrono::milliseconds> _slowQueryThreshold {DEFAULT_SLOW_QUERY_THRESHOLD};
     };
 } // namespace Database
\ No newline at end of file
@@ -10,129 +10,127 @@
 #include "Common/Util/Assert.h"
 #include "Common/Util/Util.h"
 
+#include <charconv>
+#include <cstring>
 #include <format>
 #include <variant>
 
 namespace Database
 {
-    [[nodiscard]] uint8_t Field::GetUInt8() const
+    namespace
     {
-        auto ret = CheckType<uint8_t>();
-        if (!ret.has_value())
+        template <typename T>
+        constexpr std::string_view GetterName()
         {
-            LogWrongGetter(__FUNCTION__);
-            return {};
+            if constexpr (std::is_same_v<T, uint8_t>)
+            {
+                return "GetUInt8";
+            }
+            else if constexpr (std::is_same_v<T, int8_t>)
+            {
+                return "GetInt8";
+            }
+            else if constexpr (std::is_same_v<T, uint16_t>)
+            {
+                return "GetUInt16";
+            }
+            else if constexpr (std::is_same_v<T, int16_t>)
+            {
+                return "GetInt16";
+            }
+            else if constexpr (std::is_same_v<T, uint32_t>)
+            {
+                return "GetUInt32";
+            }
+            else if constexpr (std::is_same_v<T, int32_t>)
+            {
+                return "GetInt32";
+            }
+            else if constexpr (std::is_same_v<T, uint64_t>)
+            {
+                return "GetUInt64";
+            }
+            else if constexpr (std::is_same_v<T, int64_t>)
+            {
+                return "GetInt64";
+            }
+            else if constexpr (std::is_same_v<T, float>)
+            {
+                return "GetFloat";
+            }
+            else
+            {
+                return "GetDouble";
+            }
         }
 
-        return ret.value();
-    }
-
-    [[nodiscard]] int8_t Field::GetInt8() const
-    {
-        auto ret = CheckType<int8_t>();
-        if (!ret.has_value())
+        // 按列的本机类型解析文本，失败时为0，与二进制协议的取值一致
+        template <typename T>
+        uint64_t ParseNumber(const char *pValue, uint32_t length)
         {
-            LogWrongGetter(__FUNCTION__);
-            return {};
-        }
+            T value {};
+            if constexpr (std::is_integral_v<T>)
+            {
+                value = Util::ParseDecimal<T>({pValue, length}).value_or(0);
+            }
+            else
+            {
+                std::from_chars(pValue, pValue + length, value);
+            }
 
-        return ret.value();
-    }
-
-    [[nodiscard]] uint16_t Field::GetUInt16() const
-    {
-        auto ret = CheckType<uint16_t>();
-        if (!ret.has_value())
-        {
-            LogWrongGetter(__FUNCTION__);
-            return {};
-        }
-
-        return ret.value();
-    }
-
-    [[nodiscard]] int16_t Field::GetInt16() const
-    {
-        auto ret = CheckType<int16_t>();
-        if (!ret.has_value())
-        {
-            LogWrongGetter(__FUNCTION__);
-            return {};
-        }
-
-        return ret.value();
-    }
-
-    [[nodiscard]] uint32_t Field::GetUInt32() const
-    {
-        auto ret = CheckType<uint32_t>();
-        if (!ret.has_value())
-        {
-            LogWrongGetter(__FUNCTION__);
-            return {};
-        }
-
-        return ret.value();
-    }
-
-    [[nodiscard]] int32_t Field::GetInt32() const
-    {
-        auto ret = CheckType<int32_t>();
-        if (!ret.has_value())
-        {
-            LogWrongGetter(__FUNCTION__);
-            return {};
+            uint64_t bits = 0;
+            std::memcpy(&bits, &value, sizeof(T));
+            return bits;
         }
+    } // namespace
 
-        return ret.value();
-    }
-
-    [[nodiscard]] uint64_t Field::GetUInt64() const
+    template <typename T>
+    T Field::ConvertNumber() const
     {
-        auto ret = CheckType<uint64_t>();
+        auto ret = CheckType<T>();
         if (!ret.has_value())
         {
-            LogWrongGetter(__FUNCTION__);
+            LogWrongGetter(GetterName<T>());
             return {};
         }
 
         return ret.value();
     }
 
-    [[nodiscard]] int64_t Field::GetInt64() const
-    {
-        auto ret = CheckType<int64_t>();
-        if (!ret.has_value())
-        {
-            LogWrongGetter(__FUNCTION__);
-            return {};
-        }
+    template uint8_t  Field::ConvertNumber<uint8_t>() const;
+    template int8_t   Field::ConvertNumber<int8_t>() const;
+    template uint16_t Field::ConvertNumber<uint16_t>() const;
+    template int16_t  Field::ConvertNumber<int16_t>() const;
+    template uint32_t Field::ConvertNumber<uint32_t>() const;
+    template int32_t  Field::ConvertNumber<int32_t>() const;
+    template uint64_t Field::ConvertNumber<uint64_t>() const;
+    template int64_t  Field::ConvertNumber<int64_t>() const;
+    template float    Field::ConvertNumber<float>() const;
+    template double   Field::ConvertNumber<double>() const;
 
-        return ret.value();
-    }
-
-    [[nodiscard]] float Field::GetFloat() const
+    std::string_view Field::GetStringView() const
     {
-        auto ret = CheckType<float>();
-        if (!ret.has_value())
+        // 文本协议的日期列仍是字符串，二进制协议下为MYSQL_TIME
+        const DatabaseFieldType fieldType = _meta->fieldType;
+        if (fieldType != DatabaseFieldType::Binary && fieldType != DatabaseFieldType::Decimal &&
+            (fieldType != DatabaseFieldType::Date || _meta->bBinary))
         {
             LogWrongGetter(__FUNCTION__);
             return {};
         }
 
-        return ret.value();
+        return nullptr == _pValue ? std::string_view {} : std::string_view {_pValue, _length};
     }
 
-    [[nodiscard]] double Field::GetDouble() const
+    std::span<const std::byte> Field::GetBinary() const
     {
-        auto ret = CheckType<double>();
-        if (!ret.has_value())
+        if (_meta->fieldType != DatabaseFieldType::Binary)
         {
             LogWrongGetter(__FUNCTION__);
             return {};
         }
 
-        return ret.value();
+        return {reinterpret_cast<const std::byte *>(_pValue), nullptr == _pValue ? 0 : _length};
     }
 
     [[nodiscard]] const char *Field::GetCString() const
@@ -166,6 +164,54 @@ namespace Database
         _length = length;
     }
 
+    void Field::SetTextValue(const char *newValue, uint32_t length)
+    {
+        if (nullptr == newValue)
+        {
+            SetValue(nullptr, 0);
+            return;
+        }
+
+        switch (_meta->fieldType)
+        {
+            case DatabaseFieldType::UInt8:
+                _number = ParseNumber<uint8_t>(newValue, length);
+                break;
+            case DatabaseFieldType::Int8:
+                _number = ParseNumber<int8_t>(newValue, length);
+                break;
+            case DatabaseFieldType::UInt16:
+                _number = ParseNumber<uint16_t>(newValue, length);
+                break;
+            case DatabaseFieldType::Int16:
+                _number = ParseNumber<int16_t>(newValue, length);
+                break;
+            case DatabaseFieldType::UInt32:
+                _number = ParseNumber<uint32_t>(newValue, length);
+                break;
+            case DatabaseFieldType::Int32:
+                _number = ParseNumber<int32_t>(newValue, length);
+                break;
+            case DatabaseFieldType::UInt64:
+                _number = ParseNumber<uint64_t>(newValue, length);
+                break;
+            case DatabaseFieldType::Int64:
+                _number = ParseNumber<int64_t>(newValue, length);
+                break;
+            case DatabaseFieldType::Float:
+                _number = ParseNumber<float>(newValue, length);
+                break;
+            case DatabaseFieldType::Double:
+                _number = ParseNumber<double>(newValue, length);
+                break;
+            default:
+                SetValue(newValue, length);
+                return;
+        }
+
+        SetValue(reinterpret_cast<const char *>(&_number), sizeof(_number));
+    }
+
     void Field::SetMetadata(const QueryResultFieldMetadata *fieldMeta)
     {
         Assert(fieldMeta != nullptr);
@@ -8,10 +8,14 @@
 ************************************************************************/
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <string_view>
 #include <optional>
+#include <span>
 #include <string>
+#include <type_traits>
 
 namespace Database
 {
@@ -46,6 +50,37 @@ namespace Database
         bool              bBinary   = false;
     };
 
+    // 基本类型对应的字段类型，用于按列批量读取时校验类型
+    template <typename T>
+    constexpr bool IsFieldTypeOf(DatabaseFieldType fieldType)
+    {
+        switch (fieldType)
+        {
+            case DatabaseFieldType::UInt8:
+                return std::is_same_v<T, uint8_t>;
+            case DatabaseFieldType::Int8:
+                return std::is_same_v<T, int8_t>;
+            case DatabaseFieldType::UInt16:
+                return std::is_same_v<T, uint16_t>;
+            case DatabaseFieldType::Int16:
+                return std::is_same_v<T, int16_t>;
+            case DatabaseFieldType::UInt32:
+                return std::is_same_v<T, uint32_t>;
+            case DatabaseFieldType::Int32:
+                return std::is_same_v<T, int32_t>;
+            case DatabaseFieldType::UInt64:
+                return std::is_same_v<T, uint64_t>;
+            case DatabaseFieldType::Int64:
+                return std::is_same_v<T, int64_t>;
+            case DatabaseFieldType::Float:
+                return std::is_same_v<T, float>;
+            case DatabaseFieldType::Double:
+                return std::is_same_v<T, double>;
+            default:
+                return false;
+        }
+    }
+
     class Field final
     {
         friend class QueryResultSet;
@@ -57,18 +92,46 @@ namespace Database
             return GetUInt8() == 1;
         }
 
-        [[nodiscard]] uint8_t     GetUInt8() const;
-        [[nodiscard]] int8_t      GetInt8() const;
-        [[nodiscard]] uint16_t    GetUInt16() const;
-        [[nodiscard]] int16_t     GetInt16() const;
-        [[nodiscard]] uint32_t    GetUInt32() const;
-        [[nodiscard]] int32_t     GetInt32() const;
-        [[nodiscard]] uint64_t    GetUInt64() const;
-        [[nodiscard]] int64_t     GetInt64() const;
-        [[nodiscard]] float       GetFloat() const;
-        [[nodiscard]] double      GetDouble() const;
+        // clang-format off
+        [[nodiscard]] uint8_t  GetUInt8() const  { return GetNumber<uint8_t>(); }
+        [[nodiscard]] int8_t   GetInt8() const   { return GetNumber<int8_t>(); }
+        [[nodiscard]] uint16_t GetUInt16() const { return GetNumber<uint16_t>(); }
+        [[nodiscard]] int16_t  GetInt16() const  { return GetNumber<int16_t>(); }
+        [[nodiscard]] uint32_t GetUInt32() const { return GetNumber<uint32_t>(); }
+        [[nodiscard]] int32_t  GetInt32() const  { return GetNumber<int32_t>(); }
+        [[nodiscard]] uint64_t GetUInt64() const { return GetNumber<uint64_t>(); }
+        [[nodiscard]] int64_t  GetInt64() const  { return GetNumber<int64_t>(); }
+        [[nodiscard]] float    GetFloat() const  { return GetNumber<float>(); }
+        [[nodiscard]] double   GetDouble() const { return GetNumber<double>(); }
+        // clang-format on
+
         [[nodiscard]] const char *GetCString() const;
 
+        /**
+         * @brief 读取数值，列类型与T一致时直接读取本机字节，否则转换并检查是否截断
+         *        文本协议的数值列在拉取每行时已统一解析为本机字节，两种协议的快速路径相同
+         */
+        template <typename T>
+        [[nodiscard]] T GetNumber() const
+        {
+            if (nullptr == _pValue)
+            {
+                return T {};
+            }
+
+            if (_meta->bBinary && IsFieldTypeOf<T>(_meta->fieldType)) [[likely]]
+            {
+                T value;
+                std::memcpy(&value, _pValue, sizeof(T));
+                return value;
+            }
+
+            return ConvertNumber<T>();
+        }
+
+        template <typename T>
+        T ConvertNumber() const;
+
         [[nodiscard]] bool IsNull() const
         {
             return _pValue == nullptr;
@@ -81,9 +144,26 @@ namespace Database
 
         void SetValue(const char *newValue, uint32_t length);
 
+        // 文本协议的值，数值列解析后存入_number，其余列直接引用
+        void SetTextValue(const char *newValue, uint32_t length);
+
         void SetMetadata(const QueryResultFieldMetadata *fieldMeta);
 
     public:
+        /**
+         * @brief 字符串列的值，不拷贝，只在当前行有效
+         *
+         * @return NULL值返回空
+         */
+        [[nodiscard]] std::string_view GetStringView() const;
+
+        /**
+         * @brief 二进制列的值，不拷贝，只在当前行有效
+         *
+         * @return NULL值返回空
+         */
+        [[nodiscard]] std::span<const std::byte> GetBinary() const;
+
         operator uint8_t()
         {
             return GetUInt8();
@@ -129,6 +209,11 @@ namespace Database
             return GetCString();
         }
 
+        operator std::string_view()
+        {
+            return GetStringView();
+        }
+
         operator std::string()
         {
             const char *str = GetCString();
@@ -139,6 +224,7 @@ namespace Database
         const char                     *_pValue {nullptr};
         uint32_t                        _length {0};
         const QueryResultFieldMetadata *_meta {nullptr};
+        uint64_t                        _number {0}; // 文本协议数值列解析后的本机字节
     };
 
 } // namespace Database
\ No newline at end of file
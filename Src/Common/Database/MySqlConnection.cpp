@@ -10,6 +10,8 @@
 #include "PreparedStatement.h"
 #include "MySqlPreparedStatement.h"
 #include "QueryResult.h"
+#include "ReplicaBalancer.h"
+#include "SqlPipeline.h"
 
 #include "MySqlTypeHack.h"
 #include "mysqld_error.h"
@@ -18,15 +20,28 @@
 #include "Common/Util/Util.h"
 #include "Common/Util/Performance.h"
 
+#include <algorithm>
+
 namespace Database
 {
+    namespace
+    {
+        bool IsConnectionLostError(uint32_t errcode)
+        {
+            return CR_SERVER_GONE_ERROR == errcode || CR_SERVER_LOST == errcode ||
+                   CR_SERVER_LOST_EXTENDED == errcode || CR_CONN_HOST_ERROR == errcode;
+        }
+    } // namespace
 
     IMySqlConnection::IMySqlConnection(MySqlConnectionInfo &info, MySqlConnectionType connType)
         : _connectInfo(info)
         , _mysqlConnType(connType)
         , _ioCtx(1)
+        , _queryLatency(Metrics::GetHistogram("db_query_duration_seconds",
+                                              "sql语句在数据库上的执行耗时",
+                                              std::format(R"(database="{}")", info.database)))
     {
-        Log::Debug("create MysqlConnection");
+        LOG_DEBUG(Database, "create MysqlConnection");
     }
 
     bool IMySqlConnection::Update()
@@ -41,39 +56,43 @@ namespace Database
 
     uint32_t IMySqlConnection::Open()
     {
-        _pMysqlHandle = mysql_init(nullptr);
-        if (nullptr == _pMysqlHandle)
+        MySqlHandle *pMysqlHandle = mysql_init(nullptr);
+        if (nullptr == pMysqlHandle)
         {
             Log::Error("初始化数据库：{} 失败", _connectInfo.database);
             return CR_UNKNOWN_ERROR;
         }
 
-        mysql_options(_pMysqlHandle, MYSQL_SET_CHARSET_NAME, "utf8mb4");
+        mysql_options(pMysqlHandle, MYSQL_SET_CHARSET_NAME, "utf8mb4");
+
+        // 重连在后台线程上进行，限制单次连接的耗时
+        uint32_t connectTimeout = 3;
+        mysql_options(pMysqlHandle, MYSQL_OPT_CONNECT_TIMEOUT, &connectTimeout);
 
         uint32_t port = Util::StringTo<uint32_t>(_connectInfo.port).value_or(3306);
-        _pMysqlHandle = mysql_real_connect(_pMysqlHandle,
-                                           _connectInfo.host.data(),
-                                           _connectInfo.user.data(),
-                                           _connectInfo.password.data(),
-                                           _connectInfo.database.data(),
-                                           port,
-                                           nullptr,
-                                           0);
-        if (nullptr == _pMysqlHandle)
-        {
-            uint32_t errcode = mysql_errno(_pMysqlHandle);
+        if (nullptr == mysql_real_connect(pMysqlHandle,
+                                          _connectInfo.host.data(),
+                                          _connectInfo.user.data(),
+                                          _connectInfo.password.data(),
+                                          _connectInfo.database.data(),
+                                          port,
+                                          nullptr,
+                                          0))
+        {
+            uint32_t errcode = mysql_errno(pMysqlHandle);
             Log::Error("数据库连接失败：{}:{} [host:{}, user:{}, password:{}, database:{}, port:{}]",
                        errcode,
-                       mysql_errno(_pMysqlHandle),
+                       mysql_error(pMysqlHandle),
                        _connectInfo.host,
                        _connectInfo.user,
                        _connectInfo.password,
                        _connectInfo.database,
                        port);
-            mysql_close(_pMysqlHandle);
+            mysql_close(pMysqlHandle);
             return errcode;
         }
 
+        _pMysqlHandle = pMysqlHandle;
         if (!_bReconnecting)
         {
             Log::Info("MySql client library:{}", mysql_get_client_info());
@@ -81,19 +100,31 @@ namespace Database
         }
 
         mysql_autocommit(_pMysqlHandle, true);
+
+        // 首次连接直接可用；重连时须重新预处理语句后才可用，见Reconnect
+        if (!_bReconnecting)
+        {
+            _bConnected.store(true, std::memory_order_release);
+            Touch();
+        }
+
         return 0;
     }
 
     void IMySqlConnection::Close()
     {
-        Log::Debug("mysqlconnection close");
-        // _workGrard.reset();
+        LOG_DEBUG(Database, "mysqlconnection close");
 
-        if (_pWorkerThread->joinable())
+        // 释放工作守卫，队列中的任务执行完毕后工作线程退出
+        _ioWork = asio::any_io_executor();
+        if (nullptr != _pWorkerThread && _pWorkerThread->joinable())
         {
             _pWorkerThread->join();
         }
 
+        _bConnected.store(false, std::memory_order_release);
+        _stateCond.notify_all();
+
         _stmts.clear();
 
         if (nullptr != _pMysqlHandle)
@@ -106,20 +137,38 @@ namespace Database
     bool IMySqlConnection::PrepareStatements()
     {
         DoPrepareStatements();
+
+        if (nullptr == _pStmtMetrics)
+        {
+            _pStmtMetrics = std::make_unique<StatementMetrics>(_stmts.size());
+            _bStmtMetricsReady.store(true, std::memory_order_release);
+        }
+
         return !_bPrepareError;
     }
 
     bool IMySqlConnection::Execute(std::string_view sql)
     {
-        if (nullptr == _pMysqlHandle)
+        if (!EnsureConnected())
         {
             return false;
         }
 
         {
-            PERFORMANCE_SCOPE("执行Sql语句：{}", sql);
+            PERFORMANCE_SCOPE_NAMED("IMySqlConnection::Execute", "执行Sql语句：{}", sql);
+
+            const auto beginTime = std::chrono::steady_clock::now();
+            const int  ret       = mysql_query(_pMysqlHandle, sql.data());
+            const auto elapsed   = std::chrono::steady_clock::now() - beginTime;
+            _queryLatency.Record(elapsed);
+            if (IsSlowQuery(elapsed))
+            {
+                Log::Warn("慢查询，耗时{}：{}",
+                          std::chrono::duration_cast<std::chrono::milliseconds>(elapsed),
+                          sql);
+            }
 
-            if (0 != mysql_query(_pMysqlHandle, sql.data()))
+            if (0 != ret)
             {
                 uint32_t errcode = mysql_errno(_pMysqlHandle);
                 Log::Info("执行sql脚本：{}", sql);
@@ -139,7 +188,7 @@ namespace Database
 
     bool IMySqlConnection::Execute(PreparedStatementBase *pStmt)
     {
-        if (nullptr == _pMysqlHandle)
+        if (!EnsureConnected())
         {
             return false;
         }
@@ -150,48 +199,43 @@ namespace Database
 
         pPreparedStmt->BindParameters(pStmt);
 
-        MySqlStmt *pMySqlStmt = pPreparedStmt->GetMySqlStmt();
-        MySqlBind *pMySqlBind = pPreparedStmt->GetMySqlBind();
-
+        uint32_t errcode = 0;
+        if (!ExecuteStatement(index, pPreparedStmt, errcode))
         {
-            PERFORMANCE_SCOPE("执行sql语句：{}", pPreparedStmt->GetSqlString());
-
-            if (mysql_stmt_bind_param(pMySqlStmt, pMySqlBind))
+            if (HandleMySqlErrcode(errcode))
             {
-                uint32_t errcode = mysql_errno(_pMysqlHandle);
-                Log::Error("执行sql:{} 绑定参数错误：{}:{}",
-                           pPreparedStmt->GetSqlString(),
-                           errcode,
-                           mysql_stmt_error(pMySqlStmt));
+                return Execute(pStmt);
+            }
 
-                if (HandleMySqlErrcode(errcode))
-                {
-                    return Execute(pStmt);
-                }
+            return false;
+        }
 
-                pPreparedStmt->ClearParameters();
-                return false;
-            }
+        return true;
+    }
 
-            if (0 != mysql_stmt_execute(pMySqlStmt))
-            {
-                uint32_t errcode = mysql_errno(_pMysqlHandle);
-                Log::Error("执行sql语句：{} 出错：{}:{}",
-                           pPreparedStmt->GetSqlString(),
-                           errcode,
-                           mysql_stmt_error(pMySqlStmt));
+    bool IMySqlConnection::Execute(uint32_t index, std::span<const SqlBindValue> params)
+    {
+        if (!EnsureConnected())
+        {
+            return false;
+        }
 
-                if (HandleMySqlErrcode(errcode))
-                {
-                    return Execute(pStmt);
-                }
+        MySqlPreparedStatement *pPreparedStmt = GetPrepareStatement(index);
+        Assert(nullptr != pPreparedStmt);
 
-                pPreparedStmt->ClearParameters();
-                return false;
+        pPreparedStmt->BindParameters(params);
+
+        uint32_t errcode = 0;
+        if (!ExecuteStatement(index, pPreparedStmt, errcode))
+        {
+            if (HandleMySqlErrcode(errcode))
+            {
+                return Execute(index, params);
             }
+
+            return false;
         }
 
-        pPreparedStmt->ClearParameters();
         return true;
     }
 
@@ -202,26 +246,36 @@ namespace Database
             return;
         }
 
-        asio::post(_ioWork, [this, strSql = std::string(sql)]() {
-            if (!Execute(strSql))
-            {
-                // do nothing
-            }
-        });
+        // 追加到尚未开始执行的批次，没有时新建批次并投递执行任务
+        ++_asyncTaskCount;
+        std::lock_guard lock(_batchMutex);
+        if (nullptr == _pOpenBatch)
+        {
+            _pOpenBatch = std::make_shared<SqlBatch>();
+            asio::post(_ioWork, [this, pBatch = _pOpenBatch]() {
+                ExecuteSqlBatch(pBatch);
+            });
+        }
+
+        _pOpenBatch->sqls.emplace_back(sql);
+        _pOpenBatch->queuedTimes.emplace_back(std::chrono::steady_clock::now());
     }
 
-    void IMySqlConnection::AsyncExecute(PreparedStatementBase *pStmt)
+    void IMySqlConnection::AsyncExecute(PreparedStatementPtr pStmt)
     {
         if (nullptr == pStmt)
         {
             return;
         }
 
-        asio::post(_ioWork, [this, pStmt = std::unique_ptr<PreparedStatementBase>(pStmt)]() {
+        const auto queuedTime = OnAsyncTaskQueued();
+        asio::post(_ioWork, [this, queuedTime, pStmt = std::move(pStmt)]() {
+            OnAsyncTaskStarted(queuedTime, pStmt->GetIndex());
             if (!Execute(pStmt.get()))
             {
                 // do nothing
             }
+            --_asyncTaskCount;
         });
     }
 
@@ -236,9 +290,7 @@ namespace Database
         MySqlField        *pFields    = nullptr;
         uint64_t           rowCount   = 0;
         uint32_t           fieldCount = 0;
-        std::ostringstream ss;
-        ss << std::this_thread::get_id();
-        Log::Debug("**********Query thread id:{}", ss.str());
+        LOG_DEBUG(Database, "**********Query thread id:{}", Util::GetCurrentThreadIdString());
         if (!Query(sql, pResult, pFields, rowCount, fieldCount))
         {
             return nullptr;
@@ -253,15 +305,183 @@ namespace Database
         MySqlResult            *pResult       = nullptr;
         uint64_t                rowCount      = 0;
         uint32_t                fieldCount    = 0;
-        std::ostringstream      ss;
-        ss << std::this_thread::get_id();
-        Log::Debug("**********Query thread id:{}", ss.str());
+        LOG_DEBUG(Database, "**********Query thread id:{}", Util::GetCurrentThreadIdString());
         if (!Query(pStmt, pPreparedStmt, pResult, rowCount, fieldCount))
         {
             return nullptr;
         }
 
-        return MakePreparedQueryResultSetPtr(pPreparedStmt->GetMySqlStmt(), pResult, rowCount, fieldCount);
+        const auto beginTime = std::chrono::steady_clock::now();
+        auto       pResultSet =
+            MakePreparedQueryResultSetPtr(pPreparedStmt->GetMySqlStmt(), pResult, rowCount, fieldCount);
+        RecordDecode(pStmt->GetIndex(), std::chrono::steady_clock::now() - beginTime);
+        return pResultSet;
+    }
+
+    bool IMySqlConnection::StreamQuery(std::string_view sql, const QueryRowCallback &callback)
+    {
+        if (sql.empty())
+        {
+            return false;
+        }
+
+        MySqlResult *pResult    = nullptr;
+        MySqlField  *pFields    = nullptr;
+        uint64_t     rowCount   = 0;
+        uint32_t     fieldCount = 0;
+        if (!Query(sql, pResult, pFields, rowCount, fieldCount, true))
+        {
+            return false;
+        }
+
+        // 结果集析构时释放，未读取完的行会被丢弃
+        QueryResultSet result(pResult, pFields, rowCount, fieldCount);
+        while (result.NextRow())
+        {
+            if (!callback(result))
+            {
+                break;
+            }
+        }
+
+        return true;
+    }
+
+    bool IMySqlConnection::StreamQuery(PreparedStatementBase    *pStmt,
+                                       uint32_t                  batchSize,
+                                       const QueryBatchCallback &callback)
+    {
+        MySqlPreparedStatement *pPreparedStmt = nullptr;
+        MySqlResult            *pResult       = nullptr;
+        uint64_t                rowCount      = 0;
+        uint32_t                fieldCount    = 0;
+        if (!Query(pStmt, pPreparedStmt, pResult, rowCount, fieldCount))
+        {
+            return false;
+        }
+
+        if (nullptr == pResult)
+        {
+            return false;
+        }
+
+        if (0 == batchSize)
+        {
+            batchSize = DEFAULT_STREAM_BATCH_SIZE;
+        }
+
+        // 解析耗时只累计拉取各批数据的部分，不含回调
+        MySqlStmt                          *pMySqlStmt = pPreparedStmt->GetMySqlStmt();
+        std::chrono::steady_clock::duration decodeTime {};
+        while (true)
+        {
+            const auto                beginTime = std::chrono::steady_clock::now();
+            PreparedQueryResultSetPtr pBatch =
+                MakePreparedQueryResultSetPtr(pMySqlStmt, pResult, batchSize, fieldCount, true);
+            decodeTime += std::chrono::steady_clock::now() - beginTime;
+
+            const uint64_t fetchedCount = pBatch->GetRowCount();
+            if (fetchedCount > 0 && !callback(std::move(pBatch)))
+            {
+                break;
+            }
+
+            if (fetchedCount < batchSize)
+            {
+                break;
+            }
+        }
+
+        // 丢弃未拉取的数据并释放元数据
+        mysql_stmt_free_result(pMySqlStmt);
+        mysql_free_result(pResult);
+        RecordDecode(pStmt->GetIndex(), decodeTime);
+        return true;
+    }
+
+    bool IMySqlConnection::Query(uint32_t                       index,
+                                 std::span<const SqlBindValue>  params,
+                                 std::span<const SqlResultBind> columns,
+                                 const std::function<void()>   &onRow)
+    {
+        if (!EnsureConnected())
+        {
+            return false;
+        }
+
+        MySqlPreparedStatement *pPreparedStmt = GetPrepareStatement(index);
+        Assert(nullptr != pPreparedStmt);
+
+        pPreparedStmt->BindParameters(params);
+
+        uint32_t errcode = 0;
+        if (!ExecuteStatement(index, pPreparedStmt, errcode))
+        {
+            if (HandleMySqlErrcode(errcode))
+            {
+                return Query(index, params, columns, onRow);
+            }
+
+            return false;
+        }
+
+        // 解析耗时包括拉取结果与写入列，不含行回调
+        auto       beginTime  = std::chrono::steady_clock::now();
+        auto       decodeTime = std::chrono::steady_clock::duration::zero();
+        MySqlStmt *pMySqlStmt = pPreparedStmt->GetMySqlStmt();
+        if (0 != mysql_stmt_store_result(pMySqlStmt))
+        {
+            Log::Error("预处理语句：{} 获取结果错误：{}", index, mysql_stmt_error(pMySqlStmt));
+            return false;
+        }
+
+        if (!pPreparedStmt->BindResults(columns))
+        {
+            mysql_stmt_free_result(pMySqlStmt);
+            return false;
+        }
+
+        while (true)
+        {
+            const int ret = mysql_stmt_fetch(pMySqlStmt);
+            if (MYSQL_NO_DATA == ret)
+            {
+                break;
+            }
+
+            if (1 == ret)
+            {
+                Log::Error("预处理语句：{} 拉取结果错误：{}", index, mysql_stmt_error(pMySqlStmt));
+                break;
+            }
+
+            pPreparedStmt->StoreResultRow(columns);
+            decodeTime += std::chrono::steady_clock::now() - beginTime;
+            onRow();
+            beginTime = std::chrono::steady_clock::now();
+        }
+
+        mysql_stmt_free_result(pMySqlStmt);
+        RecordDecode(index, decodeTime + (std::chrono::steady_clock::now() - beginTime));
+        return true;
+    }
+
+    std::future<bool> IMySqlConnection::AsyncStreamQuery(PreparedStatementPtr pStmt,
+                                                         uint32_t             batchSize,
+                                                         QueryBatchCallback   callback)
+    {
+        const auto queuedTime = OnAsyncTaskQueued();
+        return asio::post(_ioWork,
+                          asio::use_future([this,
+                                            queuedTime,
+                                            p  = std::shared_ptr<PreparedStatementBase>(std::move(pStmt)),
+                                            batchSize,
+                                            cb = std::move(callback)]() -> bool {
+                              OnAsyncTaskStarted(queuedTime, p->GetIndex());
+                              bool bRet = StreamQuery(p.get(), batchSize, cb);
+                              --_asyncTaskCount;
+                              return bRet;
+                          }));
     }
 
     void IMySqlConnection::BeginTransaction()
@@ -284,9 +504,206 @@ namespace Database
         return mysql_errno(_pMysqlHandle);
     }
 
-    void IMySqlConnection::Ping() const
+    bool IMySqlConnection::Ping()
     {
-        mysql_ping(_pMysqlHandle);
+        if (!IsConnected())
+        {
+            return false;
+        }
+
+        if (0 == mysql_ping(_pMysqlHandle))
+        {
+            Touch();
+            return true;
+        }
+
+        Log::Warn("数据库：{} 心跳检测失败：{}", _connectInfo.database, mysql_error(_pMysqlHandle));
+        OnConnectionLost();
+        return false;
+    }
+
+    bool IMySqlConnection::Reconnect()
+    {
+        std::lock_guard lock(_mutex);
+        if (IsConnected())
+        {
+            return true;
+        }
+
+        _bReconnecting = true;
+        if (0 != Open())
+        {
+            return false;
+        }
+
+        _bPrepareError = false;
+        if (!PrepareStatements())
+        {
+            Log::Error("重连数据库：{} 后处理预处理语句失败", _connectInfo.database);
+            mysql_close(_pMysqlHandle);
+            _pMysqlHandle = nullptr;
+            return false;
+        }
+
+        _bReconnecting = false;
+        Touch();
+        {
+            std::lock_guard stateLock(_stateMutex);
+            _bConnected.store(true, std::memory_order_release);
+        }
+        _stateCond.notify_all();
+
+        Log::Info("重连数据库成功：{} @{}:{} {}",
+                  _connectInfo.database,
+                  _connectInfo.host,
+                  _connectInfo.port,
+                  (Util::ToUnderlying(_mysqlConnType) & Util::ToUnderlying(MySqlConnectionType::Async))
+                      ? "异步方式"
+                      : "同步方式");
+        return true;
+    }
+
+    bool IMySqlConnection::QueryReplicaLag(std::optional<std::chrono::seconds> &lag, uint32_t &errcode)
+    {
+        errcode = 0;
+        if (!EnsureConnected())
+        {
+            return false;
+        }
+
+        // 8.0.22起为SHOW REPLICA STATUS，更早的版本只支持SHOW SLAVE STATUS
+        const std::string_view sql = _bLegacyReplicaStatus ? "SHOW SLAVE STATUS" : "SHOW REPLICA STATUS";
+        if (0 != mysql_query(_pMysqlHandle, sql.data()))
+        {
+            errcode = mysql_errno(_pMysqlHandle);
+            if (ER_PARSE_ERROR == errcode && !_bLegacyReplicaStatus)
+            {
+                _bLegacyReplicaStatus = true;
+                return QueryReplicaLag(lag, errcode);
+            }
+
+            // 从库的语法、权限等错误不能终止主库进程，日志与退避由调用方负责
+            if (IsConnectionLostError(errcode))
+            {
+                OnConnectionLost();
+            }
+
+            return false;
+        }
+
+        MySqlResult *pResult = mysql_store_result(_pMysqlHandle);
+        if (nullptr == pResult)
+        {
+            errcode = mysql_errno(_pMysqlHandle);
+            return false;
+        }
+
+        // 没有复制状态说明连接的不是从库，视为没有延迟
+        MYSQL_ROW row = mysql_fetch_row(pResult);
+        if (nullptr == row)
+        {
+            mysql_free_result(pResult);
+            lag = std::chrono::seconds::zero();
+            return true;
+        }
+
+        const uint32_t       fieldCount = mysql_num_fields(pResult);
+        const MySqlField    *pFields    = mysql_fetch_fields(pResult);
+        const unsigned long *pLengths   = mysql_fetch_lengths(pResult);
+
+        std::vector<std::string_view>                names(fieldCount);
+        std::vector<std::optional<std::string_view>> values(fieldCount);
+        for (uint32_t i = 0; i < fieldCount; ++i)
+        {
+            names[i] = std::string_view(pFields[i].name, pFields[i].name_length);
+            if (nullptr != row[i])
+            {
+                values[i] = std::string_view(row[i], pLengths[i]);
+            }
+        }
+
+        const bool bFound = ParseReplicaLag(names, values, lag);
+        mysql_free_result(pResult);
+
+        // 与复制中断区分开，避免把无法识别的复制状态当作复制中断
+        if (!bFound)
+        {
+            errcode = REPLICA_LAG_COLUMN_MISSING;
+            Log::Error("{} 的结果中没有复制延迟列：{} 或 {}",
+                       sql,
+                       REPLICA_LAG_COLUMNS[0],
+                       REPLICA_LAG_COLUMNS[1]);
+        }
+
+        return bFound;
+    }
+
+    std::chrono::steady_clock::duration IMySqlConnection::GetIdleTime() const
+    {
+        const int64_t lastActiveTime = _lastActiveTime.load(std::memory_order_relaxed);
+        return std::chrono::steady_clock::now().time_since_epoch() -
+               std::chrono::steady_clock::duration(lastActiveTime);
+    }
+
+    void IMySqlConnection::SetOutagePolicy(OutagePolicy policy, std::chrono::milliseconds parkTimeout)
+    {
+        _outagePolicy = policy;
+        _parkTimeout  = parkTimeout;
+    }
+
+    bool IMySqlConnection::EnsureConnected()
+    {
+        if (IsConnected())
+        {
+            Touch();
+            return true;
+        }
+
+        // 同步连接由调用线程直接使用，断线时不能阻塞业务线程
+        const bool bAsync =
+            Util::ToUnderlying(_mysqlConnType) & Util::ToUnderlying(MySqlConnectionType::Async);
+        if (OutagePolicy::Park != _outagePolicy || !bAsync)
+        {
+            return false;
+        }
+
+        std::unique_lock lock(_stateMutex);
+        return _stateCond.wait_until(lock, _disconnectTime + _parkTimeout, [this] {
+            return IsConnected();
+        });
+    }
+
+    void IMySqlConnection::OnConnectionLost()
+    {
+        if (!_bConnected.exchange(false, std::memory_order_acq_rel))
+        {
+            return;
+        }
+
+        {
+            std::lock_guard lock(_stateMutex);
+            _disconnectTime = std::chrono::steady_clock::now();
+        }
+
+        Log::Error("数据库：{} @{}:{} 连接丢失", _connectInfo.database, _connectInfo.host, _connectInfo.port);
+
+        // 预处理语句随句柄一同失效，重连时重新处理
+        if (nullptr != _pMysqlHandle)
+        {
+            mysql_close(_pMysqlHandle);
+            _pMysqlHandle = nullptr;
+        }
+
+        if (_disconnectHandler)
+        {
+            _disconnectHandler();
+        }
+    }
+
+    void IMySqlConnection::Touch()
+    {
+        _lastActiveTime.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                              std::memory_order_relaxed);
     }
 
     void IMySqlConnection::StartWorkerThread()
@@ -295,7 +712,8 @@ namespace Database
         _pWorkerThread = std::make_unique<std::thread>([this] {
             try
             {
-                Log::Debug("mysql running.....");
+                LOG_DEBUG(Database, "mysql running.....");
+                Profiler::SetThreadName("Database");
                 std::error_code errcode;
                 _ioCtx.run();
                 if (errcode)
@@ -303,7 +721,7 @@ namespace Database
                     Log::Error("sql connection running failed:{}", errcode.message());
                 }
 
-                Log::Debug("mysql stoping.....");
+                LOG_DEBUG(Database, "mysql stoping.....");
             }
             catch (std::exception &e)
             {
@@ -312,8 +730,10 @@ namespace Database
         });
     }
 
-    void
-    IMySqlConnection::PrepareStatement(uint32_t index, std::string_view sql, MySqlConnectionType connType)
+    void IMySqlConnection::PrepareStatement(uint32_t            index,
+                                            std::string_view    sql,
+                                            MySqlConnectionType connType,
+                                            bool                bReadOnly /*= false*/)
     {
         if (!(Util::ToUnderlying(_mysqlConnType) & Util::ToUnderlying(connType)))
         {
@@ -337,11 +757,29 @@ namespace Database
             }
             else
             {
-                _stmts[index] = std::make_unique<MySqlPreparedStatement>(pStmt, sql);
+                _stmts[index] = std::make_unique<MySqlPreparedStatement>(pStmt, sql, bReadOnly);
             }
         }
     }
 
+    void IMySqlConnection::CheckTypedStatement(uint32_t                    index,
+                                               std::span<const SqlArgType> argTypes,
+                                               std::span<const SqlArgType> paramTypes,
+                                               std::span<const SqlArgType> columnTypes)
+    {
+        if (!std::ranges::equal(argTypes, paramTypes))
+        {
+            Log::Error("预处理语句：{} 类型化定义的参数类型与sql定义不一致", index);
+            _bPrepareError = true;
+        }
+
+        MySqlPreparedStatement *pPreparedStmt = index < _stmts.size() ? _stmts[index].get() : nullptr;
+        if (nullptr != pPreparedStmt && !pPreparedStmt->CheckTypedStatement(paramTypes, columnTypes))
+        {
+            _bPrepareError = true;
+        }
+    }
+
     MySqlPreparedStatement *IMySqlConnection::GetPrepareStatement(uint32_t index)
     {
         Assert(
@@ -365,57 +803,18 @@ namespace Database
         return pMySqlPreparedStmt;
     }
 
-    bool IMySqlConnection::HandleMySqlErrcode(uint32_t errcode, uint8_t tryReconnectTimes /*= 5*/)
+    bool IMySqlConnection::HandleMySqlErrcode(uint32_t errcode)
     {
-        using namespace std::chrono_literals;
         switch (errcode)
         {
             case CR_SERVER_GONE_ERROR:
             case CR_SERVER_LOST:
             case CR_SERVER_LOST_EXTENDED:
-            {
-                if (nullptr != _pMysqlHandle)
-                {
-                    Log::Error("Mysql server 连接丢失");
-                    mysql_close(_pMysqlHandle);
-                    _pMysqlHandle = nullptr;
-                }
-            }
             case CR_CONN_HOST_ERROR:
             {
-                Log::Info("Reconnecting Mysql server......");
-                _bReconnecting         = true;
-                const uint32_t errcode = Open();
-                if (0 != errcode)
-                {
-                    if (!this->PrepareStatements())
-                    {
-                        Log::Critical("处理预处理sql语句失败，数据库连接即将断开!!!");
-                        std::this_thread::sleep_for(10s);
-                        std::abort();
-                    }
-
-                    Log::Info("重连数据库成功：{} @{}:{} {}",
-                              _connectInfo.database,
-                              _connectInfo.host,
-                              _connectInfo.port,
-                              ((uint8_t)_mysqlConnType & (uint8_t)MySqlConnectionType::Async) ? "异步方式"
-                                                                                              : "同步方式");
-                    _bReconnecting = false;
-                    return true;
-                }
-
-                if ((--tryReconnectTimes) == 0)
-                {
-                    Log::Critical("多次尝试重连数据库失败，服务中断！！！");
-                    std::this_thread::sleep_for(10s);
-                    std::abort();
-                }
-                else
-                {
-                    std::this_thread::sleep_for(3s);
-                    return HandleMySqlErrcode(_bPrepareError, tryReconnectTimes);
-                }
+                // 重连交由工作池的健康检查线程在后台完成，这里不阻塞调用方
+                OnConnectionLost();
+                return EnsureConnected();
             }
             case ER_LOCK_DEADLOCK:
             // Implemented in TransactionTask::Execute and DatabaseWorkerPool<T>::DirectCommitTransaction
@@ -446,33 +845,268 @@ namespace Database
         return false;
     }
 
+    bool IMySqlConnection::ExecuteStatement(uint32_t                index,
+                                            MySqlPreparedStatement *pPreparedStmt,
+                                            uint32_t               &errcode)
+    {
+        MySqlStmt *pMySqlStmt = pPreparedStmt->GetMySqlStmt();
+        MySqlBind *pMySqlBind = pPreparedStmt->GetMySqlBind();
+        const auto beginTime  = std::chrono::steady_clock::now();
+
+        PERFORMANCE_SCOPE_NAMED("IMySqlConnection::ExecuteStatement",
+                                "执行sql语句：{}",
+                                pPreparedStmt->GetSqlString());
+
+        if (mysql_stmt_bind_param(pMySqlStmt, pMySqlBind))
+        {
+            errcode = mysql_errno(_pMysqlHandle);
+            Log::Error("执行sql:{} 绑定参数错误：{}:{}",
+                       pPreparedStmt->GetSqlString(),
+                       errcode,
+                       mysql_stmt_error(pMySqlStmt));
+
+            pPreparedStmt->ClearParameters();
+            return false;
+        }
+
+        if (0 != mysql_stmt_execute(pMySqlStmt))
+        {
+            errcode = mysql_errno(_pMysqlHandle);
+            Log::Error("执行sql语句：{} 出错：{}:{}",
+                       pPreparedStmt->GetSqlString(),
+                       errcode,
+                       mysql_stmt_error(pMySqlStmt));
+
+            pPreparedStmt->ClearParameters();
+            return false;
+        }
+
+        const auto elapsed = std::chrono::steady_clock::now() - beginTime;
+        _queryLatency.Record(elapsed);
+        if (nullptr != _pStmtMetrics)
+        {
+            _pStmtMetrics->RecordExecute(index, elapsed);
+        }
+
+        // 参数在ClearParameters之后失效，须先记录
+        if (IsSlowQuery(elapsed))
+        {
+            Log::Warn("慢查询，预处理语句：{} 耗时{}：{}",
+                      index,
+                      std::chrono::duration_cast<std::chrono::milliseconds>(elapsed),
+                      pPreparedStmt->GetSqlString());
+        }
+
+        pPreparedStmt->ClearParameters();
+        return true;
+    }
+
+    void IMySqlConnection::CloseSqlBatch()
+    {
+        std::lock_guard lock(_batchMutex);
+        _pOpenBatch.reset();
+    }
+
+    void IMySqlConnection::ExecuteSqlBatch(const std::shared_ptr<SqlBatch> &pBatch)
+    {
+        {
+            std::lock_guard lock(_batchMutex);
+            if (_pOpenBatch == pBatch)
+            {
+                _pOpenBatch.reset();
+            }
+        }
+
+        for (const auto &queuedTime : pBatch->queuedTimes)
+        {
+            OnAsyncTaskStarted(queuedTime);
+        }
+
+        const std::span<const std::string> sqls(pBatch->sqls);
+        uint32_t                           retryCount = 0;
+        for (std::size_t executed = 0; executed < sqls.size();)
+        {
+            if (const std::size_t count = ExecutePipeline(sqls.subspan(executed)); 0 != count)
+            {
+                executed += count;
+                retryCount = 0;
+                continue;
+            }
+
+            // 重连后仍在同一条语句处断开时不再重试，避免一直阻塞后续任务
+            if (++retryCount >= MAX_SQL_PIPELINE_RETRY)
+            {
+                Log::Error("sql语句重试{}次后仍失败，已丢弃：{}", retryCount, sqls[executed]);
+                ++executed;
+                retryCount = 0;
+            }
+        }
+
+        _asyncTaskCount -= sqls.size();
+    }
+
+    std::size_t IMySqlConnection::ExecutePipeline(std::span<const std::string> sqls)
+    {
+        // 条数较少时合并的收益不足以抵消切换多语句选项的两次往返
+        std::size_t count = CountPipelineSql(sqls);
+        if (count < MIN_SQL_PIPELINE_SIZE)
+        {
+            count = 1;
+        }
+
+        if (!EnsureConnected())
+        {
+            Log::Error("数据库：{} 连接不可用，丢弃{}条sql语句", _connectInfo.database, count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                Log::Info("丢弃sql脚本：{}", sqls[i]);
+            }
+
+            return count;
+        }
+
+        if (1 == count)
+        {
+            return ExecuteBatchedSql(sqls.front());
+        }
+
+        const std::string pipeline = BuildPipelineSql(sqls.first(count));
+
+        PERFORMANCE_SCOPE_NAMED("IMySqlConnection::ExecutePipeline", "合并执行{}条Sql语句", count);
+
+        // 仅在执行合并请求期间开启多语句，其余sql请求不受影响
+        std::size_t index  = 0;
+        int         status = mysql_set_server_option(_pMysqlHandle, MYSQL_OPTION_MULTI_STATEMENTS_ON);
+        if (0 == status)
+        {
+            status = mysql_real_query(_pMysqlHandle, pipeline.data(), pipeline.size());
+        }
+
+        // 服务器在第一条出错的语句处停止执行，此前每条语句各产生一个结果
+        while (0 == status)
+        {
+            if (MySqlResult *pResult = mysql_store_result(_pMysqlHandle); nullptr != pResult)
+            {
+                mysql_free_result(pResult);
+            }
+
+            ++index;
+            status = mysql_next_result(_pMysqlHandle);
+        }
+
+        const uint32_t errcode = status > 0 ? mysql_errno(_pMysqlHandle) : 0;
+        if (status > 0)
+        {
+            Log::Info("执行sql脚本：{}", sqls[std::min(index, count - 1)]);
+            Log::Error("合并执行sql脚本出错:[{}]:{}", errcode, mysql_error(_pMysqlHandle));
+        }
+
+        if (nullptr != _pMysqlHandle && IsConnected())
+        {
+            mysql_set_server_option(_pMysqlHandle, MYSQL_OPTION_MULTI_STATEMENTS_OFF);
+        }
+
+        if (0 == errcode)
+        {
+            return count;
+        }
+
+        return HandleBatchedSqlErrcode(errcode, index);
+    }
+
+    std::size_t IMySqlConnection::ExecuteBatchedSql(std::string_view sql)
+    {
+        PERFORMANCE_SCOPE_NAMED("IMySqlConnection::ExecuteBatchedSql", "执行Sql语句：{}", sql);
+
+        const auto beginTime = std::chrono::steady_clock::now();
+        const int  ret       = mysql_real_query(_pMysqlHandle, sql.data(), sql.size());
+        const auto elapsed   = std::chrono::steady_clock::now() - beginTime;
+        _queryLatency.Record(elapsed);
+        if (IsSlowQuery(elapsed))
+        {
+            Log::Warn("慢查询，耗时{}：{}",
+                      std::chrono::duration_cast<std::chrono::milliseconds>(elapsed),
+                      sql);
+        }
+
+        if (0 == ret)
+        {
+            return 1;
+        }
+
+        const uint32_t errcode = mysql_errno(_pMysqlHandle);
+        Log::Info("执行sql脚本：{}", sql);
+        Log::Error("执行sql脚本出错:[{}]:{}", errcode, mysql_error(_pMysqlHandle));
+        return HandleBatchedSqlErrcode(errcode, 0);
+    }
+
+    std::size_t IMySqlConnection::HandleBatchedSqlErrcode(uint32_t errcode, std::size_t index)
+    {
+        // 只有连接断开且重连成功时从出错的语句重新执行，其余错误跳过该语句，
+        // 异步写语句出错不交给HandleMySqlErrcode，避免因表结构错误终止进程
+        if (IsConnectionLostError(errcode))
+        {
+            OnConnectionLost();
+            return EnsureConnected() ? index : index + 1;
+        }
+
+        return index + 1;
+    }
+
     bool IMySqlConnection::Query(std::string_view sql,
                                  MySqlResult    *&pResult,
                                  MySqlField     *&pFields,
                                  uint64_t        &rowCount,
-                                 uint32_t        &fieldCount)
+                                 uint32_t        &fieldCount,
+                                 bool             bStreaming /*= false*/)
     {
-        if (nullptr == _pMysqlHandle)
+        if (!EnsureConnected())
         {
             return false;
         }
 
         {
-            PERFORMANCE_SCOPE("执行sql语句：{}", sql);
+            PERFORMANCE_SCOPE_NAMED("IMySqlConnection::Query", "执行sql语句：{}", sql);
+
+            const auto beginTime = std::chrono::steady_clock::now();
+            const int  ret       = mysql_query(_pMysqlHandle, sql.data());
+            const auto elapsed   = std::chrono::steady_clock::now() - beginTime;
+            _queryLatency.Record(elapsed);
+            if (IsSlowQuery(elapsed))
+            {
+                Log::Warn("慢查询，耗时{}：{}",
+                          std::chrono::duration_cast<std::chrono::milliseconds>(elapsed),
+                          sql);
+            }
 
-            if (0 != mysql_query(_pMysqlHandle, sql.data()))
+            if (0 != ret)
             {
                 uint32_t errcode = mysql_errno(_pMysqlHandle);
                 Log::Error("执行sql语句：{} 出错：{}：{}", sql, errcode, mysql_error(_pMysqlHandle));
                 if (HandleMySqlErrcode(errcode))
                 {
-                    return Query(sql, pResult, pFields, rowCount, fieldCount);
+                    return Query(sql, pResult, pFields, rowCount, fieldCount, bStreaming);
                 }
 
                 return false;
             }
         }
 
+        if (bStreaming)
+        {
+            // 流式模式下行数未知，数据在NextRow时才从连接上读取
+            pResult    = mysql_use_result(_pMysqlHandle);
+            rowCount   = 0;
+            fieldCount = mysql_field_count(_pMysqlHandle);
+            if (nullptr == pResult)
+            {
+                return false;
+            }
+
+            pFields = mysql_fetch_fields(pResult);
+            return true;
+        }
+
         pResult    = mysql_store_result(_pMysqlHandle);
         rowCount   = mysql_affected_rows(_pMysqlHandle);
         fieldCount = mysql_field_count(_pMysqlHandle);
@@ -499,7 +1133,7 @@ namespace Database
                                  uint64_t                &rowCount,
                                  uint32_t                &fieldCount)
     {
-        if (nullptr == _pMysqlHandle)
+        if (!EnsureConnected())
         {
             return false;
         }
@@ -510,48 +1144,18 @@ namespace Database
 
         pMySqlProxyStmt->BindParameters(pStmt);
 
-        MySqlStmt *pMySqlStmt = pMySqlProxyStmt->GetMySqlStmt();
-        MySqlBind *pMySqlBind = pMySqlProxyStmt->GetMySqlBind();
-
+        uint32_t errcode = 0;
+        if (!ExecuteStatement(index, pMySqlProxyStmt, errcode))
         {
-            PERFORMANCE_SCOPE("执行sql语句：{}", pMySqlProxyStmt->GetSqlString());
-
-            if (mysql_stmt_bind_param(pMySqlStmt, pMySqlBind))
+            if (HandleMySqlErrcode(errcode))
             {
-                uint32_t errcode = mysql_errno(_pMysqlHandle);
-                Log::Error("预处理语句：{} 绑定参数错误：{}：{}",
-                           pMySqlProxyStmt->GetSqlString(),
-                           errcode,
-                           mysql_stmt_error(pMySqlStmt));
-
-                if (HandleMySqlErrcode(errcode))
-                {
-                    return Query(pStmt, pMySqlProxyStmt, pResult, rowCount, fieldCount);
-                }
-
-                pMySqlProxyStmt->ClearParameters();
-                return false;
+                return Query(pStmt, pMySqlProxyStmt, pResult, rowCount, fieldCount);
             }
 
-            if (0 != mysql_stmt_execute(pMySqlStmt))
-            {
-                uint32_t errcode = mysql_errno(_pMysqlHandle);
-                Log::Error("执行预处理语句：{} 错误：{}：{}",
-                           pMySqlProxyStmt->GetSqlString(),
-                           errcode,
-                           mysql_stmt_error(pMySqlStmt));
-
-                if (HandleMySqlErrcode(errcode))
-                {
-                    return Query(pStmt, pMySqlProxyStmt, pResult, rowCount, fieldCount);
-                }
-
-                pMySqlProxyStmt->ClearParameters();
-                return false;
-            }
+            return false;
         }
 
-        pMySqlProxyStmt->ClearParameters();
+        MySqlStmt *pMySqlStmt = pMySqlProxyStmt->GetMySqlStmt();
 
         pResult    = mysql_stmt_result_metadata(pMySqlStmt);
         rowCount   = mysql_stmt_num_rows(pMySqlStmt);
@@ -562,28 +1166,33 @@ namespace Database
 
     QueryResultFuture IMySqlConnection::AsyncQuery(std::string_view sql)
     {
-        ++_asyncTaskCount;
-        return asio::post(_ioCtx.get_executor(), asio::use_future([this, sql]() -> QueryResultSetPtr {
-                              auto result = Query(sql);
-                              --_asyncTaskCount;
-                              return result;
-                          }));
+        // sql须由任务持有，调用方的字符串在任务执行时可能已失效
+        const auto queuedTime = OnAsyncTaskQueued();
+        return asio::post(
+            _ioWork,
+            asio::use_future([this, queuedTime, strSql = std::string(sql)]() -> QueryResultSetPtr {
+                OnAsyncTaskStarted(queuedTime);
+                auto result = Query(strSql);
+                --_asyncTaskCount;
+                return result;
+            }));
     }
 
-    PreparedQueryResultFuture IMySqlConnection::AsyncQuery(PreparedStatementBase *pStmt)
+    PreparedQueryResultFuture IMySqlConnection::AsyncQuery(PreparedStatementPtr pStmt)
     {
-        std::ostringstream ss;
-        ss << std::this_thread::get_id();
-        Log::Warn("IMySqlConnection::AsyncQuery:{}", ss.str());
-        ++_asyncTaskCount;
+        LOG_WARN(Database, "IMySqlConnection::AsyncQuery:{}", Util::GetCurrentThreadIdString());
+        const auto queuedTime = OnAsyncTaskQueued();
 
+        // use_future要求任务可拷贝，转为shared_ptr持有，析构时同样归还对象池
+        std::shared_ptr<PreparedStatementBase> pSharedStmt(std::move(pStmt));
         return asio::post(
             _ioWork,
             asio::use_future(
-                [this, p = std::shared_ptr<PreparedStatementBase>(pStmt)]() -> PreparedQueryResultSetPtr {
-                    std::ostringstream ss;
-                    ss << std::this_thread::get_id();
-                    Log::Warn("IMySqlConnection::AsyncQuery running:{}", ss.str());
+                [this, queuedTime, p = std::move(pSharedStmt)]() -> PreparedQueryResultSetPtr {
+                    OnAsyncTaskStarted(queuedTime, p->GetIndex());
+                    LOG_WARN(Database,
+                             "IMySqlConnection::AsyncQuery running:{}",
+                             Util::GetCurrentThreadIdString());
                     auto result = Query(p.get());
                     --_asyncTaskCount;
                     return result;
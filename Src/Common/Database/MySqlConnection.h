@@ -11,8 +11,16 @@
 #include "DatabaseEnv.h"
 #include "asio.hpp"
 #include "MySqlPreparedStatement.h"
+#include "StatementMetrics.h"
+#include "Common/Util/Metrics.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
 #include <string_view>
 #include <vector>
 #include <mutex>
@@ -52,14 +60,103 @@ namespace Database
         bool Execute(std::string_view sql);
         bool Execute(PreparedStatementBase *pStmt);
 
+        /**
+         * @brief 异步执行sql写语句，sql须为单条语句
+         *        连续提交、中间没有其他异步任务的语句合并为一次多语句请求发送，
+         *        执行期间新提交的语句在下一次请求中发送，吞吐不再受每条语句一次往返的限制。
+         *        除结尾外含有分号的语句不参与合并，单独执行
+         *
+         * @param sql sql语句
+         */
         void AsyncExecute(std::string_view sql);
-        void AsyncExecute(PreparedStatementBase *pStmt);
+        void AsyncExecute(PreparedStatementPtr pStmt);
 
         QueryResultSetPtr         Query(std::string_view sql);
         PreparedQueryResultSetPtr Query(PreparedStatementBase *pStmt);
 
         QueryResultFuture         AsyncQuery(std::string_view sql);
-        PreparedQueryResultFuture AsyncQuery(PreparedStatementBase *pStmt);
+        PreparedQueryResultFuture AsyncQuery(PreparedStatementPtr pStmt);
+
+        /**
+         * @brief 流式查询，不缓冲整个结果集，边接收边逐行回调
+         *
+         * @param sql sql语句
+         * @param callback 行回调，返回false时停止并丢弃剩余数据
+         * @return 查询是否执行成功
+         */
+        bool StreamQuery(std::string_view sql, const QueryRowCallback &callback);
+
+        /**
+         * @brief 流式查询，不缓冲整个结果集，每拉取batchSize行回调一次
+         *
+         * @param pStmt 预处理语句
+         * @param batchSize 每批行数
+         * @param callback 批回调，返回false时停止并丢弃剩余数据
+         * @return 查询是否执行成功
+         */
+        bool StreamQuery(PreparedStatementBase    *pStmt,
+                         uint32_t                  batchSize,
+                         const QueryBatchCallback &callback);
+
+        std::future<bool> AsyncStreamQuery(PreparedStatementPtr pStmt,
+                                           uint32_t             batchSize,
+                                           QueryBatchCallback   callback);
+
+        /**
+         * @brief 执行类型化预处理语句，参数直接绑定到MYSQL_BIND，不经过PreparedStatementBase
+         *
+         * @param index 预处理语句索引
+         * @param params 参数绑定描述
+         * @return 执行是否成功
+         */
+        bool Execute(uint32_t index, std::span<const SqlBindValue> params);
+
+        /**
+         * @brief 查询类型化预处理语句，每拉取一行即写入columns描述的内存并回调
+         *
+         * @param index 预处理语句索引
+         * @param params 参数绑定描述
+         * @param columns 结果列绑定描述，列数须与语句结果一致
+         * @param onRow 行回调
+         * @return 查询是否执行成功
+         */
+        bool Query(uint32_t                       index,
+                   std::span<const SqlBindValue>  params,
+                   std::span<const SqlResultBind> columns,
+                   const std::function<void()>   &onRow);
+
+        /**
+         * @brief 将任务投递到连接的工作线程执行
+         *
+         * @param handler 任务，参数为当前连接
+         */
+        template <typename Handler>
+        void Post(Handler &&handler)
+        {
+            const auto queuedTime = OnAsyncTaskQueued();
+            asio::post(_ioWork, [this, queuedTime, h = std::forward<Handler>(handler)]() mutable {
+                OnAsyncTaskStarted(queuedTime);
+                h(*this);
+                --_asyncTaskCount;
+            });
+        }
+
+        /**
+         * @brief 将执行预处理语句的任务投递到连接的工作线程，排队时长同时计入该语句的统计
+         *
+         * @param stmtIndex 预处理语句索引
+         * @param handler 任务，参数为当前连接
+         */
+        template <typename Handler>
+        void Post(uint32_t stmtIndex, Handler &&handler)
+        {
+            const auto queuedTime = OnAsyncTaskQueued();
+            asio::post(_ioWork, [this, queuedTime, stmtIndex, h = std::forward<Handler>(handler)]() mutable {
+                OnAsyncTaskStarted(queuedTime, stmtIndex);
+                h(*this);
+                --_asyncTaskCount;
+            });
+        }
 
         void BeginTransaction();
         void CommitTransaction();
@@ -67,7 +164,68 @@ namespace Database
 
         uint32_t GetLastError();
 
-        void Ping() const;
+        /**
+         * @brief 检测连接是否可用，失败时视为连接断开并触发后台重连
+         *
+         * @return 连接是否可用
+         */
+        bool Ping();
+
+        /**
+         * @brief 后台重连，由工作池的健康检查线程调用，成功后重新预处理所有语句
+         *
+         * @return 是否重连成功
+         */
+        bool Reconnect();
+
+        [[nodiscard]] bool IsConnected() const
+        {
+            return _bConnected.load(std::memory_order_acquire);
+        }
+
+        // 距离最近一次执行语句的时长
+        [[nodiscard]] std::chrono::steady_clock::duration GetIdleTime() const;
+
+        /**
+         * @brief 设置慢查询阈值，执行耗时超过阈值的语句连同绑定的参数记录到日志
+         *
+         * @param threshold 阈值，为0时不记录
+         */
+        void SetSlowQueryThreshold(std::chrono::milliseconds threshold)
+        {
+            _slowQueryThreshold.store(threshold, std::memory_order_relaxed);
+        }
+
+        // 按预处理语句索引统计的耗时，首次预处理语句完成前为空
+        [[nodiscard]] const StatementMetrics *GetStatementMetrics() const
+        {
+            return _bStmtMetricsReady.load(std::memory_order_acquire) ? _pStmtMetrics.get() : nullptr;
+        }
+
+        // 连接断开时的回调，在发现断开的线程上调用，由工作池用于调度后台重连
+        void SetDisconnectHandler(std::function<void()> handler)
+        {
+            _disconnectHandler = std::move(handler);
+        }
+
+        /**
+         * @brief 设置断线期间异步请求的处理策略，同步连接总是立即失败
+         *
+         * @param policy 策略
+         * @param parkTimeout Park策略下从断开开始计算的最长等待时长
+         */
+        void SetOutagePolicy(OutagePolicy policy, std::chrono::milliseconds parkTimeout);
+
+        /**
+         * @brief 查询复制延迟，由工作池的健康检查线程在从库的同步连接上调用
+         *
+         *        出错时只在连接断开时触发重连，其余错误交由调用方处理，不经过HandleMySqlErrcode
+         *
+         * @param lag 复制延迟，复制中断时为空，连接的不是从库时为0
+         * @param errcode 失败时的错误码，复制状态中没有延迟列时为REPLICA_LAG_COLUMN_MISSING
+         * @return 查询是否成功
+         */
+        bool QueryReplicaLag(std::optional<std::chrono::seconds> &lag, uint32_t &errcode);
 
         void StartWorkerThread();
 
@@ -81,18 +239,141 @@ namespace Database
             return _asyncTaskCount;
         }
 
+        // 取出异步任务在队列中的等待时长样本，由工作池的伸缩策略使用
+        Metrics::HistogramSnapshot TakeQueueWaitSnapshot()
+        {
+            return _queueWaitHistogram.TakeSnapshot();
+        }
+
     protected:
         virtual void DoPrepareStatements() = 0;
-        void         PrepareStatement(uint32_t index, std::string_view sql, MySqlConnectionType connType);
+        void         PrepareStatement(uint32_t            index,
+                                      std::string_view    sql,
+                                      MySqlConnectionType connType,
+                                      bool                bReadOnly = false);
         MySqlPreparedStatement *GetPrepareStatement(uint32_t index);
 
-        bool HandleMySqlErrcode(uint32_t errcode, uint8_t tryReconnectTimes = 5);
+        /**
+         * @brief 校验类型化语句：参数类型须与sql定义一致，参数个数与每个结果列须与预处理结果一致，
+         *        不一致时视为预处理失败。在DoPrepareStatements中预处理之后调用，当前连接未预处理该语句时
+         *        只比对sql定义
+         *
+         * @param stmtData 语句的sql定义
+         */
+        template <typename StmtType>
+        void CheckTypedStatement(const SqlStmtData &stmtData)
+        {
+            CheckTypedStatement(StmtType::ID,
+                                stmtData.argtypes,
+                                StmtType::PARAM_TYPES,
+                                StmtType::COLUMN_TYPES);
+        }
+
+        void CheckTypedStatement(uint32_t                    index,
+                                 std::span<const SqlArgType> argTypes,
+                                 std::span<const SqlArgType> paramTypes,
+                                 std::span<const SqlArgType> columnTypes);
+
+        /**
+         * @brief 处理执行语句的错误码
+         *
+         * @param errcode 错误码
+         * @return 是否应当重试
+         */
+        bool HandleMySqlErrcode(uint32_t errcode);
+
+        // 连接可用时返回true；断开时按断线策略等待重连或立即返回false
+        bool EnsureConnected();
+
+        void OnConnectionLost();
+
+        void Touch();
+
+        // 异步任务入队时计数并返回入队时间，开始执行时记录排队时长
+        // 其他任务入队时结束当前的sql合并批次，保证任务按提交顺序执行
+        std::chrono::steady_clock::time_point OnAsyncTaskQueued()
+        {
+            CloseSqlBatch();
+            ++_asyncTaskCount;
+            return std::chrono::steady_clock::now();
+        }
+
+        void OnAsyncTaskStarted(std::chrono::steady_clock::time_point queuedTime)
+        {
+            _queueWaitHistogram.Record(std::chrono::steady_clock::now() - queuedTime);
+        }
+
+        // 预处理语句的排队时长同时计入该语句的统计
+        void OnAsyncTaskStarted(std::chrono::steady_clock::time_point queuedTime, uint32_t stmtIndex)
+        {
+            const auto wait = std::chrono::steady_clock::now() - queuedTime;
+            _queueWaitHistogram.Record(wait);
+            if (nullptr != _pStmtMetrics)
+            {
+                _pStmtMetrics->RecordQueueWait(stmtIndex, wait);
+            }
+        }
+
+        void RecordDecode(uint32_t stmtIndex, std::chrono::steady_clock::duration elapsed)
+        {
+            if (nullptr != _pStmtMetrics)
+            {
+                _pStmtMetrics->RecordDecode(stmtIndex, elapsed);
+            }
+        }
+
+        [[nodiscard]] bool IsSlowQuery(std::chrono::steady_clock::duration elapsed) const
+        {
+            const std::chrono::milliseconds threshold = _slowQueryThreshold.load(std::memory_order_relaxed);
+            return threshold.count() > 0 && elapsed >= threshold;
+        }
+
+        /**
+         * @brief 执行已绑定参数的预处理语句，记录执行耗时，超过慢查询阈值时记录日志
+         *
+         * @param index 预处理语句索引
+         * @param pPreparedStmt 预处理语句
+         * @param errcode 失败时的错误码
+         * @return 执行是否成功
+         */
+        bool ExecuteStatement(uint32_t index, MySqlPreparedStatement *pPreparedStmt, uint32_t &errcode);
+
+        // 连续提交的异步sql写语句，由一个任务合并执行
+        struct SqlBatch
+        {
+            std::vector<std::string>                           sqls;
+            std::vector<std::chrono::steady_clock::time_point> queuedTimes;
+        };
+
+        void CloseSqlBatch();
+        void ExecuteSqlBatch(const std::shared_ptr<SqlBatch> &pBatch);
+
+        /**
+         * @brief 以一次多语句请求执行sqls开头的若干条语句
+         *
+         * @param sqls 待执行的语句
+         * @return 已处理的条数，执行失败且不可重试的语句计为已处理
+         */
+        std::size_t ExecutePipeline(std::span<const std::string> sqls);
+
+        // 逐条执行不满足合并条件的语句，出错时与合并执行相同，不经过HandleMySqlErrcode
+        std::size_t ExecuteBatchedSql(std::string_view sql);
+
+        /**
+         * @brief 处理异步写语句的执行错误
+         *
+         * @param errcode 错误码
+         * @param index 出错语句在本次请求中的位置
+         * @return 已处理的条数，连接断开且重连成功时不计入出错的语句以便重新执行
+         */
+        std::size_t HandleBatchedSqlErrcode(uint32_t errcode, std::size_t index);
 
         bool Query(std::string_view sql,
                    MySqlResult    *&pResult,
                    MySqlField     *&pFields,
                    uint64_t        &rowCount,
-                   uint32_t        &fieldCount);
+                   uint32_t        &fieldCount,
+                   bool             bStreaming = false);
         bool Query(PreparedStatementBase   *pStmt,
                    MySqlPreparedStatement *&pMySqlProxyStmt,
                    MySqlResult            *&pResult,
@@ -129,7 +410,28 @@ namespace Database
         MySqlConnectionType          _mysqlConnType;
         asio::io_context             _ioCtx;
         asio::any_io_executor        _ioWork;
-        std::size_t                  _asyncTaskCount = 0;
+        std::atomic<std::size_t>     _asyncTaskCount {0};
+        Metrics::Histogram           _queueWaitHistogram {Metrics::MICROSECOND_UNIT};
         std::mutex                   _mutex;
+        std::mutex                   _batchMutex;
+        std::shared_ptr<SqlBatch>    _pOpenBatch; // 仍可追加语句的批次
+
+        // 语句耗时统计：首次预处理语句时按语句数量创建，重连后保留
+        std::unique_ptr<StatementMetrics>      _pStmtMetrics;
+        std::atomic<bool>                      _bStmtMetricsReady {false};
+        std::atomic<std::chrono::milliseconds> _slowQueryThreshold {DEFAULT_SLOW_QUERY_THRESHOLD};
+        Metrics::Histogram                    &_queryLatency; // 按数据库汇总，所有连接共用
+
+        // 连接状态：断开后句柄只由重连线程访问，重连完成后再交还给使用者
+        std::atomic<bool>                     _bConnected {false};
+        std::atomic<int64_t>                  _lastActiveTime {0};
+        std::chrono::steady_clock::time_point _disconnectTime;
+        std::mutex                            _stateMutex;
+        std::condition_variable               _stateCond;
+        std::function<void()>                 _disconnectHandler;
+        OutagePolicy                          _outagePolicy {OutagePolicy::FailFast};
+        std::chrono::milliseconds             _parkTimeout {DEFAULT_PARK_TIMEOUT};
+        // 服务器不支持SHOW REPLICA STATUS时改用SHOW SLAVE STATUS
+        bool                                  _bLegacyReplicaStatus {false};
     };
 } // namespace Database
\ No newline at end of file
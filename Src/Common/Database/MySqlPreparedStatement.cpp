@@ -14,16 +14,179 @@
 
 namespace Database
 {
-    MySqlPreparedStatement::MySqlPreparedStatement(MySqlStmt *pStmt, std::string_view sql)
+    namespace
+    {
+        // 类型化绑定的参数只有MYSQL_BIND描述，按缓冲区类型还原为文本
+        std::string BindToString(const MySqlBind &bind)
+        {
+            if (bind.is_null_value || nullptr == bind.buffer)
+            {
+                return "NULL";
+            }
+
+            auto toString = [&bind]<typename Signed, typename Unsigned>() {
+                if (bind.is_unsigned)
+                {
+                    return std::format("{}", *static_cast<const Unsigned *>(bind.buffer));
+                }
+
+                return std::format("{}", *static_cast<const Signed *>(bind.buffer));
+            };
+
+            switch (bind.buffer_type)
+            {
+                case MYSQL_TYPE_TINY:
+                    return toString.operator()<int8_t, uint8_t>();
+                case MYSQL_TYPE_SHORT:
+                    return toString.operator()<int16_t, uint16_t>();
+                case MYSQL_TYPE_LONG:
+                    return toString.operator()<int32_t, uint32_t>();
+                case MYSQL_TYPE_LONGLONG:
+                    return toString.operator()<int64_t, uint64_t>();
+                case MYSQL_TYPE_FLOAT:
+                    return std::format("{}", *static_cast<const float *>(bind.buffer));
+                case MYSQL_TYPE_DOUBLE:
+                    return std::format("{}", *static_cast<const double *>(bind.buffer));
+                case MYSQL_TYPE_VAR_STRING:
+                    return std::string(static_cast<const char *>(bind.buffer), bind.buffer_length);
+                default:
+                    return "BINARY";
+            }
+        }
+
+        // 整数列的字节数，非整数列为0
+        uint32_t GetIntegerFieldSize(enum_field_types type)
+        {
+            switch (type)
+            {
+                case MYSQL_TYPE_TINY:
+                    return 1;
+                case MYSQL_TYPE_SHORT:
+                case MYSQL_TYPE_YEAR:
+                    return 2;
+                case MYSQL_TYPE_INT24:
+                case MYSQL_TYPE_LONG:
+                    return 4;
+                case MYSQL_TYPE_LONGLONG:
+                    return 8;
+                default:
+                    return 0;
+            }
+        }
+
+        // 整数参数类型的字节数，非整数类型为0
+        uint32_t GetIntegerArgSize(SqlArgType type)
+        {
+            switch (type)
+            {
+                case SqlArgType::Bool:
+                case SqlArgType::Uint8:
+                case SqlArgType::Int8:
+                    return 1;
+                case SqlArgType::Uint16:
+                case SqlArgType::Int16:
+                    return 2;
+                case SqlArgType::Uint32:
+                case SqlArgType::Int32:
+                    return 4;
+                case SqlArgType::Uint64:
+                case SqlArgType::Int64:
+                    return 8;
+                default:
+                    return 0;
+            }
+        }
+
+        // 以文本形式返回的列，可写入std::string
+        bool IsTextFieldType(enum_field_types type)
+        {
+            switch (type)
+            {
+                case MYSQL_TYPE_VARCHAR:
+                case MYSQL_TYPE_VAR_STRING:
+                case MYSQL_TYPE_STRING:
+                case MYSQL_TYPE_TINY_BLOB:
+                case MYSQL_TYPE_MEDIUM_BLOB:
+                case MYSQL_TYPE_LONG_BLOB:
+                case MYSQL_TYPE_BLOB:
+                case MYSQL_TYPE_ENUM:
+                case MYSQL_TYPE_SET:
+                case MYSQL_TYPE_JSON:
+                case MYSQL_TYPE_DECIMAL:
+                case MYSQL_TYPE_NEWDECIMAL:
+                case MYSQL_TYPE_DATE:
+                case MYSQL_TYPE_TIME:
+                case MYSQL_TYPE_DATETIME:
+                case MYSQL_TYPE_TIMESTAMP:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        /**
+         * @brief 结果列能否无损写入声明的类型
+         *        整数类型不能窄于列宽，无符号列写入有符号类型时须更宽；
+         *        字符串只接受文本、小数与时间列，避免列顺序错位时把数值列当作字符串读出
+         */
+        bool IsResultTypeCompatible(const MySqlField &field, SqlArgType type)
+        {
+            switch (type)
+            {
+                case SqlArgType::Float:
+                    return MYSQL_TYPE_FLOAT == field.type;
+                case SqlArgType::Double:
+                    return MYSQL_TYPE_FLOAT == field.type || MYSQL_TYPE_DOUBLE == field.type ||
+                           MYSQL_TYPE_DECIMAL == field.type || MYSQL_TYPE_NEWDECIMAL == field.type;
+                case SqlArgType::String:
+                    return IsTextFieldType(field.type);
+                case SqlArgType::Binary:
+                    return IsTextFieldType(field.type) || MYSQL_TYPE_BIT == field.type ||
+                           MYSQL_TYPE_GEOMETRY == field.type;
+                default:
+                {
+                    const uint32_t fieldSize = GetIntegerFieldSize(field.type);
+                    const uint32_t argSize   = GetIntegerArgSize(type);
+                    if (0 == fieldSize || argSize < fieldSize)
+                    {
+                        return false;
+                    }
+
+                    const bool bUnsignedField = 0 != (field.flags & UNSIGNED_FLAG);
+                    return !bUnsignedField || IsUnsignedSqlArgType(type) || argSize > fieldSize;
+                }
+            }
+        }
+    } // namespace
+
+    // 类型化查询的结果绑定，按列数预分配，语句生命周期内复用
+    struct MySqlPreparedStatement::ResultBindStorage
+    {
+        std::vector<MySqlBind>       binds;
+        std::unique_ptr<MySqlBool[]> pIsNull;
+        std::vector<unsigned long>   lengths;
+        std::vector<char>            buffer; // 变长列的暂存区，按max_length增长
+    };
+
+    MySqlPreparedStatement::MySqlPreparedStatement(MySqlStmt *pStmt, std::string_view sql, bool bReadOnly)
         : _pMySqlStmt(pStmt)
         , _paramCount(mysql_stmt_param_count(_pMySqlStmt))
         , _pBind(new MySqlBind[_paramCount])
+        , _paramBuffer(_paramCount, 0)
+        , _paramLengths(_paramCount, 0)
+        , _pResultStorage(std::make_unique<ResultBindStorage>())
         , _sqlString(sql)
+        , _bReadOnly(bReadOnly)
     {
         std::memset(_pBind, 0, sizeof(MySqlBind) * _paramCount);
 
         _paramAssignFlag.assign(_paramCount, false);
 
+        const uint32_t fieldCount = mysql_stmt_field_count(_pMySqlStmt);
+        _pResultStorage->binds.resize(fieldCount);
+        _pResultStorage->pIsNull = std::make_unique<MySqlBool[]>(fieldCount);
+        _pResultStorage->lengths.resize(fieldCount);
+
         MySqlBool boolTmp = true;
         mysql_stmt_attr_set(_pMySqlStmt, STMT_ATTR_UPDATE_MAX_LENGTH, &boolTmp);
     }
@@ -32,12 +195,6 @@ namespace Database
     {
         ClearParameters();
 
-        if (_pMySqlStmt->bind_result_done)
-        {
-            delete[] _pMySqlStmt->bind->length;
-            delete _pMySqlStmt->bind->is_null;
-        }
-
         mysql_stmt_close(_pMySqlStmt);
         delete[] _pBind;
     }
@@ -66,22 +223,221 @@ namespace Database
 #endif
     }
 
+    void MySqlPreparedStatement::BindParameters(std::span<const SqlBindValue> params)
+    {
+        _pStmt = nullptr;
+
+        Assert(params.size() == _paramCount,
+               std::format("预处理语句：{} 需要{}个参数，实际绑定{}个",
+                           _sqlString,
+                           _paramCount,
+                           params.size()));
+
+        for (uint32_t i = 0; i < _paramCount; ++i)
+        {
+            const SqlBindValue &param  = params[i];
+            MySqlBind          *pParam = &_pBind[i];
+            _paramAssignFlag[i]        = true;
+            pParam->buffer_type        = SqlArgTypeToMySqlType(param.type);
+            pParam->buffer             = const_cast<void *>(param.pData);
+            pParam->is_unsigned        = IsUnsignedSqlArgType(param.type);
+            pParam->is_null_value      = (param.type == SqlArgType::Null);
+
+            if (IsVariableSqlArgType(param.type))
+            {
+                _paramLengths[i]      = param.length;
+                pParam->buffer_length = param.length;
+                pParam->length        = &_paramLengths[i];
+            }
+            else
+            {
+                pParam->buffer_length = 0;
+                pParam->length        = nullptr;
+            }
+        }
+    }
+
+    bool MySqlPreparedStatement::BindResults(std::span<const SqlResultBind> columns)
+    {
+        ResultBindStorage &storage = *_pResultStorage;
+        if (columns.size() != storage.binds.size())
+        {
+            Log::Error("预处理语句：{} 结果共{}列，定义了{}列",
+                       _sqlString,
+                       storage.binds.size(),
+                       columns.size());
+            return false;
+        }
+
+        MySqlResult *pMetadata = mysql_stmt_result_metadata(_pMySqlStmt);
+        if (nullptr == pMetadata)
+        {
+            return false;
+        }
+
+        // store_result之后max_length为该列实际的最大长度，据此一次性分配变长列的暂存区
+        const MySqlField *pFields    = mysql_fetch_fields(pMetadata);
+        std::size_t       bufferSize = 0;
+        for (std::size_t i = 0; i < columns.size(); ++i)
+        {
+            if (IsVariableSqlArgType(columns[i].type))
+            {
+                bufferSize += pFields[i].max_length;
+            }
+        }
+
+        storage.buffer.resize(bufferSize);
+
+        std::size_t offset = 0;
+        for (std::size_t i = 0; i < columns.size(); ++i)
+        {
+            const SqlResultBind &column = columns[i];
+            MySqlBind           &bind   = storage.binds[i];
+            std::memset(&bind, 0, sizeof(MySqlBind));
+            bind.buffer_type = SqlArgTypeToMySqlType(column.type);
+            bind.is_unsigned = IsUnsignedSqlArgType(column.type);
+            bind.is_null     = &storage.pIsNull[i];
+            bind.length      = &storage.lengths[i];
+
+            if (IsVariableSqlArgType(column.type))
+            {
+                bind.buffer        = storage.buffer.data() + offset;
+                bind.buffer_length = pFields[i].max_length;
+                offset += pFields[i].max_length;
+            }
+            else
+            {
+                bind.buffer        = column.pData;
+                bind.buffer_length = column.length;
+            }
+        }
+
+        mysql_free_result(pMetadata);
+
+        if (0 != mysql_stmt_bind_result(_pMySqlStmt, storage.binds.data()))
+        {
+            Log::Error("预处理语句：{} 绑定结果错误：{}", _sqlString, mysql_stmt_error(_pMySqlStmt));
+            return false;
+        }
+
+        return true;
+    }
+
+    bool MySqlPreparedStatement::CheckTypedStatement(std::span<const SqlArgType> paramTypes,
+                                                     std::span<const SqlArgType> columnTypes) const
+    {
+        if (paramTypes.size() != _paramCount)
+        {
+            Log::Error("预处理语句：{} 共{}个参数，定义了{}个", _sqlString, _paramCount, paramTypes.size());
+            return false;
+        }
+
+        const uint32_t fieldCount = mysql_stmt_field_count(_pMySqlStmt);
+        if (columnTypes.size() != fieldCount)
+        {
+            Log::Error("预处理语句：{} 结果共{}列，定义了{}列", _sqlString, fieldCount, columnTypes.size());
+            return false;
+        }
+
+        // 没有结果集的语句只校验参数个数
+        if (0 == fieldCount)
+        {
+            return true;
+        }
+
+        MySqlResult *pMetadata = mysql_stmt_result_metadata(_pMySqlStmt);
+        if (nullptr == pMetadata)
+        {
+            Log::Error("预处理语句：{} 没有结果集，不能定义结果列", _sqlString);
+            return false;
+        }
+
+        const MySqlField *pFields = mysql_fetch_fields(pMetadata);
+        bool              bRet    = true;
+        for (std::size_t i = 0; i < columnTypes.size(); ++i)
+        {
+            if (!IsResultTypeCompatible(pFields[i], columnTypes[i]))
+            {
+                Log::Error("预处理语句：{} 第{}列{}的类型{}与定义的类型{}不符",
+                           _sqlString,
+                           i,
+                           pFields[i].name,
+                           static_cast<uint32_t>(pFields[i].type),
+                           static_cast<uint32_t>(columnTypes[i]));
+                bRet = false;
+            }
+        }
+
+        mysql_free_result(pMetadata);
+        return bRet;
+    }
+
+    void MySqlPreparedStatement::StoreResultRow(std::span<const SqlResultBind> columns)
+    {
+        const ResultBindStorage &storage = *_pResultStorage;
+        for (std::size_t i = 0; i < columns.size(); ++i)
+        {
+            const SqlResultBind &column = columns[i];
+            const bool           bNull  = storage.pIsNull[i];
+            const char          *pValue = static_cast<const char *>(storage.binds[i].buffer);
+            switch (column.type)
+            {
+                case SqlArgType::String:
+                {
+                    std::string *pString = static_cast<std::string *>(column.pData);
+                    if (bNull)
+                    {
+                        pString->clear();
+                    }
+                    else
+                    {
+                        pString->assign(pValue, storage.lengths[i]);
+                    }
+                    break;
+                }
+                case SqlArgType::Binary:
+                {
+                    auto *pBinary = static_cast<std::vector<uint8_t> *>(column.pData);
+                    if (bNull)
+                    {
+                        pBinary->clear();
+                    }
+                    else
+                    {
+                        const auto *pBegin = reinterpret_cast<const uint8_t *>(pValue);
+                        pBinary->assign(pBegin, pBegin + storage.lengths[i]);
+                    }
+                    break;
+                }
+                default:
+                {
+                    if (bNull)
+                    {
+                        std::memset(column.pData, 0, column.length);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
     template <typename T>
     void MySqlPreparedStatement::SetParameter(uint8_t index, T &&value)
     {
+        using ValueType = std::decay_t<T>;
+        static_assert(sizeof(ValueType) <= sizeof(uint64_t));
+
         AssertValidIndex(index);
         _paramAssignFlag[index] = true;
         MySqlBind *pParam       = &_pBind[index];
-        uint32_t   length       = sizeof(T);
-        pParam->buffer_type     = MySqlType<std::decay_t<T>>::value;
-        delete[] static_cast<char *>(pParam->buffer);
-        pParam->buffer        = new char[length];
-        pParam->buffer_length = 0;
-        pParam->is_null_value = false;
-        pParam->length        = nullptr;
-        pParam->is_unsigned   = std::is_signed_v<T>;
+        pParam->buffer_type     = MySqlType<ValueType>::value;
+        pParam->buffer          = &_paramBuffer[index];
+        pParam->buffer_length   = 0;
+        pParam->is_null_value   = false;
+        pParam->length          = nullptr;
+        pParam->is_unsigned     = std::is_unsigned_v<ValueType>;
 
-        memcpy(pParam->buffer, &value, length);
+        std::memcpy(pParam->buffer, &value, sizeof(ValueType));
     }
 
     void MySqlPreparedStatement::SetParameter(uint8_t index, std::nullptr_t)
@@ -90,12 +446,10 @@ namespace Database
         _paramAssignFlag[index] = true;
         MySqlBind *pParam       = &_pBind[index];
         pParam->buffer_type     = MYSQL_TYPE_NULL;
-        delete[] static_cast<char *>(pParam->buffer);
-        pParam->buffer        = nullptr;
-        pParam->buffer_length = 0;
-        pParam->is_null_value = true;
-        delete pParam->length;
-        pParam->length = nullptr;
+        pParam->buffer          = nullptr;
+        pParam->buffer_length   = 0;
+        pParam->is_null_value   = true;
+        pParam->length          = nullptr;
     }
 
     void MySqlPreparedStatement::SetParameter(uint8_t index, bool value)
@@ -110,14 +464,13 @@ namespace Database
         MySqlBind *pParam       = &_pBind[index];
         uint32_t   length       = (uint32_t)str.size();
         pParam->buffer_type     = MYSQL_TYPE_VAR_STRING;
-        delete[] static_cast<char *>(pParam->buffer);
-        pParam->buffer        = new char[length];
+
+        // 直接引用PreparedStatementBase中的数据，执行完成前其一直有效
+        pParam->buffer        = const_cast<char *>(str.data());
         pParam->buffer_length = length;
         pParam->is_null_value = false;
-        delete pParam->length;
-        pParam->length = new unsigned long(length);
-
-        memcpy(pParam->buffer, str.c_str(), length);
+        _paramLengths[index]  = length;
+        pParam->length        = &_paramLengths[index];
     }
 
     void MySqlPreparedStatement::SetParameter(uint8_t index, const std::vector<uint8_t> &value)
@@ -127,14 +480,11 @@ namespace Database
         MySqlBind *pParam       = &_pBind[index];
         uint32_t   length       = (uint32_t)value.size();
         pParam->buffer_type     = MYSQL_TYPE_BLOB;
-        delete[] static_cast<char *>(pParam->buffer);
-        pParam->buffer        = new char[length];
-        pParam->buffer_length = length;
-        pParam->is_null_value = false;
-        delete pParam->length;
-        pParam->length = new unsigned long(length);
-
-        memcpy(pParam->buffer, value.data(), length);
+        pParam->buffer          = const_cast<uint8_t *>(value.data());
+        pParam->buffer_length   = length;
+        pParam->is_null_value   = false;
+        _paramLengths[index]    = length;
+        pParam->length          = &_paramLengths[index];
     }
 
     void MySqlPreparedStatement::AssertValidIndex(uint8_t index)
@@ -153,11 +503,10 @@ namespace Database
 
     void MySqlPreparedStatement::ClearParameters()
     {
+        // 参数存储均为预分配或由调用方持有，这里只需解除引用
         for (uint32_t i = 0; i < _paramCount; ++i)
         {
-            delete[] _pBind[i].length;
-            _pBind[i].length = nullptr;
-            delete[] static_cast<char *>(_pBind[i].buffer);
+            _pBind[i].length    = nullptr;
             _pBind[i].buffer    = nullptr;
             _paramAssignFlag[i] = false;
         }
@@ -167,6 +516,25 @@ namespace Database
     {
         std::string sqlString(_sqlString);
         size_t      pos = 0;
+        if (nullptr == _pStmt)
+        {
+            // 类型化绑定的参数由调用方持有，只在执行完成、ClearParameters之前有效
+            for (uint32_t i = 0; i < _paramCount && _paramAssignFlag[i]; ++i)
+            {
+                pos = sqlString.find('?', pos);
+                if (std::string::npos == pos)
+                {
+                    break;
+                }
+
+                const std::string replaceStr = BindToString(_pBind[i]);
+                sqlString.replace(pos, 1, replaceStr);
+                pos += replaceStr.length();
+            }
+
+            return sqlString;
+        }
+
         for (const PreparedStatementData &data : _pStmt->GetParameters())
         {
             pos = sqlString.find('?', pos);
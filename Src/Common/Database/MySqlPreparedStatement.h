@@ -10,6 +10,8 @@
 
 #include "DatabaseEnv.h"
 
+#include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -26,16 +28,54 @@ namespace Database
         MySqlPreparedStatement(MySqlPreparedStatement &&)                 = delete;
         MySqlPreparedStatement &operator=(MySqlPreparedStatement &&)      = delete;
 
-        MySqlPreparedStatement(MySqlStmt *pStmt, std::string_view sql);
+        MySqlPreparedStatement(MySqlStmt *pStmt, std::string_view sql, bool bReadOnly = false);
         ~MySqlPreparedStatement();
 
         void BindParameters(PreparedStatementBase *pStmt);
 
+        /**
+         * @brief 类型化绑定参数，直接引用调用方的数据，执行完成前数据须保持有效
+         *
+         * @param params 按参数顺序排列的绑定描述
+         */
+        void BindParameters(std::span<const SqlBindValue> params);
+
+        /**
+         * @brief 绑定结果列，定长列直接写入调用方的内存，变长列写入预分配的缓冲区
+         *
+         * @param columns 按列顺序排列的结果绑定描述
+         * @return 绑定是否成功
+         */
+        bool BindResults(std::span<const SqlResultBind> columns);
+
+        /**
+         * @brief 按预处理得到的参数个数与结果元数据校验类型化语句，不需要执行语句
+         *
+         * @param paramTypes 按参数顺序声明的类型
+         * @param columnTypes 按列顺序声明的类型
+         * @return 参数个数与列数一致，且每列都能无损写入声明的类型
+         */
+        bool CheckTypedStatement(std::span<const SqlArgType> paramTypes,
+                                 std::span<const SqlArgType> columnTypes) const;
+
+        /**
+         * @brief 拉取一行之后，将变长列拷贝到调用方，并将NULL列置零
+         *
+         * @param columns 与BindResults相同的结果绑定描述
+         */
+        void StoreResultRow(std::span<const SqlResultBind> columns);
+
         [[nodiscard]] uint32_t GetParameterCount() const
         {
             return _paramCount;
         }
 
+        // 只读语句可由工作池路由到从库
+        [[nodiscard]] bool IsReadOnly() const
+        {
+            return _bReadOnly;
+        }
+
     private:
         template <typename T>
         void SetParameter(uint8_t index, T &&value);
@@ -59,14 +99,21 @@ namespace Database
 
         void ClearParameters();
 
+        // 代入参数后的sql，类型化绑定的语句须在ClearParameters之前调用
         [[nodiscard]] std::string GetSqlString() const;
 
     private:
-        PreparedStatementBase *_pStmt {nullptr};
-        MySqlStmt             *_pMySqlStmt {nullptr};
-        uint32_t               _paramCount {0};
-        std::vector<bool>      _paramAssignFlag;
-        MySqlBind             *_pBind {nullptr};
-        std::string_view       _sqlString;
+        struct ResultBindStorage;
+
+        PreparedStatementBase             *_pStmt {nullptr};
+        MySqlStmt                         *_pMySqlStmt {nullptr};
+        uint32_t                           _paramCount {0};
+        std::vector<bool>                  _paramAssignFlag;
+        MySqlBind                         *_pBind {nullptr};
+        std::vector<uint64_t>              _paramBuffer;  // 定长参数的预分配存储，每个参数一个槽位
+        std::vector<unsigned long>         _paramLengths; // 变长参数的长度
+        std::unique_ptr<ResultBindStorage> _pResultStorage;
+        std::string_view                   _sqlString;
+        bool                               _bReadOnly {false};
     };
 } // namespace Database
\ No newline at end of file
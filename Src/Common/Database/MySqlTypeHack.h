@@ -8,6 +8,7 @@
 ************************************************************************/
 #pragma once
 
+#include "DatabaseEnv.h"
 #include "mysql.h"
 
 #include <type_traits>
@@ -56,4 +57,48 @@ struct MySqlType<float> : std::integral_constant<enum_field_types, MYSQL_TYPE_FL
 template <>
 struct MySqlType<double> : std::integral_constant<enum_field_types, MYSQL_TYPE_DOUBLE>{};
 
-// clang-format on
\ No newline at end of file
+// clang-format on
+
+// 参数类型与MySql数据类型映射
+constexpr enum_field_types SqlArgTypeToMySqlType(Database::SqlArgType type)
+{
+    using Database::SqlArgType;
+    switch (type)
+    {
+        case SqlArgType::Bool:
+        case SqlArgType::Uint8:
+        case SqlArgType::Int8:
+            return MYSQL_TYPE_TINY;
+        case SqlArgType::Uint16:
+        case SqlArgType::Int16:
+            return MYSQL_TYPE_SHORT;
+        case SqlArgType::Uint32:
+        case SqlArgType::Int32:
+            return MYSQL_TYPE_LONG;
+        case SqlArgType::Uint64:
+        case SqlArgType::Int64:
+            return MYSQL_TYPE_LONGLONG;
+        case SqlArgType::Float:
+            return MYSQL_TYPE_FLOAT;
+        case SqlArgType::Double:
+            return MYSQL_TYPE_DOUBLE;
+        case SqlArgType::String:
+            return MYSQL_TYPE_VAR_STRING;
+        case SqlArgType::Binary:
+            return MYSQL_TYPE_BLOB;
+        default:
+            return MYSQL_TYPE_NULL;
+    }
+}
+
+constexpr bool IsUnsignedSqlArgType(Database::SqlArgType type)
+{
+    using Database::SqlArgType;
+    return type == SqlArgType::Bool || type == SqlArgType::Uint8 || type == SqlArgType::Uint16 ||
+           type == SqlArgType::Uint32 || type == SqlArgType::Uint64;
+}
+
+constexpr bool IsVariableSqlArgType(Database::SqlArgType type)
+{
+    return type == Database::SqlArgType::String || type == Database::SqlArgType::Binary;
+}
\ No newline at end of file
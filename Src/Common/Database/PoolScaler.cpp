@@ -0,0 +1,64 @@
+﻿/*************************************************************************
+> File Name       : PoolScaler.cpp
+> Brief           : 数据库连接池伸缩策略
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月04日  11时02分48秒
+************************************************************************/
+#include "PoolScaler.h"
+#include "Common/Util/Assert.h"
+
+#include <algorithm>
+
+namespace Database
+{
+    PoolScaler::PoolScaler(uint8_t minConnections, uint8_t maxConnections, const DatabasePoolConfig &config)
+        : _minConnections(minConnections)
+        , _maxConnections(std::max(minConnections, maxConnections))
+        , _growQueueDepth(config.growQueueDepth)
+        , _growWaitTime(config.growWaitTime)
+        , _shrinkIdleTime(config.shrinkIdleTime)
+        , _lastBusyTime(std::chrono::steady_clock::now())
+    {
+        Assert(config.growQueueDepth > 0);
+    }
+
+    ScaleDecision PoolScaler::Evaluate(const PoolLoadSample                 &sample,
+                                       std::chrono::steady_clock::time_point now)
+    {
+        // 连接打开失败等原因导致低于下限时优先补足
+        if (sample.connectionCount < _minConnections)
+        {
+            return ScaleDecision::Grow;
+        }
+
+        // 分位数的相对误差不超过1/16，且不超过实际最大值，略低于阈值的等待不会被判定为达到阈值
+        const std::chrono::microseconds waitP90(sample.waitTime.GetPercentile(90));
+        const double                    avgQueueDepth =
+            0 == sample.connectionCount
+                ? static_cast<double>(sample.queueDepth)
+                : static_cast<double>(sample.queueDepth) / static_cast<double>(sample.connectionCount);
+
+        if (avgQueueDepth >= _growQueueDepth || waitP90 >= _growWaitTime)
+        {
+            _lastBusyTime = now;
+            return sample.connectionCount < _maxConnections ? ScaleDecision::Grow : ScaleDecision::Keep;
+        }
+
+        // 仍有负载时不缩容，避免在阈值附近反复扩缩
+        if (sample.queueDepth > 0 || waitP90 >= _growWaitTime / 4)
+        {
+            _lastBusyTime = now;
+            return ScaleDecision::Keep;
+        }
+
+        if (sample.connectionCount > _minConnections && now - _lastBusyTime >= _shrinkIdleTime)
+        {
+            _lastBusyTime = now;
+            return ScaleDecision::Shrink;
+        }
+
+        return ScaleDecision::Keep;
+    }
+} // namespace Database
@@ -0,0 +1,90 @@
+﻿/*************************************************************************
+> File Name       : PoolScaler.h
+> Brief           : 数据库连接池伸缩策略
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月04日  11时02分48秒
+************************************************************************/
+#pragma once
+
+#include "Common/Util/Metrics.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace Database
+{
+    struct DatabasePoolConfig
+    {
+        uint8_t minSyncConnections {1};
+        uint8_t maxSyncConnections {1};
+        uint8_t minAsyncConnections {1};
+        uint8_t maxAsyncConnections {1};
+
+        double                    growQueueDepth {4.0};   // 每个连接平均排队请求数达到该值时扩容
+        std::chrono::milliseconds growWaitTime {20};      // 请求等待连接时长的p90达到该值时扩容
+        std::chrono::seconds      shrinkIdleTime {60};    // 持续空闲该时长后缩容一个连接
+        std::chrono::milliseconds scaleInterval {1'000};  // 采样与决策周期
+    };
+
+    // 一个采样周期内某类连接的负载
+    struct PoolLoadSample
+    {
+        std::size_t                connectionCount {0};
+        std::size_t                queueDepth {0}; // 异步为排队任务数，同步为等待连接的调用者数
+        Metrics::HistogramSnapshot waitTime;       // 请求等待连接的时长，单位为微秒
+    };
+
+    enum class ScaleDecision : uint8_t
+    {
+        Keep,
+        Grow,
+        Shrink,
+    };
+
+    // 伸缩决策及负载，由健康检查线程每个周期更新
+    struct PoolScalingMetrics
+    {
+        uint32_t                  connectionCount {0};
+        uint32_t                  drainingCount {0}; // 已移出但仍在执行剩余任务的连接
+        uint64_t                  growCount {0};
+        uint64_t                  shrinkCount {0};
+        std::size_t               queueDepth {0};
+        std::chrono::microseconds waitP50 {0};
+        std::chrono::microseconds waitP90 {0};
+        std::chrono::microseconds waitP99 {0};
+        ScaleDecision             lastDecision {ScaleDecision::Keep};
+    };
+
+    /**
+     * @brief 按排队深度与等待时长决定一类连接的扩缩容，每次最多增减一个连接
+     *        平均排队深度或等待时长p90达到阈值时扩容；
+     *        没有排队且等待时长远低于阈值的状态持续shrinkIdleTime后缩容，缩容后重新计时
+     */
+    class PoolScaler
+    {
+    public:
+        PoolScaler(uint8_t minConnections, uint8_t maxConnections, const DatabasePoolConfig &config);
+
+        ScaleDecision Evaluate(const PoolLoadSample &sample, std::chrono::steady_clock::time_point now);
+
+        [[nodiscard]] uint8_t GetMinConnections() const
+        {
+            return _minConnections;
+        }
+
+        [[nodiscard]] uint8_t GetMaxConnections() const
+        {
+            return _maxConnections;
+        }
+
+    private:
+        uint8_t                               _minConnections;
+        uint8_t                               _maxConnections;
+        double                                _growQueueDepth;
+        std::chrono::microseconds             _growWaitTime;
+        std::chrono::seconds                  _shrinkIdleTime;
+        std::chrono::steady_clock::time_point _lastBusyTime;
+    };
+} // namespace Database
@@ -0,0 +1,166 @@
+﻿/*************************************************************************
+> File Name       : PreparedStatement.cpp
+> Brief           : 预处理语句
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年02月27日  14时05分18秒
+************************************************************************/
+#include "PreparedStatement.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace Database
+{
+    namespace
+    {
+        constexpr std::size_t LOCAL_FREE_LIST_CAPACITY = 64; // 线程本地空闲列表上限
+        constexpr std::size_t TRANSFER_BATCH_SIZE      = 32; // 与全局列表之间每次转移的数量
+
+        std::atomic<std::size_t> g_createdCount {0};
+
+        // 全局列表析构后(程序退出阶段)归还的对象直接释放
+        std::atomic<bool> g_bGlobalFreeListDestroyed {false};
+
+        struct GlobalFreeList
+        {
+            std::mutex                           mutex;
+            std::vector<PreparedStatementBase *> stmts;
+
+            ~GlobalFreeList()
+            {
+                g_bGlobalFreeListDestroyed = true;
+
+                std::scoped_lock lock(mutex);
+                for (PreparedStatementBase *pStmt : stmts)
+                {
+                    delete pStmt;
+                }
+
+                stmts.clear();
+            }
+        };
+
+        GlobalFreeList &GetGlobalFreeList()
+        {
+            static GlobalFreeList freeList;
+            return freeList;
+        }
+
+        void ReleaseToGlobal(PreparedStatementBase *pStmt)
+        {
+            if (g_bGlobalFreeListDestroyed)
+            {
+                delete pStmt;
+                return;
+            }
+
+            GlobalFreeList  &global = GetGlobalFreeList();
+            std::scoped_lock lock(global.mutex);
+            global.stmts.push_back(pStmt);
+        }
+
+        // 线程本地列表析构后仍可能有对象归还(如静态对象析构)，此时直接交给全局列表
+        thread_local bool t_bLocalFreeListDestroyed = false;
+
+        struct LocalFreeList
+        {
+            std::vector<PreparedStatementBase *> stmts;
+
+            LocalFreeList()
+            {
+                stmts.reserve(LOCAL_FREE_LIST_CAPACITY);
+            }
+
+            // 线程退出时归还全部缓存
+            ~LocalFreeList()
+            {
+                t_bLocalFreeListDestroyed = true;
+                for (PreparedStatementBase *pStmt : stmts)
+                {
+                    ReleaseToGlobal(pStmt);
+                }
+
+                stmts.clear();
+            }
+        };
+
+        thread_local LocalFreeList t_localFreeList;
+    } // namespace
+
+    void PreparedStatementDeleter::operator()(PreparedStatementBase *pStmt) const
+    {
+        PreparedStatementPool::Release(pStmt);
+    }
+
+    PreparedStatementPtr PreparedStatementPool::Acquire(uint32_t preparedStatementIndex, uint8_t dataCapacity)
+    {
+        PreparedStatementBase *pStmt = nullptr;
+        if (!t_bLocalFreeListDestroyed)
+        {
+            std::vector<PreparedStatementBase *> &local = t_localFreeList.stmts;
+            if (local.empty() && !g_bGlobalFreeListDestroyed)
+            {
+                GlobalFreeList  &global = GetGlobalFreeList();
+                std::scoped_lock lock(global.mutex);
+                const std::size_t count = std::min(TRANSFER_BATCH_SIZE, global.stmts.size());
+                local.insert(local.end(), global.stmts.end() - count, global.stmts.end());
+                global.stmts.resize(global.stmts.size() - count);
+            }
+
+            if (!local.empty())
+            {
+                pStmt = local.back();
+                local.pop_back();
+            }
+        }
+
+        if (nullptr == pStmt)
+        {
+            ++g_createdCount;
+            return PreparedStatementPtr(new PreparedStatementBase(preparedStatementIndex, dataCapacity));
+        }
+
+        pStmt->Reset(preparedStatementIndex, dataCapacity);
+        return PreparedStatementPtr(pStmt);
+    }
+
+    void PreparedStatementPool::Release(PreparedStatementBase *pStmt)
+    {
+        if (nullptr == pStmt)
+        {
+            return;
+        }
+
+        if (t_bLocalFreeListDestroyed || g_bGlobalFreeListDestroyed)
+        {
+            ReleaseToGlobal(pStmt);
+            return;
+        }
+
+        std::vector<PreparedStatementBase *> &local = t_localFreeList.stmts;
+        local.push_back(pStmt);
+        if (local.size() < LOCAL_FREE_LIST_CAPACITY)
+        {
+            return;
+        }
+
+        GlobalFreeList  &global = GetGlobalFreeList();
+        std::scoped_lock lock(global.mutex);
+        global.stmts.insert(global.stmts.end(), local.end() - TRANSFER_BATCH_SIZE, local.end());
+        local.resize(local.size() - TRANSFER_BATCH_SIZE);
+    }
+
+    std::size_t PreparedStatementPool::GetCreatedCount()
+    {
+        return g_createdCount;
+    }
+
+    std::size_t PreparedStatementPool::GetFreeCount()
+    {
+        GlobalFreeList  &global = GetGlobalFreeList();
+        std::scoped_lock lock(global.mutex);
+        return global.stmts.size() + (t_bLocalFreeListDestroyed ? 0 : t_localFreeList.stmts.size());
+    }
+} // namespace Database
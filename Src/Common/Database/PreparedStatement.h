@@ -79,13 +79,23 @@ namespace Database
         PreparedStatementBase &operator=(const PreparedStatementBase &) = delete;
         PreparedStatementBase &operator=(PreparedStatementBase &&)      = delete;
 
-        template <typename T>
-        void SerialValue(const SqlStmtData &sqlStmt, T &&value)
+        /**
+         * @brief 按参数顺序依次设置每个参数的值
+         *
+         * @param sqlStmt 语句定义
+         * @param values 参数值，个数须与语句参数个数一致
+         */
+        template <typename... Args>
+        void SerialValue(const SqlStmtData &sqlStmt, Args &&...values)
         {
-            for (size_t i = 0; i < sqlStmt.argtypes.size(); ++i)
-            {
-                SetValue(static_cast<uint8_t>(i), sqlStmt.argtypes[i], std::forward<T>(value));
-            }
+            Assert(sizeof...(Args) == sqlStmt.argtypes.size(),
+                   std::format("预处理语句id：{} 需要{}个参数，实际传入{}个",
+                               _preparedStatementIndex,
+                               sqlStmt.argtypes.size(),
+                               sizeof...(Args)));
+
+            uint8_t index = 0;
+            ((SetValue(index, sqlStmt.argtypes[index], std::forward<Args>(values)), ++index), ...);
         }
 
         template <typename ValueType>
@@ -95,7 +105,11 @@ namespace Database
 
             using DecayType = std::decay_t<ValueType>;
 
-            if constexpr (std::is_same_v<DecayType, uint8_t>)
+            if constexpr (std::is_same_v<DecayType, bool>)
+            {
+                _statementData[index].data.emplace<bool>(value);
+            }
+            else if constexpr (std::is_same_v<DecayType, uint8_t>)
             {
                 _statementData[index].data.emplace<uint8_t>(std::forward<ValueType>(value));
             }
@@ -135,9 +149,38 @@ namespace Database
             {
                 _statementData[index].data.emplace<double>(std::forward<ValueType>(value));
             }
-            else if constexpr (std::is_convertible_v<DecayType, std::string>)
+            else if constexpr (std::is_convertible_v<DecayType, std::string> ||
+                               std::is_same_v<DecayType, std::string_view>)
+            {
+                // 同一对象重复设置该参数时复用原有字符串的容量
+                if (auto *pString = std::get_if<std::string>(&_statementData[index].data); nullptr != pString)
+                {
+                    pString->assign(std::forward<ValueType>(value));
+                }
+                else
+                {
+                    _statementData[index].data.emplace<std::string>(std::forward<ValueType>(value));
+                }
+            }
+            else if constexpr (std::is_same_v<DecayType, std::vector<uint8_t>>)
             {
-                _statementData[index].data.emplace<std::string>(std::forward<ValueType>(value));
+                if (auto *pBinary = std::get_if<std::vector<uint8_t>>(&_statementData[index].data);
+                    nullptr != pBinary)
+                {
+                    pBinary->assign(value.begin(), value.end());
+                }
+                else
+                {
+                    _statementData[index].data.emplace<std::vector<uint8_t>>(std::forward<ValueType>(value));
+                }
+            }
+            else if constexpr (std::is_null_pointer_v<DecayType>)
+            {
+                _statementData[index].data.emplace<std::nullptr_t>();
+            }
+            else
+            {
+                static_assert(!sizeof(DecayType), "不支持的预处理语句参数类型");
             }
         }
 
@@ -152,8 +195,54 @@ namespace Database
             return _statementData;
         }
 
+    private:
+        friend class PreparedStatementPool;
+
+        // 从对象池取出时重置，清除上一个使用者设置的参数，避免漏设的参数沿用旧值。
+        // 字符串与二进制参数原地清空，保留其容量供下一个使用者复用
+        void Reset(uint32_t preparedStatementIndex, uint8_t dataCapacity)
+        {
+            _preparedStatementIndex = preparedStatementIndex;
+            _statementData.resize(dataCapacity);
+            for (PreparedStatementData &param : _statementData)
+            {
+                if (auto *pString = std::get_if<std::string>(&param.data); nullptr != pString)
+                {
+                    pString->clear();
+                }
+                else if (auto *pBinary = std::get_if<std::vector<uint8_t>>(&param.data); nullptr != pBinary)
+                {
+                    pBinary->clear();
+                }
+                else
+                {
+                    param.data.emplace<bool>(false);
+                }
+            }
+        }
+
     private:
         uint32_t                           _preparedStatementIndex; // 预处理语句索引
         std::vector<PreparedStatementData> _statementData;
     };
+
+    /**
+     * @brief 预处理语句对象池
+     *        每个线程持有本地空闲列表，超出上限时成批转移到全局空闲列表，本地为空时再从全局成批取回。
+     *        异步请求的语句对象在数据库线程上释放，经由全局列表回流到发起请求的线程，
+     *        稳定运行后获取与归还均不产生堆分配
+     */
+    class PreparedStatementPool
+    {
+    public:
+        static PreparedStatementPtr Acquire(uint32_t preparedStatementIndex, uint8_t dataCapacity);
+
+        static void Release(PreparedStatementBase *pStmt);
+
+        // 已创建的语句对象总数
+        static std::size_t GetCreatedCount();
+
+        // 全局及当前线程本地的空闲对象总数，所有对象归还后应与GetCreatedCount相等
+        static std::size_t GetFreeCount();
+    };
 } // namespace Database
\ No newline at end of file
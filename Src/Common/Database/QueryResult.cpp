@@ -11,6 +11,8 @@
 #include "MySqlTypeHack.h"
 #include "Common/Util/Assert.h"
 
+#include <limits>
+
 namespace Database
 {
     constexpr uint32_t SizeForType(MYSQL_FIELD *field)
@@ -65,6 +67,27 @@ namespace Database
         }
     }
 
+    // 流式模式下变长列单行绑定缓冲区的默认大小
+    constexpr uint32_t STREAM_VARIABLE_BIND_SIZE = 256;
+
+    constexpr bool IsVariableLengthType(enum_field_types type)
+    {
+        switch (type)
+        {
+            case MYSQL_TYPE_TINY_BLOB:
+            case MYSQL_TYPE_MEDIUM_BLOB:
+            case MYSQL_TYPE_LONG_BLOB:
+            case MYSQL_TYPE_BLOB:
+            case MYSQL_TYPE_STRING:
+            case MYSQL_TYPE_VAR_STRING:
+            case MYSQL_TYPE_DECIMAL:
+            case MYSQL_TYPE_NEWDECIMAL:
+                return true;
+            default:
+                return false;
+        }
+    }
+
     constexpr DatabaseFieldType MysqlTypeToFieldType(enum_field_types type, uint32_t flags)
     {
         switch (type)
@@ -187,6 +210,26 @@ namespace Database
         meta->bBinary    = bBinary;
     }
 
+    constexpr bool IsNumericFieldType(DatabaseFieldType fieldType)
+    {
+        switch (fieldType)
+        {
+            case DatabaseFieldType::UInt8:
+            case DatabaseFieldType::Int8:
+            case DatabaseFieldType::UInt16:
+            case DatabaseFieldType::Int16:
+            case DatabaseFieldType::UInt32:
+            case DatabaseFieldType::Int32:
+            case DatabaseFieldType::UInt64:
+            case DatabaseFieldType::Int64:
+            case DatabaseFieldType::Float:
+            case DatabaseFieldType::Double:
+                return true;
+            default:
+                return false;
+        }
+    }
+
     QueryResultSet::QueryResultSet(MySqlResult *pResult,
                                    MySqlField  *pFields,
                                    uint64_t     rowCount,
@@ -201,7 +244,9 @@ namespace Database
         _pCurrentRow = new Field[_fieldCount];
         for (uint32_t i = 0; i < _fieldCount; ++i)
         {
-            InitializeDatabaseFieldMetadata(&_fieldMetadata[i], &pFields[i], i, false);
+            // 数值列在NextRow中解析为本机字节，之后与二进制协议的读取方式相同
+            const bool bNumeric = IsNumericFieldType(MysqlTypeToFieldType(pFields[i].type, pFields[i].flags));
+            InitializeDatabaseFieldMetadata(&_fieldMetadata[i], &pFields[i], i, bNumeric);
             _pCurrentRow[i].SetMetadata(&_fieldMetadata[i]);
         }
     }
@@ -213,7 +258,7 @@ namespace Database
 
     bool QueryResultSet::NextRow()
     {
-        if (_pResult)
+        if (nullptr == _pResult)
         {
             return false;
         }
@@ -234,9 +279,10 @@ namespace Database
             return false;
         }
 
+        // 每行一次解析全部数值列，读取字段时不再解析字符串
         for (uint32_t i = 0; i < _fieldCount; ++i)
         {
-            _pCurrentRow[i].SetValue(row[i], pLength[i]);
+            _pCurrentRow[i].SetTextValue(row[i], static_cast<uint32_t>(pLength[i]));
         }
         return true;
     }
@@ -262,175 +308,337 @@ namespace Database
     PreparedQueryResultSet::PreparedQueryResultSet(MySqlStmt   *pStmt,
                                                    MySqlResult *pResult,
                                                    uint64_t     rowCount,
-                                                   uint32_t     fieldCount)
+                                                   uint32_t     fieldCount,
+                                                   bool         bStreaming /*= false*/)
         : _rowCount(rowCount)
         , _fieldCount(fieldCount)
         , _pStmt(pStmt)
         , _pMetaDataResult(pResult)
+        , _bStreaming(bStreaming)
     {
         if (nullptr == _pMetaDataResult)
         {
             return;
         }
 
-        if (_pStmt->bind_result_done)
+        if (!_bStreaming)
+        {
+            if (0 != mysql_stmt_store_result(_pStmt))
+            {
+                Log::Warn("mysql_stmt_store_result 存储结果集错误：{}", mysql_stmt_error(_pStmt));
+                _rowCount = 0;
+                return;
+            }
+
+            _rowCount = mysql_stmt_num_rows(_pStmt);
+        }
+
+        LoadRows();
+
+        // 所有数据拷贝完毕，释放；流式模式下由连接在拉取结束后释放
+        if (!_bStreaming)
+        {
+            mysql_stmt_free_result(_pStmt);
+        }
+
+        InitCurrentRow();
+    }
+
+    PreparedQueryResultSet::PreparedQueryResultSet(PreparedQueryResultSnapshot pSource)
+        : _rowCount(pSource->_rowCount)
+        , _fieldCount(pSource->_fieldCount)
+    {
+        // 来源本身也是共享的结果集时直接引用数据的持有者
+        _pSource = nullptr == pSource->_pSource ? std::move(pSource) : pSource->_pSource;
+        InitCurrentRow();
+    }
+
+    PreparedQueryResultSet::~PreparedQueryResultSet()
+    {
+        CleanUp();
+    }
+
+    bool PreparedQueryResultSet::NextRow()
+    {
+        if (++_rowPosition >= _rowCount)
         {
-            delete[] _pStmt->bind->length;
-            delete[] _pStmt->bind->is_null;
+            return false;
         }
 
-        _pBind = new MySqlBind[_fieldCount];
+        UpdateCurrentRow();
+        return true;
+    }
 
-        MySqlBool     *pIsNull  = new MySqlBool[_fieldCount];
-        unsigned long *pLengths = new unsigned long[_fieldCount];
+    [[nodiscard]] Field *PreparedQueryResultSet::Fetch() const
+    {
+        Assert(_rowPosition < _rowCount);
+        return const_cast<Field *>(_currentRow.data());
+    }
 
-        memset(_pBind, 0, sizeof(MySqlBind) * _fieldCount);
-        memset(pIsNull, 0, sizeof(MySqlBool) * _fieldCount);
-        memset(pLengths, 0, sizeof(unsigned long) * _fieldCount);
+    const Field &PreparedQueryResultSet::operator[](std::size_t index) const
+    {
+        Assert(_rowPosition < _rowCount);
+        Assert(index < _fieldCount);
+        return _currentRow[index];
+    }
 
-        if (0 != mysql_stmt_store_result(_pStmt))
+    std::string_view PreparedQueryResultSet::GetColumnString(uint64_t rowIndex, uint32_t index) const
+    {
+        Assert(rowIndex < _rowCount);
+        Assert(index < _fieldCount);
+
+        const PreparedQueryResultSet &owner  = GetOwner();
+        const ResultColumn           &column = owner._columns[index];
+        Assert(column.bVariable,
+               std::format("列{}({})类型为{}，不是变长列",
+                           index,
+                           owner._fieldMetadata[index].alias,
+                           owner._fieldMetadata[index].typeName));
+
+        if (IsNull(rowIndex, index))
         {
-            Log::Warn("mysql_stmt_store_result 存储结果集错误：{}", mysql_stmt_error(_pStmt));
-            delete[] _pBind;
-            delete[] pIsNull;
-            delete[] pLengths;
+            return {};
+        }
 
-            _pBind = nullptr;
-            return;
+        return {&owner._variableData[column.offsets[rowIndex]], column.lengths[rowIndex]};
+    }
+
+    bool PreparedQueryResultSet::IsNull(uint64_t rowIndex, uint32_t index) const
+    {
+        Assert(rowIndex < _rowCount);
+        Assert(index < _fieldCount);
+
+        return (GetOwner()._columns[index].nullBitmap[rowIndex / 64] >> (rowIndex % 64)) & 1;
+    }
+
+    void PreparedQueryResultSet::CleanUp()
+    {
+        if (nullptr != _pMetaDataResult && !_bStreaming)
+        {
+            mysql_free_result(_pMetaDataResult);
         }
 
-        _rowCount = mysql_stmt_num_rows(_pStmt);
+        _pMetaDataResult = nullptr;
+    }
+
+    void PreparedQueryResultSet::LoadRows()
+    {
+        // 拉取缓冲区只容纳一行数据，所有行拉取完毕后随作用域释放
+        std::vector<MySqlBind>       binds(_fieldCount);
+        std::unique_ptr<MySqlBool[]> pIsNull = std::make_unique<MySqlBool[]>(_fieldCount);
+        std::vector<unsigned long>   lengths(_fieldCount);
 
         MySqlField *pFields = mysql_fetch_fields(_pMetaDataResult);
         _fieldMetadata.resize(_fieldCount);
+        _columns.resize(_fieldCount);
         size_t rowSize = 0;
         for (uint32_t i = 0; i < _fieldCount; ++i)
         {
+            ResultColumn &column = _columns[i];
+            column.bVariable     = IsVariableLengthType(pFields[i].type);
+
+            // 流式模式下没有max_length，变长列先按默认大小绑定，超长的值在StoreRow中单独拉取
             uint32_t size = SizeForType(&pFields[i]);
+            if (column.bVariable && _bStreaming)
+            {
+                size = (std::max)(size, STREAM_VARIABLE_BIND_SIZE);
+            }
             rowSize += size;
 
             InitializeDatabaseFieldMetadata(&_fieldMetadata[i], &pFields[i], i, true);
 
-            _pBind[i].buffer_type   = pFields[i].type;
-            _pBind[i].buffer_length = size;
-            _pBind[i].length        = &pLengths[i];
-            _pBind[i].is_null       = &pIsNull[i];
-            _pBind[i].error         = nullptr;
-            _pBind[i].is_unsigned   = pFields[i].flags & UNSIGNED_FLAG;
+            binds[i].buffer_type   = pFields[i].type;
+            binds[i].buffer_length = size;
+            binds[i].length        = &lengths[i];
+            binds[i].is_null       = &pIsNull[i];
+            binds[i].error         = nullptr;
+            binds[i].is_unsigned   = pFields[i].flags & UNSIGNED_FLAG;
+
+            column.nullBitmap.assign((_rowCount + 63) / 64, 0);
+            if (column.bVariable)
+            {
+                column.offsets.reserve(_rowCount);
+                column.lengths.reserve(_rowCount);
+            }
+            else
+            {
+                column.width = size;
+                column.fixedData.resize(_rowCount * size);
+            }
+        }
+
+        // 流式模式下pResult在拉取结束后即被释放，批结果集可能在此之后仍被持有
+        if (_bStreaming)
+        {
+            CopyFieldNames();
         }
 
-        char *pDataBuffer = new char[rowSize * _rowCount];
+        std::vector<char> rowBuffer(rowSize);
         for (uint32_t i = 0, offset = 0; i < _fieldCount; ++i)
         {
-            _pBind[i].buffer = pDataBuffer + offset;
-            offset += _pBind[i].buffer_length;
+            binds[i].buffer = rowBuffer.data() + offset;
+            offset += binds[i].buffer_length;
         }
 
+        _pBind = binds.data();
         if (mysql_stmt_bind_result(_pStmt, _pBind))
         {
             Log::Warn("mysql_stmt_bind_result 绑定结果集错误：{}", mysql_stmt_errno(_pStmt));
-            mysql_stmt_free_result(_pStmt);
-            CleanUp();
-            delete[] pIsNull;
-            delete[] pLengths;
+            _pBind    = nullptr;
+            _rowCount = 0;
             return;
         }
 
-        _rows.resize(_rowCount * _fieldCount);
         while (FetchNextRow())
         {
-            for (uint32_t i = 0; i < _fieldCount; ++i)
-            {
-                _rows[_rowPosition * _fieldCount + i].SetMetadata(&_fieldMetadata[i]);
-
-                unsigned long bufferLength  = _pBind[i].buffer_length;
-                unsigned long fetchedLength = *_pBind[i].length;
-                if (!(*_pBind[i].is_null))
-                {
-                    void *buffer = _pStmt->bind[i].buffer;
-                    switch (_pBind[i].buffer_type)
-                    {
-                        case MYSQL_TYPE_TINY_BLOB:
-                        case MYSQL_TYPE_MEDIUM_BLOB:
-                        case MYSQL_TYPE_LONG_BLOB:
-                        case MYSQL_TYPE_BLOB:
-                        case MYSQL_TYPE_VAR_STRING:
-                        case MYSQL_TYPE_STRING:
-                        {
-                            if (fetchedLength < bufferLength)
-                            {
-                                *((char *)buffer + fetchedLength) = '\0';
-                            }
-                        }
-                        break;
-                        default:
-                            break;
-                    }
-
-                    _rows[_rowPosition * _fieldCount + i].SetValue((const char *)buffer, fetchedLength);
-
-                    // 偏移指针
-                    _pStmt->bind[i].buffer = (char *)buffer + rowSize;
-                }
-                else
-                {
-                    _rows[_rowPosition * _fieldCount + i].SetValue(nullptr, *_pBind[i].length);
-                }
-            }
+            StoreRow(_rowPosition);
             ++_rowPosition;
         }
-        _rowPosition = 0;
 
-        // 所有数据绑定完毕，释放
-        mysql_stmt_free_result(_pStmt);
+        _rowCount    = _rowPosition;
+        _rowPosition = 0;
+        _pBind       = nullptr;
+        _variableData.shrink_to_fit();
     }
 
-    PreparedQueryResultSet::~PreparedQueryResultSet()
+    void PreparedQueryResultSet::CopyFieldNames()
     {
-        CleanUp();
-    }
+        std::size_t size = 0;
+        for (const QueryResultFieldMetadata &meta : _fieldMetadata)
+        {
+            size += meta.tableName.size() + meta.tableAlias.size() + meta.name.size() + meta.alias.size();
+        }
 
-    bool PreparedQueryResultSet::NextRow()
-    {
-        return ++_rowPosition < _rowCount;
-    }
+        // 一次分配，之后不再扩容，各名称的视图指向其中
+        _fieldNames.resize(size);
+        std::size_t offset = 0;
+        auto        copy   = [this, &offset](std::string_view &name) {
+            if (name.empty())
+            {
+                name = {};
+                return;
+            }
 
-    [[nodiscard]] Field *PreparedQueryResultSet::Fetch() const
-    {
-        Assert(_rowPosition < _rowCount);
-        return const_cast<Field *>(&_rows[_rowPosition * _fieldCount]);
+            std::memcpy(&_fieldNames[offset], name.data(), name.size());
+            name = {&_fieldNames[offset], name.size()};
+            offset += name.size();
+        };
+
+        for (QueryResultFieldMetadata &meta : _fieldMetadata)
+        {
+            copy(meta.tableName);
+            copy(meta.tableAlias);
+            copy(meta.name);
+            copy(meta.alias);
+        }
     }
 
-    const Field &PreparedQueryResultSet::operator[](std::size_t index) const
+    bool PreparedQueryResultSet::FetchNextRow()
     {
-        Assert(_rowPosition < _rowCount);
-        Assert(index < _fieldCount);
-        return _rows[_rowPosition * _fieldCount + index];
+        if (_rowPosition >= _rowCount)
+        {
+            return false;
+        }
+
+        int retVal = mysql_stmt_fetch(_pStmt);
+        if (1 == retVal)
+        {
+            Log::Warn("mysql_stmt_fetch 拉取结果集错误：{}", mysql_stmt_error(_pStmt));
+        }
+
+        return retVal == 0 || retVal == MYSQL_DATA_TRUNCATED;
     }
 
-    void PreparedQueryResultSet::CleanUp()
+    void PreparedQueryResultSet::StoreRow(uint64_t rowIndex)
     {
-        if (nullptr != _pMetaDataResult)
+        for (uint32_t i = 0; i < _fieldCount; ++i)
         {
-            mysql_free_result(_pMetaDataResult);
+            const MySqlBind &bind   = _pBind[i];
+            ResultColumn    &column = _columns[i];
+
+            if (*bind.is_null)
+            {
+                column.nullBitmap[rowIndex / 64] |= uint64_t(1) << (rowIndex % 64);
+                if (column.bVariable)
+                {
+                    column.offsets.emplace_back(static_cast<uint32_t>(_variableData.size()));
+                    column.lengths.emplace_back(0);
+                }
+                continue;
+            }
+
+            if (column.bVariable)
+            {
+                const unsigned long length = *bind.length;
+                const size_t        offset = _variableData.size();
+                Assert(offset + length < std::numeric_limits<uint32_t>::max());
+
+                column.offsets.emplace_back(static_cast<uint32_t>(offset));
+                column.lengths.emplace_back(static_cast<uint32_t>(length));
+                _variableData.resize(offset + length + 1);
+                _variableData[offset + length] = '\0';
+
+                if (length <= bind.buffer_length)
+                {
+                    std::memcpy(&_variableData[offset], bind.buffer, length);
+                    continue;
+                }
+
+                // 绑定缓冲区不足，值被截断，直接拉取完整的列数据
+                unsigned long fetchedLength = 0;
+                MySqlBind     columnBind    = bind;
+                columnBind.buffer           = &_variableData[offset];
+                columnBind.buffer_length    = length;
+                columnBind.length           = &fetchedLength;
+                if (0 != mysql_stmt_fetch_column(_pStmt, &columnBind, i, 0))
+                {
+                    Log::Warn("mysql_stmt_fetch_column 拉取第{}列错误：{}", i, mysql_stmt_error(_pStmt));
+                }
+            }
+            else
+            {
+                std::memcpy(column.fixedData.data() + rowIndex * column.width, bind.buffer, column.width);
+            }
         }
+    }
 
-        if (nullptr != _pBind)
+    void PreparedQueryResultSet::InitCurrentRow()
+    {
+        const PreparedQueryResultSet &owner = GetOwner();
+        _currentRow.resize(_fieldCount);
+        for (uint32_t i = 0; i < _fieldCount; ++i)
         {
-            delete[] (char *)_pBind->buffer;
-            delete[] _pBind;
-            _pBind = nullptr;
+            _currentRow[i].SetMetadata(&owner._fieldMetadata[i]);
         }
+        UpdateCurrentRow();
     }
 
-    bool PreparedQueryResultSet::FetchNextRow()
+    void PreparedQueryResultSet::UpdateCurrentRow()
     {
         if (_rowPosition >= _rowCount)
         {
-            return false;
+            return;
         }
 
-        int retVal = mysql_stmt_fetch(_pStmt);
-        return retVal == 0 || retVal == MYSQL_DATA_TRUNCATED;
+        const PreparedQueryResultSet &owner = GetOwner();
+        for (uint32_t i = 0; i < _fieldCount; ++i)
+        {
+            const ResultColumn &column = owner._columns[i];
+            if (IsNull(_rowPosition, i))
+            {
+                _currentRow[i].SetValue(nullptr, 0);
+            }
+            else if (column.bVariable)
+            {
+                _currentRow[i].SetValue(&owner._variableData[column.offsets[_rowPosition]],
+                                        column.lengths[_rowPosition]);
+            }
+            else
+            {
+                _currentRow[i].SetValue(
+                    reinterpret_cast<const char *>(column.fixedData.data() + _rowPosition * column.width),
+                    column.width);
+            }
+        }
     }
 } // namespace Database
\ No newline at end of file
@@ -9,8 +9,11 @@
 #pragma once
 #include "DatabaseEnv.h"
 #include "Field.h"
+#include "Common/Util/Assert.h"
 
 #include <vector>
+#include <span>
+#include <format>
 
 namespace Database
 {
@@ -65,10 +68,29 @@ namespace Database
         PreparedQueryResultSet &operator=(const PreparedQueryResultSet &) = delete;
         PreparedQueryResultSet &operator=(PreparedQueryResultSet &&)      = delete;
 
+        /**
+         * @brief 构造预处理语句结果集
+         *
+         * @param pStmt 预处理语句
+         * @param pResult 结果集元数据
+         * @param rowCount 缓冲模式下为结果行数；流式模式下为本批最多拉取的行数
+         * @param fieldCount 字段数
+         * @param bStreaming 流式模式：不缓冲整个结果集，直接从连接上拉取至多rowCount行，
+         *                   pResult由调用者在拉取结束后释放，列名等元数据拷贝到结果集中，
+         *                   结果集可在拉取结束后继续使用
+         */
         PreparedQueryResultSet(MySqlStmt   *pStmt,
                                MySqlResult *pResult,
                                uint64_t     rowCount,
-                               uint32_t     fieldCount);
+                               uint32_t     fieldCount,
+                               bool         bStreaming = false);
+
+        /**
+         * @brief 构造共享pSource结果数据的结果集，行游标独立，用于缓存结果的多个读者
+         *
+         * @param pSource 只读的结果集，数据在所有共享者释放后才销毁
+         */
+        explicit PreparedQueryResultSet(PreparedQueryResultSnapshot pSource);
         ~PreparedQueryResultSet();
 
         bool NextRow();
@@ -87,13 +109,80 @@ namespace Database
 
         const Field &operator[](std::size_t index) const;
 
+        /**
+         * @brief 获取定长列的全部数据，用于批量加载
+         *
+         * @param index 列索引
+         * @return std::span<const T> 列数据，长度为行数，NULL值对应位置为0
+         */
+        template <typename T>
+            requires std::is_arithmetic_v<T>
+        [[nodiscard]] std::span<const T> GetColumn(uint32_t index) const
+        {
+            Assert(index < _fieldCount);
+            const PreparedQueryResultSet &owner  = GetOwner();
+            const ResultColumn           &column = owner._columns[index];
+            Assert(!column.bVariable && column.width == sizeof(T)
+                       && IsFieldTypeOf<T>(owner._fieldMetadata[index].fieldType),
+                   std::format("列{}({})类型为{}，无法按{}字节定长列读取",
+                               index,
+                               owner._fieldMetadata[index].alias,
+                               owner._fieldMetadata[index].typeName,
+                               sizeof(T)));
+
+            return {reinterpret_cast<const T *>(column.fixedData.data()),
+                    static_cast<std::size_t>(_rowCount)};
+        }
+
+        /**
+         * @brief 获取变长列（字符串、二进制）某一行的数据
+         *
+         * @param rowIndex 行索引
+         * @param index 列索引
+         * @return std::string_view 数据，NULL值返回空
+         */
+        [[nodiscard]] std::string_view GetColumnString(uint64_t rowIndex, uint32_t index) const;
+
+        [[nodiscard]] bool IsNull(uint64_t rowIndex, uint32_t index) const;
+
+        [[nodiscard]] const QueryResultFieldMetadata &GetFieldMetadata(uint32_t index) const
+        {
+            Assert(index < _fieldCount);
+            return GetOwner()._fieldMetadata[index];
+        }
+
     private:
+        // 按列存储的结果集数据：定长列连续存放，变长列统一存放在_variableData中，通过偏移访问
+        struct ResultColumn
+        {
+            std::vector<std::byte> fixedData;  // 定长列数据，rowCount * width
+            std::vector<uint32_t>  offsets;    // 变长列在_variableData中的偏移
+            std::vector<uint32_t>  lengths;    // 变长列数据长度
+            std::vector<uint64_t>  nullBitmap; // NULL值位图
+            uint32_t               width {0};
+            bool                   bVariable {false};
+        };
+
+        // 结果数据的持有者，共享其他结果集的数据时为数据来源
+        [[nodiscard]] const PreparedQueryResultSet &GetOwner() const
+        {
+            return nullptr == _pSource ? *this : *_pSource;
+        }
+
         void CleanUp();
+        void LoadRows();
+        void CopyFieldNames();
         bool FetchNextRow();
+        void StoreRow(uint64_t rowIndex);
+        void InitCurrentRow();
+        void UpdateCurrentRow();
 
     private:
         std::vector<QueryResultFieldMetadata> _fieldMetadata;
-        std::vector<Field>                    _rows;
+        std::vector<ResultColumn>             _columns;
+        std::vector<char>                     _variableData;
+        std::vector<char>                     _fieldNames; // 流式模式下拷贝的表名与列名
+        std::vector<Field>                    _currentRow;
         uint64_t                              _rowCount {0};
         uint64_t                              _rowPosition {0};
         uint32_t                              _fieldCount {0};
@@ -101,5 +190,8 @@ namespace Database
         MySqlStmt   *_pStmt {nullptr};
         MySqlBind   *_pBind {nullptr};
         MySqlResult *_pMetaDataResult {nullptr};
+        bool         _bStreaming {false};
+
+        PreparedQueryResultSnapshot _pSource; // 共享数据的来源，为空时数据由自身持有
     };
 } // namespace Database
\ No newline at end of file
@@ -0,0 +1,237 @@
+﻿/*************************************************************************
+> File Name       : QueryResultCache.cpp
+> Brief           : 预处理语句查询结果缓存
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年02月28日  15时21分42秒
+************************************************************************/
+#include "QueryResultCache.h"
+#include "PreparedStatement.h"
+
+namespace Database
+{
+    QueryResultCache::QueryResultCache(std::size_t capacity /*= DEFAULT_QUERY_CACHE_CAPACITY*/)
+        : _capacity(capacity)
+    {
+    }
+
+    void QueryResultCache::EnableStatement(uint32_t stmtID, std::chrono::milliseconds ttl)
+    {
+        std::scoped_lock lock(_mutex);
+        StatementPolicy &policy = GetPolicy(stmtID);
+        policy.ttl              = ttl;
+        policy.bEnabled         = ttl.count() > 0;
+    }
+
+    void QueryResultCache::AddInvalidation(uint32_t writeStmtID, uint32_t readStmtID)
+    {
+        std::scoped_lock lock(_mutex);
+        GetPolicy(writeStmtID).invalidateStmts.push_back(readStmtID);
+    }
+
+    bool QueryResultCache::IsCacheable(uint32_t stmtID) const
+    {
+        std::scoped_lock       lock(_mutex);
+        const StatementPolicy *pPolicy = FindPolicy(stmtID);
+        return nullptr != pPolicy && pPolicy->bEnabled;
+    }
+
+    bool QueryResultCache::HasInvalidation(uint32_t writeStmtID) const
+    {
+        std::scoped_lock       lock(_mutex);
+        const StatementPolicy *pPolicy = FindPolicy(writeStmtID);
+        return nullptr != pPolicy && !pPolicy->invalidateStmts.empty();
+    }
+
+    PreparedQueryResultSnapshot QueryResultCache::Get(const PreparedStatementBase *pStmt,
+                                                      uint64_t                    &generation)
+    {
+        // 键缓冲区按线程复用，查找不产生堆分配
+        thread_local std::string key;
+        BuildKey(key, pStmt);
+
+        std::scoped_lock       lock(_mutex);
+        const StatementPolicy *pPolicy = FindPolicy(pStmt->GetIndex());
+        if (nullptr == pPolicy || !pPolicy->bEnabled)
+        {
+            return nullptr;
+        }
+
+        generation = pPolicy->generation;
+
+        auto iter = _entryIndex.find(key);
+        if (iter == _entryIndex.end())
+        {
+            ++_stats.misses;
+            return nullptr;
+        }
+
+        EntryList::iterator entryIter = iter->second;
+        if (entryIter->generation != generation)
+        {
+            ++_stats.misses;
+            EraseEntry(entryIter);
+            return nullptr;
+        }
+
+        if (entryIter->expireTime <= Clock::now())
+        {
+            ++_stats.misses;
+            ++_stats.expirations;
+            EraseEntry(entryIter);
+            return nullptr;
+        }
+
+        ++_stats.hits;
+        _entries.splice(_entries.begin(), _entries, entryIter);
+        return entryIter->pResult;
+    }
+
+    void QueryResultCache::Put(const PreparedStatementBase *pStmt,
+                               uint64_t                     generation,
+                               PreparedQueryResultSnapshot  pResult)
+    {
+        if (nullptr == pResult)
+        {
+            return;
+        }
+
+        std::string key;
+        BuildKey(key, pStmt);
+
+        std::scoped_lock       lock(_mutex);
+        const StatementPolicy *pPolicy = FindPolicy(pStmt->GetIndex());
+        if (nullptr == pPolicy || !pPolicy->bEnabled || pPolicy->generation != generation || 0 == _capacity)
+        {
+            return;
+        }
+
+        if (auto iter = _entryIndex.find(key); iter != _entryIndex.end())
+        {
+            EraseEntry(iter->second);
+        }
+
+        _entries.push_front(Entry {std::move(key),
+                                   pStmt->GetIndex(),
+                                   generation,
+                                   Clock::now() + pPolicy->ttl,
+                                   std::move(pResult)});
+        _entryIndex.emplace(_entries.front().key, _entries.begin());
+        ++_stats.insertions;
+
+        EvictOverflow();
+    }
+
+    void QueryResultCache::OnExecute(uint32_t writeStmtID)
+    {
+        std::scoped_lock       lock(_mutex);
+        const StatementPolicy *pPolicy = FindPolicy(writeStmtID);
+        if (nullptr == pPolicy)
+        {
+            return;
+        }
+
+        for (uint32_t readStmtID : pPolicy->invalidateStmts)
+        {
+            InvalidateLocked(readStmtID);
+        }
+    }
+
+    void QueryResultCache::Invalidate(uint32_t readStmtID)
+    {
+        std::scoped_lock lock(_mutex);
+        InvalidateLocked(readStmtID);
+    }
+
+    void QueryResultCache::Clear()
+    {
+        std::scoped_lock lock(_mutex);
+        _entryIndex.clear();
+        _entries.clear();
+    }
+
+    void QueryResultCache::SetCapacity(std::size_t capacity)
+    {
+        std::scoped_lock lock(_mutex);
+        _capacity = capacity;
+        EvictOverflow();
+    }
+
+    QueryCacheStats QueryResultCache::GetStats() const
+    {
+        std::scoped_lock lock(_mutex);
+        QueryCacheStats  stats = _stats;
+        stats.size             = _entries.size();
+        return stats;
+    }
+
+    void QueryResultCache::BuildKey(std::string &key, const PreparedStatementBase *pStmt)
+    {
+        key.clear();
+
+        const uint32_t stmtID = pStmt->GetIndex();
+        key.append(reinterpret_cast<const char *>(&stmtID), sizeof(stmtID));
+
+        // 每个参数依次写入类型与数据，变长数据带长度前缀，保证不同参数组合的键不会相同
+        for (const PreparedStatementData &param : pStmt->GetParameters())
+        {
+            key.push_back(static_cast<char>(param.data.index()));
+            std::visit(
+                [&key](const auto &value) {
+                    using ValueType = std::decay_t<decltype(value)>;
+                    if constexpr (std::is_same_v<ValueType, std::string> ||
+                                  std::is_same_v<ValueType, std::vector<uint8_t>>)
+                    {
+                        const uint32_t length = static_cast<uint32_t>(value.size());
+                        key.append(reinterpret_cast<const char *>(&length), sizeof(length));
+                        key.append(reinterpret_cast<const char *>(value.data()), value.size());
+                    }
+                    else if constexpr (std::is_arithmetic_v<ValueType>)
+                    {
+                        key.append(reinterpret_cast<const char *>(&value), sizeof(value));
+                    }
+                },
+                param.data);
+        }
+    }
+
+    QueryResultCache::StatementPolicy &QueryResultCache::GetPolicy(uint32_t stmtID)
+    {
+        if (stmtID >= _policies.size())
+        {
+            _policies.resize(stmtID + 1);
+        }
+
+        return _policies[stmtID];
+    }
+
+    const QueryResultCache::StatementPolicy *QueryResultCache::FindPolicy(uint32_t stmtID) const
+    {
+        return stmtID < _policies.size() ? &_policies[stmtID] : nullptr;
+    }
+
+    void QueryResultCache::InvalidateLocked(uint32_t readStmtID)
+    {
+        if (readStmtID < _policies.size())
+        {
+            ++_policies[readStmtID].generation;
+            ++_stats.invalidations;
+        }
+    }
+
+    void QueryResultCache::EraseEntry(EntryList::iterator iter)
+    {
+        _entryIndex.erase(iter->key);
+        _entries.erase(iter);
+    }
+
+    void QueryResultCache::EvictOverflow()
+    {
+        while (_entries.size() > _capacity)
+        {
+            EraseEntry(std::prev(_entries.end()));
+            ++_stats.evictions;
+        }
+    }
+} // namespace Database
@@ -0,0 +1,149 @@
+﻿/*************************************************************************
+> File Name       : QueryResultCache.h
+> Brief           : 预处理语句查询结果缓存
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年02月28日  15时21分42秒
+************************************************************************/
+#pragma once
+
+#include "DatabaseEnv.h"
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Database
+{
+    // 缓存默认容量(条目数)
+    constexpr std::size_t DEFAULT_QUERY_CACHE_CAPACITY = 4096;
+
+    struct QueryCacheStats
+    {
+        uint64_t    hits {0};
+        uint64_t    misses {0};
+        uint64_t    insertions {0};
+        uint64_t    evictions {0};     // 超出容量被淘汰
+        uint64_t    expirations {0};   // 超过TTL
+        uint64_t    invalidations {0}; // 写语句触发的失效次数
+        std::size_t size {0};
+    };
+
+    /**
+     * @brief 预处理语句查询结果缓存，按需对语句开启
+     *        以语句ID+绑定参数为键，每条语句单独设置TTL，超出容量时按LRU淘汰。
+     *        缓存的结果集为只读快照，多个调用者共享，只能通过const接口(GetColumn等)访问。
+     *        写语句失效相关读语句时只递增其版本号，旧条目在下次访问或淘汰时移除。
+     *
+     *        例：cache.EnableStatement(LOGIN_SEL_ACCOUNT_BY_EMAIL, 30s);
+     *            cache.AddInvalidation(LOGIN_UPD_ACCOUNT, LOGIN_SEL_ACCOUNT_BY_EMAIL);
+     */
+    class QueryResultCache
+    {
+    public:
+        QueryResultCache(const QueryResultCache &)            = delete;
+        QueryResultCache(QueryResultCache &&)                 = delete;
+        QueryResultCache &operator=(const QueryResultCache &) = delete;
+        QueryResultCache &operator=(QueryResultCache &&)      = delete;
+
+        explicit QueryResultCache(std::size_t capacity = DEFAULT_QUERY_CACHE_CAPACITY);
+        ~QueryResultCache() = default;
+
+        /**
+         * @brief 开启语句的结果缓存
+         *
+         * @param stmtID 读语句ID
+         * @param ttl 结果有效时长
+         */
+        void EnableStatement(uint32_t stmtID, std::chrono::milliseconds ttl);
+
+        /**
+         * @brief 设置写语句执行后需要失效的读语句
+         *
+         * @param writeStmtID 写语句ID
+         * @param readStmtID 读语句ID
+         */
+        void AddInvalidation(uint32_t writeStmtID, uint32_t readStmtID);
+
+        [[nodiscard]] bool IsCacheable(uint32_t stmtID) const;
+
+        [[nodiscard]] bool HasInvalidation(uint32_t writeStmtID) const;
+
+        /**
+         * @brief 查找缓存
+         *
+         * @param pStmt 已绑定参数的语句
+         * @param generation 输出查找时语句的版本号，未命中时须原样传给Put
+         * @return 命中时返回结果快照，否则为空
+         */
+        PreparedQueryResultSnapshot Get(const PreparedStatementBase *pStmt, uint64_t &generation);
+
+        /**
+         * @brief 写入缓存，查询期间语句已被失效时丢弃
+         *
+         * @param pStmt 已绑定参数的语句
+         * @param generation Get输出的版本号
+         * @param pResult 查询结果
+         */
+        void Put(const PreparedStatementBase *pStmt,
+                 uint64_t                     generation,
+                 PreparedQueryResultSnapshot  pResult);
+
+        // 写语句执行，失效所有相关的读语句
+        void OnExecute(uint32_t writeStmtID);
+
+        // 失效读语句的所有缓存结果
+        void Invalidate(uint32_t readStmtID);
+
+        void Clear();
+
+        void SetCapacity(std::size_t capacity);
+
+        [[nodiscard]] QueryCacheStats GetStats() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct StatementPolicy
+        {
+            std::chrono::milliseconds ttl {0};
+            uint64_t                  generation {0};
+            std::vector<uint32_t>     invalidateStmts;
+            bool                      bEnabled {false};
+        };
+
+        struct Entry
+        {
+            std::string                 key;
+            uint32_t                    stmtID {0};
+            uint64_t                    generation {0};
+            Clock::time_point           expireTime;
+            PreparedQueryResultSnapshot pResult;
+        };
+
+        using EntryList = std::list<Entry>;
+
+        static void BuildKey(std::string &key, const PreparedStatementBase *pStmt);
+
+        StatementPolicy       &GetPolicy(uint32_t stmtID);
+        const StatementPolicy *FindPolicy(uint32_t stmtID) const;
+
+        void InvalidateLocked(uint32_t readStmtID);
+        void EraseEntry(EntryList::iterator iter);
+        void EvictOverflow();
+
+    private:
+        mutable std::mutex                                        _mutex;
+        std::vector<StatementPolicy>                              _policies; // 按语句ID索引
+        EntryList                                                 _entries;  // 头部为最近访问
+        std::unordered_map<std::string_view, EntryList::iterator> _entryIndex;
+        std::size_t                                               _capacity;
+        QueryCacheStats                                           _stats;
+    };
+} // namespace Database
@@ -0,0 +1,127 @@
+﻿/*************************************************************************
+> File Name       : ReplicaBalancer.cpp
+> Brief           : 从库负载均衡
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月06日  14时36分05秒
+************************************************************************/
+#include "ReplicaBalancer.h"
+
+#include "Common/Util/Util.h"
+
+#include <algorithm>
+
+namespace Database
+{
+    bool ParseReplicaLag(std::span<const std::string_view>                names,
+                         std::span<const std::optional<std::string_view>> values,
+                         std::optional<std::chrono::seconds>             &lag)
+    {
+        lag.reset();
+        for (std::size_t i = 0; i < names.size() && i < values.size(); ++i)
+        {
+            if (std::ranges::find(REPLICA_LAG_COLUMNS, names[i]) == std::end(REPLICA_LAG_COLUMNS))
+            {
+                continue;
+            }
+
+            if (values[i].has_value())
+            {
+                if (auto seconds = Util::StringTo<int64_t>(*values[i]); seconds)
+                {
+                    lag = std::chrono::seconds(*seconds);
+                }
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    ReplicaBalancer::ReplicaBalancer(std::chrono::seconds maxLag)
+        : _maxLag(maxLag.count())
+    {
+    }
+
+    std::size_t ReplicaBalancer::AddReplica()
+    {
+        _replicas.emplace_back(std::make_unique<ReplicaState>());
+        return _replicas.size() - 1;
+    }
+
+    void ReplicaBalancer::RecordLatency(std::size_t index, std::chrono::steady_clock::duration latency)
+    {
+        ReplicaState &replica = *_replicas[index];
+        const int64_t sample  = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+
+        // 首个样本直接采用，之后按1/8的权重平滑，单次慢查询不会使从库立即失去流量
+        if (!replica.bSampled.exchange(true, std::memory_order_relaxed))
+        {
+            replica.latency.store(sample, std::memory_order_relaxed);
+            return;
+        }
+
+        int64_t current = replica.latency.load(std::memory_order_relaxed);
+        while (!replica.latency.compare_exchange_weak(current,
+                                                      current + (sample - current) / 8,
+                                                      std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void ReplicaBalancer::UpdateLag(std::size_t index, std::optional<std::chrono::seconds> lag)
+    {
+        _replicas[index]->lag.store(lag.has_value() ? lag->count() : -1, std::memory_order_relaxed);
+    }
+
+    std::optional<std::size_t> ReplicaBalancer::SelectReplica()
+    {
+        const int64_t maxLag = _maxLag.load(std::memory_order_relaxed);
+
+        std::optional<std::size_t> selected;
+        int64_t                    minLatency = 0;
+        for (std::size_t i = 0; i < _replicas.size(); ++i)
+        {
+            const ReplicaState &replica = *_replicas[i];
+            const int64_t       lag     = replica.lag.load(std::memory_order_relaxed);
+            if (lag < 0 || lag > maxLag)
+            {
+                continue;
+            }
+
+            const int64_t latency = replica.latency.load(std::memory_order_relaxed);
+            if (!selected.has_value() || latency < minLatency)
+            {
+                selected   = i;
+                minLatency = latency;
+            }
+        }
+
+        if (selected.has_value())
+        {
+            _replicas[*selected]->selectCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        return selected;
+    }
+
+    std::vector<ReplicaStats> ReplicaBalancer::GetStats() const
+    {
+        std::vector<ReplicaStats> stats;
+        stats.reserve(_replicas.size());
+        for (const auto &pReplica : _replicas)
+        {
+            ReplicaStats &stat = stats.emplace_back();
+            stat.latency       = std::chrono::microseconds(pReplica->latency.load(std::memory_order_relaxed));
+            stat.selectCount   = pReplica->selectCount.load(std::memory_order_relaxed);
+            if (const int64_t lag = pReplica->lag.load(std::memory_order_relaxed); lag >= 0)
+            {
+                stat.lag = std::chrono::seconds(lag);
+            }
+        }
+
+        return stats;
+    }
+} // namespace Database
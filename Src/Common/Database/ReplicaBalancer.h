@@ -0,0 +1,149 @@
+﻿/*************************************************************************
+> File Name       : ReplicaBalancer.h
+> Brief           : 从库负载均衡
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月06日  14时36分05秒
+************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace Database
+{
+    // 复制延迟超过该值的从库不再承担读请求
+    constexpr std::chrono::seconds DEFAULT_MAX_REPLICA_LAG {5};
+
+    // 写入后该时长内的读请求固定走主库
+    constexpr std::chrono::milliseconds DEFAULT_STICKY_WINDOW {5'000};
+
+    // 健康检查线程探测从库复制延迟的间隔
+    constexpr std::chrono::seconds DEFAULT_REPLICA_PROBE_INTERVAL {1};
+
+    // 探测连续失败时间隔逐次倍增，不超过该值
+    constexpr std::chrono::seconds MAX_REPLICA_PROBE_BACKOFF {60};
+
+    // 复制状态中记录延迟的列名，8.0.22之前为Seconds_Behind_Master
+    constexpr std::string_view REPLICA_LAG_COLUMNS[] = {"Seconds_Behind_Source", "Seconds_Behind_Master"};
+
+    // 复制状态中没有延迟列时探测返回的错误码，不与MySql的错误码冲突
+    constexpr uint32_t REPLICA_LAG_COLUMN_MISSING = (std::numeric_limits<uint32_t>::max)();
+
+    /**
+     * @brief 从复制状态的一行中解析复制延迟
+     *
+     * @param names 列名
+     * @param values 列值，NULL为空
+     * @param lag 复制延迟，复制线程未运行(延迟列为NULL)时为空
+     * @return 是否找到延迟列
+     */
+    bool ParseReplicaLag(std::span<const std::string_view>                names,
+                         std::span<const std::optional<std::string_view>> values,
+                         std::optional<std::chrono::seconds>             &lag);
+
+    /**
+     * @brief 读己之写的会话标记，由业务会话持有
+     *        写入时调用OnWrite，之后一段时间内该会话的只读查询路由到主库，避免从库延迟导致读到旧数据
+     */
+    class ReadSession
+    {
+    public:
+        void OnWrite()
+        {
+            _lastWriteTime.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                                 std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] bool IsSticky(std::chrono::steady_clock::duration window) const
+        {
+            const int64_t lastWriteTime = _lastWriteTime.load(std::memory_order_relaxed);
+            if (0 == lastWriteTime)
+            {
+                return false;
+            }
+
+            const auto elapsed = std::chrono::steady_clock::now().time_since_epoch()
+                                 - std::chrono::steady_clock::duration(lastWriteTime);
+            return elapsed < window;
+        }
+
+    private:
+        std::atomic<int64_t> _lastWriteTime {0};
+    };
+
+    struct ReplicaStats
+    {
+        std::chrono::microseconds           latency {0};  // 查询耗时的指数加权平均
+        std::optional<std::chrono::seconds> lag;          // 复制延迟，为空表示未知或复制中断
+        uint64_t                            selectCount {0};
+    };
+
+    /**
+     * @brief 从库选择，线程安全
+     *        在复制延迟不超过上限的从库中选择查询耗时最低的一个；没有满足条件的从库时回退到主库。
+     *        延迟与耗时由健康检查线程定期探测，同步查询的耗时也会计入
+     */
+    class ReplicaBalancer
+    {
+    public:
+        explicit ReplicaBalancer(std::chrono::seconds maxLag = DEFAULT_MAX_REPLICA_LAG);
+
+        // 添加从库，返回其索引；须在开始选择之前调用
+        std::size_t AddReplica();
+
+        [[nodiscard]] std::size_t GetReplicaCount() const
+        {
+            return _replicas.size();
+        }
+
+        void SetMaxLag(std::chrono::seconds maxLag)
+        {
+            _maxLag.store(maxLag.count(), std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] std::chrono::seconds GetMaxLag() const
+        {
+            return std::chrono::seconds(_maxLag.load(std::memory_order_relaxed));
+        }
+
+        void RecordLatency(std::size_t index, std::chrono::steady_clock::duration latency);
+
+        /**
+         * @brief 更新复制延迟
+         *
+         * @param index 从库索引
+         * @param lag 复制延迟，为空表示复制中断或探测失败
+         */
+        void UpdateLag(std::size_t index, std::optional<std::chrono::seconds> lag);
+
+        /**
+         * @brief 选择从库
+         *
+         * @return 从库索引，为空表示使用主库
+         */
+        std::optional<std::size_t> SelectReplica();
+
+        [[nodiscard]] std::vector<ReplicaStats> GetStats() const;
+
+    private:
+        struct ReplicaState
+        {
+            std::atomic<int64_t>  latency {0}; // 微秒
+            std::atomic<int64_t>  lag {-1};    // 秒，小于0表示不可用
+            std::atomic<uint64_t> selectCount {0};
+            std::atomic<bool>     bSampled {false};
+        };
+
+        std::vector<std::unique_ptr<ReplicaState>> _replicas;
+        std::atomic<int64_t>                       _maxLag;
+    };
+} // namespace Database
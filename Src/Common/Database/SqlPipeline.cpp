@@ -0,0 +1,56 @@
+﻿/*************************************************************************
+> File Name       : SqlPipeline.cpp
+> Brief           : 异步sql写语句合并
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月05日  16时21分37秒
+************************************************************************/
+#include "SqlPipeline.h"
+#include "DatabaseEnv.h"
+
+namespace Database
+{
+    std::string_view TrimSqlTerminator(std::string_view sql)
+    {
+        return sql.substr(0, sql.find_last_not_of("; \t\r\n") + 1);
+    }
+
+    bool IsPipelineSql(std::string_view sql)
+    {
+        return std::string_view::npos == TrimSqlTerminator(sql).find(';');
+    }
+
+    std::size_t CountPipelineSql(std::span<const std::string> sqls)
+    {
+        std::size_t count = 0;
+        std::size_t bytes = 0;
+        while (count < sqls.size() && count < MAX_SQL_PIPELINE_SIZE && IsPipelineSql(sqls[count]) &&
+               (0 == count || bytes + sqls[count].size() < MAX_SQL_PIPELINE_BYTES))
+        {
+            bytes += sqls[count].size() + 1;
+            ++count;
+        }
+
+        return count;
+    }
+
+    std::string BuildPipelineSql(std::span<const std::string> sqls)
+    {
+        std::size_t bytes = 0;
+        for (const std::string &sql : sqls)
+        {
+            bytes += sql.size() + 1;
+        }
+
+        std::string pipeline;
+        pipeline.reserve(bytes);
+        for (const std::string &sql : sqls)
+        {
+            // 去掉结尾的分号与空白，避免产生空语句
+            pipeline.append(TrimSqlTerminator(sql)).push_back(';');
+        }
+
+        return pipeline;
+    }
+} // namespace Database
@@ -0,0 +1,36 @@
+﻿/*************************************************************************
+> File Name       : SqlPipeline.h
+> Brief           : 异步sql写语句合并
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月05日  16时21分37秒
+************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace Database
+{
+    // 去掉结尾的分号与空白
+    std::string_view TrimSqlTerminator(std::string_view sql);
+
+    // 去掉结尾分号与空白后仍含分号的sql可能由多条语句拼接而成，合并执行会打乱结果与语句的对应关系，
+    // 拼接的参数中带有分号时还会被当作额外的语句执行，因此不参与合并
+    bool IsPipelineSql(std::string_view sql);
+
+    /**
+     * @brief 计算sqls开头可以合并为一次多语句请求的条数
+     *        遇到不能合并的语句、达到条数或字节数上限时停止
+     *
+     * @param sqls 待执行的语句
+     * @return 可合并的条数，少于MIN_SQL_PIPELINE_SIZE时应逐条执行
+     */
+    std::size_t CountPipelineSql(std::span<const std::string> sqls);
+
+    // 拼接为一次多语句请求，每条语句以一个分号结尾
+    std::string BuildPipelineSql(std::span<const std::string> sqls);
+} // namespace Database
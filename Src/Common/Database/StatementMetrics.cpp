@@ -0,0 +1,75 @@
+﻿/*************************************************************************
+> File Name       : StatementMetrics.cpp
+> Brief           : 预处理语句耗时统计
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月07日  09时42分18秒
+************************************************************************/
+#include "StatementMetrics.h"
+
+#include <algorithm>
+
+namespace Database
+{
+    StatementMetrics::StatementMetrics(std::size_t stmtCount)
+        : _pHistograms(std::make_unique<Histograms[]>(stmtCount))
+        , _stmtCount(stmtCount)
+    {
+    }
+
+    void StatementMetrics::RecordQueueWait(uint32_t index, std::chrono::steady_clock::duration latency)
+    {
+        if (index < _stmtCount)
+        {
+            _pHistograms[index].queueWait.Record(latency);
+        }
+    }
+
+    void StatementMetrics::RecordExecute(uint32_t index, std::chrono::steady_clock::duration latency)
+    {
+        if (index < _stmtCount)
+        {
+            _pHistograms[index].execute.Record(latency);
+        }
+    }
+
+    void StatementMetrics::RecordDecode(uint32_t index, std::chrono::steady_clock::duration latency)
+    {
+        if (index < _stmtCount)
+        {
+            _pHistograms[index].decode.Record(latency);
+        }
+    }
+
+    void StatementMetrics::MergeInto(std::vector<StatementLatencySnapshot> &snapshots) const
+    {
+        for (std::size_t i = 0; i < _stmtCount; ++i)
+        {
+            StatementLatencySnapshot snapshot;
+            snapshot.index     = static_cast<uint32_t>(i);
+            snapshot.queueWait = _pHistograms[i].queueWait.GetSnapshot();
+            snapshot.execute   = _pHistograms[i].execute.GetSnapshot();
+            snapshot.decode    = _pHistograms[i].decode.GetSnapshot();
+            if (0 == snapshot.queueWait.count && 0 == snapshot.execute.count && 0 == snapshot.decode.count)
+            {
+                continue;
+            }
+
+            auto iter = std::lower_bound(snapshots.begin(),
+                                         snapshots.end(),
+                                         snapshot.index,
+                                         [](const StatementLatencySnapshot &lhs, uint32_t index) {
+                                             return lhs.index < index;
+                                         });
+            if (iter != snapshots.end() && iter->index == snapshot.index)
+            {
+                iter->Merge(snapshot);
+            }
+            else
+            {
+                snapshots.insert(iter, snapshot);
+            }
+        }
+    }
+} // namespace Database
@@ -0,0 +1,70 @@
+﻿/*************************************************************************
+> File Name       : StatementMetrics.h
+> Brief           : 预处理语句耗时统计
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月07日  09时42分18秒
+************************************************************************/
+#pragma once
+
+#include "Common/Util/Metrics.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace Database
+{
+    // 单条预处理语句的耗时快照，单位为微秒
+    struct StatementLatencySnapshot
+    {
+        uint32_t                   index {0};
+        Metrics::HistogramSnapshot queueWait; // 异步任务排队
+        Metrics::HistogramSnapshot execute;   // 绑定参数、发送并执行完成
+        Metrics::HistogramSnapshot decode;    // 拉取并解析结果集
+
+        void Merge(const StatementLatencySnapshot &other)
+        {
+            queueWait.Merge(other.queueWait);
+            execute.Merge(other.execute);
+            decode.Merge(other.decode);
+        }
+    };
+
+    /**
+     * @brief 按预处理语句索引统计耗时，语句数量在构造时确定，记录无锁且不分配内存
+     */
+    class StatementMetrics
+    {
+    public:
+        explicit StatementMetrics(std::size_t stmtCount);
+
+        void RecordQueueWait(uint32_t index, std::chrono::steady_clock::duration latency);
+        void RecordExecute(uint32_t index, std::chrono::steady_clock::duration latency);
+        void RecordDecode(uint32_t index, std::chrono::steady_clock::duration latency);
+
+        [[nodiscard]] std::size_t GetStatementCount() const
+        {
+            return _stmtCount;
+        }
+
+        /**
+         * @brief 将有样本的语句合并到snapshots中，按语句索引升序
+         *
+         * @param snapshots 已有的快照，须按语句索引升序，多个连接的统计依次合并到同一结果
+         */
+        void MergeInto(std::vector<StatementLatencySnapshot> &snapshots) const;
+
+    private:
+        struct Histograms
+        {
+            Metrics::Histogram queueWait {Metrics::MICROSECOND_UNIT};
+            Metrics::Histogram execute {Metrics::MICROSECOND_UNIT};
+            Metrics::Histogram decode {Metrics::MICROSECOND_UNIT};
+        };
+
+        std::unique_ptr<Histograms[]> _pHistograms;
+        std::size_t                   _stmtCount;
+    };
+} // namespace Database
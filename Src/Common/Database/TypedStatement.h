@@ -0,0 +1,233 @@
+﻿/*************************************************************************
+> File Name       : TypedStatement.h
+> Brief           : 编译期类型化预处理语句
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年02月26日  10时12分35秒
+************************************************************************/
+#pragma once
+
+#include "DatabaseEnv.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace Database
+{
+    // 预处理语句参数类型列表
+    template <typename... Types>
+    struct Params
+    {
+    };
+
+    // 预处理语句结果列类型列表
+    template <typename... Types>
+    struct Row
+    {
+    };
+
+    namespace Detail
+    {
+        // clang-format off
+
+        // C++类型与参数类型映射，未特化的类型无法作为参数或结果列
+        template <typename T>
+        struct SqlArgTypeOf{};
+
+        template <>
+        struct SqlArgTypeOf<bool> : std::integral_constant<SqlArgType, SqlArgType::Bool>{};
+
+        template <>
+        struct SqlArgTypeOf<uint8_t> : std::integral_constant<SqlArgType, SqlArgType::Uint8>{};
+
+        template <>
+        struct SqlArgTypeOf<uint16_t> : std::integral_constant<SqlArgType, SqlArgType::Uint16>{};
+
+        template <>
+        struct SqlArgTypeOf<uint32_t> : std::integral_constant<SqlArgType, SqlArgType::Uint32>{};
+
+        template <>
+        struct SqlArgTypeOf<uint64_t> : std::integral_constant<SqlArgType, SqlArgType::Uint64>{};
+
+        template <>
+        struct SqlArgTypeOf<int8_t> : std::integral_constant<SqlArgType, SqlArgType::Int8>{};
+
+        template <>
+        struct SqlArgTypeOf<int16_t> : std::integral_constant<SqlArgType, SqlArgType::Int16>{};
+
+        template <>
+        struct SqlArgTypeOf<int32_t> : std::integral_constant<SqlArgType, SqlArgType::Int32>{};
+
+        template <>
+        struct SqlArgTypeOf<int64_t> : std::integral_constant<SqlArgType, SqlArgType::Int64>{};
+
+        template <>
+        struct SqlArgTypeOf<float> : std::integral_constant<SqlArgType, SqlArgType::Float>{};
+
+        template <>
+        struct SqlArgTypeOf<double> : std::integral_constant<SqlArgType, SqlArgType::Double>{};
+
+        template <>
+        struct SqlArgTypeOf<std::string> : std::integral_constant<SqlArgType, SqlArgType::String>{};
+
+        template <>
+        struct SqlArgTypeOf<std::string_view> : std::integral_constant<SqlArgType, SqlArgType::String>{};
+
+        template <>
+        struct SqlArgTypeOf<std::vector<uint8_t>> : std::integral_constant<SqlArgType, SqlArgType::Binary>{};
+
+        // clang-format on
+
+        // 异步执行时参数须由任务持有，视图类型转为对应的持有类型
+        template <typename T>
+        using OwnedParamType = std::conditional_t<std::is_same_v<T, std::string_view>, std::string, T>;
+
+        /**
+         * @brief 实参能否无损传给参数
+         *        数值参数只接受数值实参，且须能列表初始化，即不能缩窄、不能在有符号与无符号间转换、
+         *        不能由浮点转为整数，bool只与bool对应；字符串、二进制参数须能隐式转换
+         */
+        template <typename Arg, typename Param>
+        constexpr bool IsLosslessParam()
+        {
+            using ArgType = std::remove_cvref_t<Arg>;
+            if constexpr (std::is_arithmetic_v<Param>)
+            {
+                return std::is_arithmetic_v<ArgType> &&
+                       std::is_same_v<ArgType, bool> == std::is_same_v<Param, bool> &&
+                       requires(ArgType value) { Param {value}; };
+            }
+            else
+            {
+                return !std::is_arithmetic_v<ArgType> && std::is_convertible_v<Arg, Param>;
+            }
+        }
+
+        template <typename Tuple, typename... Args>
+        struct IsLosslessParams : std::false_type
+        {
+        };
+
+        template <typename... ParamTypes, typename... Args>
+            requires(sizeof...(ParamTypes) == sizeof...(Args))
+        struct IsLosslessParams<std::tuple<ParamTypes...>, Args...>
+            : std::bool_constant<(IsLosslessParam<Args, ParamTypes>() && ...)>
+        {
+        };
+
+        template <typename ResultType, typename Tuple>
+        struct IsConstructibleFromRow : std::false_type
+        {
+        };
+
+        template <typename ResultType, typename... ColumnTypes>
+        struct IsConstructibleFromRow<ResultType, std::tuple<ColumnTypes...>>
+            : std::bool_constant<std::is_constructible_v<ResultType, ColumnTypes &&...>>
+        {
+        };
+
+        template <typename T>
+        SqlBindValue MakeBindValue(const T &value)
+        {
+            if constexpr (SqlArgTypeOf<T>::value == SqlArgType::String ||
+                          SqlArgTypeOf<T>::value == SqlArgType::Binary)
+            {
+                return {SqlArgTypeOf<T>::value, value.data(), static_cast<uint32_t>(value.size())};
+            }
+            else
+            {
+                return {SqlArgTypeOf<T>::value, &value, sizeof(T)};
+            }
+        }
+
+        template <typename T>
+        SqlResultBind MakeResultBind(T &value)
+        {
+            if constexpr (SqlArgTypeOf<T>::value == SqlArgType::String ||
+                          SqlArgTypeOf<T>::value == SqlArgType::Binary)
+            {
+                return {SqlArgTypeOf<T>::value, &value, 0};
+            }
+            else
+            {
+                return {SqlArgTypeOf<T>::value, &value, sizeof(T)};
+            }
+        }
+
+        /**
+         * @brief 生成参数绑定描述，只引用params中的数据，不产生堆分配
+         */
+        template <typename... Types>
+        std::array<SqlBindValue, sizeof...(Types)> MakeBindValues(const std::tuple<Types...> &params)
+        {
+            return std::apply(
+                [](const auto &...values) {
+                    return std::array<SqlBindValue, sizeof...(Types)> {MakeBindValue(values)...};
+                },
+                params);
+        }
+
+        /**
+         * @brief 生成结果列绑定描述，每拉取一行，列值直接写入row
+         */
+        template <typename... Types>
+        std::array<SqlResultBind, sizeof...(Types)> MakeResultBinds(std::tuple<Types...> &row)
+        {
+            return std::apply(
+                [](auto &...values) {
+                    return std::array<SqlResultBind, sizeof...(Types)> {MakeResultBind(values)...};
+                },
+                row);
+        }
+    } // namespace Detail
+
+    template <typename T>
+    concept SqlParamType = requires { Detail::SqlArgTypeOf<T>::value; };
+
+    // 结果列须持有数据，不能使用视图类型
+    template <typename T>
+    concept SqlColumnType = SqlParamType<T> && !std::is_same_v<T, std::string_view>;
+
+    template <auto StmtID, typename ParamList, typename RowList>
+    struct Stmt;
+
+    /**
+     * @brief 类型化预处理语句定义，参数与结果列类型在编译期确定
+     *        例：using LoginSelAccountByEmail = Stmt<LOGIN_SEL_ACCOUNT_BY_EMAIL,
+     *                                              Params<std::string_view>,
+     *                                              Row<uint32_t, std::string>>;
+     */
+    template <auto StmtID, SqlParamType... ParamTypes, SqlColumnType... ColumnTypes>
+    struct Stmt<StmtID, Params<ParamTypes...>, Row<ColumnTypes...>>
+    {
+        static constexpr uint32_t    ID           = static_cast<uint32_t>(StmtID);
+        static constexpr std::size_t PARAM_COUNT  = sizeof...(ParamTypes);
+        static constexpr std::size_t COLUMN_COUNT = sizeof...(ColumnTypes);
+
+        using ParamTuple      = std::tuple<ParamTypes...>;
+        using OwnedParamTuple = std::tuple<Detail::OwnedParamType<ParamTypes>...>;
+        using RowType         = std::tuple<ColumnTypes...>;
+
+        // 预处理时与语句的sql定义及结果元数据比对，见IMySqlConnection::CheckTypedStatement
+        static constexpr std::array<SqlArgType, PARAM_COUNT> PARAM_TYPES {
+            Detail::SqlArgTypeOf<ParamTypes>::value...};
+        static constexpr std::array<SqlArgType, COLUMN_COUNT> COLUMN_TYPES {
+            Detail::SqlArgTypeOf<ColumnTypes>::value...};
+    };
+
+    // 实参个数须与语句定义一致，且每个实参都能无损传给对应的参数
+    template <typename StmtType, typename... Args>
+    concept StmtInvocable = (sizeof...(Args) == StmtType::PARAM_COUNT) &&
+                            Detail::IsLosslessParams<typename StmtType::ParamTuple, Args...>::value;
+
+    // 结果类型须能由整行各列构造，可以是RowType本身或按列顺序声明成员的结构体
+    template <typename StmtType, typename ResultType>
+    concept StmtRowMappable = Detail::IsConstructibleFromRow<ResultType, typename StmtType::RowType>::value;
+
+} // namespace Database
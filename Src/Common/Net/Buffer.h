@@ -10,6 +10,7 @@
 
 #include <vector>
 #include <cassert>
+#include <cstring>
 #include <string>
 
 namespace Net
@@ -27,9 +28,10 @@ namespace Net
 
         MessageBuffer(const MessageBuffer &buffer) = default;
 
-        MessageBuffer &operator=(MessageBuffer buffer)
+        MessageBuffer &operator=(const MessageBuffer &buffer)
         {
-            swap(buffer);
+            MessageBuffer copy(buffer);
+            swap(copy);
             return *this;
         }
 
@@ -317,14 +319,14 @@ namespace Net
          */
         void MakeSpace(size_t len)
         {
-            if (WritableBytes() < len)
+            if (WritableBytes() + _readIndex < len)
             {
-                // 可写的空间不足，扩容
+                // 加上已读出的前缀仍不足，扩容
                 _buffer.resize(_writeIndex + len);
             }
             else
             {
-                // 前缀空余过多，调整
+                // 前缀空余足够，把未读数据前移，避免缓冲区无限增长
                 // assert(CHEAP_PREPEND < _readIndex);
                 const size_t readableBytes = ReadableBytes();
                 std::copy(GetReadPointer(), GetWritPointer(), _buffer.data());
@@ -55,7 +55,8 @@ namespace Http
             return {{header.name, header.name_len}, {header.value, header.value_len}};
         };
 
-        for (size_t i = 0; i < headers.size(); ++i)
+        // 只拷贝实际解析出的头部，GetHeaderValue也只在这个范围内查找
+        for (size_t i = 0; i < _numHeaders; ++i)
         {
             _headers[i] = toHttpHeader(headers[i]);
         }
@@ -94,6 +95,11 @@ namespace Http
                                         headers.data(),
                                         &_numHeaders,
                                         0);
+        for (size_t i = 0; i < _numHeaders; ++i)
+        {
+            _headers[i] = {{headers[i].name, headers[i].name_len}, {headers[i].value, headers[i].value_len}};
+        }
+
         _msg                        = {msg, msgLen};
         std::string_view contentLen = GetHeaderValue("content-length"sv);
         _bodyLen                    = Util::StringTo<int>(contentLen).value_or(0);
@@ -119,23 +125,20 @@ namespace Http
         std::string_view val;
         size_t           length = str.length();
         size_t           pos    = 0;
-        for (size_t i = 0; i < length; ++i)
+        for (size_t i = Util::FindFirstOf(str, '=', '&'); i != std::string_view::npos;
+             i = Util::FindFirstOf(str, '=', '&', i + 1))
         {
-            char chr = str[i];
-            if (chr == '=')
+            if (str[i] == '=')
             {
-                key = {&str[pos], i - pos};
-                key = TrimSpace(key);
-                pos = i + 1;
+                key = Util::TrimSpace(str.substr(pos, i - pos));
             }
-            else if (chr == '&')
+            else
             {
-                val = {&str[pos], i - pos};
-                val = TrimSpace(val);
+                val = Util::TrimSpace(str.substr(pos, i - pos));
                 _queries.emplace(key, val);
-
-                pos = i + 1;
             }
+
+            pos = i + 1;
         }
 
         if (pos == 0)
@@ -145,8 +148,7 @@ namespace Http
 
         if ((length - pos) > 0)
         {
-            val = {&str[pos], length - pos};
-            val = TrimSpace(val);
+            val = Util::TrimSpace(str.substr(pos));
             _queries.try_emplace(key, val);
         }
         else if ((length - pos) == 0)
@@ -157,11 +159,11 @@ namespace Http
 
     [[nodiscard]] std::string_view HttpParser::GetHeaderValue(std::string_view key) const
     {
-        for (auto &&header : _headers)
+        for (size_t i = 0; i < _numHeaders; ++i)
         {
-            if (Util::StringEqual(header.first, key))
+            if (Util::StringEqual(_headers[i].first, key))
             {
-                return header.second;
+                return _headers[i].second;
             }
         }
 
@@ -183,11 +185,18 @@ namespace Http
         return _minorVersion;
     }
 
-    std::string_view HttpParser::TrimSpace(std::string_view str)
+    [[nodiscard]] size_t HttpParser::HeaderLength() const
     {
-        str.remove_prefix((std::min)(str.find_first_not_of(' '), str.size()));
-        str.remove_suffix((std::min)(str.size() - str.find_last_not_of(' ') - 1, str.size()));
+        return _headerLen > 0 ? static_cast<size_t>(_headerLen) : 0;
+    }
 
-        return str;
+    [[nodiscard]] size_t HttpParser::BodyLength() const
+    {
+        return _bodyLen > 0 ? static_cast<size_t>(_bodyLen) : 0;
+    }
+
+    [[nodiscard]] int HttpParser::Status() const
+    {
+        return _status;
     }
 } // namespace Http
\ No newline at end of file
@@ -25,9 +25,9 @@ namespace Http
         [[nodiscard]] std::string_view Method() const;
         [[nodiscard]] std::string_view Path() const;
         [[nodiscard]] int8_t           MinorVersion() const;
-
-    private:
-        std::string_view TrimSpace(std::string_view str);
+        [[nodiscard]] size_t           HeaderLength() const; // 请求行(状态行)与头部的字节数
+        [[nodiscard]] size_t           BodyLength() const;   // 由Content-Length给出的包体字节数
+        [[nodiscard]] int              Status() const;       // 响应状态码，仅ParseResponse有效
 
     private:
         // HeaderField <-> HeaderValue
@@ -61,4 +61,9 @@ namespace Http
         // todo 实现？
         return {};
     }
+
+    [[nodiscard]] size_t HttpRequest::GetRequestLength() const
+    {
+        return _parser.HeaderLength() + _parser.BodyLength();
+    }
 } // namespace Http
\ No newline at end of file
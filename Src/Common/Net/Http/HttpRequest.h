@@ -30,6 +30,9 @@ namespace Http
         [[nodiscard]] std::string_view GetHeader(std::string_view headerType) const;
         [[nodiscard]] std::string_view GetBody() const;
 
+        // 请求行、头部与请求体的总字节数，content中有多个流水线请求时据此定位下一个请求
+        [[nodiscard]] size_t GetRequestLength() const;
+
     private:
         HttpParser _parser;
     };
@@ -60,6 +60,16 @@ namespace Http
         _content     = content;
     }
 
+    void HttpResponse::Reset()
+    {
+        _statusCode  = StatusCode::Unknown;
+        _contentType = ContentType::String;
+        _charset     = "UTF-8";
+        _head.clear();
+        _content.clear();
+        _headers.clear();
+    }
+
     void HttpResponse::BuildResponseHead()
     {
         if (std::find_if(_headers.begin(),
@@ -86,7 +96,16 @@ namespace Http
             _headers.emplace_back("Content-Length", Util::ToString(_content.size()));
         }
 
-        _headers.emplace_back("Date", TimeUtil::GetGMTTimeStr());
+        // 会话已设置的Date(如缓存时钟的时间)优先，否则按当前时间生成
+        if (std::find_if(_headers.begin(),
+                         _headers.end(),
+                         [](ResponseHeader &header) {
+                             return header.first == "Date";
+                         })
+            == _headers.end())
+        {
+            _headers.emplace_back("Date", TimeUtil::GetGMTTimeStr());
+        }
 
         _head.append(StatusToResponseHead(_statusCode));
         for (auto &[k, v] : _headers)
@@ -33,6 +33,9 @@ namespace Http
 
         void FillResponse(StatusCode statusCode, ContentType type, std::string_view content);
 
+        // 恢复为未设置任何内容的状态，保留已分配的内存，同一会话处理下一个请求前调用
+        void Reset();
+
     private:
         void BuildResponseHead();
 
@@ -9,6 +9,7 @@
 #include "HttpRouter.h"
 #include "HttpUtil.h"
 #include "Common/Util/Log.h"
+#include "Common/Util/Metrics.h"
 #include "HttpCommon.h"
 
 #include <format>
@@ -64,4 +65,11 @@ namespace Http
 
         _httpHandlers.emplace(*it, std::move(handler));
     }
+
+    void HttpRouter::AddMetricsHandler(std::string_view path)
+    {
+        AddHttpHandler(HttpMethod::Get, path, [](const HttpRequest & /*req*/, HttpResponse &resp) {
+            resp.FillResponse(StatusCode::Ok, ContentType::String, Metrics::ExportPrometheus());
+        });
+    }
 } // namespace Http
\ No newline at end of file
@@ -35,6 +35,13 @@ namespace Http
          */
         void AddHttpHandler(HttpMethod method, std::string_view path, HttpHandlerFunc handler);
 
+        /**
+         * @brief 注册以Prometheus文本格式导出运行时指标的GET处理函数
+         *
+         * @param path 路径
+         */
+        void AddMetricsHandler(std::string_view path = "/metrics");
+
     private:
         std::unordered_map<std::string_view, HttpHandlerFunc> _httpHandlers;
         std::set<std::string>                                 _pathKeys;
@@ -0,0 +1,49 @@
+﻿/*************************************************************************
+> File Name       : Packet.h
+> Brief           : 二进制消息帧
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年10月15日  10时12分37秒
+************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Net
+{
+    // 消息帧为4字节小端序的包体长度加包体，对应NetMessage.proto中Message的header与content
+    constexpr size_t   PACKET_HEADER_SIZE   = sizeof(uint32_t);
+    constexpr uint32_t MAX_PACKET_BODY_SIZE = 1024 * 1024; // 超过该长度视为非法数据，关闭连接
+
+    /**
+     * @brief 写入包头
+     *
+     * @param pHeader 至少PACKET_HEADER_SIZE字节
+     * @param bodySize 包体字节数
+     */
+    inline void WritePacketHeader(uint8_t *pHeader, uint32_t bodySize)
+    {
+        for (size_t i = 0; i < PACKET_HEADER_SIZE; ++i)
+        {
+            pHeader[i] = static_cast<uint8_t>(bodySize >> (i * 8));
+        }
+    }
+
+    /**
+     * @brief 读取包头
+     *
+     * @param pHeader 至少PACKET_HEADER_SIZE字节
+     * @return 包体字节数
+     */
+    inline uint32_t ReadPacketHeader(const uint8_t *pHeader)
+    {
+        uint32_t bodySize = 0;
+        for (size_t i = 0; i < PACKET_HEADER_SIZE; ++i)
+        {
+            bodySize |= static_cast<uint32_t>(pHeader[i]) << (i * 8);
+        }
+        return bodySize;
+    }
+} // namespace Net
@@ -8,6 +8,9 @@
 ************************************************************************/
 #include "Server.h"
 #include "Common/Util/Log.h"
+#include "Common/Util/CachedClock.h"
+#include "Common/Util/Profiler.h"
+#include "Common/Util/Util.h"
 #include "Session.h"
 
 namespace Net
@@ -19,12 +22,15 @@ namespace Net
         , _listenEndPoint(Asio::make_address(ip), port)
         , _acceptor(_netIoCtx, _listenEndPoint)
         , _updateTimer(_logicIoCtx)
+        , _sessionGauge(Metrics::GetGauge("net_sessions", "当前会话数"))
+        , _acceptCounter(Metrics::GetCounter("net_accepted_total", "接受的连接数"))
+        , _tickHistogram(Metrics::GetHistogram("server_tick_duration_seconds", "逻辑线程每次Update的耗时"))
     {
     }
 
     IServer::~IServer()
     {
-        Log::Debug("~IServer");
+        LOG_DEBUG(Net, "~IServer");
         if (_netThread.joinable())
         {
             _netThread.join();
@@ -37,10 +43,11 @@ namespace Net
             // 启动网络协程
             try
             {
+                Profiler::SetThreadName("Net");
                 // _signals.add(SIGINT);
                 _signals.add(SIGTERM);
                 _signals.async_wait([this](const std::error_code &errcode, int signal) {
-                    Log::Debug("signal:{}", signal);
+                    LOG_DEBUG(Net, "signal:{}", signal);
                     _netIoCtx.stop();
                 });
 
@@ -65,13 +72,12 @@ namespace Net
             _updateTimer.async_wait([this](const std::error_code &errcode) {
                 Update();
             });
-            std::stringstream ss;
-            ss << std::this_thread::get_id();
-            Log::Debug("逻辑线程启动：{}", ss.str());
+            LOG_DEBUG(Net, "逻辑线程启动：{}", Util::GetCurrentThreadIdString());
+            Profiler::SetThreadName("Logic");
             // auto wg =
             //     asio::require(_logicIoCtx.get_executor(), asio::execution::outstanding_work.tracked);
             _logicIoCtx.run();
-            Log::Debug("logic thread stoping.....");
+            LOG_DEBUG(Net, "logic thread stoping.....");
         }
         catch (const std::exception &e)
         {
@@ -92,29 +98,41 @@ namespace Net
 
     void IServer::Update()
     {
+        PROFILE_SCOPE("IServer::Update");
+
         using namespace std::chrono_literals;
         _updateTimer.expires_from_now(1ms);
         _updateTimer.async_wait([this](const std::error_code &errcode) {
             Update();
         });
 
+        // 缓存时钟与时间轮随逻辑帧推进，会话超时、延时事件等定时器批量到期
+        TimeUtil::CachedClock::Update();
+        _timerWheel.Advance(TimeUtil::CachedClock::GetSteadyTime());
+
+        // 没有会话的空转不计入耗时分布
         if (_sessions.empty())
         {
             return;
         }
 
+        const auto tickBegin = std::chrono::steady_clock::now();
+
         std::lock_guard lock(_mutex);
         _sessions.erase(std::remove_if(_sessions.begin(),
                                        _sessions.end(),
                                        [](const std::shared_ptr<ISession> &pSession) {
                                            if (!pSession->Update())
                                            {
+                                               pSession->DisarmIdleTimeout();
                                                pSession->CloseSession();
                                                return true;
                                            }
                                            return false;
                                        }),
                         _sessions.end());
+        _sessionGauge.Set(static_cast<int64_t>(_sessions.size()));
+        _tickHistogram.Record(std::chrono::steady_clock::now() - tickBegin);
     }
 
     asio::awaitable<void> IServer::AcceptLoop()
@@ -128,6 +146,7 @@ namespace Net
                 co_return;
             }
 
+            _acceptCounter.Increment();
             auto pSession = CreateSession(std::move(socket));
             AddNewSession(pSession);
             OnSessionCreated(pSession);
@@ -139,11 +158,24 @@ namespace Net
     {
         std::lock_guard lock(_mutex);
         _sessions.emplace_back(pNewSession);
+        _sessionGauge.Set(static_cast<int64_t>(_sessions.size()));
+
+        // 在网络线程接受连接，时间轮只能在逻辑线程访问
+        if (_sessionIdleTimeout.count() > 0)
+        {
+            asio::post(_logicIoCtx, [this, pNewSession]() {
+                if (pNewSession->IsAlive())
+                {
+                    pNewSession->ArmIdleTimeout(_timerWheel, _sessionIdleTimeout);
+                }
+            });
+        }
     }
 
     void IServer::RemoveSession(std::shared_ptr<ISession> pSession)
     {
         std::lock_guard lock(_mutex);
         _sessions.erase(std::remove(_sessions.begin(), _sessions.end(), pSession), _sessions.end());
+        _sessionGauge.Set(static_cast<int64_t>(_sessions.size()));
     }
 } // namespace Net
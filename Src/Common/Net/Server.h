@@ -9,6 +9,8 @@
 #pragma once
 #include "Asio.h"
 #include "Session.h"
+#include "Common/Util/Metrics.h"
+#include "Common/Util/TimerWheel.h"
 
 namespace Net
 {
@@ -27,6 +29,27 @@ namespace Net
         void Start();
         virtual void Stop();
 
+        // 会话的空闲超时，为0时不启用，需在Start之前设置
+        void SetSessionIdleTimeout(std::chrono::milliseconds timeout)
+        {
+            _sessionIdleTimeout = timeout;
+        }
+
+        /**
+         * @brief 新会话读写队列各自的容量，需在Start之前设置
+         *        逻辑线程处理不及或客户端不读取回复，导致任一队列满时，会话被关闭而不是无限积压
+         */
+        void SetSessionQueueCapacity(std::size_t capacity)
+        {
+            _sessionQueueCapacity = capacity;
+        }
+
+        // 逻辑线程的时间轮，用于buff到期、延时事件等，只能在逻辑线程访问
+        TimeUtil::TimerWheel &GetTimerWheel()
+        {
+            return _timerWheel;
+        }
+
     protected:
         virtual void Update();
         virtual std::shared_ptr<ISession> CreateSession(Asio::socket&& socket) = 0;
@@ -47,5 +70,12 @@ namespace Net
         Asio::acceptor                               _acceptor;
         Asio::steady_timer                           _updateTimer;
         std::vector<std::shared_ptr<ISession>>      _sessions;
+        TimeUtil::TimerWheel                        _timerWheel;
+        std::chrono::milliseconds                   _sessionIdleTimeout {0};
+        std::size_t                                 _sessionQueueCapacity {DEFAULT_SESSION_QUEUE_CAPACITY};
+
+        Metrics::Gauge     &_sessionGauge;
+        Metrics::Counter   &_acceptCounter;
+        Metrics::Histogram &_tickHistogram;
     };
 } // namespace Net
@@ -7,17 +7,49 @@
 > Created Time    : 2024年01月08日  16时51分30秒
 ************************************************************************/
 #include "Session.h"
+#include "Common/Coroutine/FrameAllocator.h"
 #include "Common/Util/Log.h"
+#include "Common/Util/Metrics.h"
 
 // #include "NetMessage.pb.h"
 
 namespace Net
 {
-    ISession::ISession(asio::ip::tcp::socket &&socket)
+    namespace
+    {
+        // 所有会话共用的指标，首次使用时注册
+        struct SessionMetrics
+        {
+            Metrics::Counter &bytesReceived;
+            Metrics::Counter &bytesSent;
+            Metrics::Counter &socketReads;
+            Metrics::Counter &messagesSent;
+            Metrics::Gauge   &readQueueDepth;
+            Metrics::Gauge   &writeQueueDepth;
+        };
+
+        SessionMetrics &GetSessionMetrics()
+        {
+            static SessionMetrics metrics {
+                .bytesReceived    = Metrics::GetCounter("net_received_bytes_total", "网络会话接收的字节数"),
+                .bytesSent        = Metrics::GetCounter("net_sent_bytes_total", "网络会话发送的字节数"),
+                .socketReads      = Metrics::GetCounter("net_socket_reads_total", "网络会话读取套接字的次数"),
+                .messagesSent     = Metrics::GetCounter("net_sent_messages_total", "网络会话发送的消息数"),
+                .readQueueDepth   = Metrics::GetGauge("net_read_queue_depth", "待逻辑线程处理的消息数"),
+                .writeQueueDepth  = Metrics::GetGauge("net_write_queue_depth", "待发送的消息数"),
+            };
+            return metrics;
+        }
+    } // namespace
+
+    ISession::ISession(asio::ip::tcp::socket &&socket,
+                       std::size_t queueCapacity /*= DEFAULT_SESSION_QUEUE_CAPACITY*/)
         : _socket(std::move(socket))
         , _remoteAddress(_socket.remote_endpoint().address())
         , _timer(_socket.get_executor())
         , _remotePort(_socket.remote_endpoint().port())
+        , _readBufferQueue(queueCapacity)
+        , _writeBufferQueue(queueCapacity)
         , _closed(false)
         , _closing(false)
     {
@@ -26,6 +58,11 @@ namespace Net
 
     ISession::~ISession()
     {
+        // 会话销毁时队列中剩余的消息不再处理
+        SessionMetrics &metrics = GetSessionMetrics();
+        metrics.readQueueDepth.Sub(static_cast<int64_t>(_readBufferQueue.Size()));
+        metrics.writeQueueDepth.Sub(static_cast<int64_t>(_writeBufferQueue.Size()));
+
         if (_closed)
         {
             return;
@@ -37,8 +74,21 @@ namespace Net
 
     void ISession::StartSession()
     {
-        asio::co_spawn(_socket.get_executor(), ReadLoop(), asio::detached);
-        asio::co_spawn(_socket.get_executor(), WriteLoop(), asio::detached);
+        // 会话频繁建立与断开，co_spawn的状态与完成回调从线程本地的帧缓存中分配
+        // 读写协程各持有会话的引用，逻辑线程移除会话后，会话在两个协程都结束时才销毁
+        const auto token = asio::bind_allocator(Coroutine::FrameRecyclingAllocator<void> {}, asio::detached);
+        asio::co_spawn(
+            _socket.get_executor(),
+            [self = shared_from_this()]() {
+                return self->ReadLoop();
+            },
+            token);
+        asio::co_spawn(
+            _socket.get_executor(),
+            [self = shared_from_this()]() {
+                return self->WriteLoop();
+            },
+            token);
     }
 
 
@@ -58,18 +108,73 @@ namespace Net
                        error.value(),
                        error.message());
         }
+
+        WakeUpWriteLoop();
+    }
+
+    void ISession::WakeUpWriteLoop()
+    {
+        // 在网络线程上取消等待，与发送协程的出队和等待串行执行，不会在两者之间丢失唤醒
+        asio::post(_socket.get_executor(), [self = shared_from_this()]() {
+            self->_timer.cancel_one();
+        });
     }
 
     bool ISession::Update()
     {
         MessageBuffer buffer;
+        bool          bReceived = false;
         while (_readBufferQueue.Pop(buffer))
         {
+            GetSessionMetrics().readQueueDepth.Sub();
             OnMessageReceived(buffer);
+            bReceived = true;
+        }
+
+        // 每次Update最多推迟一次，在时间轮上只是链表节点的移动
+        if (bReceived && nullptr != _pTimerWheel)
+        {
+            _pTimerWheel->Reschedule(_idleTimerId, _idleTimeout);
         }
         return !_closed;
     }
 
+    void ISession::ArmIdleTimeout(TimeUtil::TimerWheel &timerWheel, std::chrono::milliseconds timeout)
+    {
+        DisarmIdleTimeout();
+
+        _pTimerWheel = &timerWheel;
+        _idleTimeout = timeout;
+        _idleTimerId = timerWheel.Schedule(timeout, [pWeakSession = weak_from_this()]() {
+            std::shared_ptr<ISession> pSession = pWeakSession.lock();
+            if (nullptr == pSession)
+            {
+                return;
+            }
+
+            pSession->_pTimerWheel = nullptr;
+            pSession->_idleTimerId = TimeUtil::TimerWheel::INVALID_TIMER_ID;
+            Log::Info("网络会话空闲超时，IP:{}", pSession->GetRemoteIpAddress());
+
+            // 时间轮在逻辑线程上推进，不能直接操作socket，交由网络线程关闭
+            asio::post(pSession->_socket.get_executor(), [pSession]() {
+                pSession->CloseSession();
+            });
+        });
+    }
+
+    void ISession::DisarmIdleTimeout()
+    {
+        if (nullptr == _pTimerWheel)
+        {
+            return;
+        }
+
+        _pTimerWheel->Cancel(_idleTimerId);
+        _pTimerWheel = nullptr;
+        _idleTimerId = TimeUtil::TimerWheel::INVALID_TIMER_ID;
+    }
+
     void ISession::SendMessage(const MessageBuffer &message)
     {
         if (message.ReadableBytes() <= 0)
@@ -77,8 +182,17 @@ namespace Net
             return;
         }
 
-        _writeBufferQueue.Push(message);
-        _timer.cancel_one();
+        // 在逻辑线程调用，不能直接操作socket，交由网络线程关闭
+        if (!_writeBufferQueue.Push(message))
+        {
+            Log::Error("发送队列已满，关闭网络会话，IP:{}", GetRemoteIpAddress());
+            asio::post(_socket.get_executor(), [self = shared_from_this()]() {
+                self->CloseSession();
+            });
+            return;
+        }
+        GetSessionMetrics().writeQueueDepth.Add();
+        WakeUpWriteLoop();
     }
 
     asio::awaitable<void> ISession::ReadLoop()
@@ -86,11 +200,11 @@ namespace Net
         while (true)
         {
             MessageBuffer _buffer;
-            Log::Debug("readLoop {}, {}", _buffer.ReadableBytes(), _buffer.WritableBytes());
+            LOG_DEBUG(Net, "readLoop {}, {}", _buffer.ReadableBytes(), _buffer.WritableBytes());
             auto [errcode, length] = co_await _socket.async_read_some(
                 asio::buffer(_buffer.GetWritPointer(), _buffer.WritableBytes()));
 
-            Log::Debug("after readLoop:{}", length);
+            LOG_DEBUG(Net, "after readLoop:{}", length);
             if (errcode)
             {
                 if (errcode != asio::error::eof)
@@ -104,7 +218,17 @@ namespace Net
             }
 
             _buffer.WriteDone(length);
-            _readBufferQueue.Push(std::move(_buffer));
+            if (!_readBufferQueue.Push(std::move(_buffer)))
+            {
+                Log::Error("接收队列已满，关闭网络会话，IP:{}", GetRemoteIpAddress());
+                CloseSession();
+                co_return;
+            }
+
+            SessionMetrics &metrics = GetSessionMetrics();
+            metrics.bytesReceived.Increment(length);
+            metrics.socketReads.Increment();
+            metrics.readQueueDepth.Add();
         }
     }
 
@@ -113,8 +237,12 @@ namespace Net
         while (_socket.is_open())
         {
             MessageBuffer packet;
-            Log::Debug("Write");
-            if (!_writeBufferQueue.Pop(packet))
+            LOG_DEBUG(Net, "Write");
+            if (_writeBufferQueue.Pop(packet))
+            {
+                GetSessionMetrics().writeQueueDepth.Sub();
+            }
+            else
             {
                 std::error_code errcode;
                 co_await _timer.async_wait(asio::redirect_error(asio::use_awaitable, errcode));
@@ -129,6 +257,9 @@ namespace Net
 
             if (_closed)
             {
+                // 关闭socket使读协程退出，会话随之销毁
+                std::error_code                  errcode;
+                [[maybe_unused]] std::error_code ret = _socket.close(errcode);
                 co_return;
             }
 
@@ -141,6 +272,14 @@ namespace Net
                 Log::Error("发送消息失败：{}", errcode.message());
                 co_return;
             }
+
+            // 等待被唤醒时队列可能仍为空，此时没有实际发送
+            if (length > 0)
+            {
+                SessionMetrics &metrics = GetSessionMetrics();
+                metrics.bytesSent.Increment(length);
+                metrics.messagesSent.Increment();
+            }
         }
     }
 } // namespace Net
@@ -12,9 +12,13 @@
 #include "Buffer.h"
 #include "Asio.h"
 #include "Common/Util/ProducerConsumerQueue.hpp"
+#include "Common/Util/TimerWheel.h"
 
 namespace Net
 {
+    // 会话读写队列的默认容量(消息数)
+    constexpr std::size_t DEFAULT_SESSION_QUEUE_CAPACITY = 256;
+
     class ISession : public std::enable_shared_from_this<ISession>
     {
     public:
@@ -23,7 +27,14 @@ namespace Net
         ISession &operator=(const ISession &) = delete;
         ISession &operator=(ISession &&)      = delete;
 
-        explicit ISession(asio::ip::tcp::socket &&socket);
+        /**
+         * @brief 构造会话
+         *
+         * @param socket 已连接的socket
+         * @param queueCapacity 读写队列各自的容量，任一队列满时关闭会话
+         */
+        explicit ISession(asio::ip::tcp::socket &&socket,
+                          std::size_t             queueCapacity = DEFAULT_SESSION_QUEUE_CAPACITY);
         virtual ~ISession();
 
         void StartSession();
@@ -37,6 +48,15 @@ namespace Net
         bool IsAlive() const { return !_closed && !_closing; }
         void DelayCloseSession() { _closing = true; }
 
+        /**
+         * @brief 在逻辑线程的时间轮上启用空闲超时，超过timeout没有收到消息的会话被关闭
+         *        只能在逻辑线程调用，收到消息时在Update中推迟
+         */
+        void ArmIdleTimeout(TimeUtil::TimerWheel &timerWheel, std::chrono::milliseconds timeout);
+
+        // 取消空闲超时，只能在逻辑线程调用
+        void DisarmIdleTimeout();
+
     protected:
         virtual void OnMessageReceived(MessageBuffer& buffer) = 0;
 
@@ -44,15 +64,25 @@ namespace Net
         asio::awaitable<void> ReadLoop();
         asio::awaitable<void> WriteLoop();
 
+        // 通知发送协程有新消息或会话已关闭，可在任意线程调用
+        void WakeUpWriteLoop();
+
     protected:
         Asio::socket _socket;
         Asio::address _remoteAddress;
         Asio::steady_timer _timer;
         uint16_t _remotePort;
+
+        // 积压超过容量时消息不入队，会话被关闭
         ProducerConsumerQueue<MessageBuffer> _readBufferQueue;
         ProducerConsumerQueue<MessageBuffer> _writeBufferQueue;
 
         std::atomic_bool _closed;
         std::atomic_bool _closing;
+
+        // 空闲超时，只在逻辑线程访问
+        TimeUtil::TimerWheel         *_pTimerWheel {nullptr};
+        TimeUtil::TimerWheel::TimerId _idleTimerId {TimeUtil::TimerWheel::INVALID_TIMER_ID};
+        std::chrono::milliseconds     _idleTimeout {0};
     };
 } // namespace Net
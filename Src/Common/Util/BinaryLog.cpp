@@ -0,0 +1,477 @@
+﻿/*************************************************************************
+> File Name       : BinaryLog.cpp
+> Brief           : 二进制结构化日志
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月12日  15时08分21秒
+************************************************************************/
+#include "BinaryLog.h"
+#include "Platform.h"
+
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#ifdef OS_PLATFORM_LINUX
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+#endif
+
+namespace Log
+{
+    namespace
+    {
+        struct SiteCacheKey
+        {
+            const char *format;
+            std::size_t formatSize;
+            const char *file;
+            uint32_t    line;
+
+            bool operator==(const SiteCacheKey &) const = default;
+        };
+
+        struct SiteCacheKeyHash
+        {
+            std::size_t operator()(const SiteCacheKey &key) const
+            {
+                const std::size_t hash = std::hash<const void *> {}(key.format);
+                return hash ^ (std::hash<const void *> {}(key.file) + 0x9E3779B9 + (hash << 6) + key.line);
+            }
+        };
+
+        // 线程本地的调用点缓存，格式串通常是字面量，按地址查找即可命中
+        struct SiteCache
+        {
+            uint32_t                                                                  generation {UINT32_MAX};
+            std::unordered_map<SiteCacheKey, const BinaryLogSite *, SiteCacheKeyHash> sites;
+        };
+
+        uint32_t GetCurrentThreadID()
+        {
+            thread_local const uint32_t threadID = []() {
+#ifdef OS_PLATFORM_WINDOWS
+                return static_cast<uint32_t>(::GetCurrentThreadId());
+#else
+                return static_cast<uint32_t>(::syscall(SYS_gettid));
+#endif
+            }();
+            return threadID;
+        }
+
+        std::string EscapeSiteField(std::string_view field)
+        {
+            std::string result;
+            result.reserve(field.size());
+            for (const char c : field)
+            {
+                switch (c)
+                {
+                    case '\\':
+                        result += "\\\\";
+                        break;
+                    case '\t':
+                        result += "\\t";
+                        break;
+                    case '\n':
+                        result += "\\n";
+                        break;
+                    case '\r':
+                        result += "\\r";
+                        break;
+                    default:
+                        result += c;
+                        break;
+                }
+            }
+            return result;
+        }
+
+        std::string UnescapeSiteField(std::string_view field)
+        {
+            std::string result;
+            result.reserve(field.size());
+            for (std::size_t i = 0; i < field.size(); ++i)
+            {
+                if (field[i] != '\\' || i + 1 == field.size())
+                {
+                    result += field[i];
+                    continue;
+                }
+
+                switch (field[++i])
+                {
+                    case 't':
+                        result += '\t';
+                        break;
+                    case 'n':
+                        result += '\n';
+                        break;
+                    case 'r':
+                        result += '\r';
+                        break;
+                    default:
+                        result += field[i];
+                        break;
+                }
+            }
+            return result;
+        }
+    } // namespace
+
+    std::string FormatBinaryLogSite(const BinaryLogSite &site)
+    {
+        return std::format("{}\t{}\t{}\t{}\t{}",
+                           site.id,
+                           site.line,
+                           EscapeSiteField(site.file),
+                           EscapeSiteField(site.function),
+                           EscapeSiteField(site.format));
+    }
+
+    std::optional<BinaryLogSite> ParseBinaryLogSite(std::string_view line)
+    {
+        std::string_view fields[5];
+        for (std::size_t i = 0; i < std::size(fields); ++i)
+        {
+            const std::size_t pos = line.find('\t');
+            if ((pos == std::string_view::npos) != (i + 1 == std::size(fields)))
+            {
+                return std::nullopt;
+            }
+
+            fields[i] = line.substr(0, pos);
+            line.remove_prefix(pos == std::string_view::npos ? line.size() : pos + 1);
+        }
+
+        auto parseNumber = [](std::string_view field, uint32_t &value) {
+            const auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+            return result.ec == std::errc {} && result.ptr == field.data() + field.size();
+        };
+
+        BinaryLogSite site;
+        if (!parseNumber(fields[0], site.id) || !parseNumber(fields[1], site.line))
+        {
+            return std::nullopt;
+        }
+
+        site.file     = UnescapeSiteField(fields[2]);
+        site.function = UnescapeSiteField(fields[3]);
+        site.format   = UnescapeSiteField(fields[4]);
+        return site;
+    }
+
+    BinaryLogger::~BinaryLogger()
+    {
+        // 退出时其他线程可能仍在写日志，只回写不解除映射，映射由系统回收
+        Flush();
+    }
+
+    bool BinaryLogger::Open(std::string_view fileName, uint64_t capacity)
+    {
+        Close();
+
+        capacity = AlignBinaryLogSize(std::max<uint64_t>(capacity, 4096));
+
+        const std::string strFileName(fileName);
+        if (!MapFile(strFileName, sizeof(BinaryLogFileHeader) + capacity))
+        {
+            std::fprintf(stderr, "BinaryLogger open %s failed\n", strFileName.c_str());
+            UnmapFile();
+            return false;
+        }
+
+        _pHeader  = reinterpret_cast<BinaryLogFileHeader *>(_pMapped);
+        _pData    = _pMapped + sizeof(BinaryLogFileHeader);
+        _capacity = capacity;
+
+        // 容量或版本不同的旧文件重新初始化，否则接着上次的位置写
+        const bool bReset = _pHeader->magic != BINARY_LOG_FILE_MAGIC
+                            || _pHeader->version != BINARY_LOG_VERSION || _pHeader->capacity != capacity;
+        if (bReset)
+        {
+            std::memset(_pHeader, 0, sizeof(BinaryLogFileHeader));
+            _pHeader->magic    = BINARY_LOG_FILE_MAGIC;
+            _pHeader->version  = BINARY_LOG_VERSION;
+            _pHeader->capacity = capacity;
+        }
+
+        {
+            std::lock_guard lock(_siteMutex);
+            _sites.clear();
+            _siteIndex.clear();
+            OpenSiteFile(strFileName + ".sites", bReset);
+        }
+
+        _generation.fetch_add(1, std::memory_order_release);
+        _bOpen.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void BinaryLogger::Close()
+    {
+        if (!_bOpen.exchange(false))
+        {
+            return;
+        }
+
+        // 等待已进入写入的线程写完再解除映射，之后进入的线程看到已关闭直接返回
+        while (0 != _writerCount.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+
+        Flush();
+        UnmapFile();
+
+        std::lock_guard lock(_siteMutex);
+        if (nullptr != _pSiteFile)
+        {
+            std::fclose(_pSiteFile);
+            _pSiteFile = nullptr;
+        }
+    }
+
+    void BinaryLogger::Flush()
+    {
+        if (nullptr != _pMapped)
+        {
+#ifdef OS_PLATFORM_WINDOWS
+            ::FlushViewOfFile(_pMapped, 0);
+            ::FlushFileBuffers(static_cast<HANDLE>(_fileHandle));
+#else
+            ::msync(_pMapped, _mappedSize, MS_SYNC);
+#endif
+        }
+
+        std::lock_guard lock(_siteMutex);
+        if (nullptr != _pSiteFile)
+        {
+            std::fflush(_pSiteFile);
+        }
+    }
+
+    uint32_t BinaryLogger::GetSiteId(std::string_view format,
+                                     const char      *file,
+                                     uint32_t         line,
+                                     const char      *function)
+    {
+        thread_local SiteCache cache;
+
+        const uint32_t generation = _generation.load(std::memory_order_acquire);
+        if (cache.generation != generation)
+        {
+            cache.sites.clear();
+            cache.generation = generation;
+        }
+
+        // 同一地址的格式串内容可能变化(非字面量)，命中后再比较一次内容
+        const SiteCacheKey cacheKey {format.data(), format.size(), file, line};
+        if (auto iter = cache.sites.find(cacheKey); iter != cache.sites.end())
+        {
+            if (iter->second->format == format)
+            {
+                return iter->second->id;
+            }
+        }
+
+        std::lock_guard lock(_siteMutex);
+
+        const SiteKey  key {format, nullptr == file ? std::string_view {} : file, line};
+        BinaryLogSite *pSite = nullptr;
+        if (auto iter = _siteIndex.find(key); iter != _siteIndex.end())
+        {
+            pSite = iter->second;
+        }
+        else
+        {
+            pSite = &_sites.emplace_back(BinaryLogSite {_nextSiteId++,
+                                                        line,
+                                                        std::string(key.file),
+                                                        nullptr == function ? std::string {} : function,
+                                                        std::string(format)});
+            _siteIndex.emplace(SiteKey {pSite->format, pSite->file, line}, pSite);
+
+            if (nullptr != _pSiteFile)
+            {
+                const std::string text = FormatBinaryLogSite(*pSite);
+                std::fprintf(_pSiteFile, "%s\n", text.c_str());
+                std::fflush(_pSiteFile);
+            }
+        }
+
+        cache.sites[cacheKey] = pSite;
+        return pSite->id;
+    }
+
+    void BinaryLogger::Commit(uint8_t                 level,
+                              uint32_t                siteId,
+                              uint8_t                 argCount,
+                              std::vector<std::byte> &record)
+    {
+        // 超长记录只保留调用点，解码时参数显示为缺失
+        if (record.size() > MAX_BINARY_LOG_RECORD_SIZE)
+        {
+            record.resize(sizeof(BinaryLogRecordHeader));
+            argCount = 0;
+        }
+
+        const auto size = static_cast<uint32_t>(AlignBinaryLogSize(record.size()));
+        record.resize(size);
+
+        BinaryLogRecordHeader header {};
+        header.size      = size;
+        header.timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                     std::chrono::system_clock::now().time_since_epoch())
+                                                     .count());
+        header.siteId    = siteId;
+        header.threadId  = GetCurrentThreadID();
+        header.level     = level;
+        header.argCount  = argCount;
+        std::memcpy(record.data(), &header, sizeof(header));
+
+        // 先登记再检查是否打开，与Close的关闭、等待之间须顺序一致，映射区在登记期间不会被解除
+        _writerCount.fetch_add(1);
+        if (!_bOpen.load())
+        {
+            _writerCount.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+
+        const uint64_t offset =
+            std::atomic_ref<uint64_t>(_pHeader->writeOffset).fetch_add(size, std::memory_order_relaxed);
+        WriteRing(offset, record.data(), size);
+
+        // 记录按8字节对齐且容量是8的倍数，magic不会被拆开
+        auto *pMagic = reinterpret_cast<uint32_t *>(_pData + offset % _capacity);
+        std::atomic_ref<uint32_t>(*pMagic).store(BINARY_LOG_RECORD_MAGIC, std::memory_order_release);
+
+        _writerCount.fetch_sub(1, std::memory_order_release);
+    }
+
+    void BinaryLogger::WriteRing(uint64_t offset, const void *pData, std::size_t size)
+    {
+        const uint64_t    pos   = offset % _capacity;
+        const std::size_t first = static_cast<std::size_t>(std::min<uint64_t>(size, _capacity - pos));
+        std::memcpy(_pData + pos, pData, first);
+        if (first < size)
+        {
+            std::memcpy(_pData, static_cast<const std::byte *>(pData) + first, size - first);
+        }
+    }
+
+    bool BinaryLogger::MapFile(const std::string &fileName, uint64_t fileSize)
+    {
+#ifdef OS_PLATFORM_WINDOWS
+        HANDLE hFile = ::CreateFileA(fileName.c_str(),
+                                     GENERIC_READ | GENERIC_WRITE,
+                                     FILE_SHARE_READ,
+                                     nullptr,
+                                     OPEN_ALWAYS,
+                                     FILE_ATTRIBUTE_NORMAL,
+                                     nullptr);
+        if (INVALID_HANDLE_VALUE == hFile)
+        {
+            return false;
+        }
+        _fileHandle = hFile;
+
+        HANDLE hMapping = ::CreateFileMappingA(hFile,
+                                               nullptr,
+                                               PAGE_READWRITE,
+                                               static_cast<DWORD>(fileSize >> 32),
+                                               static_cast<DWORD>(fileSize & 0xFFFFFFFF),
+                                               nullptr);
+        if (nullptr == hMapping)
+        {
+            return false;
+        }
+        _mappingHandle = hMapping;
+
+        void *pMapped = ::MapViewOfFile(hMapping, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<SIZE_T>(fileSize));
+        if (nullptr == pMapped)
+        {
+            return false;
+        }
+#else
+        _fd = ::open(fileName.c_str(), O_RDWR | O_CREAT, 0644);
+        if (_fd < 0)
+        {
+            return false;
+        }
+
+        if (::ftruncate(_fd, static_cast<off_t>(fileSize)) != 0)
+        {
+            return false;
+        }
+
+        void *pMapped = ::mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+        if (MAP_FAILED == pMapped)
+        {
+            return false;
+        }
+#endif
+        _pMapped    = static_cast<std::byte *>(pMapped);
+        _mappedSize = fileSize;
+        return true;
+    }
+
+    void BinaryLogger::UnmapFile()
+    {
+#ifdef OS_PLATFORM_WINDOWS
+        if (nullptr != _pMapped)
+        {
+            ::UnmapViewOfFile(_pMapped);
+        }
+
+        if (nullptr != _mappingHandle)
+        {
+            ::CloseHandle(static_cast<HANDLE>(_mappingHandle));
+        }
+
+        if (nullptr != _fileHandle)
+        {
+            ::CloseHandle(static_cast<HANDLE>(_fileHandle));
+        }
+#else
+        if (nullptr != _pMapped)
+        {
+            ::munmap(_pMapped, _mappedSize);
+        }
+
+        if (_fd >= 0)
+        {
+            ::close(_fd);
+        }
+#endif
+        _pMapped       = nullptr;
+        _mappedSize    = 0;
+        _pHeader       = nullptr;
+        _pData         = nullptr;
+        _capacity      = 0;
+        _fileHandle    = nullptr;
+        _mappingHandle = nullptr;
+        _fd            = -1;
+    }
+
+    void BinaryLogger::OpenSiteFile(const std::string &fileName, bool bReset)
+    {
+        _nextSiteId = 0;
+        if (!bReset)
+        {
+            std::ifstream siteFile(fileName);
+            std::string   line;
+            while (std::getline(siteFile, line))
+            {
+                if (auto site = ParseBinaryLogSite(line); site.has_value())
+                {
+                    _nextSiteId = std::max(_nextSiteId, site->id + 1);
+                }
+            }
+        }
+
+        _pSiteFile = std::fopen(fileName.c_str(), bReset ? "wb" : "ab");
+    }
+} // namespace Log
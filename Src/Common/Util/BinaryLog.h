@@ -0,0 +1,304 @@
+﻿/*************************************************************************
+> File Name       : BinaryLog.h
+> Brief           : 二进制结构化日志
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月12日  15时08分21秒
+************************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <format>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace Log
+{
+    constexpr uint32_t BINARY_LOG_FILE_MAGIC      = 0x474F4C42; // "BLOG"
+    constexpr uint32_t BINARY_LOG_RECORD_MAGIC    = 0x43455242; // "BREC"
+    constexpr uint32_t BINARY_LOG_VERSION         = 1;
+    constexpr uint32_t MAX_BINARY_LOG_RECORD_SIZE = 64 * 1024; // 单条记录上限，超出的字符串参数会被截断
+    constexpr uint32_t BINARY_LOG_ALIGNMENT       = 8;
+
+    // 日志文件头，记录之后的数据区为环形缓冲
+    struct BinaryLogFileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t capacity;    // 数据区大小
+        uint64_t writeOffset; // 已分配的逻辑偏移，对capacity取模即数据区位置
+        uint64_t reserved[5];
+    };
+
+    // 每条记录的头部，magic在参数写完后最后写入，用于识别未写完的记录
+    struct BinaryLogRecordHeader
+    {
+        uint32_t magic;
+        uint32_t size; // 含头部并按8字节对齐的总大小
+        uint64_t timestamp;
+        uint32_t siteId;
+        uint32_t threadId;
+        uint8_t  level;
+        uint8_t  argCount;
+        uint8_t  reserved[6];
+    };
+
+    static_assert(sizeof(BinaryLogFileHeader) == 64);
+    static_assert(sizeof(BinaryLogRecordHeader) == 32);
+
+    constexpr uint64_t AlignBinaryLogSize(uint64_t size)
+    {
+        return (size + BINARY_LOG_ALIGNMENT - 1) / BINARY_LOG_ALIGNMENT * BINARY_LOG_ALIGNMENT;
+    }
+
+    enum class BinaryLogArgType : uint8_t
+    {
+        Int64,
+        UInt64,
+        Float,
+        Double,
+        Bool,
+        Char,
+        String,
+    };
+
+    // 日志调用点，格式串与源码位置只在注册时写入旁路的站点文件一次
+    struct BinaryLogSite
+    {
+        uint32_t    id {0};
+        uint32_t    line {0};
+        std::string file;
+        std::string function;
+        std::string format;
+    };
+
+    /**
+     * @brief 站点表中的一行，字段以制表符分隔：id 行号 文件 函数 格式串
+     */
+    std::string FormatBinaryLogSite(const BinaryLogSite &site);
+
+    std::optional<BinaryLogSite> ParseBinaryLogSite(std::string_view line);
+
+    /**
+     * @brief 将日志参数按原始值编码，格式化推迟到离线解码
+     *        整数、浮点、布尔、字符与字符串按类型保存，其余类型在调用线程格式化为字符串
+     */
+    class BinaryLogEncoder
+    {
+    public:
+        explicit BinaryLogEncoder(std::vector<std::byte> &buffer)
+            : _buffer(buffer)
+        {
+        }
+
+        template <typename T>
+        void Append(const T &value)
+        {
+            using DecayType = std::decay_t<T>;
+
+            if constexpr (std::is_same_v<DecayType, bool>)
+            {
+                AppendTagged(BinaryLogArgType::Bool, static_cast<uint8_t>(value));
+            }
+            else if constexpr (std::is_same_v<DecayType, char>)
+            {
+                AppendTagged(BinaryLogArgType::Char, value);
+            }
+            else if constexpr (std::is_integral_v<DecayType> && std::is_signed_v<DecayType>)
+            {
+                AppendTagged(BinaryLogArgType::Int64, static_cast<int64_t>(value));
+            }
+            else if constexpr (std::is_integral_v<DecayType>)
+            {
+                AppendTagged(BinaryLogArgType::UInt64, static_cast<uint64_t>(value));
+            }
+            else if constexpr (std::is_same_v<DecayType, float>)
+            {
+                AppendTagged(BinaryLogArgType::Float, value);
+            }
+            else if constexpr (std::is_floating_point_v<DecayType>)
+            {
+                AppendTagged(BinaryLogArgType::Double, static_cast<double>(value));
+            }
+            else if constexpr (std::is_same_v<DecayType, const char *> || std::is_same_v<DecayType, char *>)
+            {
+                AppendString(nullptr == value ? std::string_view {} : std::string_view {value});
+            }
+            else if constexpr (std::is_convertible_v<const DecayType &, std::string_view>)
+            {
+                AppendString(std::string_view {value});
+            }
+            else if constexpr (std::is_pointer_v<DecayType>)
+            {
+                AppendString(std::format("{}", static_cast<const void *>(value)));
+            }
+            else
+            {
+                AppendString(std::format("{}", value));
+            }
+        }
+
+    private:
+        template <typename T>
+        void AppendTagged(BinaryLogArgType type, T value)
+        {
+            _buffer.push_back(static_cast<std::byte>(type));
+            AppendRaw(&value, sizeof(value));
+        }
+
+        void AppendString(std::string_view value)
+        {
+            const auto length =
+                static_cast<uint32_t>(std::min<std::size_t>(value.size(), MAX_BINARY_LOG_RECORD_SIZE / 2));
+            _buffer.push_back(static_cast<std::byte>(BinaryLogArgType::String));
+            AppendRaw(&length, sizeof(length));
+            AppendRaw(value.data(), length);
+        }
+
+        void AppendRaw(const void *pData, std::size_t size)
+        {
+            const std::size_t offset = _buffer.size();
+            _buffer.resize(offset + size);
+            if (size > 0)
+            {
+                std::memcpy(_buffer.data() + offset, pData, size);
+            }
+        }
+
+    private:
+        std::vector<std::byte> &_buffer;
+    };
+
+    /**
+     * @brief 二进制日志写入器，记录写入预分配并内存映射的环形文件
+     *        每条记录只包含时间戳、等级、线程、调用点id和原始参数，写满后覆盖最旧的记录。
+     *        映射区由操作系统回写，进程崩溃时已提交的记录仍保留在文件中
+     */
+    class BinaryLogger
+    {
+    public:
+        static BinaryLogger &GetInstance()
+        {
+            static BinaryLogger logger;
+            return logger;
+        }
+
+        BinaryLogger(const BinaryLogger &)            = delete;
+        BinaryLogger &operator=(const BinaryLogger &) = delete;
+        BinaryLogger(BinaryLogger &&)                 = delete;
+        BinaryLogger &operator=(BinaryLogger &&)      = delete;
+
+        /**
+         * @brief 打开日志文件，已存在且容量相同的文件从上次的位置继续写入
+         *
+         * @param fileName 日志文件名，站点表写入同名的.sites文件
+         * @param capacity 数据区大小(字节)
+         * @return 是否成功
+         */
+        bool Open(std::string_view fileName, uint64_t capacity);
+
+        // 关闭前等待正在写入的线程完成，可与Write并发调用
+        void Close();
+
+        // 将映射区同步写回磁盘
+        void Flush();
+
+        [[nodiscard]] bool IsOpen() const
+        {
+            return _bOpen.load(std::memory_order_acquire);
+        }
+
+        template <typename... Args>
+        void Write(uint8_t          level,
+                   std::string_view format,
+                   const char      *file,
+                   uint32_t         line,
+                   const char      *function,
+                   const Args &...args)
+        {
+            static_assert(sizeof...(Args) <= UINT8_MAX, "日志参数过多");
+
+            thread_local std::vector<std::byte> buffer;
+            buffer.clear();
+            buffer.resize(sizeof(BinaryLogRecordHeader));
+
+            BinaryLogEncoder encoder(buffer);
+            (encoder.Append(args), ...);
+
+            Commit(level, GetSiteId(format, file, line, function), sizeof...(Args), buffer);
+        }
+
+        /**
+         * @brief 取得调用点id，线程本地缓存命中时不加锁
+         */
+        uint32_t GetSiteId(std::string_view format, const char *file, uint32_t line, const char *function);
+
+    private:
+        BinaryLogger() = default;
+
+        ~BinaryLogger();
+
+        void Commit(uint8_t level, uint32_t siteId, uint8_t argCount, std::vector<std::byte> &record);
+
+        // 按环形缓冲的方式写入，必要时拆成两段
+        void WriteRing(uint64_t offset, const void *pData, std::size_t size);
+
+        bool MapFile(const std::string &fileName, uint64_t fileSize);
+
+        void UnmapFile();
+
+        // 站点表只追加，重新打开时从已有的最大id之后继续编号，旧记录引用的站点保持有效
+        void OpenSiteFile(const std::string &fileName, bool bReset);
+
+    private:
+        struct SiteKey
+        {
+            std::string_view format;
+            std::string_view file;
+            uint32_t         line;
+
+            bool operator==(const SiteKey &) const = default;
+        };
+
+        struct SiteKeyHash
+        {
+            std::size_t operator()(const SiteKey &key) const
+            {
+                const std::size_t hash     = std::hash<std::string_view> {}(key.format);
+                const std::size_t fileHash = std::hash<std::string_view> {}(key.file);
+                return hash ^ (fileHash + 0x9E3779B9 + (hash << 6) + key.line);
+            }
+        };
+
+        std::atomic<bool>     _bOpen {false};
+        std::atomic<uint32_t> _generation {0};  // 每次打开递增，使线程本地缓存失效
+        std::atomic<uint32_t> _writerCount {0}; // 正在写入映射区的线程数，关闭时等待归零
+
+        std::byte           *_pMapped {nullptr};
+        uint64_t             _mappedSize {0};
+        BinaryLogFileHeader *_pHeader {nullptr};
+        std::byte           *_pData {nullptr};
+        uint64_t             _capacity {0};
+        void                *_fileHandle {nullptr};    // windows文件句柄
+        void                *_mappingHandle {nullptr}; // windows映射句柄
+        int                  _fd {-1};                 // linux文件描述符
+
+        std::mutex                                                _siteMutex;
+        std::deque<BinaryLogSite>                                 _sites; // 元素地址稳定，可被线程缓存引用
+        std::unordered_map<SiteKey, BinaryLogSite *, SiteKeyHash> _siteIndex;
+        uint32_t                                                  _nextSiteId {0};
+        std::FILE                                                *_pSiteFile {nullptr};
+    };
+} // namespace Log
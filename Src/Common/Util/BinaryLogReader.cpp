@@ -0,0 +1,381 @@
+﻿/*************************************************************************
+> File Name       : BinaryLogReader.cpp
+> Brief           : 二进制日志解码
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月12日  17时42分09秒
+************************************************************************/
+#include "BinaryLogReader.h"
+
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace Log
+{
+    namespace
+    {
+        // 按环形方式读取，必要时从数据区开头接着读
+        void ReadRing(std::span<const std::byte> data, uint64_t offset, void *pDest, std::size_t size)
+        {
+            const uint64_t    pos   = offset % data.size();
+            const std::size_t first = static_cast<std::size_t>(std::min<uint64_t>(size, data.size() - pos));
+            std::memcpy(pDest, data.data() + pos, first);
+            if (first < size)
+            {
+                std::memcpy(static_cast<std::byte *>(pDest) + first, data.data(), size - first);
+            }
+        }
+
+        bool IsValidRecordSize(uint32_t size)
+        {
+            return size >= sizeof(BinaryLogRecordHeader) && size % BINARY_LOG_ALIGNMENT == 0
+                   && size <= AlignBinaryLogSize(MAX_BINARY_LOG_RECORD_SIZE);
+        }
+
+        // 从start开始按记录大小前进，恰好走到writeOffset时start是记录起点
+        bool IsRecordChain(std::span<const std::byte> data, uint64_t start, uint64_t writeOffset)
+        {
+            uint32_t magic = 0;
+            ReadRing(data, start, &magic, sizeof(magic));
+            if (magic != BINARY_LOG_RECORD_MAGIC)
+            {
+                return false;
+            }
+
+            uint64_t pos = start;
+            while (pos < writeOffset)
+            {
+                uint32_t head[2] {};
+                ReadRing(data, pos, head, sizeof(head));
+                if ((head[0] != BINARY_LOG_RECORD_MAGIC && head[0] != 0) || !IsValidRecordSize(head[1]))
+                {
+                    return false;
+                }
+                pos += head[1];
+            }
+            return pos == writeOffset;
+        }
+
+        class PayloadReader
+        {
+        public:
+            explicit PayloadReader(std::span<const std::byte> payload)
+                : _payload(payload)
+            {
+            }
+
+            template <typename T>
+            bool Read(T &value)
+            {
+                if (_payload.size() < sizeof(T))
+                {
+                    return false;
+                }
+
+                std::memcpy(&value, _payload.data(), sizeof(T));
+                _payload = _payload.subspan(sizeof(T));
+                return true;
+            }
+
+            bool ReadString(std::string &value, uint32_t length)
+            {
+                if (_payload.size() < length)
+                {
+                    return false;
+                }
+
+                value.assign(reinterpret_cast<const char *>(_payload.data()), length);
+                _payload = _payload.subspan(length);
+                return true;
+            }
+
+        private:
+            std::span<const std::byte> _payload;
+        };
+
+        template <typename T>
+        bool ReadArg(PayloadReader &reader, std::vector<BinaryLogArg> &args)
+        {
+            T value {};
+            if (!reader.Read(value))
+            {
+                return false;
+            }
+
+            args.emplace_back(value);
+            return true;
+        }
+
+        bool DecodeArgs(std::span<const std::byte> payload, uint8_t argCount, std::vector<BinaryLogArg> &args)
+        {
+            PayloadReader reader(payload);
+            for (uint8_t i = 0; i < argCount; ++i)
+            {
+                BinaryLogArgType type {};
+                if (!reader.Read(type))
+                {
+                    return false;
+                }
+
+                bool bOk = false;
+                switch (type)
+                {
+                    case BinaryLogArgType::Int64:
+                        bOk = ReadArg<int64_t>(reader, args);
+                        break;
+                    case BinaryLogArgType::UInt64:
+                        bOk = ReadArg<uint64_t>(reader, args);
+                        break;
+                    case BinaryLogArgType::Float:
+                        bOk = ReadArg<float>(reader, args);
+                        break;
+                    case BinaryLogArgType::Double:
+                        bOk = ReadArg<double>(reader, args);
+                        break;
+                    case BinaryLogArgType::Bool:
+                    {
+                        uint8_t value = 0;
+                        bOk           = reader.Read(value);
+                        args.emplace_back(value != 0);
+                        break;
+                    }
+                    case BinaryLogArgType::Char:
+                        bOk = ReadArg<char>(reader, args);
+                        break;
+                    case BinaryLogArgType::String:
+                    {
+                        uint32_t    length = 0;
+                        std::string value;
+                        bOk = reader.Read(length) && reader.ReadString(value, length);
+                        args.emplace_back(std::move(value));
+                        break;
+                    }
+                }
+
+                if (!bOk)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        std::string FormatArg(std::span<const BinaryLogArg> args, std::size_t index, std::string_view spec)
+        {
+            if (index >= args.size())
+            {
+                return "{?}";
+            }
+
+            const std::string format = std::format("{{{}}}", spec);
+            return std::visit(
+                [&format](const auto &value) -> std::string {
+                    try
+                    {
+                        return std::vformat(format, std::make_format_args(value));
+                    }
+                    catch (const std::format_error &)
+                    {
+                        return "{?}";
+                    }
+                },
+                args[index]);
+        }
+
+        std::string_view GetLevelName(uint8_t level)
+        {
+            constexpr std::string_view levelNames[] = {
+                "trace", "debug", "info", "warning", "error", "critical"};
+            return level < std::size(levelNames) ? levelNames[level] : "unknown";
+        }
+    } // namespace
+
+    std::vector<BinaryLogRecord> ParseBinaryLogRing(std::span<const std::byte> data, uint64_t writeOffset)
+    {
+        std::vector<BinaryLogRecord> records;
+        if (data.empty() || data.size() % BINARY_LOG_ALIGNMENT != 0)
+        {
+            return records;
+        }
+
+        // 未写满时从0开始，否则在最旧的一段里找第一个完整记录
+        uint64_t start = 0;
+        if (writeOffset > data.size())
+        {
+            start = AlignBinaryLogSize(writeOffset - data.size());
+            while (start < writeOffset && !IsRecordChain(data, start, writeOffset))
+            {
+                start += BINARY_LOG_ALIGNMENT;
+            }
+        }
+
+        std::vector<std::byte> buffer;
+        for (uint64_t pos = start; pos < writeOffset;)
+        {
+            BinaryLogRecordHeader header {};
+            ReadRing(data, pos, &header, sizeof(header));
+            if (!IsValidRecordSize(header.size))
+            {
+                break;
+            }
+
+            if (BINARY_LOG_RECORD_MAGIC == header.magic)
+            {
+                buffer.resize(header.size - sizeof(header));
+                ReadRing(data, pos + sizeof(header), buffer.data(), buffer.size());
+
+                BinaryLogRecord record;
+                record.timestamp = header.timestamp;
+                record.siteId    = header.siteId;
+                record.threadId  = header.threadId;
+                record.level     = header.level;
+                DecodeArgs(buffer, header.argCount, record.args);
+                records.emplace_back(std::move(record));
+            }
+
+            pos += header.size;
+        }
+
+        return records;
+    }
+
+    std::string FormatBinaryLogMessage(std::string_view format, std::span<const BinaryLogArg> args)
+    {
+        std::string result;
+        result.reserve(format.size());
+
+        std::size_t nextArg = 0;
+        for (std::size_t i = 0; i < format.size(); ++i)
+        {
+            const char c = format[i];
+            if (('{' == c || '}' == c) && i + 1 < format.size() && format[i + 1] == c)
+            {
+                result += c;
+                ++i;
+                continue;
+            }
+
+            if ('{' != c)
+            {
+                result += c;
+                continue;
+            }
+
+            const std::size_t close = format.find('}', i);
+            if (close == std::string_view::npos)
+            {
+                result.append(format.substr(i));
+                break;
+            }
+
+            // 替换字段：[参数序号][:格式说明]
+            const std::string_view field = format.substr(i + 1, close - i - 1);
+            const std::size_t      colon = field.find(':');
+            const std::string_view index = field.substr(0, colon);
+            const std::string_view spec  = colon == std::string_view::npos ? "" : field.substr(colon);
+
+            std::size_t argIndex = nextArg;
+            if (index.empty())
+            {
+                ++nextArg;
+            }
+            else if (std::from_chars(index.data(), index.data() + index.size(), argIndex).ec != std::errc {})
+            {
+                argIndex = args.size();
+            }
+
+            result += FormatArg(args, argIndex, spec);
+            i = close;
+        }
+
+        return result;
+    }
+
+    bool BinaryLogReader::Open(const std::string &fileName)
+    {
+        _records.clear();
+        _sites.clear();
+
+        std::ifstream file(fileName, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+
+        BinaryLogFileHeader header {};
+        if (!file.read(reinterpret_cast<char *>(&header), sizeof(header))
+            || header.magic != BINARY_LOG_FILE_MAGIC || header.version != BINARY_LOG_VERSION)
+        {
+            return false;
+        }
+
+        std::vector<std::byte> data(header.capacity);
+        if (!file.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size())))
+        {
+            return false;
+        }
+
+        _records = ParseBinaryLogRing(data, header.writeOffset);
+
+        std::ifstream siteFile(fileName + ".sites");
+        std::string   line;
+        while (std::getline(siteFile, line))
+        {
+            if (auto site = ParseBinaryLogSite(line); site.has_value())
+            {
+                const uint32_t siteId = site->id;
+                _sites.insert_or_assign(siteId, std::move(*site));
+            }
+        }
+
+        return true;
+    }
+
+    const BinaryLogSite *BinaryLogReader::GetSite(uint32_t siteId) const
+    {
+        const auto iter = _sites.find(siteId);
+        return iter == _sites.end() ? nullptr : &iter->second;
+    }
+
+    std::string BinaryLogReader::FormatMessage(const BinaryLogRecord &record) const
+    {
+        if (const BinaryLogSite *pSite = GetSite(record.siteId); nullptr != pSite)
+        {
+            return FormatBinaryLogMessage(pSite->format, record.args);
+        }
+
+        std::string result = std::format("<未知调用点 {}>", record.siteId);
+        for (const auto &arg : record.args)
+        {
+            result += ' ';
+            result += FormatArg(std::span {&arg, 1}, 0, "");
+        }
+        return result;
+    }
+
+    std::string BinaryLogReader::FormatLine(const BinaryLogRecord &record) const
+    {
+        using namespace std::chrono;
+
+        const nanoseconds sinceEpoch {record.timestamp};
+        const auto        timePoint = system_clock::time_point {} + sinceEpoch;
+        const zoned_time  localTime {current_zone(), floor<seconds>(timePoint)};
+        const auto        millisec = duration_cast<milliseconds>(sinceEpoch) % 1000;
+
+        const BinaryLogSite *pSite = GetSite(record.siteId);
+        const std::string    fileName =
+            nullptr == pSite ? std::string {} : std::filesystem::path(pSite->file).filename().string();
+
+        return std::format("[{:%Y-%m-%d %H:%M:%S}.{:03}] [{}:{} {}]: {}",
+                           localTime,
+                           millisec.count(),
+                           fileName,
+                           nullptr == pSite ? 0 : pSite->line,
+                           GetLevelName(record.level),
+                           FormatMessage(record));
+    }
+} // namespace Log
@@ -0,0 +1,76 @@
+﻿/*************************************************************************
+> File Name       : BinaryLogReader.h
+> Brief           : 二进制日志解码
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月12日  17时42分09秒
+************************************************************************/
+#pragma once
+
+#include "BinaryLog.h"
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace Log
+{
+    using BinaryLogArg = std::variant<int64_t, uint64_t, float, double, bool, char, std::string>;
+
+    struct BinaryLogRecord
+    {
+        uint64_t                  timestamp {0}; // 纳秒，system_clock纪元
+        uint32_t                  siteId {0};
+        uint32_t                  threadId {0};
+        uint8_t                   level {0};
+        std::vector<BinaryLogArg> args;
+    };
+
+    /**
+     * @brief 按写入顺序解析环形数据区中的记录
+     *        数据区写满后最旧的记录可能只剩一部分，从能连续走到写入位置的第一个记录开始解析，
+     *        未提交完成的记录被跳过
+     *
+     * @param data 数据区
+     * @param writeOffset 文件头中记录的逻辑写入偏移
+     * @return 记录列表
+     */
+    std::vector<BinaryLogRecord> ParseBinaryLogRing(std::span<const std::byte> data, uint64_t writeOffset);
+
+    /**
+     * @brief 用记录的参数填充格式串，支持{}、{n}与{:spec}，无法格式化的字段输出{?}
+     */
+    std::string FormatBinaryLogMessage(std::string_view format, std::span<const BinaryLogArg> args);
+
+    class BinaryLogReader
+    {
+    public:
+        /**
+         * @brief 读取日志文件及同名的.sites站点表
+         *
+         * @return 文件头是否有效
+         */
+        bool Open(const std::string &fileName);
+
+        [[nodiscard]] const std::vector<BinaryLogRecord> &GetRecords() const
+        {
+            return _records;
+        }
+
+        [[nodiscard]] const BinaryLogSite *GetSite(uint32_t siteId) const;
+
+        // 记录正文，站点缺失时输出参数列表
+        [[nodiscard]] std::string FormatMessage(const BinaryLogRecord &record) const;
+
+        // 与默认日志格式相同的一行文本：[时间] [文件:行 等级]: 正文
+        [[nodiscard]] std::string FormatLine(const BinaryLogRecord &record) const;
+
+    private:
+        std::vector<BinaryLogRecord>                _records;
+        std::unordered_map<uint32_t, BinaryLogSite> _sites;
+    };
+} // namespace Log
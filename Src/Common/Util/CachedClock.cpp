@@ -0,0 +1,208 @@
+﻿/*************************************************************************
+> File Name       : CachedClock.cpp
+> Brief           : 缓存时钟
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年05月28日  10时15分37秒
+************************************************************************/
+#include "CachedClock.h"
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace TimeUtil::CachedClock
+{
+    namespace
+    {
+        // 每秒格式化一次的字符串
+        struct ClockStrings
+        {
+            int64_t unixSecond {INT64_MIN};
+            char    httpDate[HTTP_DATE_LENGTH] {};
+            char    fileTimestamp[FILE_TIMESTAMP_LENGTH] {};
+        };
+
+        // 按秒轮换，读者拿到的缓存要在64秒后才会被覆盖
+        constexpr std::size_t CLOCK_STRING_SLOTS = 64;
+
+        std::array<ClockStrings, CLOCK_STRING_SLOTS> g_clockStrings;
+        std::size_t                                  g_clockStringSlot = 0;
+        std::atomic<const ClockStrings *>            g_pClockStrings {nullptr};
+        std::atomic<int64_t>                         g_unixMillis {0};
+        std::atomic<int64_t>                         g_steadyNanos {0};
+        std::atomic_flag                             g_bUpdating;
+
+        constexpr std::string_view WEEKDAY_NAMES = "SunMonTueWedThuFriSat";
+        constexpr std::string_view MONTH_NAMES   = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+        char *WriteDigits(char *pOutput, uint32_t value, int digitCount)
+        {
+            for (int i = digitCount - 1; i >= 0; --i)
+            {
+                pOutput[i] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            }
+            return pOutput + digitCount;
+        }
+
+        // 本地时间相对UTC的偏移，时区数据库只在首次使用时查找
+        std::chrono::seconds GetLocalOffset(std::chrono::sys_seconds time)
+        {
+            static const std::chrono::time_zone *pZone = std::chrono::current_zone();
+            return pZone->get_info(time).offset;
+        }
+
+        void UpdateStrings(int64_t unixSecond)
+        {
+            ClockStrings &strings = g_clockStrings[g_clockStringSlot];
+            g_clockStringSlot     = (g_clockStringSlot + 1) % CLOCK_STRING_SLOTS;
+
+            const std::chrono::sys_seconds time {std::chrono::seconds(unixSecond)};
+            const int64_t                  localSecond = unixSecond + GetLocalOffset(time).count();
+
+            strings.unixSecond = unixSecond;
+            FormatHttpDate(unixSecond, strings.httpDate);
+            FormatTimestamp(localSecond, '_', '_', '_', strings.fileTimestamp);
+            g_pClockStrings.store(&strings, std::memory_order_release);
+        }
+
+        const ClockStrings &GetClockStrings()
+        {
+            const ClockStrings *pStrings = g_pClockStrings.load(std::memory_order_acquire);
+            // 从未刷新过时自行刷新，其他线程正在首次刷新时等它完成
+            while (nullptr == pStrings) [[unlikely]]
+            {
+                Update();
+                std::this_thread::yield();
+                pStrings = g_pClockStrings.load(std::memory_order_acquire);
+            }
+            return *pStrings;
+        }
+    } // namespace
+
+    void Update()
+    {
+        if (g_bUpdating.test_and_set(std::memory_order_acquire))
+        {
+            return;
+        }
+
+        const auto now       = std::chrono::system_clock::now();
+        const auto steadyNow = std::chrono::steady_clock::now();
+        const auto unixMillis =
+            std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+
+        g_unixMillis.store(unixMillis, std::memory_order_relaxed);
+        g_steadyNanos.store(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(steadyNow.time_since_epoch()).count(),
+            std::memory_order_relaxed);
+
+        // 秒数向下取整，负数时间也按日历对齐
+        const int64_t       unixSecond = unixMillis >= 0 ? unixMillis / 1000 : (unixMillis - 999) / 1000;
+        const ClockStrings *pStrings   = g_pClockStrings.load(std::memory_order_relaxed);
+        if (nullptr == pStrings || pStrings->unixSecond != unixSecond)
+        {
+            UpdateStrings(unixSecond);
+        }
+
+        g_bUpdating.clear(std::memory_order_release);
+    }
+
+    int64_t GetUnixMillis()
+    {
+        int64_t unixMillis = g_unixMillis.load(std::memory_order_relaxed);
+        while (0 == unixMillis) [[unlikely]]
+        {
+            Update();
+            std::this_thread::yield();
+            unixMillis = g_unixMillis.load(std::memory_order_relaxed);
+        }
+        return unixMillis;
+    }
+
+    std::chrono::steady_clock::time_point GetSteadyTime()
+    {
+        int64_t steadyNanos = g_steadyNanos.load(std::memory_order_relaxed);
+        while (0 == steadyNanos) [[unlikely]]
+        {
+            Update();
+            std::this_thread::yield();
+            steadyNanos = g_steadyNanos.load(std::memory_order_relaxed);
+        }
+        const std::chrono::nanoseconds steadyTime(steadyNanos);
+        return std::chrono::steady_clock::time_point {
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(steadyTime)};
+    }
+
+    std::string_view GetHttpDate()
+    {
+        const ClockStrings &strings = GetClockStrings();
+        return {strings.httpDate, HTTP_DATE_LENGTH};
+    }
+
+    std::string_view GetFileTimestamp()
+    {
+        const ClockStrings &strings = GetClockStrings();
+        return {strings.fileTimestamp, FILE_TIMESTAMP_LENGTH};
+    }
+
+    void FormatHttpDate(int64_t unixSecond, char *pOutput)
+    {
+        using namespace std::chrono;
+
+        const sys_seconds    time {seconds(unixSecond)};
+        const sys_days       days = floor<std::chrono::days>(time);
+        const year_month_day date {days};
+        const hh_mm_ss       clock {time - days};
+        const unsigned       weekdayIndex = weekday {days}.c_encoding();
+        const unsigned       monthIndex   = static_cast<unsigned>(date.month()) - 1;
+
+        char *pCursor = pOutput;
+        std::memcpy(pCursor, WEEKDAY_NAMES.data() + weekdayIndex * 3, 3);
+        pCursor += 3;
+        *pCursor++ = ',';
+        *pCursor++ = ' ';
+        pCursor    = WriteDigits(pCursor, static_cast<unsigned>(date.day()), 2);
+        *pCursor++ = ' ';
+        std::memcpy(pCursor, MONTH_NAMES.data() + monthIndex * 3, 3);
+        pCursor += 3;
+        *pCursor++ = ' ';
+        pCursor    = WriteDigits(pCursor, static_cast<uint32_t>(static_cast<int>(date.year())), 4);
+        *pCursor++ = ' ';
+        pCursor    = WriteDigits(pCursor, static_cast<uint32_t>(clock.hours().count()), 2);
+        *pCursor++ = ':';
+        pCursor    = WriteDigits(pCursor, static_cast<uint32_t>(clock.minutes().count()), 2);
+        *pCursor++ = ':';
+        pCursor    = WriteDigits(pCursor, static_cast<uint32_t>(clock.seconds().count()), 2);
+        std::memcpy(pCursor, " GMT", 4);
+    }
+
+    void FormatTimestamp(int64_t localSecond,
+                         char    dateSeparator,
+                         char    middleSeparator,
+                         char    timeSeparator,
+                         char   *pOutput)
+    {
+        using namespace std::chrono;
+
+        const sys_seconds    time {seconds(localSecond)};
+        const sys_days       days = floor<std::chrono::days>(time);
+        const year_month_day date {days};
+        const hh_mm_ss       clock {time - days};
+
+        char *pCursor = WriteDigits(pOutput, static_cast<uint32_t>(static_cast<int>(date.year())), 4);
+        *pCursor++    = dateSeparator;
+        pCursor       = WriteDigits(pCursor, static_cast<unsigned>(date.month()), 2);
+        *pCursor++    = dateSeparator;
+        pCursor       = WriteDigits(pCursor, static_cast<unsigned>(date.day()), 2);
+        *pCursor++    = middleSeparator;
+        pCursor       = WriteDigits(pCursor, static_cast<uint32_t>(clock.hours().count()), 2);
+        *pCursor++    = timeSeparator;
+        pCursor       = WriteDigits(pCursor, static_cast<uint32_t>(clock.minutes().count()), 2);
+        *pCursor++    = timeSeparator;
+        WriteDigits(pCursor, static_cast<uint32_t>(clock.seconds().count()), 2);
+    }
+} // namespace TimeUtil::CachedClock
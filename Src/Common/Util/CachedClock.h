@@ -0,0 +1,66 @@
+﻿/*************************************************************************
+> File Name       : CachedClock.h
+> Brief           : 缓存时钟
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年05月28日  10时15分37秒
+************************************************************************/
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+namespace TimeUtil
+{
+    /**
+     * @brief 粗粒度的缓存时钟，由逻辑帧(IServer::Update)周期调用Update刷新
+     *        读取毫秒时间只需一次原子读；HTTP Date与日志文件时间戳每秒只格式化一次，读取时也只需一次原子读。
+     *        字符串缓存按秒轮换，返回的string_view应立即拷贝或使用，不要长期持有
+     */
+    namespace CachedClock
+    {
+        constexpr std::size_t HTTP_DATE_LENGTH      = 29; // "Sun, 06 Nov 1994 08:49:37 GMT"
+        constexpr std::size_t LOG_TIMESTAMP_LENGTH  = 19; // "2024-05-28 10:15:37"
+        constexpr std::size_t FILE_TIMESTAMP_LENGTH = 19; // "2024_05_28_10_15_37"
+
+        // 刷新缓存，多个线程同时调用时只有一个生效
+        void Update();
+
+        // 最近一次Update时的系统时间，Unix毫秒
+        [[nodiscard]] int64_t GetUnixMillis();
+
+        // 最近一次Update时的单调时间
+        [[nodiscard]] std::chrono::steady_clock::time_point GetSteadyTime();
+
+        // RFC 7231格式的GMT时间，用于HTTP响应的Date头
+        [[nodiscard]] std::string_view GetHttpDate();
+
+        // 本地时间，用于日志文件名
+        [[nodiscard]] std::string_view GetFileTimestamp();
+
+        /**
+         * @brief 把Unix秒格式化为HTTP Date
+         *
+         * @param unixSecond Unix秒
+         * @param pOutput 至少HTTP_DATE_LENGTH字节
+         */
+        void FormatHttpDate(int64_t unixSecond, char *pOutput);
+
+        /**
+         * @brief 把本地时间的秒数格式化为"YYYY-MM-DD HH:MM:SS"，分隔符可替换
+         *
+         * @param localSecond 本地时间，自1970-01-01 00:00:00起的秒数
+         * @param dateSeparator 年月日之间的分隔符
+         * @param middleSeparator 日期与时间之间的分隔符
+         * @param timeSeparator 时分秒之间的分隔符
+         * @param pOutput 至少LOG_TIMESTAMP_LENGTH字节
+         */
+        void FormatTimestamp(int64_t localSecond,
+                             char    dateSeparator,
+                             char    middleSeparator,
+                             char    timeSeparator,
+                             char   *pOutput);
+    } // namespace CachedClock
+} // namespace TimeUtil
@@ -0,0 +1,255 @@
+﻿/*************************************************************************
+> File Name       : Histogram.h
+> Brief           : 对数线性直方图
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年10月28日  15时20分47秒
+************************************************************************/
+#pragma once
+
+#include "LogLinearBuckets.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace Util
+{
+    /**
+     * @brief 直方图的快照，也可在单个线程上直接记录，多个快照可合并后计算百分位
+     *
+     * @tparam Buckets LogLinearBuckets分桶
+     */
+    template <typename Buckets>
+    struct BasicHistogramSnapshot
+    {
+        static constexpr uint32_t SUB_BUCKET_COUNT = Buckets::SUB_BUCKET_COUNT;
+        static constexpr uint32_t BUCKET_COUNT     = Buckets::BUCKET_COUNT;
+
+        std::vector<uint64_t> buckets = std::vector<uint64_t>(BUCKET_COUNT, 0);
+        uint64_t              count {0};
+        uint64_t              sum {0};
+        uint64_t              min {UINT64_MAX}; // 没有记录时为UINT64_MAX，读取用GetMin
+        uint64_t              max {0};
+
+        void Record(uint64_t value, uint64_t times = 1)
+        {
+            if (0 == times)
+            {
+                return;
+            }
+
+            buckets[Buckets::GetBucketIndex(value)] += times;
+            count += times;
+            sum += value * times;
+            min = (std::min)(min, value);
+            max = (std::max)(max, value);
+        }
+
+        /**
+         * @brief 记录并校正协调遗漏(coordinated omission)：
+         *        一次响应耗时超过期望间隔时，期间本应发出却被阻塞的请求也计入，
+         *        补记的值依次为 value - interval, value - 2 * interval ...，与HdrHistogram的做法一致
+         *
+         * @param value 记录值
+         * @param expectedInterval 期望的请求间隔，为0时不校正
+         * @param times 记录次数
+         */
+        void RecordCorrected(uint64_t value, uint64_t expectedInterval, uint64_t times = 1)
+        {
+            Record(value, times);
+            if (0 == expectedInterval || value <= expectedInterval)
+            {
+                return;
+            }
+
+            for (uint64_t missingValue = value - expectedInterval; missingValue >= expectedInterval;
+                 missingValue -= expectedInterval)
+            {
+                Record(missingValue, times);
+            }
+        }
+
+        // 以期望间隔校正后的副本，用于事后校正闭环压测的结果
+        [[nodiscard]] BasicHistogramSnapshot CopyCorrected(uint64_t expectedInterval) const
+        {
+            BasicHistogramSnapshot result;
+            for (uint32_t i = 0; i < BUCKET_COUNT; ++i)
+            {
+                if (0 == buckets[i])
+                {
+                    continue;
+                }
+
+                result.RecordCorrected(GetBucketValue(i), expectedInterval, buckets[i]);
+            }
+            return result;
+        }
+
+        void Merge(const BasicHistogramSnapshot &other)
+        {
+            for (uint32_t i = 0; i < BUCKET_COUNT; ++i)
+            {
+                buckets[i] += other.buckets[i];
+            }
+            count += other.count;
+            sum += other.sum;
+            min = (std::min)(min, other.min);
+            max = (std::max)(max, other.max);
+        }
+
+        /**
+         * @brief 百分位值，相对误差不超过1/SUB_BUCKET_COUNT
+         *
+         * @param percentile 0到100
+         * @return 所在桶的上界，限制在最小值与最大值之间；没有记录时返回0
+         */
+        [[nodiscard]] uint64_t GetPercentile(double percentile) const
+        {
+            if (0 == count)
+            {
+                return 0;
+            }
+
+            const double   ratio      = std::clamp(percentile, 0.0, 100.0) / 100.0;
+            const auto     rank       = static_cast<uint64_t>(std::ceil(ratio * static_cast<double>(count)));
+            const uint64_t target     = (std::max)(uint64_t {1}, rank);
+            uint64_t       cumulative = 0;
+            for (uint32_t i = 0; i < BUCKET_COUNT; ++i)
+            {
+                cumulative += buckets[i];
+                if (cumulative >= target)
+                {
+                    return GetBucketValue(i);
+                }
+            }
+            return max;
+        }
+
+        [[nodiscard]] uint64_t GetMin() const
+        {
+            return 0 == count ? 0 : min;
+        }
+
+        [[nodiscard]] double GetMean() const
+        {
+            return 0 == count ? 0.0 : static_cast<double>(sum) / static_cast<double>(count);
+        }
+
+    private:
+        // 桶内的值以上界代表，首尾两个非空桶以实际的最小值、最大值代表
+        [[nodiscard]] uint64_t GetBucketValue(uint32_t index) const
+        {
+            // 并发取出快照时最值可能与桶计数不一致，此时不做限制
+            const uint64_t upperBound = Buckets::GetBucketUpperBound(index);
+            return min <= max ? std::clamp(upperBound, min, max) : upperBound;
+        }
+    };
+
+    /**
+     * @brief 无锁对数线性直方图，多个线程可同时记录，读取时生成快照
+     *
+     * @tparam Buckets LogLinearBuckets分桶
+     */
+    template <typename Buckets>
+    class BasicHistogram
+    {
+    public:
+        using Snapshot = BasicHistogramSnapshot<Buckets>;
+
+        static constexpr uint32_t SUB_BUCKET_COUNT = Buckets::SUB_BUCKET_COUNT;
+        static constexpr uint32_t BUCKET_COUNT     = Buckets::BUCKET_COUNT;
+
+        /**
+         * @param unit 记录值换算为秒的系数，如1e-6表示记录微秒数
+         */
+        explicit BasicHistogram(double unit = 1.0)
+            : _unit(unit)
+            , _unitNs(std::max<int64_t>(1, std::llround(unit * 1e9)))
+        {
+        }
+
+        void Record(uint64_t value)
+        {
+            _buckets[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+            _sum.fetch_add(value, std::memory_order_relaxed);
+
+            uint64_t current = _min.load(std::memory_order_relaxed);
+            while (value < current && !_min.compare_exchange_weak(current, value, std::memory_order_relaxed))
+            {
+            }
+
+            current = _max.load(std::memory_order_relaxed);
+            while (value > current && !_max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        // 按记录值的单位换算后记录，单位为1e-6的直方图记录微秒数
+        void Record(std::chrono::steady_clock::duration duration)
+        {
+            // 按整数纳秒换算，避免浮点误差使整数值落入相邻的桶
+            const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+            Record(nanoseconds > 0 ? static_cast<uint64_t>(nanoseconds / _unitNs) : 0);
+        }
+
+        [[nodiscard]] Snapshot GetSnapshot() const
+        {
+            // 样本数由各桶汇总，保证与桶计数一致
+            Snapshot snapshot;
+            for (uint32_t i = 0; i < BUCKET_COUNT; ++i)
+            {
+                snapshot.buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+                snapshot.count += snapshot.buckets[i];
+            }
+            snapshot.sum = _sum.load(std::memory_order_relaxed);
+            snapshot.min = _min.load(std::memory_order_relaxed);
+            snapshot.max = _max.load(std::memory_order_relaxed);
+            return snapshot;
+        }
+
+        // 取出自上次取出以来的样本并清零
+        Snapshot TakeSnapshot()
+        {
+            Snapshot snapshot;
+            for (uint32_t i = 0; i < BUCKET_COUNT; ++i)
+            {
+                snapshot.buckets[i] = _buckets[i].exchange(0, std::memory_order_relaxed);
+                snapshot.count += snapshot.buckets[i];
+            }
+            snapshot.sum = _sum.exchange(0, std::memory_order_relaxed);
+            snapshot.min = _min.exchange(UINT64_MAX, std::memory_order_relaxed);
+            snapshot.max = _max.exchange(0, std::memory_order_relaxed);
+            return snapshot;
+        }
+
+        [[nodiscard]] double GetUnit() const
+        {
+            return _unit;
+        }
+
+        static uint32_t GetBucketIndex(uint64_t value)
+        {
+            return Buckets::GetBucketIndex(value);
+        }
+
+        // 桶内值的上界(含)
+        static uint64_t GetBucketUpperBound(uint32_t index)
+        {
+            return Buckets::GetBucketUpperBound(index);
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> _buckets {};
+        std::atomic<uint64_t>                           _sum {0};
+        std::atomic<uint64_t>                           _min {UINT64_MAX};
+        std::atomic<uint64_t>                           _max {0};
+        double                                          _unit;
+        int64_t                                         _unitNs; // 单位对应的纳秒数，至少为1
+    };
+} // namespace Util
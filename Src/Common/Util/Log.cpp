@@ -7,15 +7,65 @@
 > Created Time    : 2024年01月05日  17时36分03秒
 ************************************************************************/
 #include "Log.h"
+#include "CachedClock.h"
+#include "MPSCQueue.hpp"
 #include "spdlog/sinks/base_sink.h"
 #include "spdlog/details/file_helper.h"
+#include "spdlog/details/log_msg_buffer.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <filesystem>
 #include <chrono>
+#include <mutex>
+#include <thread>
 
 namespace Log
 {
+    std::string_view GetHtmlLogHeader()
+    {
+        return R"(<html>
+                <head>
+                <meta http-equiv="content-type" content="text/html; charset-gb2312">
+                <title>Html Output</title>
+                </head>
+                <body>
+                <font face="Fixedsys" size="2" color="#0000FF">)";
+    }
+
+    const char *GetLogLevelHtmlPrefix(spdlog::level level)
+    {
+        const char *pPrefix = "";
+        switch (level)
+        {
+            case spdlog::level::trace:
+                pPrefix = R"(<font color=" #DCDFE4">)";
+                break;
+            case spdlog::level::debug:
+                pPrefix = R"(<font color=" #56B6C2">)";
+                break;
+            case spdlog::level::info:
+                pPrefix = R"(<font color=" #98C379">)";
+                break;
+            case spdlog::level::warn:
+                pPrefix = R"(<font color=" #E5C07B">)";
+                break;
+            case spdlog::level::err:
+                pPrefix = R"(<font color=" #E06C75">)";
+                break;
+            case spdlog::level::critical:
+                pPrefix = R"(<font color=" #DCDFE4" style="background-color:#E06C75;">)";
+                break;
+            case spdlog::level::off:
+            case spdlog::level::n_levels:
+                break;
+        }
+
+        return pPrefix;
+    }
+
     template <typename Mutex>
     class HtmlFormatSink final : public spdlog::sinks::base_sink<Mutex>
     {
@@ -41,18 +91,7 @@ namespace Log
             }
             _fileHelper.open(calc_filename(_mBaseFilename, 0));
 
-            // 写入html头
-            spdlog::memory_buf_t htmlHeader;
-            const char          *pHtmlHeader =
-                R"(<html>
-                <head>
-                <meta http-equiv="content-type" content="text/html; charset-gb2312">
-                <title>Html Output</title>
-                </head>
-                <body>
-                <font face="Fixedsys" size="2" color="#0000FF">)";
-            htmlHeader.append(pHtmlHeader, pHtmlHeader + std::strlen(pHtmlHeader));
-            _fileHelper.write(htmlHeader);
+            WriteHtmlHeader();
 
             _currentSize = _fileHelper.size(); // expensive. called only once
             if (rotateOnOpen && _currentSize > 0)
@@ -65,9 +104,9 @@ namespace Log
         static spdlog::filename_t calc_filename(const spdlog::filename_t &fileName, std::size_t index)
         {
             const auto &[basename, ext] = spdlog::details::file_helper::split_by_extension(fileName);
-            std::string strTimeStr      = std::format(
-                "{:%Y_%m_%d_%H_%M_%OS}",
-                std::chrono::zoned_time {std::chrono::current_zone(), std::chrono::system_clock::now()});
+            // 轮换不频繁，先刷新再取缓存的本地时间，避免每次查找时区数据库
+            TimeUtil::CachedClock::Update();
+            const std::string_view strTimeStr = TimeUtil::CachedClock::GetFileTimestamp();
 
             return spdlog::fmt_lib::format(SPDLOG_FILENAME_T("{}{}.{}{}"), basename, strTimeStr, index, ext);
         }
@@ -89,8 +128,7 @@ namespace Log
             spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, formatted);
 
             // 填充后缀
-            const char *pSuffix = R"(<br></font>)";
-            formatted.append(pSuffix, pSuffix + std::strlen(pSuffix));
+            formatted.append(HTML_LOG_SUFFIX.data(), HTML_LOG_SUFFIX.data() + HTML_LOG_SUFFIX.size());
 
             auto newSize = _currentSize + formatted.size();
 
@@ -153,19 +191,14 @@ namespace Log
                 }
             }
             _fileHelper.reopen(true);
+            WriteHtmlHeader();
+        }
 
-            // 写入html头
-            spdlog::memory_buf_t htmlHeader;
-            const char          *pHtmlHeader =
-                R"(<html>
-                <head>
-                <meta http-equiv="content-type" content="text/html; charset-gb2312">
-                <title>Html Output</title>
-                </head>
-                <body>
-                <font face="Fixedsys" size="2" color="#0000FF">)";
-
-            htmlHeader.append(pHtmlHeader, pHtmlHeader + std::strlen(pHtmlHeader));
+        void WriteHtmlHeader()
+        {
+            const std::string_view strHeader = GetHtmlLogHeader();
+            spdlog::memory_buf_t   htmlHeader;
+            htmlHeader.append(strHeader.data(), strHeader.data() + strHeader.size());
             _fileHelper.write(htmlHeader);
         }
 
@@ -178,48 +211,304 @@ namespace Log
             return std::rename(srcFileName.c_str(), targetFileName.c_str()) == 0;
         }
 
-        constexpr const char *GetLogLevelHtmlPrefix(spdlog::level level)
+    private:
+        spdlog::filename_t           _mBaseFilename;
+        std::size_t                  _maxSize;
+        std::size_t                  _maxFiles;
+        std::size_t                  _currentSize;
+        spdlog::details::file_helper _fileHelper;
+    };
+
+    using HtmlFormatSinkMt = HtmlFormatSink<std::mutex>;
+    using HtmlFormatSinkSt = HtmlFormatSink<spdlog::details::null_mutex>;
+
+    namespace
+    {
+        enum class AsyncRecordType : uint8_t
+        {
+            Message,
+            Flush,
+            Stop,
+        };
+
+        struct AsyncRecord
         {
-            const char *pPrefix = "";
-            switch (level)
+            AsyncRecordType                 type {AsyncRecordType::Message};
+            spdlog::details::log_msg_buffer msg;
+            uint64_t                        flushTicket {0}; // Flush记录的序号
+        };
+    } // namespace
+
+    /**
+     * @brief 异步sink，日志拷贝进无锁队列后立即返回，由写线程成批交给内部sink写出
+     *        内部sink只在写线程上使用，因此使用无锁版本(_st)
+     */
+    class AsyncSink final : public spdlog::sinks::sink
+    {
+        using Record     = AsyncRecord;
+        using RecordType = AsyncRecordType;
+
+    public:
+        AsyncSink(std::vector<spdlog::sink_ptr> sinks, const AsyncLogConfig &config)
+            : _sinks(std::move(sinks))
+            , _capacity(std::max<std::size_t>(config.queueCapacity, 1))
+            , _maxBatchSize(std::max<std::size_t>(config.maxBatchSize, 1))
+            , _overflowPolicy(config.overflowPolicy)
+            , _queue(_capacity)
+        {
+            _writer = std::thread([this]() { WriterLoop(); });
+        }
+
+        ~AsyncSink() override
+        {
+            // 停止记录排在所有已入队日志之后，写线程写完剩余日志后退出
+            Enqueue(Record {RecordType::Stop, {}, 0});
+            _writer.join();
+        }
+
+        AsyncSink(const AsyncSink &)            = delete;
+        AsyncSink &operator=(const AsyncSink &) = delete;
+        AsyncSink(AsyncSink &&)                 = delete;
+        AsyncSink &operator=(AsyncSink &&)      = delete;
+
+        void log(const spdlog::details::log_msg &msg) override
+        {
+            // 队列已满时先丢弃，不必拷贝
+            if (OverflowPolicy::Drop == _overflowPolicy && _size.load(std::memory_order_relaxed) >= _capacity)
             {
-                case spdlog::level::trace:
-                    pPrefix = R"(<font color=" #DCDFE4">)";
-                    break;
-                case spdlog::level::debug:
-                    pPrefix = R"(<font color=" #56B6C2">)";
-                    break;
-                case spdlog::level::info:
-                    pPrefix = R"(<font color=" #98C379">)";
-                    break;
-                case spdlog::level::warn:
-                    pPrefix = R"(<font color=" #E5C07B">)";
-                    break;
-                case spdlog::level::err:
-                    pPrefix = R"(<font color=" #E06C75">)";
+                _droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            // 占位之前拷贝日志，拷贝抛出异常时不会留下一个永远不入队的占位使写线程一直等待
+            Record record {RecordType::Message, spdlog::details::log_msg_buffer {msg}, 0};
+            if (!Reserve())
+            {
+                _droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            Push(std::move(record));
+        }
+
+        void flush() override
+        {
+            const uint64_t ticket = _flushRequested.fetch_add(1, std::memory_order_relaxed) + 1;
+            Enqueue(Record {RecordType::Flush, {}, ticket});
+
+            uint64_t completed = _flushCompleted.load(std::memory_order_acquire);
+            while (completed < ticket)
+            {
+                _flushCompleted.wait(completed, std::memory_order_acquire);
+                completed = _flushCompleted.load(std::memory_order_acquire);
+            }
+        }
+
+        void set_pattern(const std::string &pattern) override
+        {
+            std::lock_guard lock(_sinkMutex);
+            for (const auto &sink : _sinks)
+            {
+                sink->set_pattern(pattern);
+            }
+        }
+
+        void set_formatter(std::unique_ptr<spdlog::formatter> sinkFormatter) override
+        {
+            std::lock_guard lock(_sinkMutex);
+            for (const auto &sink : _sinks)
+            {
+                sink->set_formatter(sinkFormatter->clone());
+            }
+        }
+
+        [[nodiscard]] uint64_t GetDroppedCount() const
+        {
+            return _droppedCount.load(std::memory_order_relaxed);
+        }
+
+    private:
+        // 占用一个队列位置，队列已满时按溢出策略阻塞或返回false
+        bool Reserve()
+        {
+            std::size_t size = _size.load(std::memory_order_relaxed);
+            while (true)
+            {
+                if (size >= _capacity)
+                {
+                    if (OverflowPolicy::Drop == _overflowPolicy)
+                    {
+                        return false;
+                    }
+
+                    _size.wait(size, std::memory_order_relaxed);
+                    size = _size.load(std::memory_order_relaxed);
+                    continue;
+                }
+
+                if (_size.compare_exchange_weak(size, size + 1))
+                {
+                    return true;
+                }
+            }
+        }
+
+        // 控制记录不受容量限制，保证Flush与析构不会被丢弃
+        void Enqueue(Record &&record)
+        {
+            _size.fetch_add(1);
+            Push(std::move(record));
+        }
+
+        void Push(Record &&record)
+        {
+            _queue.Push(std::move(record));
+
+            // 只有写线程空闲等待时才需要唤醒，与写线程的标记、等待之间需要顺序一致
+            if (_bWriterIdle.load())
+            {
+                _bWriterIdle.store(false, std::memory_order_relaxed);
+                _size.notify_all();
+            }
+        }
+
+        void WriterLoop()
+        {
+            bool   bStop = false;
+            Record record;
+            while (true)
+            {
+                std::size_t pending = _size.load(std::memory_order_acquire);
+                if (0 == pending)
+                {
+                    if (bStop)
+                    {
+                        break;
+                    }
+
+                    _bWriterIdle.store(true);
+                    _size.wait(0);
+                    continue;
+                }
+
+                const std::size_t batchSize = std::min(pending, _maxBatchSize);
+                std::size_t       written   = 0;
+                {
+                    std::lock_guard lock(_sinkMutex);
+                    while (written < batchSize)
+                    {
+                        // 生产者已占位但尚未完成入队
+                        if (!_queue.Pop(record))
+                        {
+                            std::this_thread::yield();
+                            continue;
+                        }
+
+                        bStop = bStop || RecordType::Stop == record.type;
+                        WriteRecord(record);
+                        ++written;
+                    }
+
+                    ReportDropped();
+
+                    // 队列已写空时统一刷新，繁忙时由缓冲区合并写入
+                    if (written == pending)
+                    {
+                        FlushSinks();
+                    }
+                }
+
+                _size.fetch_sub(written, std::memory_order_release);
+                _size.notify_all();
+            }
+        }
+
+        void WriteRecord(const Record &record)
+        {
+            switch (record.type)
+            {
+                case RecordType::Message:
+                    WriteMessage(record.msg);
                     break;
-                case spdlog::level::critical:
-                    pPrefix = R"(<font color=" #DCDFE4" style="background-color:#E06C75;">)";
+                case RecordType::Flush:
+                    FlushSinks();
+                    if (record.flushTicket > _flushCompleted.load(std::memory_order_relaxed))
+                    {
+                        _flushCompleted.store(record.flushTicket, std::memory_order_release);
+                    }
+                    _flushCompleted.notify_all();
                     break;
-                case spdlog::level::off:
-                case spdlog::level::n_levels:
+                case RecordType::Stop:
                     break;
             }
+        }
+
+        void WriteMessage(const spdlog::details::log_msg &msg)
+        {
+            for (const auto &sink : _sinks)
+            {
+                if (!sink->should_log(msg.log_level))
+                {
+                    continue;
+                }
+
+                try
+                {
+                    sink->log(msg);
+                }
+                catch (const std::exception &e)
+                {
+                    std::fprintf(stderr, "AsyncSink write failed: %s\n", e.what());
+                }
+            }
+        }
+
+        void FlushSinks()
+        {
+            for (const auto &sink : _sinks)
+            {
+                try
+                {
+                    sink->flush();
+                }
+                catch (const std::exception &e)
+                {
+                    std::fprintf(stderr, "AsyncSink flush failed: %s\n", e.what());
+                }
+            }
+        }
+
+        // 丢弃的条数在写线程上以一条警告日志输出
+        void ReportDropped()
+        {
+            const uint64_t dropped = _droppedCount.load(std::memory_order_relaxed);
+            if (dropped == _reportedDropped)
+            {
+                return;
+            }
 
-            return pPrefix;
+            const std::string text = std::format("异步日志队列已满，丢弃{}条日志",
+                                                 dropped - _reportedDropped);
+            _reportedDropped       = dropped;
+            WriteMessage(spdlog::details::log_msg {spdlog::source_loc {}, "", spdlog::level::warn, text});
         }
 
     private:
-        spdlog::filename_t           _mBaseFilename;
-        std::size_t                  _maxSize;
-        std::size_t                  _maxFiles;
-        std::size_t                  _currentSize;
-        spdlog::details::file_helper _fileHelper;
+        std::vector<spdlog::sink_ptr> _sinks;     // 只在写线程上使用的内部sink
+        std::mutex                    _sinkMutex; // 保护写入与修改格式，正常只由写线程持有
+        const std::size_t             _capacity;
+        const std::size_t             _maxBatchSize;
+        const OverflowPolicy          _overflowPolicy;
+        MPSCQueue<Record>             _queue;
+        std::atomic<std::size_t>      _size {0}; // 已占位但未写出的记录数
+        std::atomic<bool>             _bWriterIdle {false};
+        std::atomic<uint64_t>         _droppedCount {0};
+        uint64_t                      _reportedDropped {0};
+        std::atomic<uint64_t>         _flushRequested {0};
+        std::atomic<uint64_t>         _flushCompleted {0};
+        std::thread                   _writer;
     };
 
-    using HtmlFormatSinkMt = HtmlFormatSink<std::mutex>;
-    using HtmlFormatSinkSt = HtmlFormatSink<spdlog::details::null_mutex>;
-
     void CLogger::InitLogger(std::string_view fileName,
                              size_t           level,
                              size_t           maxFileSize,
@@ -228,17 +517,80 @@ namespace Log
     {
         auto fileSink =
             std::make_shared<HtmlFormatSinkMt>(std::string(fileName), maxFileSize * 1024 * 1024, maxFiles);
-        fileSink->set_level(static_cast<spdlog::level>(level));
+        fileSink->set_level(spdlog::level::trace);
         fileSink->set_pattern(std::string(pattern));
 
         auto consoleSink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-        consoleSink->set_level(static_cast<spdlog::level>(level));
+        consoleSink->set_level(spdlog::level::trace);
         consoleSink->set_pattern(std::string(pattern));
 
         std::vector<spdlog::sink_ptr> sinks {fileSink, consoleSink};
         _logger = std::make_shared<spdlog::logger>("MultiLogger", std::begin(sinks), std::end(sinks));
-        _logger->set_level(static_cast<spdlog::level>(level));
+        _logger->set_level(spdlog::level::trace);
+
+        // 等级由Log::ShouldLog按模块过滤，spdlog本身不再过滤
+        SetLevel(level);
+        spdlog::set_default_logger(_logger);
+    }
+
+    void CLogger::InitAsyncLogger(std::string_view      fileName,
+                                  size_t                level,
+                                  size_t                maxFileSize,
+                                  size_t                maxFiles,
+                                  const AsyncLogConfig &config,
+                                  std::string_view      pattern)
+    {
+        auto fileSink =
+            std::make_shared<HtmlFormatSinkSt>(std::string(fileName), maxFileSize * 1024 * 1024, maxFiles);
+        fileSink->set_level(spdlog::level::trace);
+        fileSink->set_pattern(std::string(pattern));
+
+        std::vector<spdlog::sink_ptr> sinks {fileSink};
+        if (config.bConsoleOutput)
+        {
+            auto consoleSink = std::make_shared<spdlog::sinks::stdout_color_sink_st>();
+            consoleSink->set_level(spdlog::level::trace);
+            consoleSink->set_pattern(std::string(pattern));
+            sinks.push_back(std::move(consoleSink));
+        }
+
+        _asyncSink = std::make_shared<AsyncSink>(std::move(sinks), config);
+        _asyncSink->set_level(spdlog::level::trace);
 
+        _logger = std::make_shared<spdlog::logger>("MultiLogger", _asyncSink);
+        _logger->set_level(spdlog::level::trace);
+
+        // 等级由Log::ShouldLog按模块过滤，spdlog本身不再过滤
+        SetLevel(level);
         spdlog::set_default_logger(_logger);
     }
+
+    bool CLogger::InitBinaryLogger(std::string_view fileName, size_t level, size_t capacity)
+    {
+        SetLevel(level);
+        return BinaryLogger::GetInstance().Open(fileName, capacity * 1024 * 1024);
+    }
+
+    uint64_t CLogger::GetDroppedCount() const
+    {
+        return nullptr == _asyncSink ? 0 : _asyncSink->GetDroppedCount();
+    }
+
+    void CLogger::SetLevel(size_t level)
+    {
+        for (auto &moduleLevel : Detail::g_moduleLevels.levels)
+        {
+            moduleLevel.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+        }
+    }
+
+    void CLogger::SetModuleLevel(LogModule module, size_t level)
+    {
+        Detail::GetModuleLevel(module).store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+    }
+
+    size_t CLogger::GetModuleLevel(LogModule module) const
+    {
+        return Detail::GetModuleLevel(module).load(std::memory_order_relaxed);
+    }
 } // namespace Log
\ No newline at end of file
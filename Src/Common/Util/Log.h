@@ -9,8 +9,20 @@
 #pragma once
 #define SPDLOG_SOURCE_LOCATION
 #include "spdlog/spdlog.h"
+#include "BinaryLog.h"
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <format>
+#include <functional>
 #include <string_view>
+#include <type_traits>
+
+// 编译期保留的最低日志等级，取值同spdlog::level，低于该等级的调用被整体移除
+#ifndef LOG_ACTIVE_LEVEL
+    #define LOG_ACTIVE_LEVEL 0
+#endif
 
 constexpr inline std::string_view GetDefaultLogPattern()
 {
@@ -23,6 +35,80 @@ constexpr inline std::string_view GetDefaultLogPattern()
 
 namespace Log
 {
+    // 可单独设置运行时等级的模块
+    enum class LogModule : uint8_t
+    {
+        Default,
+        Net,
+        Http,
+        Database,
+        Script,
+        Count,
+    };
+
+    constexpr bool IsLevelCompiled(spdlog::level level)
+    {
+        return static_cast<int>(level) >= LOG_ACTIVE_LEVEL;
+    }
+
+    namespace Detail
+    {
+        // 各模块的运行时等级，独占缓存行，只在修改等级时写入
+        struct alignas(64) ModuleLevels
+        {
+            std::array<std::atomic<uint8_t>, static_cast<std::size_t>(LogModule::Count)> levels {};
+        };
+
+        inline ModuleLevels g_moduleLevels;
+
+        inline std::atomic<uint8_t> &GetModuleLevel(LogModule module)
+        {
+            return g_moduleLevels.levels[static_cast<std::size_t>(module)];
+        }
+    } // namespace Detail
+
+    inline bool ShouldLog(LogModule module, spdlog::level level)
+    {
+        return static_cast<uint8_t>(level) >= Detail::GetModuleLevel(module).load(std::memory_order_relaxed);
+    }
+
+    // 延迟求值的日志参数，见文件末尾的std::formatter特化
+    template <typename F>
+        requires std::invocable<const F &>
+    struct Lazy
+    {
+        F func;
+    };
+
+    template <typename F>
+    Lazy(F) -> Lazy<F>;
+
+    // 异步日志队列已满时的处理方式
+    enum class OverflowPolicy : uint8_t
+    {
+        Block, // 阻塞调用线程直到队列有空位
+        Drop,  // 丢弃并计数，由写线程输出丢弃条数
+    };
+
+    struct AsyncLogConfig
+    {
+        std::size_t    queueCapacity  = 8192;                  // 队列中最多缓存的日志条数
+        OverflowPolicy overflowPolicy = OverflowPolicy::Block; // 队列满时的处理方式
+        std::size_t    maxBatchSize   = 256;                   // 写线程每批最多写入的条数
+        bool           bConsoleOutput = true;                  // 是否同时输出到控制台
+    };
+
+    class AsyncSink;
+
+    // html日志文件头
+    std::string_view GetHtmlLogHeader();
+
+    // 各等级日志在html中的字体前缀
+    const char *GetLogLevelHtmlPrefix(spdlog::level level);
+
+    // html中每条日志的后缀
+    constexpr std::string_view HTML_LOG_SUFFIX = R"(<br></font>)";
+
     class CLogger final
     {
     public:
@@ -43,11 +129,60 @@ namespace Log
                         size_t           maxFiles,
                         std::string_view pattern = GetDefaultLogPattern());
 
+        /**
+         * @brief 初始化异步日志，调用线程只负责格式化参数并入队，
+         *        html格式化与文件、控制台写入由独立的写线程成批完成
+         *
+         * @param fileName 日志文件名
+         * @param level 日志等级
+         * @param maxFileSize 单个日志文件大小上限(MB)
+         * @param maxFiles 日志文件个数上限
+         * @param config 队列容量、溢出策略等配置
+         * @param pattern 日志格式
+         */
+        void InitAsyncLogger(std::string_view      fileName,
+                             size_t                level,
+                             size_t                maxFileSize,
+                             size_t                maxFiles,
+                             const AsyncLogConfig &config  = {},
+                             std::string_view      pattern = GetDefaultLogPattern());
+
+        /**
+         * @brief 初始化二进制日志，调用线程只把原始参数编码进内存映射的环形文件，
+         *        格式化推迟到离线工具LogDecoder，可还原为html或文本
+         *
+         * @param fileName 日志文件名
+         * @param level 日志等级
+         * @param capacity 环形文件大小(MB)，写满后覆盖最旧的日志
+         * @return 是否成功
+         */
+        bool InitBinaryLogger(std::string_view fileName, size_t level, size_t capacity);
+
+        // 同步模式下立即写出；异步模式下等待写线程写完此前入队的日志；二进制模式下回写映射文件
         void Flush() const
         {
-            _logger->flush();
+            if (BinaryLogger::GetInstance().IsOpen())
+            {
+                BinaryLogger::GetInstance().Flush();
+            }
+
+            if (nullptr != _logger)
+            {
+                _logger->flush();
+            }
         }
 
+        // 异步模式下因队列已满而丢弃的日志条数
+        [[nodiscard]] uint64_t GetDroppedCount() const;
+
+        // 设置所有模块的运行时等级
+        void SetLevel(size_t level);
+
+        // 单独设置某个模块的运行时等级，可低于或高于其他模块
+        void SetModuleLevel(LogModule module, size_t level);
+
+        [[nodiscard]] size_t GetModuleLevel(LogModule module) const;
+
     private:
         CLogger() = default;
 
@@ -55,42 +190,134 @@ namespace Log
 
     private:
         std::shared_ptr<spdlog::logger> _logger;
+        std::shared_ptr<AsyncSink>      _asyncSink; // 异步模式下的队列sink
     };
 
-    template <typename... Args>
+    namespace Detail
+    {
+        // 二进制日志开启时只编码原始参数，否则交给spdlog格式化输出，调用方已检查过等级
+        template <typename... Args>
+        inline void Output(spdlog::level level, const spdlog::loc_with_fmt &fmt, Args &&...args)
+        {
+            auto &binaryLogger = BinaryLogger::GetInstance();
+            if (binaryLogger.IsOpen())
+            {
+                binaryLogger.Write(static_cast<uint8_t>(level),
+                                   fmt.fmt_string,
+                                   fmt.loc.filename,
+                                   static_cast<uint32_t>(fmt.loc.line),
+                                   fmt.loc.funcname,
+                                   args...);
+                return;
+            }
+
+            spdlog::log(fmt.loc, level, fmt.fmt_string, std::forward<Args>(args)...);
+        }
+
+        template <typename... Args>
+        inline void Write(LogModule                   module,
+                          spdlog::level               level,
+                          const spdlog::loc_with_fmt &fmt,
+                          Args &&...args)
+        {
+            if (ShouldLog(module, level))
+            {
+                Output(level, fmt, std::forward<Args>(args)...);
+            }
+        }
+    } // namespace Detail
+
+    template <LogModule Module = LogModule::Default, typename... Args>
     inline void Tracy(spdlog::loc_with_fmt fmt, Args &&...args)
     {
-        spdlog::log(fmt.loc, spdlog::level::trace, fmt.fmt_string, std::forward<Args>(args)...);
+        if constexpr (IsLevelCompiled(spdlog::level::trace))
+        {
+            Detail::Write(Module, spdlog::level::trace, fmt, std::forward<Args>(args)...);
+        }
     }
 
-    template <typename... Args>
+    template <LogModule Module = LogModule::Default, typename... Args>
     inline void Debug(spdlog::loc_with_fmt fmt, Args &&...args)
     {
-        spdlog::log(fmt.loc, spdlog::level::debug, fmt.fmt_string, std::forward<Args>(args)...);
+        if constexpr (IsLevelCompiled(spdlog::level::debug))
+        {
+            Detail::Write(Module, spdlog::level::debug, fmt, std::forward<Args>(args)...);
+        }
     }
 
-    template <typename... Args>
+    template <LogModule Module = LogModule::Default, typename... Args>
     inline void Info(spdlog::loc_with_fmt fmt, Args &&...args)
     {
-        spdlog::log(fmt.loc, spdlog::level::info, fmt.fmt_string, std::forward<Args>(args)...);
+        if constexpr (IsLevelCompiled(spdlog::level::info))
+        {
+            Detail::Write(Module, spdlog::level::info, fmt, std::forward<Args>(args)...);
+        }
     }
 
-    template <typename... Args>
+    template <LogModule Module = LogModule::Default, typename... Args>
     inline void Warn(spdlog::loc_with_fmt fmt, Args &&...args)
     {
-        spdlog::log(fmt.loc, spdlog::level::warn, fmt.fmt_string, std::forward<Args>(args)...);
+        if constexpr (IsLevelCompiled(spdlog::level::warn))
+        {
+            Detail::Write(Module, spdlog::level::warn, fmt, std::forward<Args>(args)...);
+        }
     }
 
-    template <typename... Args>
+    template <LogModule Module = LogModule::Default, typename... Args>
     inline void Error(spdlog::loc_with_fmt fmt, Args &&...args)
     {
-        spdlog::log(fmt.loc, spdlog::level::err, fmt.fmt_string, std::forward<Args>(args)...);
+        if constexpr (IsLevelCompiled(spdlog::level::err))
+        {
+            Detail::Write(Module, spdlog::level::err, fmt, std::forward<Args>(args)...);
+        }
     }
 
-    template <typename... Args>
+    template <LogModule Module = LogModule::Default, typename... Args>
     inline void Critical(spdlog::loc_with_fmt fmt, Args &&...args)
     {
-        spdlog::log(fmt.loc, spdlog::level::critical, fmt.fmt_string, std::forward<Args>(args)...);
+        if constexpr (IsLevelCompiled(spdlog::level::critical))
+        {
+            Detail::Write(Module, spdlog::level::critical, fmt, std::forward<Args>(args)...);
+        }
     }
 
 } // namespace Log
+
+/**
+ * 带模块的日志宏，与Log::Debug等函数不同，等级不满足时参数不会求值：
+ * 低于LOG_ACTIVE_LEVEL的调用在编译期整体移除，运行时模块等级不满足时只有一次原子读和一次分支
+ * 用法：LOG_DEBUG(Database, "query {}", sql);
+ */
+#define LOG_MODULE_CALL(lvl, module, ...)                                         \
+    do                                                                            \
+    {                                                                             \
+        if constexpr (Log::IsLevelCompiled(spdlog::level::lvl))                   \
+        {                                                                         \
+            if (Log::ShouldLog(Log::LogModule::module, spdlog::level::lvl))       \
+            {                                                                     \
+                Log::Detail::Output(spdlog::level::lvl, __VA_ARGS__);             \
+            }                                                                     \
+        }                                                                         \
+    } while (0)
+
+#define LOG_TRACE(module, ...)    LOG_MODULE_CALL(trace, module, __VA_ARGS__)
+#define LOG_DEBUG(module, ...)    LOG_MODULE_CALL(debug, module, __VA_ARGS__)
+#define LOG_INFO(module, ...)     LOG_MODULE_CALL(info, module, __VA_ARGS__)
+#define LOG_WARN(module, ...)     LOG_MODULE_CALL(warn, module, __VA_ARGS__)
+#define LOG_ERROR(module, ...)    LOG_MODULE_CALL(err, module, __VA_ARGS__)
+#define LOG_CRITICAL(module, ...) LOG_MODULE_CALL(critical, module, __VA_ARGS__)
+
+/**
+ * 延迟求值的日志参数，只有日志确实输出时才调用，返回值按其自身的格式说明格式化
+ * 用法：Log::Debug("thread:{}", Log::Lazy([] { return ThreadIdString(); }));
+ */
+template <typename F>
+    requires std::invocable<const F &>
+struct std::formatter<Log::Lazy<F>> : std::formatter<std::decay_t<std::invoke_result_t<const F &>>>
+{
+    template <typename FormatContext>
+    auto format(const Log::Lazy<F> &lazy, FormatContext &ctx) const
+    {
+        return std::formatter<std::decay_t<std::invoke_result_t<const F &>>>::format(lazy.func(), ctx);
+    }
+};
@@ -0,0 +1,66 @@
+﻿/*************************************************************************
+> File Name       : LogLinearBuckets.h
+> Brief           : 对数线性分桶
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年10月21日  10时05分32秒
+************************************************************************/
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+namespace Util
+{
+    /**
+     * @brief 直方图的对数线性分桶，不超过SUB_BUCKET_COUNT的值各占一个桶，
+     *        之后每个2的幂区间再等分为SUB_BUCKET_COUNT个桶，相对误差不超过1/SUB_BUCKET_COUNT。
+     *        桶为左开右闭区间，与Prometheus的le语义一致
+     *
+     * @tparam SubBucketBits 每个2的幂区间的等分数取2的对数，为0时退化为按2的幂分桶
+     * @tparam MaxValueBits 可区分的最大值取2的对数，超出的值计入最后一个桶
+     */
+    template <uint32_t SubBucketBits, uint32_t MaxValueBits>
+    struct LogLinearBuckets
+    {
+        static_assert(SubBucketBits < MaxValueBits && MaxValueBits < 64);
+
+        static constexpr uint32_t SUB_BUCKET_BITS  = SubBucketBits;
+        static constexpr uint32_t SUB_BUCKET_COUNT = 1U << SubBucketBits;
+        static constexpr uint32_t MAX_VALUE_BITS   = MaxValueBits;
+        static constexpr uint32_t BUCKET_COUNT     = (MaxValueBits - SubBucketBits + 1) * SUB_BUCKET_COUNT;
+
+        static constexpr uint32_t GetBucketIndex(uint64_t value)
+        {
+            value = 0 == value ? 0 : value - 1;
+            if (value < SUB_BUCKET_COUNT)
+            {
+                return static_cast<uint32_t>(value);
+            }
+
+            const auto exponent = static_cast<uint32_t>(std::bit_width(value) - 1);
+            if (exponent >= MAX_VALUE_BITS)
+            {
+                return BUCKET_COUNT - 1;
+            }
+
+            const uint32_t shift     = exponent - SUB_BUCKET_BITS;
+            const auto     subBucket = static_cast<uint32_t>(value >> shift) & (SUB_BUCKET_COUNT - 1);
+            return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + subBucket;
+        }
+
+        // 桶内值的上界(含)
+        static constexpr uint64_t GetBucketUpperBound(uint32_t index)
+        {
+            if (index < SUB_BUCKET_COUNT)
+            {
+                return index + 1;
+            }
+
+            const uint32_t shift     = index / SUB_BUCKET_COUNT - 1;
+            const uint64_t subBucket = index % SUB_BUCKET_COUNT;
+            return (SUB_BUCKET_COUNT + subBucket + 1) << shift;
+        }
+    };
+} // namespace Util
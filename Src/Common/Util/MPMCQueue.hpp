@@ -0,0 +1,342 @@
+﻿/*************************************************************************
+> File Name       : MPMCQueue.hpp
+> Brief           : 无锁多生产者多消费者有界队列
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月12日  15时08分21秒
+************************************************************************/
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief 基于环形数组的无锁多生产者多消费者有界队列（Vyukov MPMC）
+ *        每个槽位带序号，生产者与消费者各自只竞争一个位置计数，TryPush/TryPop不加锁也不分配内存。
+ *        WaitAndPush/WaitAndPop在队列满/空时先让出几次CPU，
+ *        仍不成功再通过std::atomic::wait阻塞(Linux上为futex)，
+ *        只有存在休眠的等待者时入队/出队才会发出唤醒，每次休眠只唤醒一次。
+ *        元素的移动构造与移动赋值不能抛出异常，否则已占用的槽位无法发布
+ */
+template <typename T>
+    requires std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>
+class MPMCQueue
+{
+    static constexpr int WAIT_YIELD_COUNT = 16; // 休眠前让出CPU的次数
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence {0};
+        alignas(T) std::byte storage[sizeof(T)];
+
+        T *Get() noexcept
+        {
+            return std::launder(reinterpret_cast<T *>(storage));
+        }
+    };
+
+public:
+    /**
+     * @brief 构造队列
+     *
+     * @param capacity 容量，向上取整为2的幂，至少为2
+     */
+    explicit MPMCQueue(std::size_t capacity)
+        : _capacity(std::bit_ceil((std::max)(capacity, std::size_t {2})))
+        , _mask(_capacity - 1)
+        , _pCells(std::make_unique<Cell[]>(_capacity))
+    {
+        for (std::size_t i = 0; i < _capacity; ++i)
+        {
+            _pCells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // 析构时不能再有其他线程访问队列
+    ~MPMCQueue()
+    {
+        const std::size_t end = _enqueuePos.load(std::memory_order_relaxed);
+        for (std::size_t pos = _dequeuePos.load(std::memory_order_relaxed); pos != end; ++pos)
+        {
+            std::destroy_at(_pCells[pos & _mask].Get());
+        }
+    }
+
+    MPMCQueue(const MPMCQueue &)            = delete;
+    MPMCQueue &operator=(const MPMCQueue &) = delete;
+    MPMCQueue(MPMCQueue &&)                 = delete;
+    MPMCQueue &operator=(MPMCQueue &&)      = delete;
+
+    /**
+     * @brief 非阻塞入队
+     *
+     * @param value 入队的值，能够无异常构造T时失败不会被移走
+     * @return 队列已满时返回false
+     */
+    template <typename U>
+        requires std::constructible_from<T, U &&>
+    bool TryPush(U &&value)
+    {
+        if constexpr (std::is_nothrow_constructible_v<T, U &&>)
+        {
+            return PushImpl(std::forward<U>(value));
+        }
+        else
+        {
+            // 构造可能抛出异常，先在槽位外构造好再占用槽位
+            T element(std::forward<U>(value));
+            return PushImpl(std::move(element));
+        }
+    }
+
+    /**
+     * @brief 阻塞入队，队列满时等待消费者取出元素
+     *
+     * @return 队列已关闭时返回false
+     */
+    template <typename U>
+        requires std::constructible_from<T, U &&>
+    bool WaitAndPush(U &&value)
+    {
+        if constexpr (std::is_nothrow_constructible_v<T, U &&>)
+        {
+            return Wait(_popSignal, _bProducerSleeping, [&] {
+                return !_bShutdown.load(std::memory_order_acquire) && PushImpl(std::forward<U>(value));
+            });
+        }
+        else
+        {
+            T element(std::forward<U>(value));
+            return Wait(_popSignal, _bProducerSleeping, [&] {
+                return !_bShutdown.load(std::memory_order_acquire) && PushImpl(std::move(element));
+            });
+        }
+    }
+
+    // 非阻塞出队，队列为空时返回false
+    bool TryPop(T &value)
+    {
+        std::size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        Cell       *pCell;
+        while (true)
+        {
+            pCell                    = &_pCells[pos & _mask];
+            const std::size_t seq    = pCell->sequence.load(std::memory_order_acquire);
+            const auto        offset = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (offset == 0)
+            {
+                if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (offset < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = _dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = std::move(*pCell->Get());
+        std::destroy_at(pCell->Get());
+        // 序号推进一圈，供下一轮的生产者使用
+        pCell->sequence.store(pos + _capacity, std::memory_order_release);
+        Notify(_popSignal, _bProducerSleeping);
+        return true;
+    }
+
+    /**
+     * @brief 阻塞出队，队列为空时等待生产者
+     *
+     * @return 队列已关闭且为空时返回false，关闭前入队的元素仍可取出
+     */
+    bool WaitAndPop(T &value)
+    {
+        return Wait(_pushSignal, _bConsumerSleeping, [&] {
+            return TryPop(value);
+        });
+    }
+
+    /**
+     * @brief 批量入队，逐个占用槽位，直到全部入队或队列已满
+     *
+     * @param first 起始迭代器，需要移动元素时传入std::move_iterator
+     * @param last 结束迭代器
+     * @return 实际入队的个数
+     */
+    template <std::input_iterator Iterator>
+    std::size_t TryPushBatch(Iterator first, Iterator last)
+    {
+        std::size_t count = 0;
+        for (; first != last && TryPush(*first); ++first)
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    /**
+     * @brief 批量出队
+     *
+     * @param output 输出迭代器
+     * @param maxCount 最多取出的个数
+     * @return 实际取出的个数
+     */
+    template <std::output_iterator<T> Iterator>
+        requires std::is_default_constructible_v<T>
+    std::size_t TryPopBatch(Iterator output, std::size_t maxCount)
+    {
+        std::size_t count = 0;
+        T           value {};
+        while (count < maxCount && TryPop(value))
+        {
+            *output++ = std::move(value);
+            ++count;
+        }
+        return count;
+    }
+
+    // 关闭队列，唤醒所有等待者，之后WaitAndPush直接返回false
+    void Shutdown()
+    {
+        _bShutdown.store(true, std::memory_order_seq_cst);
+        for (std::atomic<uint32_t> *pSignal : {&_pushSignal, &_popSignal})
+        {
+            pSignal->fetch_add(1, std::memory_order_release);
+            pSignal->notify_all();
+        }
+    }
+
+    [[nodiscard]] bool IsShutdown() const
+    {
+        return _bShutdown.load(std::memory_order_acquire);
+    }
+
+    // 近似的元素个数，并发修改时只作参考
+    [[nodiscard]] std::size_t Size() const
+    {
+        const std::size_t dequeuePos = _dequeuePos.load(std::memory_order_relaxed);
+        const std::size_t enqueuePos = _enqueuePos.load(std::memory_order_relaxed);
+        return enqueuePos > dequeuePos ? (std::min)(enqueuePos - dequeuePos, _capacity) : 0;
+    }
+
+    [[nodiscard]] bool Empty() const
+    {
+        return Size() == 0;
+    }
+
+    [[nodiscard]] std::size_t GetCapacity() const
+    {
+        return _capacity;
+    }
+
+private:
+    template <typename U>
+    bool PushImpl(U &&value) noexcept
+    {
+        std::size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        Cell       *pCell;
+        while (true)
+        {
+            pCell                    = &_pCells[pos & _mask];
+            const std::size_t seq    = pCell->sequence.load(std::memory_order_acquire);
+            const auto        offset = static_cast<std::ptrdiff_t>(seq - pos);
+            if (offset == 0)
+            {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (offset < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        std::construct_at(pCell->Get(), std::forward<U>(value));
+        pCell->sequence.store(pos + 1, std::memory_order_release);
+        Notify(_pushSignal, _bConsumerSleeping);
+        return true;
+    }
+
+    /**
+     * @brief 等待直到tryFunc成功或队列关闭
+     *        休眠前置位bSleeping再读取信号值并重试，通知方发布元素后再检查bSleeping，
+     *        两侧的seq_cst栅栏保证至少一方看到另一方，不会丢失唤醒
+     */
+    template <typename TryFunc>
+    bool Wait(std::atomic<uint32_t> &signal, std::atomic<bool> &bSleeping, TryFunc &&tryFunc)
+    {
+        for (int i = 0;; ++i)
+        {
+            if (tryFunc())
+            {
+                return true;
+            }
+            if (_bShutdown.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            if (i < WAIT_YIELD_COUNT)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            bSleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const uint32_t observed = signal.load(std::memory_order_acquire);
+            if (tryFunc())
+            {
+                return true;
+            }
+            if (_bShutdown.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            signal.wait(observed, std::memory_order_acquire);
+        }
+    }
+
+    // 清除休眠标记并唤醒全部休眠者，之后的通知在有线程再次休眠前不再进入内核
+    static void Notify(std::atomic<uint32_t> &signal, std::atomic<bool> &bSleeping) noexcept
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (bSleeping.load(std::memory_order_relaxed) && bSleeping.exchange(false, std::memory_order_relaxed))
+        {
+            signal.fetch_add(1, std::memory_order_release);
+            signal.notify_all();
+        }
+    }
+
+private:
+    const std::size_t       _capacity;
+    const std::size_t       _mask;
+    std::unique_ptr<Cell[]> _pCells;
+
+    alignas(64) std::atomic<std::size_t> _enqueuePos {0};
+    alignas(64) std::atomic<std::size_t> _dequeuePos {0};
+    alignas(64) std::atomic<uint32_t> _pushSignal {0}; // 唤醒消费者时递增，消费者在其上休眠
+    std::atomic<bool> _bConsumerSleeping {false};
+    alignas(64) std::atomic<uint32_t> _popSignal {0}; // 唤醒生产者时递增，生产者在其上休眠
+    std::atomic<bool> _bProducerSleeping {false};
+    std::atomic<bool> _bShutdown {false};
+};
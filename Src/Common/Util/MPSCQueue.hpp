@@ -0,0 +1,173 @@
+﻿/*************************************************************************
+> File Name       : MPSCQueue.hpp
+> Brief           : 无锁多生产者单消费者队列
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月11日  10时26分44秒
+************************************************************************/
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief 基于链表的无锁多生产者单消费者队列（Vyukov MPSC）
+ *        Push可在任意线程调用且不会等待其他生产者；Pop只能由同一个消费者线程调用。
+ *        生产者交换头指针后、链接前驱节点之前，消费者会暂时看不到该节点及其之后的节点，
+ *        此时Pop返回false，稍后重试即可。
+ *        可按容量预分配节点池，出队的节点归还到池中，元素不超过容量时入队不分配内存，超出时从堆上分配
+ */
+template <typename T>
+    requires std::is_default_constructible_v<T> && std::is_move_assignable_v<T>
+class MPSCQueue
+{
+private:
+    static constexpr uint32_t INVALID_NODE_INDEX = UINT32_MAX;
+
+    struct Node
+    {
+        std::atomic<Node *>   next {nullptr};
+        std::atomic<uint32_t> freeNext {INVALID_NODE_INDEX}; // 空闲链表中下一个节点的下标
+        T                     value {};
+    };
+
+public:
+    MPSCQueue() : MPSCQueue(0)
+    {
+    }
+
+    /**
+     * @brief 构造队列
+     *
+     * @param capacity 预分配的节点数(另加一个哨兵节点)，为0时每次入队都从堆上分配
+     */
+    explicit MPSCQueue(std::size_t capacity)
+        : _poolSize(capacity == 0 ? 0 : static_cast<uint32_t>(capacity + 1))
+        , _pPool(_poolSize == 0 ? nullptr : std::make_unique<Node[]>(_poolSize))
+    {
+        // 空闲链表初始为0 -> 1 -> ... -> poolSize-1
+        for (uint32_t i = 0; i + 1 < _poolSize; ++i)
+        {
+            _pPool[i].freeNext.store(i + 1, std::memory_order_relaxed);
+        }
+        _freeHead.store(_poolSize == 0 ? INVALID_NODE_INDEX : 0, std::memory_order_relaxed);
+
+        Node *pSentinel = AllocateNode();
+        _head.store(pSentinel, std::memory_order_relaxed);
+        _tail = pSentinel;
+    }
+
+    ~MPSCQueue()
+    {
+        T value;
+        while (Pop(value))
+        {
+        }
+
+        if (!IsPoolNode(_tail))
+        {
+            delete _tail;
+        }
+    }
+
+    MPSCQueue(const MPSCQueue &)            = delete;
+    MPSCQueue &operator=(const MPSCQueue &) = delete;
+    MPSCQueue(MPSCQueue &&)                 = delete;
+    MPSCQueue &operator=(MPSCQueue &&)      = delete;
+
+    template <typename U>
+    void Push(U &&value)
+    {
+        Node *pNode = AllocateNode();
+        pNode->next.store(nullptr, std::memory_order_relaxed);
+        pNode->value = std::forward<U>(value);
+
+        Node *pPrev = _head.exchange(pNode, std::memory_order_acq_rel);
+        pPrev->next.store(pNode, std::memory_order_release);
+    }
+
+    bool Pop(T &value)
+    {
+        Node *pTail = _tail;
+        Node *pNext = pTail->next.load(std::memory_order_acquire);
+        if (nullptr == pNext)
+        {
+            return false;
+        }
+
+        // 取出值后pNext成为新的哨兵节点
+        value = std::move(pNext->value);
+        _tail = pNext;
+        FreeNode(pTail);
+        return true;
+    }
+
+    // 只能在消费者线程调用
+    bool Empty() const
+    {
+        return nullptr == _tail->next.load(std::memory_order_acquire);
+    }
+
+private:
+    [[nodiscard]] bool IsPoolNode(const Node *pNode) const
+    {
+        return _poolSize != 0 && pNode >= _pPool.get() && pNode < _pPool.get() + _poolSize;
+    }
+
+    // 空闲链表头：高32位为修改次数，低32位为节点下标，修改次数避免多个生产者并发取节点时的ABA问题
+    static uint64_t MakeFreeHead(uint64_t oldHead, uint32_t index)
+    {
+        return (((oldHead >> 32) + 1) << 32) | index;
+    }
+
+    // 生产者从池中取节点，池已取空时从堆上分配
+    Node *AllocateNode()
+    {
+        uint64_t head = _freeHead.load(std::memory_order_acquire);
+        while (true)
+        {
+            const auto index = static_cast<uint32_t>(head);
+            if (INVALID_NODE_INDEX == index)
+            {
+                return new Node;
+            }
+
+            Node          &node    = _pPool[index];
+            const uint64_t newHead = MakeFreeHead(head, node.freeNext.load(std::memory_order_relaxed));
+            if (_freeHead.compare_exchange_weak(head, newHead, std::memory_order_acquire))
+            {
+                return &node;
+            }
+        }
+    }
+
+    // 只由消费者调用，池中的节点归还到空闲链表
+    void FreeNode(Node *pNode)
+    {
+        if (!IsPoolNode(pNode))
+        {
+            delete pNode;
+            return;
+        }
+
+        const auto index = static_cast<uint32_t>(pNode - _pPool.get());
+        uint64_t   head  = _freeHead.load(std::memory_order_relaxed);
+        do
+        {
+            pNode->freeNext.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        } while (!_freeHead.compare_exchange_weak(head,
+                                                  MakeFreeHead(head, index),
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed));
+    }
+
+    const uint32_t          _poolSize;
+    std::unique_ptr<Node[]> _pPool;
+    alignas(64) std::atomic<uint64_t> _freeHead; // 生产者取节点，消费者归还节点
+    alignas(64) std::atomic<Node *> _head;       // 生产者端，最近入队的节点
+    alignas(64) Node *_tail;                     // 消费者端，哨兵节点
+};
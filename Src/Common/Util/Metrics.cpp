@@ -0,0 +1,257 @@
+﻿/*************************************************************************
+> File Name       : Metrics.cpp
+> Brief           : 运行时指标
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月18日  14时26分53秒
+************************************************************************/
+#include "Metrics.h"
+#include "Assert.h"
+
+#include <cmath>
+#include <format>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <variant>
+#include <vector>
+
+namespace Metrics
+{
+    namespace
+    {
+        std::size_t GetShardIndex()
+        {
+            static std::atomic<std::size_t> s_nextThreadIndex {0};
+            thread_local const std::size_t  index =
+                s_nextThreadIndex.fetch_add(1, std::memory_order_relaxed) % COUNTER_SHARD_COUNT;
+            return index;
+        }
+
+        struct MetricEntry
+        {
+            std::string                                                                             labels;
+            std::variant<std::unique_ptr<Counter>, std::unique_ptr<Gauge>, std::unique_ptr<Histogram>> metric;
+        };
+
+        struct MetricFamily
+        {
+            MetricType               type;
+            std::string              help;
+            std::vector<MetricEntry> entries;
+        };
+
+        struct Registry
+        {
+            std::mutex                                         mutex;
+            std::map<std::string, MetricFamily, std::less<>> families; // 按名称排序，导出顺序稳定
+        };
+
+        Registry &GetRegistry()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        const char *GetTypeName(MetricType type)
+        {
+            switch (type)
+            {
+                case MetricType::Counter:
+                    return "counter";
+                case MetricType::Gauge:
+                    return "gauge";
+                case MetricType::Histogram:
+                    return "histogram";
+            }
+            return "untyped";
+        }
+
+        template <typename MetricClass, typename Factory>
+        MetricClass &GetOrCreate(MetricType       type,
+                                 std::string_view name,
+                                 std::string_view help,
+                                 std::string_view labels,
+                                 Factory        &&factory)
+        {
+            Registry       &registry = GetRegistry();
+            std::lock_guard lock(registry.mutex);
+
+            auto iter = registry.families.find(name);
+            if (iter == registry.families.end())
+            {
+                MetricFamily family {type, std::string(help), {}};
+                iter = registry.families.emplace(std::string(name), std::move(family)).first;
+            }
+
+            MetricFamily &family = iter->second;
+            Assert(family.type == type, std::format("指标：{} 重复注册为不同类型", name));
+
+            for (auto &entry : family.entries)
+            {
+                if (entry.labels == labels)
+                {
+                    return *std::get<std::unique_ptr<MetricClass>>(entry.metric);
+                }
+            }
+
+            auto &entry = family.entries.emplace_back(MetricEntry {std::string(labels), factory()});
+            return *std::get<std::unique_ptr<MetricClass>>(entry.metric);
+        }
+
+        // 换算为秒，按单位的倒数相除，使常见的十进制值精确输出
+        double ToBaseUnit(uint64_t value, double unit)
+        {
+            if (unit < 1.0)
+            {
+                return static_cast<double>(value) / std::round(1.0 / unit);
+            }
+            return static_cast<double>(value) * unit;
+        }
+
+        void AppendHelp(std::string &text, std::string_view help)
+        {
+            for (const char c : help)
+            {
+                if ('\\' == c)
+                {
+                    text += "\\\\";
+                }
+                else if ('\n' == c)
+                {
+                    text += "\\n";
+                }
+                else
+                {
+                    text += c;
+                }
+            }
+        }
+
+        // 生成 name{labels} 形式的序列名，extraLabel用于直方图的le标签
+        void AppendSeries(std::string     &text,
+                          std::string_view name,
+                          std::string_view suffix,
+                          std::string_view labels,
+                          std::string_view extraLabel = {})
+        {
+            text += name;
+            text += suffix;
+            if (labels.empty() && extraLabel.empty())
+            {
+                return;
+            }
+
+            text += '{';
+            text += labels;
+            if (!labels.empty() && !extraLabel.empty())
+            {
+                text += ',';
+            }
+            text += extraLabel;
+            text += '}';
+        }
+
+        void AppendHistogram(std::string     &text,
+                             std::string_view name,
+                             std::string_view labels,
+                             const Histogram &histogram)
+        {
+            const HistogramSnapshot snapshot = histogram.GetSnapshot();
+
+            // 每次导出相同的桶集合，便于按le聚合；最后一个桶容纳超出范围的值，只计入+Inf
+            uint64_t cumulative = 0;
+            for (uint32_t i = 0; i + 1 < HISTOGRAM_BUCKET_COUNT; ++i)
+            {
+                cumulative += snapshot.buckets[i];
+                if ((i + 1) % HISTOGRAM_EXPORT_STRIDE != 0)
+                {
+                    continue;
+                }
+
+                const double upperBound = ToBaseUnit(Histogram::GetBucketUpperBound(i), histogram.GetUnit());
+                AppendSeries(text, name, "_bucket", labels, std::format(R"(le="{}")", upperBound));
+                text += std::format(" {}\n", cumulative);
+            }
+
+            AppendSeries(text, name, "_bucket", labels, R"(le="+Inf")");
+            text += std::format(" {}\n", snapshot.count);
+            AppendSeries(text, name, "_sum", labels);
+            text += std::format(" {}\n", ToBaseUnit(snapshot.sum, histogram.GetUnit()));
+            AppendSeries(text, name, "_count", labels);
+            text += std::format(" {}\n", snapshot.count);
+        }
+    } // namespace
+
+    void Counter::Increment(uint64_t value)
+    {
+        _shards[GetShardIndex()].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t Counter::GetValue() const
+    {
+        uint64_t value = 0;
+        for (const auto &shard : _shards)
+        {
+            value += shard.value.load(std::memory_order_relaxed);
+        }
+        return value;
+    }
+
+    Counter &GetCounter(std::string_view name, std::string_view help, std::string_view labels)
+    {
+        return GetOrCreate<Counter>(MetricType::Counter, name, help, labels, []() {
+            return std::make_unique<Counter>();
+        });
+    }
+
+    Gauge &GetGauge(std::string_view name, std::string_view help, std::string_view labels)
+    {
+        return GetOrCreate<Gauge>(MetricType::Gauge, name, help, labels, []() {
+            return std::make_unique<Gauge>();
+        });
+    }
+
+    Histogram &
+    GetHistogram(std::string_view name, std::string_view help, std::string_view labels, double unit)
+    {
+        return GetOrCreate<Histogram>(MetricType::Histogram, name, help, labels, [unit]() {
+            return std::make_unique<Histogram>(unit);
+        });
+    }
+
+    std::string ExportPrometheus()
+    {
+        Registry       &registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+
+        std::string text;
+        for (const auto &[name, family] : registry.families)
+        {
+            text += std::format("# HELP {} ", name);
+            AppendHelp(text, family.help);
+            text += std::format("\n# TYPE {} {}\n", name, GetTypeName(family.type));
+
+            for (const auto &entry : family.entries)
+            {
+                if (const auto *ppCounter = std::get_if<std::unique_ptr<Counter>>(&entry.metric))
+                {
+                    AppendSeries(text, name, {}, entry.labels);
+                    text += std::format(" {}\n", (*ppCounter)->GetValue());
+                }
+                else if (const auto *ppGauge = std::get_if<std::unique_ptr<Gauge>>(&entry.metric))
+                {
+                    AppendSeries(text, name, {}, entry.labels);
+                    text += std::format(" {}\n", (*ppGauge)->GetValue());
+                }
+                else if (const auto *ppHistogram = std::get_if<std::unique_ptr<Histogram>>(&entry.metric))
+                {
+                    AppendHistogram(text, name, entry.labels, **ppHistogram);
+                }
+            }
+        }
+
+        return text;
+    }
+} // namespace Metrics
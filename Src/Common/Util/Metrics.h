@@ -0,0 +1,117 @@
+﻿/*************************************************************************
+> File Name       : Metrics.h
+> Brief           : 运行时指标
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月18日  14时26分53秒
+************************************************************************/
+#pragma once
+
+#include "Histogram.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Metrics
+{
+    constexpr std::size_t COUNTER_SHARD_COUNT = 16; // 计数器分片数，线程按序号分散到各分片
+
+    // 直方图桶：每个2的幂区间分为16个桶，相对误差不超过1/16，最大约2^36
+    using HistogramBuckets                    = Util::LogLinearBuckets<4, 36>;
+    constexpr uint32_t HISTOGRAM_BUCKET_COUNT = HistogramBuckets::BUCKET_COUNT;
+
+    // 导出时每个2的幂区间只取4个桶边界，避免每个序列导出全部桶
+    constexpr uint32_t HISTOGRAM_EXPORT_STRIDE = HistogramBuckets::SUB_BUCKET_COUNT / 4;
+
+    // 直方图记录值的单位换算为秒的系数，按Prometheus惯例导出时以秒为单位
+    constexpr double MICROSECOND_UNIT = 1e-6;
+    constexpr double NANOSECOND_UNIT  = 1e-9;
+
+    enum class MetricType : uint8_t
+    {
+        Counter,
+        Gauge,
+        Histogram,
+    };
+
+    /**
+     * @brief 单调递增计数器，按线程分片累加，只在导出时汇总
+     */
+    class Counter
+    {
+    public:
+        void Increment(uint64_t value = 1);
+
+        [[nodiscard]] uint64_t GetValue() const;
+
+    private:
+        struct alignas(64) Shard
+        {
+            std::atomic<uint64_t> value {0};
+        };
+
+        std::array<Shard, COUNTER_SHARD_COUNT> _shards;
+    };
+
+    /**
+     * @brief 可增减的瞬时值
+     */
+    class Gauge
+    {
+    public:
+        void Set(int64_t value)
+        {
+            _value.store(value, std::memory_order_relaxed);
+        }
+
+        void Add(int64_t value = 1)
+        {
+            _value.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        void Sub(int64_t value = 1)
+        {
+            _value.fetch_sub(value, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] int64_t GetValue() const
+        {
+            return _value.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<int64_t> _value {0};
+    };
+
+    // 指标注册表、数据库统计共用的直方图，单位为MICROSECOND_UNIT时记录微秒数
+    using Histogram         = Util::BasicHistogram<HistogramBuckets>;
+    using HistogramSnapshot = Histogram::Snapshot;
+
+    /**
+     * @brief 获取或注册指标，同名同标签的指标只创建一次，返回的引用在进程内一直有效
+     *        注册需要加锁，调用方应缓存返回的引用，热路径上只做原子操作
+     *
+     * @param name 指标名
+     * @param help 说明
+     * @param labels 标签，格式为 key="value",key2="value2"，为空时无标签
+     */
+    Counter &GetCounter(std::string_view name, std::string_view help, std::string_view labels = {});
+    Gauge   &GetGauge(std::string_view name, std::string_view help, std::string_view labels = {});
+
+    /**
+     * @param unit 记录值换算为秒的系数，如MICROSECOND_UNIT
+     */
+    Histogram &GetHistogram(std::string_view name,
+                            std::string_view help,
+                            std::string_view labels = {},
+                            double           unit   = MICROSECOND_UNIT);
+
+    /**
+     * @brief 以Prometheus文本格式导出所有指标，只读取原子值，不阻塞记录
+     */
+    [[nodiscard]] std::string ExportPrometheus();
+} // namespace Metrics
@@ -8,15 +8,25 @@
 ************************************************************************/
 #pragma once
 
+#include "Profiler.h"
+
+// 始终记录到性能分析器；调试构建额外输出按msg格式化的本次耗时日志
+// 分析器的作用域名称不含格式化参数：PERFORMANCE_SCOPE以未格式化的msg作为名称，
+// 同一调用点的所有调用汇总为一项，需要与其他调用点区分时用PERFORMANCE_SCOPE_NAMED另给一个静态名称
 #if defined(ENABLE_PERFORMANCE_DECT)
     #include "TimeUtil.h"
     #include <source_location>
     #include <format>
 
-    #define PERFORMANCE_SCOPE_LINE(line, msg, ...) \
+    #define PERFORMANCE_SCOPE_LINE(line, name, msg, ...) \
+        PROFILE_SCOPE_LINE(line, name);                  \
         TimeUtil::Timer timer##line(std::format(msg, __VA_ARGS__), true, std::source_location::current())
-    #define PERFORMANCE_SCOPE(msg, ...) PERFORMANCE_SCOPE_LINE(__LINE__, msg, __VA_ARGS__)
+    #define PERFORMANCE_SCOPE_EXPAND(line, name, msg, ...) \
+        PERFORMANCE_SCOPE_LINE(line, name, msg, __VA_ARGS__)
+    #define PERFORMANCE_SCOPE_NAMED(name, msg, ...) PERFORMANCE_SCOPE_EXPAND(__LINE__, name, msg, __VA_ARGS__)
 
 #else
-    #define PERFORMANCE_SCOPE(msg, ...)
-#endif
\ No newline at end of file
+    #define PERFORMANCE_SCOPE_NAMED(name, msg, ...) PROFILE_SCOPE(name)
+#endif
+
+#define PERFORMANCE_SCOPE(msg, ...) PERFORMANCE_SCOPE_NAMED(msg, msg, __VA_ARGS__)
\ No newline at end of file
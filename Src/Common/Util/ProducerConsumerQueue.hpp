@@ -24,116 +24,79 @@
 > Created Time    : 2023年07月28日  11时15分57秒
 ************************************************************************/
 #pragma once
-#include <condition_variable>
-#include <mutex>
-#include <queue>
-#include <atomic>
+#include "MPMCQueue.hpp"
+
+#include <cstddef>
 #include <type_traits>
+#include <utility>
+
+constexpr std::size_t DEFAULT_PRODUCER_CONSUMER_QUEUE_CAPACITY = 1024;
 
+/**
+ * @brief 有界的生产者消费者队列，基于MPMCQueue，Push/Pop不加锁
+ *        队列满时Push返回false，由调用方决定丢弃、重试还是断开连接
+ */
 template <typename T>
 class ProducerConsumerQueue
 {
 private:
-    std::mutex              _queueLock;
-    std::queue<T>           _queue;
-    std::condition_variable _condition;
-    std::atomic<bool>       _shutdown;
+    MPMCQueue<T> _queue;
 
 public:
-    ProducerConsumerQueue<T>()
-        : _shutdown(false)
+    explicit ProducerConsumerQueue(std::size_t capacity = DEFAULT_PRODUCER_CONSUMER_QUEUE_CAPACITY)
+        : _queue(capacity)
     {
     }
 
-    void Push(const T &value)
+    template <typename U>
+        requires std::constructible_from<T, U &&>
+    [[nodiscard]] bool Push(U &&value)
     {
-        std::lock_guard<std::mutex> lock(_queueLock);
-        _queue.push(std::move(value));
-
-        _condition.notify_one();
+        return _queue.TryPush(std::forward<U>(value));
     }
 
-    bool Empty()
+    bool Empty() const
     {
-        std::lock_guard<std::mutex> lock(_queueLock);
-
-        return _queue.empty();
+        return _queue.Empty();
     }
 
     size_t Size() const
     {
-        return _queue.size();
+        return _queue.Size();
     }
 
     bool Pop(T &value)
     {
-        std::lock_guard<std::mutex> lock(_queueLock);
-
-        if (_queue.empty() || _shutdown)
+        if (_queue.IsShutdown())
         {
             return false;
         }
 
-        value = _queue.front();
-
-        _queue.pop();
-
-        return true;
+        return _queue.TryPop(value);
     }
 
-    void WaitAndPop(T &value)
+    // 等待至取出元素，队列关闭且为空时返回false
+    bool WaitAndPop(T &value)
     {
-        std::unique_lock<std::mutex> lock(_queueLock);
-
-        _condition.wait(lock, [this]() -> bool
-                        { return _queue.empty() && !_shutdown; });
-
-        if (_queue.empty() || _shutdown)
-        {
-            return;
-        }
-
-        value = _queue.front();
-
-        _queue.pop();
+        return _queue.WaitAndPop(value);
     }
 
     T WaitAndPop()
     {
-        std::unique_lock<std::mutex> lock(_queueLock);
-        T                            value{};
-
-        _condition.wait(lock, [this]() -> bool
-                        { return !_queue.empty() && !_shutdown; });
-        // while (_queue.empty() && !_shutdown)
-        //     _condition.wait(lock);
-
-        if (_queue.empty() || _shutdown)
-        {
-            return value;
-        }
-
-        value = _queue.front();
-        _queue.pop();
+        T value {};
+        WaitAndPop(value);
         return value;
     }
 
     void Clear()
     {
-        std::unique_lock<std::mutex> lock(_queueLock);
-
-        while (!_queue.empty())
+        T value {};
+        while (_queue.TryPop(value))
         {
-            T &value = _queue.front();
-
             DeleteQueuedObject(value);
-
-            _queue.pop();
         }
 
-        _shutdown = true;
-
-        _condition.notify_all();
+        _queue.Shutdown();
     }
 
 private:
@@ -147,4 +110,4 @@ private:
     typename std::enable_if<!std::is_pointer<E>::value>::type DeleteQueuedObject(E const & /*packet*/)
     {
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,369 @@
+﻿/*************************************************************************
+> File Name       : Profiler.cpp
+> Brief           : 分层作用域性能分析
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月14日  11时02分37秒
+************************************************************************/
+#include "Profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <format>
+#include <memory>
+#include <mutex>
+
+namespace Profiler
+{
+    namespace
+    {
+        struct ScopeInfo
+        {
+            const char *name;
+            const char *file;
+            uint32_t    line;
+        };
+
+        // 字段按8字节对齐，导出线程通过atomic_ref读取
+        struct ProfileEvent
+        {
+            uint64_t scopeId {0};
+            uint64_t begin {0};
+            uint64_t end {0};
+        };
+
+        struct ScopeCounter
+        {
+            std::atomic<uint64_t> count {0};
+            std::atomic<uint64_t> total {0};
+            std::atomic<uint64_t> max {0};
+        };
+
+        // 每个线程独占的记录区，只有所属线程写入
+        struct ThreadProfile
+        {
+            ThreadProfile(uint32_t id, std::size_t capacity)
+                : threadId(id)
+                , events(capacity)
+            {
+            }
+
+            uint32_t                                     threadId;
+            std::string                                  name; // 受Registry::mutex保护
+            std::vector<ProfileEvent>                    events;
+            std::atomic<uint64_t>                        writeCount {0};
+            std::array<ScopeCounter, MAX_PROFILE_SCOPES> counters;
+        };
+
+        struct Registry
+        {
+            std::mutex                                  mutex;
+            std::vector<ScopeInfo>                      scopes;
+            std::vector<std::unique_ptr<ThreadProfile>> threads;      // 线程退出后保留，数据仍可导出
+            std::vector<ThreadProfile *>                freeProfiles; // 已退出线程的记录区，由新线程复用
+            std::size_t                                 ringCapacity {DEFAULT_PROFILE_RING_CAPACITY};
+            uint32_t                                    nextThreadId {1};
+        };
+
+        Registry &GetRegistry()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        /**
+         * @brief 线程持有的记录区，线程退出时交还给注册表
+         *        记录区较大，复用已退出线程的记录区，总数不超过同时记录过的线程数；
+         *        复用后累计计数继续叠加，环形缓冲中旧线程的事件会逐渐被覆盖
+         */
+        class ThreadProfileHolder
+        {
+        public:
+            ThreadProfileHolder()
+            {
+                Registry       &registry = GetRegistry();
+                std::lock_guard lock(registry.mutex);
+                if (!registry.freeProfiles.empty())
+                {
+                    _pProfile = registry.freeProfiles.back();
+                    registry.freeProfiles.pop_back();
+                    _pProfile->name.clear();
+                    return;
+                }
+
+                const auto capacity = std::max<std::size_t>(registry.ringCapacity, 1);
+                auto       pNew     = std::make_unique<ThreadProfile>(registry.nextThreadId++, capacity);
+                _pProfile           = pNew.get();
+                registry.threads.emplace_back(std::move(pNew));
+            }
+
+            ~ThreadProfileHolder()
+            {
+                Registry       &registry = GetRegistry();
+                std::lock_guard lock(registry.mutex);
+                registry.freeProfiles.emplace_back(_pProfile);
+            }
+
+            ThreadProfileHolder(const ThreadProfileHolder &)            = delete;
+            ThreadProfileHolder &operator=(const ThreadProfileHolder &) = delete;
+
+            ThreadProfile &Get()
+            {
+                return *_pProfile;
+            }
+
+        private:
+            ThreadProfile *_pProfile {nullptr};
+        };
+
+        ThreadProfile &GetThreadProfile()
+        {
+            thread_local ThreadProfileHolder holder;
+            return holder.Get();
+        }
+
+        void AppendJsonString(std::string &json, std::string_view value)
+        {
+            json += '"';
+            for (const char c : value)
+            {
+                switch (c)
+                {
+                    case '"':
+                        json += "\\\"";
+                        break;
+                    case '\\':
+                        json += "\\\\";
+                        break;
+                    case '\n':
+                        json += "\\n";
+                        break;
+                    case '\t':
+                        json += "\\t";
+                        break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20)
+                        {
+                            json += std::format("\\u{:04x}", static_cast<unsigned int>(c));
+                        }
+                        else
+                        {
+                            json += c;
+                        }
+                        break;
+                }
+            }
+            json += '"';
+        }
+
+        /**
+         * @brief 复制线程环形缓冲中仍然有效的事件
+         *        复制期间可能被所属线程覆盖，复制后重新读取写入计数，丢弃可能已被覆盖的部分
+         */
+        std::vector<ProfileEvent> SnapshotEvents(const ThreadProfile &profile)
+        {
+            const uint64_t capacity = profile.events.size();
+            const uint64_t end      = profile.writeCount.load(std::memory_order_acquire);
+            const uint64_t begin    = end > capacity ? end - capacity : 0;
+
+            std::vector<ProfileEvent> events;
+            events.reserve(end - begin);
+            for (uint64_t i = begin; i < end; ++i)
+            {
+                auto &slot = const_cast<ProfileEvent &>(profile.events[i % capacity]);
+
+                ProfileEvent event;
+                event.scopeId = std::atomic_ref<uint64_t>(slot.scopeId).load(std::memory_order_relaxed);
+                event.begin   = std::atomic_ref<uint64_t>(slot.begin).load(std::memory_order_relaxed);
+                event.end     = std::atomic_ref<uint64_t>(slot.end).load(std::memory_order_relaxed);
+                events.emplace_back(event);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t after = profile.writeCount.load(std::memory_order_relaxed);
+            const uint64_t valid = after > capacity ? after - capacity + 1 : 0;
+            if (valid > begin)
+            {
+                const uint64_t stale = std::min(valid - begin, end - begin);
+                events.erase(events.begin(), events.begin() + static_cast<std::ptrdiff_t>(stale));
+            }
+            return events;
+        }
+    } // namespace
+
+    uint32_t RegisterScope(const char *name, const char *file, uint32_t line)
+    {
+        Registry       &registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        if (registry.scopes.size() >= MAX_PROFILE_SCOPES)
+        {
+            return INVALID_PROFILE_SCOPE;
+        }
+
+        registry.scopes.emplace_back(ScopeInfo {name, file, line});
+        return static_cast<uint32_t>(registry.scopes.size() - 1);
+    }
+
+    void SetEnabled(bool bEnabled)
+    {
+        Detail::g_bEnabled.store(bEnabled, std::memory_order_relaxed);
+    }
+
+    bool IsEnabled()
+    {
+        return Detail::g_bEnabled.load(std::memory_order_relaxed);
+    }
+
+    void SetRingCapacity(std::size_t capacity)
+    {
+        Registry       &registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        registry.ringCapacity = capacity;
+    }
+
+    void SetThreadName(std::string_view name)
+    {
+        ThreadProfile  &profile  = GetThreadProfile();
+        Registry       &registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        profile.name = name;
+    }
+
+    std::vector<ProfileScopeStats> GetScopeStats()
+    {
+        Registry       &registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+
+        std::vector<ProfileScopeStats> result;
+        for (uint32_t scopeId = 0; scopeId < registry.scopes.size(); ++scopeId)
+        {
+            ProfileScopeStats stats;
+            stats.scopeId = scopeId;
+            for (const auto &pProfile : registry.threads)
+            {
+                const ScopeCounter      &counter = pProfile->counters[scopeId];
+                const std::chrono::nanoseconds max(counter.max.load(std::memory_order_relaxed));
+                stats.count += counter.count.load(std::memory_order_relaxed);
+                stats.total += std::chrono::nanoseconds(counter.total.load(std::memory_order_relaxed));
+                stats.max = std::max(stats.max, max);
+            }
+
+            if (0 == stats.count)
+            {
+                continue;
+            }
+
+            const ScopeInfo &info = registry.scopes[scopeId];
+            stats.name            = info.name;
+            stats.file            = info.file;
+            stats.line            = info.line;
+            result.emplace_back(std::move(stats));
+        }
+
+        return result;
+    }
+
+    std::string ExportChromeTrace()
+    {
+        struct ThreadSnapshot
+        {
+            uint32_t                  threadId;
+            std::string               name;
+            std::vector<ProfileEvent> events;
+        };
+
+        std::vector<ScopeInfo>      scopes;
+        std::vector<ThreadSnapshot> threads;
+        {
+            Registry       &registry = GetRegistry();
+            std::lock_guard lock(registry.mutex);
+            scopes = registry.scopes;
+            for (const auto &pProfile : registry.threads)
+            {
+                threads.emplace_back(ThreadSnapshot {pProfile->threadId, pProfile->name, {}});
+            }
+
+            for (std::size_t i = 0; i < threads.size(); ++i)
+            {
+                threads[i].events = SnapshotEvents(*registry.threads[i]);
+            }
+        }
+
+        // 时间戳以最早的事件为起点，单位微秒
+        uint64_t origin = UINT64_MAX;
+        for (const auto &thread : threads)
+        {
+            for (const auto &event : thread.events)
+            {
+                origin = std::min(origin, event.begin);
+            }
+        }
+
+        std::string json = R"({"displayTimeUnit":"ms","traceEvents":[)";
+        bool        bFirst = true;
+        auto        appendSeparator = [&json, &bFirst]() {
+            if (!bFirst)
+            {
+                json += ',';
+            }
+            bFirst = false;
+        };
+
+        for (const auto &thread : threads)
+        {
+            appendSeparator();
+            json += std::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":)",
+                                thread.threadId);
+            AppendJsonString(json,
+                             thread.name.empty() ? std::format("Thread {}", thread.threadId) : thread.name);
+            json += "}}";
+
+            for (const auto &event : thread.events)
+            {
+                if (event.scopeId >= scopes.size() || event.end < event.begin)
+                {
+                    continue;
+                }
+
+                appendSeparator();
+                json += R"({"name":)";
+                AppendJsonString(json, scopes[event.scopeId].name);
+                json += std::format(R"(,"cat":"scope","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+                                    thread.threadId,
+                                    static_cast<double>(event.begin - origin) / 1000.0,
+                                    static_cast<double>(event.end - event.begin) / 1000.0);
+            }
+        }
+
+        json += "]}";
+        return json;
+    }
+
+    void Detail::Record(uint32_t scopeId, uint64_t begin, uint64_t end)
+    {
+        if (scopeId >= MAX_PROFILE_SCOPES)
+        {
+            return;
+        }
+
+        ThreadProfile &profile = GetThreadProfile();
+        const uint64_t index   = profile.writeCount.load(std::memory_order_relaxed);
+        ProfileEvent  &event   = profile.events[index % profile.events.size()];
+        std::atomic_ref<uint64_t>(event.scopeId).store(scopeId, std::memory_order_relaxed);
+        std::atomic_ref<uint64_t>(event.begin).store(begin, std::memory_order_relaxed);
+        std::atomic_ref<uint64_t>(event.end).store(end, std::memory_order_relaxed);
+        profile.writeCount.store(index + 1, std::memory_order_release);
+
+        // 计数只由本线程写入，读改写不需要带锁的原子指令
+        ScopeCounter  &counter = profile.counters[scopeId];
+        const uint64_t elapsed = end - begin;
+        counter.count.store(counter.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        const uint64_t total   = counter.total.load(std::memory_order_relaxed) + elapsed;
+        counter.total.store(total, std::memory_order_relaxed);
+        if (elapsed > counter.max.load(std::memory_order_relaxed))
+        {
+            counter.max.store(elapsed, std::memory_order_relaxed);
+        }
+    }
+} // namespace Profiler
@@ -0,0 +1,112 @@
+﻿/*************************************************************************
+> File Name       : Profiler.h
+> Brief           : 分层作用域性能分析
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月14日  11时02分37秒
+************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Profiler
+{
+    constexpr uint32_t    MAX_PROFILE_SCOPES            = 1024;       // 可注册的作用域上限
+    constexpr uint32_t    INVALID_PROFILE_SCOPE         = UINT32_MAX; // 超出上限时的作用域id，不做记录
+    constexpr std::size_t DEFAULT_PROFILE_RING_CAPACITY = 8192;       // 每个线程保留的最近事件数
+
+    // 按作用域汇总的统计，跨线程合并
+    struct ProfileScopeStats
+    {
+        uint32_t                 scopeId {0};
+        std::string              name;
+        std::string              file;
+        uint32_t                 line {0};
+        uint64_t                 count {0};
+        std::chrono::nanoseconds total {0};
+        std::chrono::nanoseconds max {0};
+    };
+
+    /**
+     * @brief 注册作用域，同一调用点只在首次执行时注册一次(见PROFILE_SCOPE)
+     *
+     * @param name 作用域名称，须为静态字符串
+     * @param file 源文件
+     * @param line 行号
+     * @return 作用域id，超出上限时返回INVALID_PROFILE_SCOPE
+     */
+    uint32_t RegisterScope(const char *name, const char *file, uint32_t line);
+
+    // 开关记录，关闭时作用域只有一次原子读
+    void SetEnabled(bool bEnabled);
+
+    [[nodiscard]] bool IsEnabled();
+
+    // 新线程首次记录时分配的环形缓冲大小，只影响之后新建的缓冲，复用已退出线程的缓冲时保持原大小
+    void SetRingCapacity(std::size_t capacity);
+
+    // 设置当前线程在导出的trace中显示的名称
+    void SetThreadName(std::string_view name);
+
+    [[nodiscard]] std::vector<ProfileScopeStats> GetScopeStats();
+
+    /**
+     * @brief 导出各线程环形缓冲中的事件为Chrome trace-event格式，可在chrome://tracing或Perfetto中查看
+     */
+    [[nodiscard]] std::string ExportChromeTrace();
+
+    namespace Detail
+    {
+        inline std::atomic<bool> g_bEnabled {true};
+
+        inline uint64_t Now()
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                             std::chrono::steady_clock::now().time_since_epoch())
+                                             .count());
+        }
+
+        void Record(uint32_t scopeId, uint64_t begin, uint64_t end);
+    } // namespace Detail
+
+    // 作用域计时，退出时把开始与结束时间写入当前线程的环形缓冲
+    class ScopeGuard
+    {
+    public:
+        explicit ScopeGuard(uint32_t scopeId)
+            : _scopeId(scopeId)
+            , _begin(Detail::g_bEnabled.load(std::memory_order_relaxed) ? Detail::Now() : 0)
+        {
+        }
+
+        ~ScopeGuard()
+        {
+            if (0 != _begin)
+            {
+                Detail::Record(_scopeId, _begin, Detail::Now());
+            }
+        }
+
+        ScopeGuard(const ScopeGuard &)            = delete;
+        ScopeGuard &operator=(const ScopeGuard &) = delete;
+        ScopeGuard(ScopeGuard &&)                 = delete;
+        ScopeGuard &operator=(ScopeGuard &&)      = delete;
+
+    private:
+        uint32_t _scopeId;
+        uint64_t _begin;
+    };
+} // namespace Profiler
+
+// 作用域id在调用点首次执行时注册并保存在静态变量中，热路径上不做格式化和查找
+#define PROFILE_SCOPE_LINE(line, name)                                                          \
+    static const uint32_t profileScopeId##line = Profiler::RegisterScope(name, __FILE__, line); \
+    Profiler::ScopeGuard  profileScope##line(profileScopeId##line)
+#define PROFILE_SCOPE_EXPAND(line, name) PROFILE_SCOPE_LINE(line, name)
+#define PROFILE_SCOPE(name)              PROFILE_SCOPE_EXPAND(__LINE__, name)
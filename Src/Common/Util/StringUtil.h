@@ -0,0 +1,508 @@
+﻿/*************************************************************************
+> File Name       : StringUtil.h
+> Brief           : ASCII字符串快速处理
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年03月18日  10时42分57秒
+************************************************************************/
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+// x64总是支持SSE2，其余平台使用64位字的SWAR实现
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define UTIL_STRING_USE_SSE2
+#endif
+
+/**
+ * @brief Http头、查询参数、数据库文本行等热路径使用的字符串工具
+ *        只处理ASCII，与区域设置无关；按16字节（SSE2）或8字节（SWAR）成块处理，不足一块时回退逐字节处理
+ */
+namespace Util
+{
+    namespace detail
+    {
+        constexpr uint64_t BroadcastByte(uint8_t byte)
+        {
+            return 0x0101010101010101ULL * byte;
+        }
+
+        constexpr uint64_t HIGH_BITS = BroadcastByte(0x80);
+        constexpr uint64_t LOW_BITS  = BroadcastByte(0x7F);
+
+        inline uint64_t LoadWord(const char *pData)
+        {
+            uint64_t word = 0;
+            std::memcpy(&word, pData, sizeof(word));
+            return word;
+        }
+
+        // 不足8字节时高位补0
+        inline uint64_t LoadPartialWord(const char *pData, std::size_t length)
+        {
+            uint64_t word = 0;
+            std::memcpy(&word, pData, length);
+            return word;
+        }
+
+        // 字中ASCII大写字母转为小写，其余字节不变
+        constexpr uint64_t ToLowerWord(uint64_t word)
+        {
+            const uint64_t heptets = word & LOW_BITS;
+            const uint64_t geA     = heptets + BroadcastByte(0x80 - 'A');
+            const uint64_t gtZ     = heptets + BroadcastByte(0x80 - 'Z' - 1);
+            const uint64_t upper   = geA & ~gtZ & ~word & HIGH_BITS;
+            return word | (upper >> 2);
+        }
+
+        // 非0字节的最高位置1，其余位为0，字节间不产生进位
+        constexpr uint64_t NonZeroByteMask(uint64_t word)
+        {
+            return (((word & LOW_BITS) + LOW_BITS) | word) & HIGH_BITS;
+        }
+
+        constexpr uint64_t ZeroByteMask(uint64_t word)
+        {
+            return ~NonZeroByteMask(word) & HIGH_BITS;
+        }
+
+        // 字节掩码中第一个/最后一个置位字节在字符串中的下标，掩码不能为0
+        constexpr std::size_t FirstByteIndex(uint64_t mask)
+        {
+            if constexpr (std::endian::native == std::endian::little)
+            {
+                return static_cast<std::size_t>(std::countr_zero(mask)) / 8;
+            }
+            else
+            {
+                return static_cast<std::size_t>(std::countl_zero(mask)) / 8;
+            }
+        }
+
+        constexpr std::size_t LastByteIndex(uint64_t mask)
+        {
+            if constexpr (std::endian::native == std::endian::little)
+            {
+                return 7 - static_cast<std::size_t>(std::countl_zero(mask)) / 8;
+            }
+            else
+            {
+                return 7 - static_cast<std::size_t>(std::countr_zero(mask)) / 8;
+            }
+        }
+
+        // 8个字节是否都是'0'~'9'
+        constexpr bool IsEightDigits(uint64_t word)
+        {
+            const uint64_t highNibbles = word & BroadcastByte(0xF0);
+            const uint64_t carried     = ((word + BroadcastByte(0x06)) & BroadcastByte(0xF0)) >> 4;
+            return (highNibbles | carried) == BroadcastByte(0x33);
+        }
+
+        // 小端序下把8个数字字符一次转为整数
+        constexpr uint64_t ParseEightDigits(uint64_t word)
+        {
+            constexpr uint64_t MASK = 0x000000FF000000FFULL;
+            constexpr uint64_t MUL1 = 100 + (1000000ULL << 32);
+            constexpr uint64_t MUL2 = 1 + (10000ULL << 32);
+
+            word -= BroadcastByte('0');
+            word = (word * 10) + (word >> 8);
+            return (((word & MASK) * MUL1) + (((word >> 16) & MASK) * MUL2)) >> 32;
+        }
+
+#ifdef UTIL_STRING_USE_SSE2
+        inline __m128i LoadBlock(const char *pData)
+        {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i *>(pData));
+        }
+
+        inline __m128i ToLowerBlock(__m128i block)
+        {
+            // 有符号比较，0x80以上的字节为负数，不会被当作大写字母
+            const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('A' - 1)),
+                                                _mm_cmplt_epi8(block, _mm_set1_epi8('Z' + 1)));
+            return _mm_or_si128(block, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+        }
+
+        // 与chr相等的字节对应位置1
+        inline uint32_t MatchMask(__m128i block, char chr)
+        {
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(chr))));
+        }
+#endif
+
+        constexpr std::size_t MAX_DECIMAL_DIGITS = std::numeric_limits<uint64_t>::digits10; // 19位不会溢出
+
+        // 解析不超过MAX_DECIMAL_DIGITS位的纯数字串
+        inline bool ParseDigits(std::string_view str, uint64_t &value)
+        {
+            const char *pData  = str.data();
+            std::size_t length = str.length();
+            if constexpr (std::endian::native == std::endian::little)
+            {
+                for (; length >= 8; pData += 8, length -= 8)
+                {
+                    const uint64_t word = LoadWord(pData);
+                    if (!IsEightDigits(word))
+                    {
+                        return false;
+                    }
+                    value = value * 100000000 + ParseEightDigits(word);
+                }
+            }
+
+            for (; length > 0; ++pData, --length)
+            {
+                const uint32_t digit = static_cast<uint8_t>(*pData) - static_cast<uint32_t>('0');
+                if (digit > 9)
+                {
+                    return false;
+                }
+                value = value * 10 + digit;
+            }
+
+            return true;
+        }
+    } // namespace detail
+
+    constexpr char ToLowerAscii(char chr)
+    {
+        return (chr >= 'A' && chr <= 'Z') ? static_cast<char>(chr | 0x20) : chr;
+    }
+
+    /**
+     * @brief 忽略ASCII大小写比较两个字符串
+     */
+    inline bool EqualIgnoreCaseAscii(std::string_view strLeft, std::string_view strRight)
+    {
+        const std::size_t length = strLeft.length();
+        if (length != strRight.length())
+        {
+            return false;
+        }
+
+        const char *pLeft  = strLeft.data();
+        const char *pRight = strRight.data();
+        std::size_t i      = 0;
+#ifdef UTIL_STRING_USE_SSE2
+        for (; i + 16 <= length; i += 16)
+        {
+            const __m128i left  = detail::ToLowerBlock(detail::LoadBlock(pLeft + i));
+            const __m128i right = detail::ToLowerBlock(detail::LoadBlock(pRight + i));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(left, right)) != 0xFFFF)
+            {
+                return false;
+            }
+        }
+#endif
+        for (; i + 8 <= length; i += 8)
+        {
+            if (detail::ToLowerWord(detail::LoadWord(pLeft + i))
+                != detail::ToLowerWord(detail::LoadWord(pRight + i)))
+            {
+                return false;
+            }
+        }
+
+        // 尾部不足8字节时与前面已比较的部分重叠读取最后8字节
+        if (i < length && length >= 8)
+        {
+            return detail::ToLowerWord(detail::LoadWord(pLeft + length - 8))
+                   == detail::ToLowerWord(detail::LoadWord(pRight + length - 8));
+        }
+
+        for (; i < length; ++i)
+        {
+            if (ToLowerAscii(pLeft[i]) != ToLowerAscii(pRight[i]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief 忽略ASCII大小写的哈希，与EqualIgnoreCaseAscii相等的字符串哈希值相同
+     */
+    inline uint64_t HashIgnoreCaseAscii(std::string_view str)
+    {
+        constexpr uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ULL;
+
+        const char *pData  = str.data();
+        std::size_t length = str.length();
+        uint64_t    hash   = MULTIPLIER ^ length;
+        for (; length >= 8; pData += 8, length -= 8)
+        {
+            hash = (hash ^ detail::ToLowerWord(detail::LoadWord(pData))) * MULTIPLIER;
+            hash ^= hash >> 32;
+        }
+
+        if (length > 0)
+        {
+            hash = (hash ^ detail::ToLowerWord(detail::LoadPartialWord(pData, length))) * MULTIPLIER;
+        }
+
+        // 最后混合一次，使高位的差异也能影响低位，便于按桶取模
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    // 用作Http头等容器的哈希与比较函数
+    struct IgnoreCaseAsciiHash
+    {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view str) const
+        {
+            return static_cast<std::size_t>(HashIgnoreCaseAscii(str));
+        }
+    };
+
+    struct IgnoreCaseAsciiEqual
+    {
+        using is_transparent = void;
+
+        bool operator()(std::string_view strLeft, std::string_view strRight) const
+        {
+            return EqualIgnoreCaseAscii(strLeft, strRight);
+        }
+    };
+
+    /**
+     * @brief 从pos开始查找第一个等于first或second的字符
+     *
+     * @return 下标，未找到返回std::string_view::npos
+     */
+    inline std::size_t FindFirstOf(std::string_view str, char first, char second, std::size_t pos = 0)
+    {
+        const char       *pData  = str.data();
+        const std::size_t length = str.length();
+        std::size_t       i      = pos;
+#ifdef UTIL_STRING_USE_SSE2
+        for (; i + 16 <= length; i += 16)
+        {
+            const __m128i  block = detail::LoadBlock(pData + i);
+            const uint32_t mask  = detail::MatchMask(block, first) | detail::MatchMask(block, second);
+            if (0 != mask)
+            {
+                return i + static_cast<std::size_t>(std::countr_zero(mask));
+            }
+        }
+#endif
+        const uint64_t firstWord  = detail::BroadcastByte(static_cast<uint8_t>(first));
+        const uint64_t secondWord = detail::BroadcastByte(static_cast<uint8_t>(second));
+        for (; i + 8 <= length; i += 8)
+        {
+            const uint64_t word = detail::LoadWord(pData + i);
+            const uint64_t mask =
+                detail::ZeroByteMask(word ^ firstWord) | detail::ZeroByteMask(word ^ secondWord);
+            if (0 != mask)
+            {
+                return i + detail::FirstByteIndex(mask);
+            }
+        }
+
+        for (; i < length; ++i)
+        {
+            if (pData[i] == first || pData[i] == second)
+            {
+                return i;
+            }
+        }
+
+        return std::string_view::npos;
+    }
+
+    /**
+     * @brief 查找第一个不等于chr的字符
+     *
+     * @return 下标，全部等于chr时返回std::string_view::npos
+     */
+    inline std::size_t FindFirstNotOf(std::string_view str, char chr)
+    {
+        const char       *pData  = str.data();
+        const std::size_t length = str.length();
+        std::size_t       i      = 0;
+#ifdef UTIL_STRING_USE_SSE2
+        for (; i + 16 <= length; i += 16)
+        {
+            const uint32_t mask = ~detail::MatchMask(detail::LoadBlock(pData + i), chr) & 0xFFFF;
+            if (0 != mask)
+            {
+                return i + static_cast<std::size_t>(std::countr_zero(mask));
+            }
+        }
+#endif
+        const uint64_t chrWord = detail::BroadcastByte(static_cast<uint8_t>(chr));
+        for (; i + 8 <= length; i += 8)
+        {
+            const uint64_t mask = detail::NonZeroByteMask(detail::LoadWord(pData + i) ^ chrWord);
+            if (0 != mask)
+            {
+                return i + detail::FirstByteIndex(mask);
+            }
+        }
+
+        for (; i < length; ++i)
+        {
+            if (pData[i] != chr)
+            {
+                return i;
+            }
+        }
+
+        return std::string_view::npos;
+    }
+
+    /**
+     * @brief 查找最后一个不等于chr的字符
+     *
+     * @return 下标，全部等于chr时返回std::string_view::npos
+     */
+    inline std::size_t FindLastNotOf(std::string_view str, char chr)
+    {
+        const char *pData = str.data();
+        std::size_t end   = str.length(); // [0, end)尚未检查
+#ifdef UTIL_STRING_USE_SSE2
+        for (; end >= 16; end -= 16)
+        {
+            const uint32_t mask = ~detail::MatchMask(detail::LoadBlock(pData + end - 16), chr) & 0xFFFF;
+            if (0 != mask)
+            {
+                return end - 16 + static_cast<std::size_t>(std::bit_width(mask)) - 1;
+            }
+        }
+#endif
+        const uint64_t chrWord = detail::BroadcastByte(static_cast<uint8_t>(chr));
+        for (; end >= 8; end -= 8)
+        {
+            const uint64_t mask = detail::NonZeroByteMask(detail::LoadWord(pData + end - 8) ^ chrWord);
+            if (0 != mask)
+            {
+                return end - 8 + detail::LastByteIndex(mask);
+            }
+        }
+
+        for (; end > 0; --end)
+        {
+            if (pData[end - 1] != chr)
+            {
+                return end - 1;
+            }
+        }
+
+        return std::string_view::npos;
+    }
+
+    /**
+     * @brief 去掉首尾的空格
+     */
+    inline std::string_view TrimSpace(std::string_view str)
+    {
+        // 多数字符串首尾本就没有空格
+        if (str.empty() || (str.front() != ' ' && str.back() != ' '))
+        {
+            return str;
+        }
+
+        const std::size_t begin = FindFirstNotOf(str, ' ');
+        if (std::string_view::npos == begin)
+        {
+            return str.substr(str.length());
+        }
+
+        return str.substr(begin, FindLastNotOf(str, ' ') - begin + 1);
+    }
+
+    /**
+     * @brief 解析十进制整数，语义与std::from_chars一致：整个字符串须为数字，有符号类型允许前导'-'，越界失败
+     *        按8字节一组解析，前19位不会溢出，无需逐位检查
+     *
+     * @return 解析失败返回std::nullopt
+     */
+    template <typename T>
+        requires std::is_integral_v<T> && (!std::is_same_v<T, bool>)
+    inline std::optional<T> ParseDecimal(std::string_view str)
+    {
+        bool bNegative = false;
+        if constexpr (std::is_signed_v<T>)
+        {
+            if (!str.empty() && '-' == str.front())
+            {
+                bNegative = true;
+                str.remove_prefix(1);
+            }
+        }
+
+        if (str.empty())
+        {
+            return std::nullopt;
+        }
+
+        if (str.length() > detail::MAX_DECIMAL_DIGITS)
+        {
+            const std::size_t first = FindFirstNotOf(str, '0');
+            if (std::string_view::npos == first)
+            {
+                return T {};
+            }
+
+            // 去掉前导0后仍超过20位，不是非法字符就是越界
+            str.remove_prefix(first);
+            if (str.length() > detail::MAX_DECIMAL_DIGITS + 1)
+            {
+                return std::nullopt;
+            }
+        }
+
+        uint64_t value = 0;
+        if (!detail::ParseDigits(str.substr(0, detail::MAX_DECIMAL_DIGITS), value))
+        {
+            return std::nullopt;
+        }
+
+        // 第20位单独检查是否超出uint64_t
+        if (str.length() > detail::MAX_DECIMAL_DIGITS)
+        {
+            constexpr uint64_t LIMIT = std::numeric_limits<uint64_t>::max() / 10;
+            const uint32_t     digit = static_cast<uint8_t>(str.back()) - static_cast<uint32_t>('0');
+            if (digit > 9 || value > LIMIT
+                || (value == LIMIT && digit > std::numeric_limits<uint64_t>::max() % 10))
+            {
+                return std::nullopt;
+            }
+            value = value * 10 + digit;
+        }
+
+        constexpr uint64_t MAX_VALUE = static_cast<uint64_t>(std::numeric_limits<T>::max());
+        if constexpr (std::is_signed_v<T>)
+        {
+            if (bNegative)
+            {
+                if (value > MAX_VALUE + 1)
+                {
+                    return std::nullopt;
+                }
+                return static_cast<T>(static_cast<std::make_unsigned_t<T>>(0 - value));
+            }
+        }
+
+        if (value > MAX_VALUE)
+        {
+            return std::nullopt;
+        }
+        return static_cast<T>(value);
+    }
+} // namespace Util
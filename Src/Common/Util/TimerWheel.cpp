@@ -0,0 +1,272 @@
+﻿/*************************************************************************
+> File Name       : TimerWheel.cpp
+> Brief           : 分层时间轮
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年05月27日  16时42分09秒
+************************************************************************/
+#include "TimerWheel.h"
+#include "Assert.h"
+
+#include <algorithm>
+
+namespace TimeUtil
+{
+    TimerWheel::TimerWheel(std::chrono::steady_clock::time_point startTime)
+        : _startTime(startTime)
+    {
+        for (TimerLink &slot : _rootSlots)
+        {
+            slot.pPrev = slot.pNext = &slot;
+        }
+        for (auto &slots : _levelSlots)
+        {
+            for (TimerLink &slot : slots)
+            {
+                slot.pPrev = slot.pNext = &slot;
+            }
+        }
+    }
+
+    TimerWheel::TimerId TimerWheel::Schedule(std::chrono::milliseconds delay,
+                                             Callback                  callback,
+                                             std::chrono::milliseconds interval)
+    {
+        TimerNode &node = AllocateNode();
+        node.expireTick = _elapsedTick + static_cast<uint64_t>((std::max)(delay.count(), int64_t {1}));
+        node.interval   = static_cast<uint64_t>((std::max)(interval.count(), int64_t {0}));
+        node.callback   = std::move(callback);
+        Insert(node);
+        ++_timerCount;
+        return MakeTimerId(node.index, node.generation);
+    }
+
+    bool TimerWheel::Cancel(TimerId timerId)
+    {
+        TimerNode *pNode = FindNode(timerId);
+        if (nullptr == pNode || pNode->bCancelled)
+        {
+            return false;
+        }
+
+        if (pNode->bRunning)
+        {
+            pNode->bCancelled = true;
+            if (nullptr != pNode->pNext)
+            {
+                Unlink(*pNode);
+            }
+            return true;
+        }
+
+        Unlink(*pNode);
+        ReleaseNode(*pNode);
+        return true;
+    }
+
+    bool TimerWheel::Reschedule(TimerId timerId, std::chrono::milliseconds delay)
+    {
+        TimerNode *pNode = FindNode(timerId);
+        if (nullptr == pNode || pNode->bCancelled)
+        {
+            return false;
+        }
+
+        if (nullptr != pNode->pNext)
+        {
+            Unlink(*pNode);
+        }
+        pNode->expireTick = _elapsedTick + static_cast<uint64_t>((std::max)(delay.count(), int64_t {1}));
+        Insert(*pNode);
+        return true;
+    }
+
+    std::size_t TimerWheel::Advance(std::chrono::steady_clock::time_point now)
+    {
+        Assert(!_bAdvancing, "不能在定时器回调中推进时间轮");
+        if (now <= _startTime)
+        {
+            return 0;
+        }
+
+        const auto targetTick = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - _startTime).count());
+
+        _bAdvancing          = true;
+        std::size_t runCount = 0;
+        while (_elapsedTick < targetTick)
+        {
+            ++_elapsedTick;
+
+            // 第0层转完一圈时从第1层下沉，第1层也转完一圈时再从第2层下沉，依此类推
+            if ((_elapsedTick & (ROOT_SLOT_COUNT - 1)) == 0)
+            {
+                for (uint32_t level = 1; level < LEVEL_COUNT; ++level)
+                {
+                    Cascade(level);
+                    if (((_elapsedTick >> GetLevelShift(level)) & (LEVEL_SLOT_COUNT - 1)) != 0)
+                    {
+                        break;
+                    }
+                }
+            }
+
+            TimerLink expired;
+            expired.pPrev = expired.pNext = &expired;
+            SpliceSlot(_rootSlots[_elapsedTick & (ROOT_SLOT_COUNT - 1)], expired);
+
+            // 回调中可能取消同一批中的其他定时器，每次从头取
+            while (expired.pNext != &expired)
+            {
+                auto &node = static_cast<TimerNode &>(*expired.pNext);
+                Unlink(node);
+                RunTimer(node);
+                ++runCount;
+            }
+        }
+        _bAdvancing = false;
+        return runCount;
+    }
+
+    TimerWheel::TimerNode *TimerWheel::FindNode(TimerId timerId)
+    {
+        const auto index      = static_cast<uint32_t>(timerId & UINT32_MAX);
+        const auto generation = static_cast<uint32_t>(timerId >> 32);
+        if (timerId == INVALID_TIMER_ID || index >= _nodes.size())
+        {
+            return nullptr;
+        }
+
+        TimerNode &node = _nodes[index];
+        return node.bActive && node.generation == generation ? &node : nullptr;
+    }
+
+    TimerWheel::TimerId TimerWheel::MakeTimerId(uint32_t index, uint32_t generation)
+    {
+        return (static_cast<uint64_t>(generation) << 32) | index;
+    }
+
+    TimerWheel::TimerNode &TimerWheel::AllocateNode()
+    {
+        TimerNode *pNode = nullptr;
+        if (!_freeNodes.empty())
+        {
+            pNode = &_nodes[_freeNodes.back()];
+            _freeNodes.pop_back();
+        }
+        else
+        {
+            pNode        = &_nodes.emplace_back();
+            pNode->index = static_cast<uint32_t>(_nodes.size() - 1);
+        }
+
+        pNode->bActive = true;
+        return *pNode;
+    }
+
+    void TimerWheel::ReleaseNode(TimerNode &node)
+    {
+        node.callback = nullptr;
+        node.bActive = node.bRunning = node.bCancelled = false;
+        // 跳过0，保证id不等于INVALID_TIMER_ID
+        if (++node.generation == 0)
+        {
+            node.generation = 1;
+        }
+        _freeNodes.push_back(node.index);
+        --_timerCount;
+    }
+
+    void TimerWheel::Insert(TimerNode &node)
+    {
+        // 下沉时到期tick可能恰好是当前tick，放入第0层即将执行的槽
+        const uint64_t delay = node.expireTick > _elapsedTick ? node.expireTick - _elapsedTick : 0;
+        if (delay < ROOT_SLOT_COUNT)
+        {
+            PushBack(_rootSlots[node.expireTick & (ROOT_SLOT_COUNT - 1)], node);
+            return;
+        }
+
+        // 超出范围的定时器放在最高层最远的槽，到时再重新计算位置
+        const uint64_t placeTick =
+            delay < MAX_TIMER_DELAY ? node.expireTick : _elapsedTick + MAX_TIMER_DELAY - 1;
+        uint32_t level = 1;
+        while (level < LEVEL_COUNT - 1 && delay >= (uint64_t {1} << GetLevelShift(level + 1)))
+        {
+            ++level;
+        }
+        PushBack(_levelSlots[level - 1][(placeTick >> GetLevelShift(level)) & (LEVEL_SLOT_COUNT - 1)], node);
+    }
+
+    void TimerWheel::Unlink(TimerLink &link)
+    {
+        link.pPrev->pNext = link.pNext;
+        link.pNext->pPrev = link.pPrev;
+        link.pPrev = link.pNext = nullptr;
+    }
+
+    void TimerWheel::PushBack(TimerLink &head, TimerLink &link)
+    {
+        link.pPrev        = head.pPrev;
+        link.pNext        = &head;
+        head.pPrev->pNext = &link;
+        head.pPrev        = &link;
+    }
+
+    void TimerWheel::SpliceSlot(TimerLink &slot, TimerLink &head)
+    {
+        if (slot.pNext == &slot)
+        {
+            return;
+        }
+
+        head.pNext        = slot.pNext;
+        head.pPrev        = slot.pPrev;
+        head.pNext->pPrev = &head;
+        head.pPrev->pNext = &head;
+        slot.pPrev = slot.pNext = &slot;
+    }
+
+    void TimerWheel::Cascade(uint32_t level)
+    {
+        TimerLink pending;
+        pending.pPrev = pending.pNext = &pending;
+        SpliceSlot(_levelSlots[level - 1][(_elapsedTick >> GetLevelShift(level)) & (LEVEL_SLOT_COUNT - 1)],
+                   pending);
+
+        while (pending.pNext != &pending)
+        {
+            auto &node = static_cast<TimerNode &>(*pending.pNext);
+            Unlink(node);
+            Insert(node);
+        }
+    }
+
+    void TimerWheel::RunTimer(TimerNode &node)
+    {
+        if (0 == node.interval)
+        {
+            // 一次性定时器先释放节点再回调，回调中对该id的操作都返回false
+            Callback callback = std::move(node.callback);
+            ReleaseNode(node);
+            callback();
+            return;
+        }
+
+        node.bRunning = true;
+        node.callback();
+        node.bRunning = false;
+
+        if (node.bCancelled)
+        {
+            ReleaseNode(node);
+        }
+        else if (nullptr == node.pNext)
+        {
+            // 回调中没有Reschedule时按周期重新加入
+            node.expireTick = _elapsedTick + node.interval;
+            Insert(node);
+        }
+    }
+} // namespace TimeUtil
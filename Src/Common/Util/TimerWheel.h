@@ -0,0 +1,157 @@
+﻿/*************************************************************************
+> File Name       : TimerWheel.h
+> Brief           : 分层时间轮
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年05月27日  16时42分09秒
+************************************************************************/
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace TimeUtil
+{
+    /**
+     * @brief 毫秒精度的分层时间轮，用于会话超时、buff到期、延时事件等大量定时器
+     *        第0层256个槽，之后4层各64个槽，覆盖约49天，更远的定时器停在最高层并在到期前逐层下沉。
+     *        添加、取消、重新设置都是O(1)，每个tick整槽摘下批量执行。
+     *        不是线程安全的，只能在推进它的线程(逻辑线程)上使用
+     */
+    class TimerWheel
+    {
+    public:
+        using TimerId  = uint64_t;
+        using Callback = std::function<void()>;
+
+        static constexpr TimerId INVALID_TIMER_ID = 0;
+
+        explicit TimerWheel(
+            std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now());
+
+        TimerWheel(const TimerWheel &)            = delete;
+        TimerWheel(TimerWheel &&)                 = delete;
+        TimerWheel &operator=(const TimerWheel &) = delete;
+        TimerWheel &operator=(TimerWheel &&)      = delete;
+
+        ~TimerWheel() = default;
+
+        /**
+         * @brief 添加定时器，延时从最近一次Advance推进到的时刻算起
+         *
+         * @param delay 延时，不足1ms按1ms计，即最早在下一个tick执行
+         * @param callback 到期时在Advance中调用
+         * @param interval 大于0时为周期定时器，每次执行后按此间隔重新加入
+         * @return 定时器id，用于取消或重新设置
+         */
+        TimerId Schedule(std::chrono::milliseconds delay,
+                         Callback                  callback,
+                         std::chrono::milliseconds interval = std::chrono::milliseconds::zero());
+
+        /**
+         * @brief 取消定时器，可以在回调中调用(包括取消正在执行的周期定时器自身)
+         *
+         * @return 定时器不存在或已执行完时返回false
+         */
+        bool Cancel(TimerId timerId);
+
+        /**
+         * @brief 重新设置定时器的到期时间，用于有活动时推迟会话的空闲超时
+         *
+         * @return 定时器不存在或已执行完时返回false
+         */
+        bool Reschedule(TimerId timerId, std::chrono::milliseconds delay);
+
+        /**
+         * @brief 推进到指定时刻，依次执行途经的每个tick上到期的定时器
+         *
+         * @param now 当前时刻
+         * @return 执行的定时器个数
+         */
+        std::size_t Advance(std::chrono::steady_clock::time_point now);
+
+        // 等待执行的定时器个数
+        [[nodiscard]] std::size_t GetTimerCount() const
+        {
+            return _timerCount;
+        }
+
+        // 已推进的tick数，每个tick为1ms
+        [[nodiscard]] uint64_t GetElapsedTicks() const
+        {
+            return _elapsedTick;
+        }
+
+    private:
+        struct TimerLink
+        {
+            TimerLink *pPrev {nullptr};
+            TimerLink *pNext {nullptr};
+        };
+
+        struct TimerNode : TimerLink
+        {
+            uint64_t expireTick {0};
+            uint64_t interval {0}; // 周期定时器的间隔，0为一次性定时器
+            uint32_t index {0};
+            uint32_t generation {1}; // 节点复用时递增，使旧id失效
+            bool     bActive {false};
+            bool     bRunning {false};
+            bool     bCancelled {false}; // 回调执行中被取消，回调返回后再释放
+            Callback callback;
+        };
+
+        static constexpr uint32_t ROOT_SLOT_BITS   = 8;
+        static constexpr uint32_t LEVEL_SLOT_BITS  = 6;
+        static constexpr uint32_t LEVEL_COUNT      = 5;
+        static constexpr uint32_t ROOT_SLOT_COUNT  = 1U << ROOT_SLOT_BITS;
+        static constexpr uint32_t LEVEL_SLOT_COUNT = 1U << LEVEL_SLOT_BITS;
+        static constexpr uint64_t MAX_TIMER_DELAY  = uint64_t {1} << (ROOT_SLOT_BITS + LEVEL_SLOT_BITS * 4);
+
+        // 第level层(level >= 1)的槽位由到期tick右移的位数
+        static constexpr uint32_t GetLevelShift(uint32_t level)
+        {
+            return ROOT_SLOT_BITS + LEVEL_SLOT_BITS * (level - 1);
+        }
+
+        TimerNode *FindNode(TimerId timerId);
+
+        static TimerId MakeTimerId(uint32_t index, uint32_t generation);
+
+        TimerNode &AllocateNode();
+
+        void ReleaseNode(TimerNode &node);
+
+        // 按到期tick与当前tick的距离放入对应层的槽
+        void Insert(TimerNode &node);
+
+        static void Unlink(TimerLink &link);
+
+        static void PushBack(TimerLink &head, TimerLink &link);
+
+        // 把整个槽的链表移到head，槽变为空
+        static void SpliceSlot(TimerLink &slot, TimerLink &head);
+
+        // 第level层对应当前tick的槽中的定时器下沉到低层
+        void Cascade(uint32_t level);
+
+        void RunTimer(TimerNode &node);
+
+    private:
+        std::chrono::steady_clock::time_point _startTime;
+        uint64_t                              _elapsedTick {0}; // 已执行过的最后一个tick
+        std::size_t                           _timerCount {0};
+        bool                                  _bAdvancing {false};
+
+        std::array<TimerLink, ROOT_SLOT_COUNT>                               _rootSlots;
+        std::array<std::array<TimerLink, LEVEL_SLOT_COUNT>, LEVEL_COUNT - 1> _levelSlots;
+
+        std::deque<TimerNode> _nodes; // deque保证节点地址稳定
+        std::vector<uint32_t> _freeNodes;
+    };
+} // namespace TimeUtil
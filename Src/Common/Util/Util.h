@@ -10,6 +10,7 @@
 
 #include "Assert.h"
 #include "Platform.h"
+#include "StringUtil.h"
 
 #include <type_traits>
 #include <string_view>
@@ -17,6 +18,8 @@
 #include <optional>
 #include <charconv>
 #include <string>
+#include <sstream>
+#include <thread>
 
 namespace Util
 {
@@ -47,15 +50,10 @@ namespace Util
         return static_cast<std::underlying_type_t<Enum>>(eum);
     }
 
+    // 忽略大小写比较，只处理ASCII，不受区域设置影响
     inline bool StringEqual(std::string_view strLeft, std::string_view strRight)
     {
-        return std::equal(strLeft.begin(),
-                          strLeft.end(),
-                          strRight.begin(),
-                          strRight.end(),
-                          [](char left, char right) {
-                              return std::tolower(left) == std::tolower(right);
-                          });
+        return EqualIgnoreCaseAscii(strLeft, strRight);
     }
 
     namespace detail
@@ -66,6 +64,12 @@ namespace Util
         {
             constexpr static std::optional<T> FromString(std::string_view str, int base = 10)
             {
+                // 十进制最常用，不检查前缀，直接走快速解析
+                if (10 == base)
+                {
+                    return ParseDecimal<T>(str);
+                }
+
                 if (0 == base || 10 != base)
                 {
                     if (Util::StringEqual(str.substr(0, 2), "0x"))
@@ -254,6 +258,14 @@ namespace Util
         }
     }
 
+    // 当前线程id的字符串形式，用于日志
+    inline std::string GetCurrentThreadIdString()
+    {
+        std::ostringstream ss;
+        ss << std::this_thread::get_id();
+        return ss.str();
+    }
+
     inline std::filesystem::path GetExecutableDirectoryPath()
     {
 #ifdef OS_PLATFORM_WINDOWS
@@ -10,11 +10,27 @@
 #include "Common/Net/Http/HttpCommon.h"
 #include "Common/Util/Log.h"
 #include "Common/Util/Assert.h"
+#include "Common/Util/Profiler.h"
+#include "Common/Util/Util.h"
 #include "Common/Database/DatabaseImpl/LoginDatabase.h"
 
-HttpServer::HttpServer(std::string_view ip, uint16_t port) : Net::IServer(ip, port)
+HttpServer::HttpServer(std::string_view ip, uint16_t port, bool bEnableDiagnostics)
+    : Net::IServer(ip, port)
 {
     InitHttpRouter();
+
+    if (!bEnableDiagnostics)
+    {
+        return;
+    }
+
+    if (!_listenEndPoint.address().is_loopback())
+    {
+        Log::Warn("诊断接口没有鉴权，监听地址{}不是本机地址，不开放", ip);
+        return;
+    }
+
+    InitDiagnosticHandlers();
 }
 
 void HttpServer::InitHttpRouter()
@@ -40,17 +56,15 @@ void HttpServer::InitHttpRouter()
                 resp.SetStatusCode(Http::StatusCode::InternalServerError);
                 return;
             }
-            Log::Debug("/user request");
-            Database::PreparedStatementBase *pStmt = Database::g_LoginDatabase.GetPrepareStatement(
+            LOG_DEBUG(Http, "/user request");
+            Database::PreparedStatementPtr pStmt = Database::g_LoginDatabase.GetPrepareStatement(
                 Database::LoginDatabaseSqlID::LOGIN_SEL_ACCOUNT_BY_EMAIL);
             pStmt->SerialValue(data->second, "123456@qq.com");
 
-            auto callback = Database::g_LoginDatabase.AsyncQuery(pStmt).Then(
+            auto callback = Database::g_LoginDatabase.AsyncQuery(std::move(pStmt)).Then(
                 // R"(select id, name, email, age, intro from account where email="123456@qq.com")",
                 [&resp](Database::PreparedQueryResultSetPtr pResult) {
-                    std::ostringstream ss;
-                    ss << std::this_thread::get_id();
-                    Log::Error("=======Query End:{}", ss.str());
+                    LOG_ERROR(Http, "=======Query End:{}", Util::GetCurrentThreadIdString());
                     if (pResult == nullptr)
                     {
                         resp.SetStatusCode(Http::StatusCode::InternalServerError);
@@ -70,16 +84,20 @@ void HttpServer::InitHttpRouter()
                                                 strName,
                                                 age,
                                                 intro));
-                    Log::Debug("id:{}, email:{}, name:{}, age:{}, intro:{}", id, email, strName, age, intro);
+                    LOG_DEBUG(Http,
+                              "id:{}, email:{}, name:{}, age:{}, intro:{}",
+                              id,
+                              email,
+                              strName,
+                              age,
+                              intro);
 
                     resp.SetStatusCode(Http::StatusCode::Ok);
                 });
 
             _queryCallbackProcessor.AddCallback(std::move(callback));
             std::this_thread::sleep_for(std::chrono::seconds(3));
-            std::ostringstream ss;
-            ss << std::this_thread::get_id();
-            Log::Warn("-------------------------------:{}", ss.str());
+            LOG_WARN(Http, "-------------------------------:{}", Util::GetCurrentThreadIdString());
         });
 
     _router.AddHttpHandler(
@@ -93,16 +111,14 @@ void HttpServer::InitHttpRouter()
                 resp.SetStatusCode(Http::StatusCode::InternalServerError);
                 return;
             }
-            Log::Debug("/user2 request");
+            LOG_DEBUG(Http, "/user2 request");
 
-            Database::PreparedStatementBase *pStmt = Database::g_LoginDatabase.GetPrepareStatement(
+            Database::PreparedStatementPtr pStmt = Database::g_LoginDatabase.GetPrepareStatement(
                 Database::LoginDatabaseSqlID::LOGIN_SEL_ACCOUNT_BY_EMAIL);
             pStmt->SerialValue(data->second, "123456@qq.com");
 
-            std::ostringstream ss;
-            ss << std::this_thread::get_id();
-            Log::Debug("**********request Query thread id:{}", ss.str());
-            auto pResult = Database::g_LoginDatabase.SyncQuery(pStmt);
+            LOG_DEBUG(Http, "**********request Query thread id:{}", Util::GetCurrentThreadIdString());
+            auto pResult = Database::g_LoginDatabase.SyncQuery(pStmt.get());
             // R"(select id, name, email, age, intro from account where email="123456@qq.com")");
             if (pResult == nullptr)
             {
@@ -119,7 +135,7 @@ void HttpServer::InitHttpRouter()
 
             resp.SetContent(
                 std::format("id:{}, email:{}, name:{}, age:{}, intro:{}", id, email, strName, age, intro));
-            Log::Debug("id:{}, email:{}, name:{}, age:{}, intro:{}", id, email, strName, age, intro);
+            LOG_DEBUG(Http, "id:{}, email:{}, name:{}, age:{}, intro:{}", id, email, strName, age, intro);
 
             resp.SetStatusCode(Http::StatusCode::Ok);
         });
@@ -135,15 +151,31 @@ void HttpServer::InitHttpRouter()
                            });
 }
 
+void HttpServer::InitDiagnosticHandlers()
+{
+    _router.AddMetricsHandler();
+
+    // 导出性能分析数据，保存后在chrome://tracing或Perfetto中打开
+    _router.AddHttpHandler(Http::HttpMethod::Get,
+                           "/debug/trace",
+                           [](const Http::HttpRequest &request, Http::HttpResponse &resp) -> void {
+                               resp.FillResponse(Http::StatusCode::Ok,
+                                                 Http::ContentType::Json,
+                                                 Profiler::ExportChromeTrace());
+                           });
+}
+
 void HttpServer::Update()
 {
     Net::IServer::Update();
+
+    PROFILE_SCOPE("HttpServer::ProcessReadyCallbacks");
     _queryCallbackProcessor.ProcessReadyCallbacks();
 }
 
 std::shared_ptr<Net::ISession> HttpServer::CreateSession(Asio::socket &&socket)
 {
-    return std::make_shared<Http::HttpSession>(std::move(socket));
+    return std::make_shared<Http::HttpSession>(std::move(socket), _sessionQueueCapacity);
 }
 
 void HttpServer::OnSessionCreated(std::shared_ptr<Net::ISession> pSession)
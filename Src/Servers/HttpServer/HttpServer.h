@@ -15,7 +15,10 @@
 class HttpServer final : public Net::IServer
 {
 public:
-    HttpServer(std::string_view ip, uint16_t port);
+    /**
+     * @param bEnableDiagnostics 是否开放/metrics与/debug/trace，这两个接口没有鉴权，只在监听本机地址时生效
+     */
+    HttpServer(std::string_view ip, uint16_t port, bool bEnableDiagnostics = false);
 
     void InitHttpRouter();
 
@@ -25,6 +28,8 @@ protected:
     void OnSessionCreated(std::shared_ptr<Net::ISession> pSession) override;
 
 private:
+    void InitDiagnosticHandlers();
+
     Database::QueryCallbackProcessor _queryCallbackProcessor;
     Http::HttpRouter _router;
 };
@@ -8,11 +8,12 @@
 ************************************************************************/
 #include "HttpSession.h"
 #include "Common/Util/Log.h"
+#include "Common/Util/CachedClock.h"
 
 namespace Http
 {
-    HttpSession::HttpSession(Asio::socket&& socket)
-        : Net::ISession(std::move(socket))
+    HttpSession::HttpSession(Asio::socket&& socket, std::size_t queueCapacity)
+        : Net::ISession(std::move(socket), queueCapacity)
     {
     }
 
@@ -23,20 +24,48 @@ namespace Http
 
     void HttpSession::OnMessageReceived(Net::MessageBuffer& buffer)
     {
-        const std::string &content = buffer.ReadAllAsString();
-        if (!content.empty())
-        {
-            _req.Parse(content);
-            _router.Route(_req, _rep);
+        // 一次读取可能包含多个流水线请求，也可能只有半个请求，不完整的部分留到下次
+        _pending.append(reinterpret_cast<const char *>(buffer.GetReadPointer()), buffer.ReadableBytes());
 
-            std::string_view response = _rep.GetPayload();
-            Net::MessageBuffer sendBuffer(response.size());
-            sendBuffer.Write(response);
-            SendMessage(std::move(sendBuffer));
-        }
-        else
+        Net::MessageBuffer sendBuffer;
+        size_t offset = 0;
+        while (offset < _pending.size())
         {
-            Log::Error("解析Http请求内容出错");
+            const std::string_view content = std::string_view(_pending).substr(offset);
+            if (content.find("\r\n\r\n") == std::string_view::npos)
+            {
+                if (content.size() > MAX_REQUEST_HEADER_SIZE)
+                {
+                    Log::Error("Http请求头过长，关闭会话，IP:{}", GetRemoteIpAddress());
+                    CloseSession();
+                    return;
+                }
+                break;
+            }
+
+            HttpRequest req;
+            if (req.Parse(content) != StatusCode::Ok)
+            {
+                Log::Error("解析Http请求内容出错，IP:{}", GetRemoteIpAddress());
+                CloseSession();
+                return;
+            }
+
+            const size_t requestLen = req.GetRequestLength();
+            if (content.size() < requestLen)
+            {
+                break;
+            }
+
+            _rep.Reset();
+            _router.Route(req, _rep);
+            // 会话在逻辑线程上处理，Date使用逻辑帧刷新的缓存时间
+            _rep.SetHeader("Date", TimeUtil::CachedClock::GetHttpDate());
+            sendBuffer.Write(_rep.GetPayload());
+            offset += requestLen;
         }
+
+        _pending.erase(0, offset);
+        SendMessage(sendBuffer);
     }
 } // namespace Http
@@ -17,15 +17,19 @@ namespace Http
     class HttpSession final : public Net::ISession
     {
     public:
-        HttpSession(Asio::socket&& socket);
+        HttpSession(Asio::socket&& socket, std::size_t queueCapacity = Net::DEFAULT_SESSION_QUEUE_CAPACITY);
         void SetRouter(const HttpRouter& router);
 
     protected:
         void OnMessageReceived(Net::MessageBuffer& buffer) override;
 
     private:
-        HttpRequest _req;
+        // 请求头超过该长度仍不完整时关闭会话
+        static constexpr size_t MAX_REQUEST_HEADER_SIZE = 8192;
+
+        // 处理函数可能异步持有响应的引用，响应对象随会话存在，每个请求前重置
         HttpResponse _rep;
         HttpRouter _router;
+        std::string _pending; // 尚未处理完的请求内容
     };
 } // namespace Http
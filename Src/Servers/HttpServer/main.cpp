@@ -13,14 +13,14 @@ int main()
     }
     auto strLogFile = std::format("{}/HttpServer.html", logDir.string());
 
-    Log::CLogger::GetLogger().InitLogger(strLogFile, 0, 10240, 10);
+    Log::CLogger::GetLogger().InitAsyncLogger(strLogFile, 0, 10240, 10);
 
     Database::g_LoginDatabase.Open({"root", "cr11234", "test", "127.0.0.1", "3306"}, 1, 1);
     Database::g_LoginDatabase.PrepareStatements();
 
     try
     {
-        HttpServer server("127.0.0.1", 10007);
+        HttpServer server("127.0.0.1", 10007, true);
 
         server.Start();
     }
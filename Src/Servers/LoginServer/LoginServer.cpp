@@ -20,5 +20,5 @@ void LoginServer::Update()
 
 std::shared_ptr<Net::ISession> LoginServer::CreateSession(Asio::socket &&socket)
 {
-    return std::make_shared<LoginSession>(std::move(socket));
+    return std::make_shared<LoginSession>(std::move(socket), _sessionQueueCapacity);
 }
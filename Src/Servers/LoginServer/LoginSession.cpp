@@ -7,7 +7,40 @@
 > Created Time    : 2024年10月14日  18时03分06秒
 ************************************************************************/
 #include "LoginSession.h"
+#include "Common/Net/Packet.h"
+#include "Common/Util/Log.h"
+
+LoginSession::LoginSession(Asio::socket &&socket, std::size_t queueCapacity)
+    : Net::ISession(std::move(socket), queueCapacity)
+{
+}
 
 void LoginSession::OnMessageReceived(Net::MessageBuffer &buffer)
 {
+    // 一次读取可能包含多个消息帧，也可能只有半个
+    _recvBuffer.Write(buffer.GetReadPointer(), buffer.ReadableBytes());
+
+    // 登录协议尚未定义，目前原样回显每个完整的消息帧，供压测工具衡量收发开销
+    Net::MessageBuffer sendBuffer;
+    while (_recvBuffer.ReadableBytes() >= Net::PACKET_HEADER_SIZE)
+    {
+        const uint32_t bodySize = Net::ReadPacketHeader(_recvBuffer.GetReadPointer());
+        if (bodySize > Net::MAX_PACKET_BODY_SIZE)
+        {
+            Log::Error("消息帧过长：{}，关闭会话，IP:{}", bodySize, GetRemoteIpAddress());
+            CloseSession();
+            return;
+        }
+
+        const size_t packetSize = Net::PACKET_HEADER_SIZE + bodySize;
+        if (_recvBuffer.ReadableBytes() < packetSize)
+        {
+            break;
+        }
+
+        sendBuffer.Write(_recvBuffer.GetReadPointer(), packetSize);
+        _recvBuffer.ReadDone(packetSize);
+    }
+
+    SendMessage(sendBuffer);
 }
@@ -13,6 +13,12 @@
 class LoginSession final : public Net::ISession
 {
 public:
+    explicit LoginSession(Asio::socket &&socket,
+                          std::size_t     queueCapacity = Net::DEFAULT_SESSION_QUEUE_CAPACITY);
+
 protected:
     void OnMessageReceived(Net::MessageBuffer &buffer) override;
+
+private:
+    Net::MessageBuffer _recvBuffer; // 尚未凑成完整消息帧的数据
 };
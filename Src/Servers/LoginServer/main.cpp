@@ -0,0 +1,32 @@
+﻿#include "LoginServer.h"
+#include "Common/Util/Log.h"
+#include "Common/Util/Util.h"
+
+int main()
+{
+    auto logDir = Util::GetExecutableDirectoryPath() / "log";
+    if (!std::filesystem::exists(logDir))
+    {
+        std::filesystem::create_directories(logDir);
+    }
+    auto strLogFile = std::format("{}/LoginServer.html", logDir.string());
+
+    Log::CLogger::GetLogger().InitAsyncLogger(strLogFile, 0, 10240, 10);
+
+    try
+    {
+        LoginServer server("127.0.0.1", 10008);
+
+        server.Start();
+    }
+    catch (const std::exception &exception)
+    {
+        Log::Critical("登录服务器发生异常：{}", exception.what());
+    }
+    catch (...)
+    {
+        Log::Critical("登录服务器发生未知异常！！！");
+    }
+
+    return 0;
+}
@@ -11,4 +11,11 @@ target("DemoServer")
     add_rules("CommonRule")
     add_headerfiles("DemoServer/*.h")
     add_files("DemoServer/*.cpp")
+    add_deps("Common")
+
+target("LoginServer")
+    set_kind("binary")
+    add_rules("CommonRule")
+    add_headerfiles("LoginServer/*.h")
+    add_files("LoginServer/*.cpp")
     add_deps("Common")
\ No newline at end of file
@@ -0,0 +1,23 @@
+﻿/*************************************************************************
+> File Name       : LatencyHistogram.h
+> Brief           : 压测延迟直方图
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年10月15日  14时36分20秒
+************************************************************************/
+#pragma once
+
+#include "Common/Util/Histogram.h"
+
+namespace LoadGen
+{
+    // 每个2的幂区间分为128个桶，百分位的相对误差小于1%，最大约1100秒
+    using LatencyBuckets = Util::LogLinearBuckets<7, 40>;
+
+    /**
+     * @brief 纳秒延迟直方图，与Metrics::Histogram同为Util的对数线性直方图，分桶更细；
+     *        只在单个线程上记录，不需要原子操作，结束后合并
+     */
+    using LatencyHistogram = Util::BasicHistogramSnapshot<LatencyBuckets>;
+} // namespace LoadGen
@@ -0,0 +1,538 @@
+﻿/*************************************************************************
+> File Name       : LoadGenerator.cpp
+> Brief           : 压测负载生成
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年10月15日  15时02分48秒
+************************************************************************/
+#include "LoadGenerator.h"
+#include "Common/Net/Packet.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <format>
+#include <thread>
+
+namespace LoadGen
+{
+    namespace
+    {
+        // 停止发送后等待未完成响应的最长时间，超过后剩余请求计为超时
+        constexpr std::chrono::seconds DRAIN_TIMEOUT {2};
+
+        constexpr std::array<double, 5> REPORT_PERCENTILES = {50, 90, 99, 99.9, 99.99};
+
+        std::string BuildRequest(const LoadConfig &config)
+        {
+            if (config.mode == LoadMode::Packet)
+            {
+                std::string packet(Net::PACKET_HEADER_SIZE + config.packetSize, 'x');
+                Net::WritePacketHeader(reinterpret_cast<uint8_t *>(packet.data()),
+                                       static_cast<uint32_t>(config.packetSize));
+                return packet;
+            }
+
+            return std::format("GET {} HTTP/1.1\r\nHost: {}:{}\r\nConnection: {}\r\n\r\n",
+                               config.path,
+                               config.host,
+                               config.port,
+                               config.bKeepAlive ? "keep-alive" : "close");
+        }
+
+        uint64_t ToNanoseconds(std::chrono::steady_clock::duration duration)
+        {
+            const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+            return nanoseconds > 0 ? static_cast<uint64_t>(nanoseconds) : 0;
+        }
+
+        void CloseSocket(Asio::socket &socket)
+        {
+            std::error_code                  errcode;
+            [[maybe_unused]] std::error_code ret = socket.close(errcode);
+        }
+
+        std::string FormatLatency(uint64_t nanoseconds)
+        {
+            if (nanoseconds < 1'000)
+            {
+                return std::format("{}ns", nanoseconds);
+            }
+
+            if (nanoseconds < 1'000'000)
+            {
+                return std::format("{:.1f}us", static_cast<double>(nanoseconds) / 1e3);
+            }
+
+            if (nanoseconds < 1'000'000'000)
+            {
+                return std::format("{:.2f}ms", static_cast<double>(nanoseconds) / 1e6);
+            }
+
+            return std::format("{:.2f}s", static_cast<double>(nanoseconds) / 1e9);
+        }
+
+        void AppendLatencyLine(std::string &text, const LatencyHistogram &histogram, std::string_view title)
+        {
+            text += std::format("{:>10}{:>10}",
+                                FormatLatency(histogram.GetMin()),
+                                FormatLatency(static_cast<uint64_t>(histogram.GetMean())));
+            for (double percentile : REPORT_PERCENTILES)
+            {
+                text += std::format("{:>10}", FormatLatency(histogram.GetPercentile(percentile)));
+            }
+            text += std::format("{:>10}  {}\n", FormatLatency(histogram.max), title);
+        }
+    } // namespace
+
+    LoadGenerator::LoadGenerator(LoadConfig config) : _config(std::move(config))
+    {
+        _config.connections = (std::max)(_config.connections, std::size_t {1});
+        _config.threads     = std::clamp(_config.threads, std::size_t {1}, _config.connections);
+        _config.pipeline    = (std::max)(_config.pipeline, std::size_t {1});
+        _config.packetSize  = (std::min)(_config.packetSize, std::size_t {Net::MAX_PACKET_BODY_SIZE});
+        if (_config.mode == LoadMode::Http && !_config.bKeepAlive)
+        {
+            _config.pipeline = 1;
+        }
+
+        if (_config.rate > 0)
+        {
+            // 总速率平均分到各连接
+            const double                        connections = static_cast<double>(_config.connections);
+            const std::chrono::duration<double> seconds(connections / _config.rate);
+
+            _interval = (std::max)(std::chrono::duration_cast<Clock::duration>(seconds), Clock::duration {1});
+        }
+
+        _request = BuildRequest(_config);
+    }
+
+    LoadReport LoadGenerator::Run()
+    {
+        {
+            Asio::io_context        ioCtx;
+            asio::ip::tcp::resolver resolver(ioCtx);
+            _endpoint = *resolver.resolve(_config.host, std::to_string(_config.port)).begin();
+        }
+
+        _workers.clear();
+        for (std::size_t i = 0; i < _config.threads; ++i)
+        {
+            _workers.push_back(std::make_unique<Worker>());
+        }
+
+        _startTime   = Clock::now();
+        _measureTime = _startTime + _config.warmup;
+        _stopTime    = _measureTime + _config.duration;
+
+        const bool bShortConnection = _config.mode == LoadMode::Http && !_config.bKeepAlive;
+        for (std::size_t i = 0; i < _config.connections; ++i)
+        {
+            Worker &worker = *_workers[i % _workers.size()];
+            ++worker.activeConnections;
+            if (bShortConnection)
+            {
+                Asio::co_spawn(worker.ioCtx, RunShortConnection(worker, i), asio::detached);
+            }
+            else
+            {
+                Asio::co_spawn(worker.ioCtx, RunConnection(worker, i), asio::detached);
+            }
+        }
+
+        std::vector<std::thread> threads;
+        for (const auto &pWorker : _workers)
+        {
+            Worker &worker = *pWorker;
+            worker.drainTimer.expires_at(_stopTime + DRAIN_TIMEOUT);
+            worker.drainTimer.async_wait([&worker](std::error_code errcode) {
+                if (!errcode)
+                {
+                    worker.ioCtx.stop();
+                }
+            });
+            threads.emplace_back([&worker]() {
+                worker.ioCtx.run();
+            });
+        }
+
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+
+        LoadReport report;
+        report.elapsed = _config.duration;
+        for (const auto &pWorker : _workers)
+        {
+            report.latency.Merge(pWorker->latency);
+            report.requests += pWorker->requests;
+            report.errors += pWorker->errors;
+            report.timeouts += pWorker->inFlight;
+            report.bytesSent += pWorker->bytesSent;
+            report.bytesReceived += pWorker->bytesReceived;
+        }
+        _workers.clear();
+
+        if (_interval > Clock::duration::zero())
+        {
+            // 开环的延迟从计划发送时间起算，本身已包含被阻塞的时间
+            report.expectedInterval = ToNanoseconds(_interval);
+            report.corrected        = report.latency;
+        }
+        else
+        {
+            report.expectedInterval = report.latency.GetPercentile(50);
+            report.corrected        = report.latency.CopyCorrected(report.expectedInterval);
+        }
+        return report;
+    }
+
+    asio::awaitable<void> LoadGenerator::RunConnection(Worker &worker, std::size_t index)
+    {
+        auto pConn     = std::make_shared<Connection>(worker.ioCtx);
+        auto [errcode] = co_await pConn->socket.async_connect(_endpoint);
+        if (errcode)
+        {
+            ++worker.errors;
+            std::fprintf(stderr, "连接%zu建立失败：%s\n", index, errcode.message().c_str());
+            OnConnectionExit(worker);
+            co_return;
+        }
+
+        pConn->socket.set_option(asio::ip::tcp::no_delay(true));
+        Asio::co_spawn(worker.ioCtx, SendLoop(worker, pConn, index), asio::detached);
+        co_await ReceiveLoop(worker, pConn);
+        OnConnectionExit(worker);
+    }
+
+    asio::awaitable<void> LoadGenerator::SendLoop(Worker                     &worker,
+                                                  std::shared_ptr<Connection> pConn,
+                                                  std::size_t                 index)
+    {
+        const bool        bOpenLoop = _interval > Clock::duration::zero();
+        Clock::time_point next      = GetFirstSendTime(index);
+        while (pConn->socket.is_open())
+        {
+            Clock::time_point intended = next;
+            if (bOpenLoop)
+            {
+                if (next >= _stopTime)
+                {
+                    break;
+                }
+
+                pConn->sendTimer.expires_at(next);
+                co_await pConn->sendTimer.async_wait();
+                next += _interval;
+            }
+
+            while (pConn->pending.size() >= _config.pipeline && pConn->socket.is_open())
+            {
+                pConn->slotTimer.expires_at((Clock::time_point::max)());
+                co_await pConn->slotTimer.async_wait();
+            }
+
+            if (!bOpenLoop)
+            {
+                intended = Clock::now();
+                if (intended >= _stopTime)
+                {
+                    break;
+                }
+            }
+
+            if (!pConn->socket.is_open())
+            {
+                break;
+            }
+
+            const bool bMeasured = intended >= _measureTime;
+            pConn->pending.push_back(intended);
+            if (bMeasured)
+            {
+                ++worker.inFlight;
+            }
+
+            auto [errcode, length] = co_await asio::async_write(pConn->socket, asio::buffer(_request));
+            if (errcode)
+            {
+                ++worker.errors;
+                DropPending(worker, *pConn);
+                CloseSocket(pConn->socket);
+                break;
+            }
+
+            if (bMeasured)
+            {
+                worker.bytesSent += length;
+            }
+        }
+
+        pConn->bSendDone = true;
+        if (pConn->pending.empty())
+        {
+            // 没有待接收的响应，关闭连接以结束接收协程
+            CloseSocket(pConn->socket);
+        }
+    }
+
+    asio::awaitable<void> LoadGenerator::ReceiveLoop(Worker &worker, std::shared_ptr<Connection> pConn)
+    {
+        while (!pConn->bSendDone || !pConn->pending.empty())
+        {
+            auto [length, bSuccess] = co_await ReadResponse(*pConn);
+            if (length == 0)
+            {
+                // 发送结束且响应已收齐时由发送协程关闭连接，读取被取消不是错误
+                if (!pConn->bSendDone || !pConn->pending.empty())
+                {
+                    ++worker.errors;
+                    DropPending(worker, *pConn);
+                }
+                break;
+            }
+
+            if (pConn->pending.empty())
+            {
+                ++worker.errors;
+                std::fprintf(stderr, "收到多余的响应，关闭连接\n");
+                break;
+            }
+
+            const Clock::time_point intended = pConn->pending.front();
+            pConn->pending.pop_front();
+            RecordResponse(worker, intended, length, bSuccess);
+            pConn->slotTimer.cancel();
+        }
+
+        CloseSocket(pConn->socket);
+        pConn->sendTimer.cancel();
+        pConn->slotTimer.cancel();
+    }
+
+    asio::awaitable<void> LoadGenerator::RunShortConnection(Worker &worker, std::size_t index)
+    {
+        const bool         bOpenLoop = _interval > Clock::duration::zero();
+        Clock::time_point  next      = GetFirstSendTime(index);
+        Asio::steady_timer sendTimer(worker.ioCtx);
+        while (true)
+        {
+            Clock::time_point intended = next;
+            if (bOpenLoop)
+            {
+                if (next >= _stopTime)
+                {
+                    break;
+                }
+
+                sendTimer.expires_at(next);
+                co_await sendTimer.async_wait();
+                next += _interval;
+            }
+            else
+            {
+                intended = Clock::now();
+                if (intended >= _stopTime)
+                {
+                    break;
+                }
+            }
+
+            const bool bMeasured = intended >= _measureTime;
+            if (bMeasured)
+            {
+                ++worker.inFlight;
+            }
+
+            Connection  conn(worker.ioCtx);
+            std::size_t length   = 0;
+            bool        bSuccess = false;
+            auto [connectErrcode] = co_await conn.socket.async_connect(_endpoint);
+            if (!connectErrcode)
+            {
+                auto [writeErrcode, sentBytes] =
+                    co_await asio::async_write(conn.socket, asio::buffer(_request));
+                if (!writeErrcode)
+                {
+                    if (bMeasured)
+                    {
+                        worker.bytesSent += sentBytes;
+                    }
+                    std::tie(length, bSuccess) = co_await ReadResponse(conn);
+                }
+            }
+            CloseSocket(conn.socket);
+
+            if (length == 0)
+            {
+                RecordFailure(worker, intended);
+                continue;
+            }
+            RecordResponse(worker, intended, length, bSuccess);
+        }
+
+        OnConnectionExit(worker);
+    }
+
+    asio::awaitable<std::pair<std::size_t, bool>> LoadGenerator::ReadResponse(Connection &conn)
+    {
+        if (_config.mode == LoadMode::Packet)
+        {
+            std::array<uint8_t, Net::PACKET_HEADER_SIZE> header {};
+            auto [headerErrcode, headerLength] = co_await asio::async_read(conn.socket, asio::buffer(header));
+            if (headerErrcode)
+            {
+                co_return std::pair {std::size_t {0}, false};
+            }
+
+            const uint32_t bodySize = Net::ReadPacketHeader(header.data());
+            if (bodySize > Net::MAX_PACKET_BODY_SIZE)
+            {
+                co_return std::pair {std::size_t {0}, false};
+            }
+
+            conn.readBuffer.resize(bodySize);
+            auto [bodyErrcode, bodyLength] =
+                co_await asio::async_read(conn.socket, asio::buffer(conn.readBuffer));
+            if (bodyErrcode)
+            {
+                co_return std::pair {std::size_t {0}, false};
+            }
+
+            // 服务器原样回显，长度不同说明帧已错位
+            co_return std::pair {Net::PACKET_HEADER_SIZE + bodySize, bodySize == _config.packetSize};
+        }
+
+        auto [headerErrcode, headerLength] =
+            co_await asio::async_read_until(conn.socket, asio::dynamic_buffer(conn.readBuffer), "\r\n\r\n");
+        if (headerErrcode
+            || conn.parser.ParseResponse(std::string_view(conn.readBuffer).substr(0, headerLength)) == 0)
+        {
+            co_return std::pair {std::size_t {0}, false};
+        }
+
+        const std::size_t responseLength = headerLength + conn.parser.BodyLength();
+        if (const std::size_t received = conn.readBuffer.size(); received < responseLength)
+        {
+            conn.readBuffer.resize(responseLength);
+            auto [bodyErrcode, bodyLength] = co_await asio::async_read(
+                conn.socket,
+                asio::buffer(conn.readBuffer.data() + received, responseLength - received));
+            if (bodyErrcode)
+            {
+                co_return std::pair {std::size_t {0}, false};
+            }
+        }
+
+        // 流水线时缓冲区中可能已有下一个响应的内容，只移除当前响应
+        const int status = conn.parser.Status();
+        conn.readBuffer.erase(0, responseLength);
+        co_return std::pair {responseLength, status >= 200 && status < 300};
+    }
+
+    LoadGenerator::Clock::time_point LoadGenerator::GetFirstSendTime(std::size_t index) const
+    {
+        const auto offset = _interval * static_cast<Clock::rep>(index);
+        return _startTime + offset / static_cast<Clock::rep>(_config.connections);
+    }
+
+    void LoadGenerator::RecordResponse(Worker           &worker,
+                                       Clock::time_point intended,
+                                       std::size_t       bytes,
+                                       bool              bSuccess) const
+    {
+        if (intended < _measureTime)
+        {
+            return;
+        }
+
+        --worker.inFlight;
+        ++worker.requests;
+        worker.bytesReceived += bytes;
+        worker.latency.Record(ToNanoseconds(Clock::now() - intended));
+        if (!bSuccess)
+        {
+            ++worker.errors;
+        }
+    }
+
+    void LoadGenerator::RecordFailure(Worker &worker, Clock::time_point intended) const
+    {
+        if (intended < _measureTime)
+        {
+            return;
+        }
+
+        --worker.inFlight;
+        ++worker.errors;
+    }
+
+    void LoadGenerator::DropPending(Worker &worker, Connection &conn) const
+    {
+        for (Clock::time_point intended : conn.pending)
+        {
+            RecordFailure(worker, intended);
+        }
+        conn.pending.clear();
+    }
+
+    void LoadGenerator::OnConnectionExit(Worker &worker)
+    {
+        if (--worker.activeConnections == 0)
+        {
+            worker.drainTimer.cancel();
+        }
+    }
+
+    std::string FormatReport(const LoadConfig &config, const LoadReport &report)
+    {
+        const bool   bOpenLoop = config.rate > 0;
+        const double seconds   = (std::max)(std::chrono::duration<double>(report.elapsed).count(), 1e-9);
+
+        std::string_view mode = "消息帧";
+        if (config.mode == LoadMode::Http)
+        {
+            mode = config.bKeepAlive ? "Http" : "Http短连接";
+        }
+
+        std::string text = std::format("目标 {}:{}  {}  {}  连接 {}  线程 {}  流水线 {}\n",
+                                       config.host,
+                                       config.port,
+                                       mode,
+                                       bOpenLoop ? std::format("开环 {} 请求/秒", config.rate) : "闭环",
+                                       config.connections,
+                                       config.threads,
+                                       config.pipeline);
+        text += std::format("时长 {:.2f}s  请求 {}  错误 {}  超时 {}\n",
+                            seconds,
+                            report.requests,
+                            report.errors,
+                            report.timeouts);
+        text += std::format("吞吐 {:.1f} 请求/秒  发送 {:.2f} MB/s  接收 {:.2f} MB/s\n",
+                            static_cast<double>(report.requests) / seconds,
+                            static_cast<double>(report.bytesSent) / seconds / 1e6,
+                            static_cast<double>(report.bytesReceived) / seconds / 1e6);
+
+        text += std::format("{:>10}{:>10}", "min", "mean");
+        for (double percentile : REPORT_PERCENTILES)
+        {
+            text += std::format("{:>10}", std::format("p{}", percentile));
+        }
+        text += std::format("{:>10}\n", "max");
+
+        if (bOpenLoop)
+        {
+            AppendLatencyLine(text, report.latency, "自计划发送时间起算");
+        }
+        else
+        {
+            AppendLatencyLine(text, report.latency, "未校正");
+            const std::string interval = FormatLatency(report.expectedInterval);
+            AppendLatencyLine(text, report.corrected, std::format("校正协调遗漏，期望间隔 {}", interval));
+        }
+        return text;
+    }
+} // namespace LoadGen
@@ -0,0 +1,157 @@
+﻿/*************************************************************************
+> File Name       : LoadGenerator.h
+> Brief           : 压测负载生成
+> Author          : Harold
+> Mail            : 2106562095@qq.com
+> Github          : www.github.com/Haroldcc
+> Created Time    : 2024年10月15日  15时02分48秒
+************************************************************************/
+#pragma once
+
+#include "LatencyHistogram.h"
+#include "Common/Net/Asio.h"
+#include "Common/Net/Http/HttpParser.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace LoadGen
+{
+    enum class LoadMode : uint8_t
+    {
+        Http,   // Http GET请求，对应HttpServer
+        Packet, // 长度前缀的二进制消息帧，对应LoginServer
+    };
+
+    struct LoadConfig
+    {
+        std::string               host        = "127.0.0.1";
+        uint16_t                  port        = 10007;
+        LoadMode                  mode        = LoadMode::Http;
+        std::size_t               connections = 16;      // 并发连接数
+        std::size_t               threads     = 1;       // 网络线程数，连接平均分到各线程
+        std::chrono::milliseconds duration {10000};      // 计入统计的时长
+        std::chrono::milliseconds warmup {1000};         // 预热时长，期间完成的请求不计入统计
+        double                    rate        = 0;       // 每秒总请求数，为0时为闭环，收到响应后发送下一个
+        std::size_t               pipeline    = 1;       // 每个连接上未完成的请求数上限
+        bool                      bKeepAlive  = true;    // Http为false时每个请求新建连接，不使用流水线
+        std::string               path        = "/";     // Http请求路径
+        std::size_t               packetSize  = 64;      // 消息帧的包体字节数
+    };
+
+    struct LoadReport
+    {
+        uint64_t                 requests {0};         // 统计期间完成的请求数
+        uint64_t                 errors {0};           // 连接或读写失败、Http状态码不是2xx的次数
+        uint64_t                 timeouts {0};         // 压测结束后等待超时仍未响应的请求数
+        uint64_t                 bytesSent {0};
+        uint64_t                 bytesReceived {0};
+        std::chrono::nanoseconds elapsed {0};
+        LatencyHistogram         latency;              // 开环时自计划发送时间起算，已计入排队等待
+        LatencyHistogram         corrected;            // 校正协调遗漏后的延迟
+        uint64_t                 expectedInterval {0}; // 校正所用的期望间隔(纳秒)
+    };
+
+    /**
+     * @brief 向目标服务器建立多个连接并持续发送请求，统计吞吐与延迟。
+     *        开环(rate > 0)时每个连接按固定间隔排定发送时间，延迟从排定时间起算，
+     *        服务器变慢导致的发送推迟也计入延迟，不会掩盖停顿(协调遗漏)；
+     *        闭环时延迟从实际发送起算，事后以中位延迟为期望间隔补记被阻塞的请求
+     */
+    class LoadGenerator
+    {
+    public:
+        explicit LoadGenerator(LoadConfig config);
+
+        LoadReport Run();
+
+        // 校正过取值范围后的配置
+        [[nodiscard]] const LoadConfig &GetConfig() const
+        {
+            return _config;
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        // 每个网络线程一份，只在该线程上访问，结束后合并
+        struct Worker
+        {
+            Asio::io_context   ioCtx {1};
+            Asio::steady_timer drainTimer {ioCtx}; // 到期后放弃仍未响应的请求
+            LatencyHistogram   latency;
+            uint64_t           requests {0};
+            uint64_t           errors {0};
+            uint64_t           inFlight {0}; // 计入统计且尚未响应的请求数
+            uint64_t           bytesSent {0};
+            uint64_t           bytesReceived {0};
+            std::size_t        activeConnections {0};
+        };
+
+        struct Connection
+        {
+            explicit Connection(Asio::io_context &ioCtx)
+                : socket(ioCtx)
+                , sendTimer(ioCtx)
+                , slotTimer(ioCtx)
+            {
+            }
+
+            Asio::socket                  socket;
+            Asio::steady_timer            sendTimer; // 开环时等待排定的发送时间
+            Asio::steady_timer            slotTimer; // 流水线已满时等待响应腾出空位
+            std::deque<Clock::time_point> pending;   // 已发送未响应的请求的计划发送时间
+            std::string                   readBuffer;
+            Http::HttpParser              parser;
+            bool                          bSendDone = false;
+        };
+
+        asio::awaitable<void> RunConnection(Worker &worker, std::size_t index);
+        asio::awaitable<void> SendLoop(Worker &worker, std::shared_ptr<Connection> pConn, std::size_t index);
+        asio::awaitable<void> ReceiveLoop(Worker &worker, std::shared_ptr<Connection> pConn);
+
+        // 不复用连接的Http请求，每个请求依次建立连接、发送、接收、断开
+        asio::awaitable<void> RunShortConnection(Worker &worker, std::size_t index);
+
+        /**
+         * @brief 读取一个完整的响应
+         *
+         * @return 响应字节数与是否成功，Http状态码不是2xx时视为失败；读取出错时字节数为0
+         */
+        asio::awaitable<std::pair<std::size_t, bool>> ReadResponse(Connection &conn);
+
+        // 第index个连接的第一个排定发送时间，各连接错开，避免同时发送
+        Clock::time_point GetFirstSendTime(std::size_t index) const;
+
+        // 计入统计的请求完成
+        void RecordResponse(Worker           &worker,
+                            Clock::time_point intended,
+                            std::size_t       bytes,
+                            bool              bSuccess) const;
+
+        // 计入统计的请求因连接出错而失败
+        void RecordFailure(Worker &worker, Clock::time_point intended) const;
+
+        // 连接出错时放弃其上所有未响应的请求
+        void DropPending(Worker &worker, Connection &conn) const;
+
+        static void OnConnectionExit(Worker &worker);
+
+    private:
+        LoadConfig                           _config;
+        std::string                          _request;     // 每次发送的请求内容
+        Asio::endpoint                       _endpoint;
+        Clock::duration                      _interval {0}; // 开环时每个连接的发送间隔，闭环为0
+        Clock::time_point                    _startTime;
+        Clock::time_point                    _measureTime; // 预热结束，开始统计
+        Clock::time_point                    _stopTime;    // 停止发送
+        std::vector<std::unique_ptr<Worker>> _workers;
+    };
+
+    // 可读的压测结果
+    std::string FormatReport(const LoadConfig &config, const LoadReport &report);
+} // namespace LoadGen
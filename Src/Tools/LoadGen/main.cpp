@@ -0,0 +1,158 @@
+﻿#include "LoadGenerator.h"
+#include "Common/Util/Util.h"
+
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace
+{
+    constexpr uint16_t HTTP_SERVER_PORT  = 10007;
+    constexpr uint16_t LOGIN_SERVER_PORT = 10008;
+
+    constexpr const char *USAGE = R"(用法：LoadGen [选项]
+  --mode http|packet   Http请求(默认)或长度前缀的消息帧
+  --host <地址>        目标地址，默认127.0.0.1
+  --port <端口>        目标端口，http默认10007(HttpServer)，packet默认10008(LoginServer)
+  -c <连接数>          并发连接数，默认16
+  -t <线程数>          网络线程数，默认1
+  -d <秒>              统计时长，默认10
+  --warmup <秒>        预热时长，不计入统计，默认1
+  -r <请求/秒>         总发送速率(开环)，默认0为闭环
+  --pipeline <深度>    每个连接上未完成的请求数上限，默认1
+  --no-keepalive       Http每个请求新建连接
+  --path <路径>        Http请求路径，默认/
+  --size <字节>        消息帧的包体字节数，默认64
+)";
+
+    template <typename T>
+    bool ParseNumber(std::string_view value, T &result)
+    {
+        const std::optional<T> number = Util::StringTo<T>(value);
+        if (!number.has_value() || *number < T {})
+        {
+            return false;
+        }
+
+        result = *number;
+        return true;
+    }
+
+    bool ParseSeconds(std::string_view value, std::chrono::milliseconds &result)
+    {
+        double seconds = 0;
+        if (!ParseNumber(value, seconds))
+        {
+            return false;
+        }
+
+        const std::chrono::duration<double> duration(seconds);
+        result = std::chrono::duration_cast<std::chrono::milliseconds>(duration);
+        return true;
+    }
+} // namespace
+
+/**
+ * 压测工具，向HttpServer或LoginServer建立多个连接持续发送请求，输出吞吐与延迟分布
+ * 例：LoadGen -c 64 -d 30 -r 20000            开环，每秒共20000个请求
+ *     LoadGen --mode packet -c 128 --pipeline 8 闭环，每个连接保持8个未完成的请求
+ */
+int main(int argc, char *argv[])
+{
+    LoadGen::LoadConfig config;
+    bool                bPortSet = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (arg == "--no-keepalive")
+        {
+            config.bKeepAlive = false;
+            continue;
+        }
+
+        if (i + 1 >= argc)
+        {
+            std::fprintf(stderr, "缺少参数值：%s\n%s", argv[i], USAGE);
+            return 1;
+        }
+
+        const std::string_view value  = argv[++i];
+        bool                   bValid = true;
+        if (arg == "--mode")
+        {
+            bValid      = value == "http" || value == "packet";
+            config.mode = value == "packet" ? LoadGen::LoadMode::Packet : LoadGen::LoadMode::Http;
+        }
+        else if (arg == "--host")
+        {
+            config.host = value;
+        }
+        else if (arg == "--port")
+        {
+            bValid   = ParseNumber(value, config.port);
+            bPortSet = true;
+        }
+        else if (arg == "-c")
+        {
+            bValid = ParseNumber(value, config.connections);
+        }
+        else if (arg == "-t")
+        {
+            bValid = ParseNumber(value, config.threads);
+        }
+        else if (arg == "-d")
+        {
+            bValid = ParseSeconds(value, config.duration);
+        }
+        else if (arg == "--warmup")
+        {
+            bValid = ParseSeconds(value, config.warmup);
+        }
+        else if (arg == "-r")
+        {
+            bValid = ParseNumber(value, config.rate);
+        }
+        else if (arg == "--pipeline")
+        {
+            bValid = ParseNumber(value, config.pipeline);
+        }
+        else if (arg == "--size")
+        {
+            bValid = ParseNumber(value, config.packetSize);
+        }
+        else if (arg == "--path")
+        {
+            config.path = value;
+        }
+        else
+        {
+            std::fprintf(stderr, "未知选项：%s\n%s", argv[i - 1], USAGE);
+            return 1;
+        }
+
+        if (!bValid)
+        {
+            std::fprintf(stderr, "参数值无效：%s %s\n", argv[i - 1], argv[i]);
+            return 1;
+        }
+    }
+
+    if (!bPortSet)
+    {
+        config.port = config.mode == LoadGen::LoadMode::Packet ? LOGIN_SERVER_PORT : HTTP_SERVER_PORT;
+    }
+
+    try
+    {
+        LoadGen::LoadGenerator    generator(config);
+        const LoadGen::LoadReport report = generator.Run();
+        std::printf("%s", LoadGen::FormatReport(generator.GetConfig(), report).c_str());
+        return report.requests > 0 ? 0 : 1;
+    }
+    catch (const std::exception &exception)
+    {
+        std::fprintf(stderr, "压测失败：%s\n", exception.what());
+        return 1;
+    }
+}
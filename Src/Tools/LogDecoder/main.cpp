@@ -0,0 +1,86 @@
+﻿#include "Common/Util/BinaryLogReader.h"
+#include "Common/Util/Log.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+/**
+ * 将二进制日志还原为html或文本
+ * 用法：LogDecoder <日志文件> [输出文件] [--text]
+ *      输出文件缺省为日志文件名加.html/.txt，为-时输出到标准输出
+ */
+int main(int argc, char *argv[])
+{
+    std::string inputFile;
+    std::string outputFile;
+    bool        bText = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (arg == "--text")
+        {
+            bText = true;
+        }
+        else if (inputFile.empty())
+        {
+            inputFile = arg;
+        }
+        else
+        {
+            outputFile = arg;
+        }
+    }
+
+    if (inputFile.empty())
+    {
+        std::fprintf(stderr, "用法：LogDecoder <日志文件> [输出文件] [--text]\n");
+        return 1;
+    }
+
+    Log::BinaryLogReader reader;
+    if (!reader.Open(inputFile))
+    {
+        std::fprintf(stderr, "无法读取二进制日志：%s\n", inputFile.c_str());
+        return 1;
+    }
+
+    if (outputFile.empty())
+    {
+        outputFile = inputFile + (bText ? ".txt" : ".html");
+    }
+
+    std::ofstream file;
+    if (outputFile != "-")
+    {
+        file.open(outputFile, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            std::fprintf(stderr, "无法写入：%s\n", outputFile.c_str());
+            return 1;
+        }
+    }
+    std::ostream &output = outputFile == "-" ? std::cout : file;
+
+    if (!bText)
+    {
+        output << Log::GetHtmlLogHeader();
+    }
+
+    for (const auto &record : reader.GetRecords())
+    {
+        if (bText)
+        {
+            output << reader.FormatLine(record) << '\n';
+        }
+        else
+        {
+            output << Log::GetLogLevelHtmlPrefix(static_cast<spdlog::level>(record.level))
+                   << reader.FormatLine(record) << Log::HTML_LOG_SUFFIX << '\n';
+        }
+    }
+
+    return 0;
+}
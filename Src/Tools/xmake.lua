@@ -0,0 +1,12 @@
+target("LogDecoder")
+    set_kind("binary")
+    add_rules("CommonRule")
+    add_files("LogDecoder/*.cpp")
+    add_deps("Common")
+
+-- 压测工具，用法见LoadGen/main.cpp
+target("LoadGen")
+    set_kind("binary")
+    add_rules("CommonRule")
+    add_files("LoadGen/*.cpp")
+    add_deps("Common")
@@ -0,0 +1,169 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Util/BinaryLog.h"
+#include "Common/Util/BinaryLogReader.h"
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Log;
+
+namespace
+{
+    std::filesystem::path GetTempLogPath(std::string_view name)
+    {
+        auto path = std::filesystem::temp_directory_path() / name;
+        std::filesystem::remove(path);
+        std::filesystem::remove(path.string() + ".sites");
+        return path;
+    }
+} // namespace
+
+TEST_CASE("BinaryLog - Format message")
+{
+    const std::vector<BinaryLogArg> args {int64_t {-3}, std::string {"abc"}, 1.5, true, 'x'};
+
+    CHECK(FormatBinaryLogMessage("{} {} {} {} {}", args) == "-3 abc 1.5 true x");
+    CHECK(FormatBinaryLogMessage("{1}-{0}", args) == "abc--3");
+    CHECK(FormatBinaryLogMessage("{:>5}|{{}}", args) == "   -3|{}");
+    CHECK(FormatBinaryLogMessage("{:08.3f}", std::vector<BinaryLogArg> {2.0}) == "0002.000");
+
+    // 参数不足或格式说明与类型不符
+    CHECK(FormatBinaryLogMessage("{} {} {} {} {} {}", args) == "-3 abc 1.5 true x {?}");
+    CHECK(FormatBinaryLogMessage("{:d}", std::vector<BinaryLogArg> {std::string {"s"}}) == "{?}");
+}
+
+TEST_CASE("BinaryLog - Site line")
+{
+    const BinaryLogSite site {7, 42, "a\\b.cpp", "void F()", "tab\there\nline {}"};
+
+    const auto parsed = ParseBinaryLogSite(FormatBinaryLogSite(site));
+    REQUIRE(parsed.has_value());
+    CHECK(parsed->id == 7);
+    CHECK(parsed->line == 42);
+    CHECK(parsed->file == site.file);
+    CHECK(parsed->function == site.function);
+    CHECK(parsed->format == site.format);
+
+    CHECK_FALSE(ParseBinaryLogSite("1\t2\tfile").has_value());
+    CHECK_FALSE(ParseBinaryLogSite("x\t2\tfile\tfunc\tfmt").has_value());
+}
+
+TEST_CASE("BinaryLog - Write and read")
+{
+    const auto path = GetTempLogPath("TestBinaryLog.blog");
+
+    auto &logger = BinaryLogger::GetInstance();
+    REQUIRE(logger.Open(path.string(), 1024 * 1024));
+
+    const std::string name = "player";
+    for (int i = 0; i < 3; ++i)
+    {
+        logger.Write(2, "login {} id:{} ratio:{}", __FILE__, __LINE__, "Test", name, i, 0.25F);
+    }
+    logger.Close();
+
+    BinaryLogReader reader;
+    REQUIRE(reader.Open(path.string()));
+
+    const auto &records = reader.GetRecords();
+    REQUIRE(records.size() == 3);
+    CHECK(records[0].siteId == records[2].siteId);
+    CHECK(records[1].level == 2);
+    CHECK(reader.FormatMessage(records[1]) == "login player id:1 ratio:0.25");
+
+    const BinaryLogSite *pSite = reader.GetSite(records[0].siteId);
+    REQUIRE(pSite != nullptr);
+    CHECK(pSite->function == "Test");
+
+    // 重新打开后继续写入，站点编号不与旧记录冲突
+    REQUIRE(logger.Open(path.string(), 1024 * 1024));
+    logger.Write(3, "reopen {}", __FILE__, __LINE__, "Test", 'c');
+    logger.Close();
+
+    REQUIRE(reader.Open(path.string()));
+    REQUIRE(reader.GetRecords().size() == 4);
+    CHECK(reader.GetRecords()[3].siteId != records[0].siteId);
+    CHECK(reader.FormatMessage(reader.GetRecords()[3]) == "reopen c");
+    CHECK(reader.FormatMessage(reader.GetRecords()[0]) == "login player id:0 ratio:0.25");
+}
+
+TEST_CASE("BinaryLog - Ring wrap")
+{
+    const auto path = GetTempLogPath("TestBinaryLogRing.blog");
+
+    auto &logger = BinaryLogger::GetInstance();
+    REQUIRE(logger.Open(path.string(), 4096));
+    for (uint64_t i = 0; i < 1000; ++i)
+    {
+        logger.Write(2, "seq {} {}", __FILE__, __LINE__, "Test", i, std::string(i % 50, 'x'));
+    }
+    logger.Close();
+
+    BinaryLogReader reader;
+    REQUIRE(reader.Open(path.string()));
+
+    // 只保留最新的一段且序号连续
+    const auto &records = reader.GetRecords();
+    REQUIRE(records.size() > 10);
+    REQUIRE(records.size() < 1000);
+    CHECK(std::get<uint64_t>(records.back().args[0]) == 999);
+
+    bool bContinuous = true;
+    for (std::size_t i = 1; i < records.size(); ++i)
+    {
+        const auto prev = std::get<uint64_t>(records[i - 1].args[0]);
+        bContinuous     = bContinuous && std::get<uint64_t>(records[i].args[0]) == prev + 1;
+    }
+    CHECK(bContinuous);
+}
+
+TEST_CASE("BinaryLog - Reopen while writing")
+{
+    const auto path = GetTempLogPath("TestBinaryLogReopen.blog");
+
+    auto &logger = BinaryLogger::GetInstance();
+    REQUIRE(logger.Open(path.string(), 4096));
+
+    // 写入线程与关闭、重新打开并发，映射区不能在写入期间被解除
+    std::atomic<bool>        bStop {false};
+    std::vector<std::thread> writers;
+    for (int i = 0; i < 4; ++i)
+    {
+        writers.emplace_back([&logger, &bStop]() {
+            uint64_t seq = 0;
+            while (!bStop.load(std::memory_order_relaxed))
+            {
+                if (logger.IsOpen())
+                {
+                    logger.Write(2, "seq {} {}", __FILE__, __LINE__, "Test", seq, std::string(seq % 50, 'x'));
+                    ++seq;
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < 200; ++i)
+    {
+        logger.Close();
+        REQUIRE(logger.Open(path.string(), 4096));
+    }
+
+    bStop = true;
+    for (std::thread &writer : writers)
+    {
+        writer.join();
+    }
+    logger.Close();
+
+    // 关闭后的写入直接丢弃
+    logger.Write(2, "closed {}", __FILE__, __LINE__, "Test", 1);
+
+    BinaryLogReader reader;
+    REQUIRE(reader.Open(path.string()));
+    CHECK_FALSE(reader.GetRecords().empty());
+}
@@ -167,6 +167,54 @@ TEST_CASE("测试MessageBuffer的EnsureWritableBytes和MakeSpace逻辑")
     CHECK(mb.WritableBytes() >= 5); // 现在应该有更多可写空间了
 }
 
+TEST_CASE("测试MakeSpace的前移与扩容保留未读数据")
+{
+    const char *data = "0123456789";
+
+    SUBCASE("已读前缀足够时前移，不扩容")
+    {
+        MessageBuffer mb(10);
+        mb.Write(reinterpret_cast<const uint8_t *>(data), 10);
+        CHECK(mb.ReadAsString(6) == "012345");
+
+        const uint8_t *pBase = mb.GetBasePointer();
+        mb.EnsureWritableBytes(5);
+        CHECK(mb.GetBasePointer() == pBase);
+        CHECK(mb.GetReadPointer() == pBase);
+        CHECK(mb.ReadableBytes() == 4);
+        CHECK(mb.WritableBytes() == 6); // 总大小仍为10
+        CHECK(mb.ReadAllAsString() == "6789");
+    }
+
+    SUBCASE("已读前缀不够时扩容")
+    {
+        MessageBuffer mb(10);
+        mb.Write(reinterpret_cast<const uint8_t *>(data), 10);
+        CHECK(mb.ReadAsString(2) == "01");
+
+        mb.EnsureWritableBytes(5);
+        CHECK(mb.WritableBytes() >= 5);
+        CHECK(mb.ReadableBytes() == 8);
+
+        mb.Write(reinterpret_cast<const uint8_t *>("abcde"), 5);
+        CHECK(mb.ReadAllAsString() == "23456789abcde");
+    }
+
+    SUBCASE("持续读写时缓冲区大小不增长")
+    {
+        // 始终留有3字节未读，缓冲区不会因读空而重置
+        MessageBuffer mb(16);
+        mb.Write(reinterpret_cast<const uint8_t *>("xyz"), 3);
+        for (int i = 0; i < 1000; ++i)
+        {
+            mb.Write(reinterpret_cast<const uint8_t *>(data), 10);
+            mb.ReadAsString(10);
+        }
+        CHECK(mb.ReadableBytes() + mb.WritableBytes() <= 16);
+        CHECK(mb.ReadAllAsString() == "789");
+    }
+}
+
 TEST_CASE("测试MessageBuffer流操作符")
 {
     MessageBuffer mb;
@@ -0,0 +1,61 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Database/BulkLoader.h"
+
+#include <limits>
+
+using namespace Database;
+
+TEST_CASE("BulkLoader - Split key range")
+{
+    const auto chunks = SplitKeyRange<uint32_t>(1, 100, 4, 1);
+    REQUIRE(chunks.size() == 4);
+    CHECK(chunks.front().first == 1);
+    CHECK(chunks.back().second == 100);
+    for (std::size_t i = 1; i < chunks.size(); ++i)
+    {
+        // 各块首尾相接，不重叠也不遗漏
+        CHECK(chunks[i].first == chunks[i - 1].second + 1);
+    }
+}
+
+TEST_CASE("BulkLoader - Min chunk size")
+{
+    // 主键不足时减少块数
+    CHECK(SplitKeyRange<uint32_t>(1, 100, 8, 4096).size() == 1);
+    CHECK(SplitKeyRange<uint32_t>(1, 10000, 8, 4096).size() == 3);
+    CHECK(SplitKeyRange<uint32_t>(5, 7, 8, 1).size() == 3);
+
+    const auto single = SplitKeyRange<uint32_t>(7, 7, 8, 1);
+    REQUIRE(single.size() == 1);
+    CHECK(single.front().first == 7);
+    CHECK(single.front().second == 7);
+
+    CHECK(SplitKeyRange<uint32_t>(8, 7, 8, 1).empty());
+}
+
+TEST_CASE("BulkLoader - Signed and full range")
+{
+    const auto signedChunks = SplitKeyRange<int32_t>(-50, 49, 4, 1);
+    REQUIRE(signedChunks.size() == 4);
+    CHECK(signedChunks.front().first == -50);
+    CHECK(signedChunks[1].first == -25);
+    CHECK(signedChunks.back().second == 49);
+
+    constexpr uint64_t maxKey     = std::numeric_limits<uint64_t>::max();
+    const auto         fullChunks = SplitKeyRange<uint64_t>(0, maxKey, 4, 1);
+    REQUIRE(fullChunks.size() == 4);
+    CHECK(fullChunks.back().second == maxKey);
+    CHECK(fullChunks[1].first == fullChunks[0].second + 1);
+}
+
+TEST_CASE("BulkLoader - Rows per second")
+{
+    BulkLoadStats stats;
+    CHECK(stats.RowsPerSecond() == 0);
+
+    stats.rowCount = 5000;
+    stats.elapsed  = std::chrono::milliseconds(500);
+    CHECK(stats.RowsPerSecond() == 10000.0);
+}
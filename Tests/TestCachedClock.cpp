@@ -0,0 +1,72 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Util/CachedClock.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+using namespace TimeUtil;
+
+TEST_CASE("CachedClock - 格式化")
+{
+    char httpDate[CachedClock::HTTP_DATE_LENGTH];
+    // RFC 7231中的示例
+    CachedClock::FormatHttpDate(784111777, httpDate);
+    CHECK(std::string(httpDate, sizeof(httpDate)) == "Sun, 06 Nov 1994 08:49:37 GMT");
+
+    CachedClock::FormatHttpDate(951782400, httpDate);
+    CHECK(std::string(httpDate, sizeof(httpDate)) == "Tue, 29 Feb 2000 00:00:00 GMT");
+
+    char timestamp[CachedClock::LOG_TIMESTAMP_LENGTH];
+    CachedClock::FormatTimestamp(0, '-', ' ', ':', timestamp);
+    CHECK(std::string(timestamp, sizeof(timestamp)) == "1970-01-01 00:00:00");
+
+    CachedClock::FormatTimestamp(1716862537, '_', '_', '_', timestamp);
+    CHECK(std::string(timestamp, sizeof(timestamp)) == "2024_05_28_02_15_37");
+}
+
+TEST_CASE("CachedClock - 缓存值")
+{
+    CachedClock::Update();
+    const int64_t systemMillis = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count();
+    CHECK(systemMillis - CachedClock::GetUnixMillis() < 1000);
+    CHECK(CachedClock::GetSteadyTime() <= std::chrono::steady_clock::now());
+
+    char httpDate[CachedClock::HTTP_DATE_LENGTH];
+    CachedClock::FormatHttpDate(CachedClock::GetUnixMillis() / 1000, httpDate);
+    CHECK(CachedClock::GetHttpDate() == std::string_view(httpDate, sizeof(httpDate)));
+    CHECK(CachedClock::GetFileTimestamp().find_first_of(" :") == std::string_view::npos);
+
+    // 未调用Update时时间不前进
+    const int64_t cached = CachedClock::GetUnixMillis();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    CHECK(CachedClock::GetUnixMillis() == cached);
+    CachedClock::Update();
+    CHECK(CachedClock::GetUnixMillis() > cached);
+}
+
+TEST_CASE("CachedClock - 并发读取")
+{
+    std::atomic<bool> bStop {false};
+    std::thread       updater([&bStop] {
+        while (!bStop.load(std::memory_order_relaxed))
+        {
+            CachedClock::Update();
+        }
+    });
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        const std::string date(CachedClock::GetHttpDate());
+        REQUIRE(date.size() == CachedClock::HTTP_DATE_LENGTH);
+        REQUIRE(date.ends_with(" GMT"));
+    }
+
+    bStop = true;
+    updater.join();
+}
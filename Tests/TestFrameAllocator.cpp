@@ -0,0 +1,109 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Coroutine/FrameAllocator.h"
+#include "Common/Coroutine/Task.hpp"
+
+#include <thread>
+#include <vector>
+
+using namespace Coroutine;
+
+namespace
+{
+    Task<int> Leaf(int value)
+    {
+        co_return value + 1;
+    }
+
+    Task<int> Nested(int depth)
+    {
+        if (0 == depth)
+        {
+            co_return co_await Leaf(depth);
+        }
+        co_return co_await Nested(depth - 1) + 1;
+    }
+} // namespace
+
+TEST_CASE("同级别的帧被复用")
+{
+    FrameAllocator::TrimThreadCache();
+
+    void *pFirst = FrameAllocator::Allocate(100);
+    FrameAllocator::Deallocate(pFirst, 100);
+
+    // 100与120同属(96, 128]级别
+    const FrameAllocatorStats before = FrameAllocator::GetThreadStats();
+    void                     *pSecond = FrameAllocator::Allocate(120);
+    CHECK(pSecond == pFirst);
+    CHECK(FrameAllocator::GetThreadStats().reusedFrames == before.reusedFrames + 1);
+    CHECK(FrameAllocator::GetThreadStats().heapAllocations == before.heapAllocations);
+
+    // 不同级别不复用
+    FrameAllocator::Deallocate(pSecond, 120);
+    void *pThird = FrameAllocator::Allocate(200);
+    CHECK(FrameAllocator::GetThreadStats().heapAllocations == before.heapAllocations + 1);
+    FrameAllocator::Deallocate(pThird, 200);
+
+    FrameAllocator::TrimThreadCache();
+    CHECK(FrameAllocator::GetThreadStats().cachedFrames == 0);
+}
+
+TEST_CASE("超大帧与缓存上限")
+{
+    FrameAllocator::TrimThreadCache();
+
+    const FrameAllocatorStats before = FrameAllocator::GetThreadStats();
+    void                     *pLarge = FrameAllocator::Allocate(MAX_POOLED_FRAME_SIZE + 1);
+    FrameAllocator::Deallocate(pLarge, MAX_POOLED_FRAME_SIZE + 1);
+    CHECK(FrameAllocator::GetThreadStats().oversizeFrames == before.oversizeFrames + 1);
+    CHECK(FrameAllocator::GetThreadStats().cachedFrames == 0);
+
+    FrameAllocator::SetThreadCacheCapacity(2);
+    std::vector<void *> frames;
+    for (int i = 0; i < 4; ++i)
+    {
+        frames.push_back(FrameAllocator::Allocate(64));
+    }
+    for (void *pFrame : frames)
+    {
+        FrameAllocator::Deallocate(pFrame, 64);
+    }
+    CHECK(FrameAllocator::GetThreadStats().cachedFrames == 2);
+
+    FrameAllocator::SetThreadCacheCapacity(0);
+    CHECK(FrameAllocator::GetThreadStats().cachedFrames == 0);
+    FrameAllocator::SetThreadCacheCapacity(DEFAULT_FRAME_CACHE_CAPACITY);
+}
+
+TEST_CASE("Task调用链稳定后不再产生堆分配")
+{
+    constexpr int DEPTH = 32;
+
+    CHECK(SyncWait(Nested(DEPTH)) == DEPTH + 1);
+
+    const FrameAllocatorStats before = FrameAllocator::GetThreadStats();
+    for (int i = 0; i < 10; ++i)
+    {
+        CHECK(SyncWait(Nested(DEPTH)) == DEPTH + 1);
+    }
+    const FrameAllocatorStats after = FrameAllocator::GetThreadStats();
+    CHECK(after.heapAllocations == before.heapAllocations);
+    CHECK(after.reusedFrames > before.reusedFrames);
+}
+
+TEST_CASE("在其他线程释放的帧进入该线程的缓存")
+{
+    FrameAllocator::TrimThreadCache();
+
+    void *pFrame = FrameAllocator::Allocate(64);
+    std::thread([pFrame] {
+        FrameAllocator::Deallocate(pFrame, 64);
+        CHECK(FrameAllocator::GetThreadStats().cachedFrames == 1);
+        CHECK(FrameAllocator::Allocate(64) == pFrame);
+        FrameAllocator::Deallocate(pFrame, 64);
+    }).join();
+
+    CHECK(FrameAllocator::GetThreadStats().cachedFrames == 0);
+}
@@ -0,0 +1,128 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Tools/LoadGen/LatencyHistogram.h"
+
+#include <random>
+
+using LoadGen::LatencyBuckets;
+using LoadGen::LatencyHistogram;
+
+TEST_CASE("桶边界")
+{
+    for (uint64_t value = 1; value <= LatencyHistogram::SUB_BUCKET_COUNT; ++value)
+    {
+        CHECK(LatencyBuckets::GetBucketUpperBound(LatencyBuckets::GetBucketIndex(value)) == value);
+    }
+
+    // 每个值都不超过所在桶的上界，且大于前一个桶的上界
+    std::mt19937_64 random(42);
+    for (int i = 0; i < 100000; ++i)
+    {
+        const uint64_t value = random() >> (random() % 39 + 25);
+        if (value == 0)
+        {
+            continue;
+        }
+
+        const uint32_t index = LatencyBuckets::GetBucketIndex(value);
+        CHECK(value <= LatencyBuckets::GetBucketUpperBound(index));
+        if (index > 0)
+        {
+            CHECK(value > LatencyBuckets::GetBucketUpperBound(index - 1));
+        }
+    }
+
+    CHECK(LatencyBuckets::GetBucketIndex(UINT64_MAX) == LatencyBuckets::BUCKET_COUNT - 1);
+}
+
+TEST_CASE("百分位")
+{
+    LatencyHistogram histogram;
+    CHECK(histogram.GetPercentile(50) == 0);
+
+    // 1..100000微秒均匀分布
+    for (uint64_t i = 1; i <= 100000; ++i)
+    {
+        histogram.Record(i * 1000);
+    }
+
+    CHECK(histogram.count == 100000);
+    CHECK(histogram.GetMin() == 1000);
+    CHECK(histogram.max == 100000000);
+    CHECK(histogram.GetMean() == doctest::Approx(50000500.0));
+
+    // 相对误差小于1/SUB_BUCKET_COUNT
+    for (double percentile : {1.0, 25.0, 50.0, 90.0, 99.0, 99.9, 99.99})
+    {
+        const double expected = percentile * 1000000;
+        const auto   actual   = static_cast<double>(histogram.GetPercentile(percentile));
+        CHECK(actual >= expected);
+        CHECK(actual <= expected * (1.0 + 1.0 / LatencyHistogram::SUB_BUCKET_COUNT));
+    }
+    CHECK(histogram.GetPercentile(100) == histogram.max);
+    CHECK(histogram.GetPercentile(0) == histogram.GetMin());
+}
+
+TEST_CASE("协调遗漏校正")
+{
+    SUBCASE("未超过期望间隔时不补记")
+    {
+        LatencyHistogram histogram;
+        histogram.RecordCorrected(100, 100);
+        histogram.RecordCorrected(50, 0);
+        CHECK(histogram.count == 2);
+    }
+
+    SUBCASE("补记被阻塞的请求")
+    {
+        // 间隔1ms的请求遇到100ms的停顿，期间本应发出的99个请求延迟依次为99ms..1ms
+        LatencyHistogram histogram;
+        histogram.RecordCorrected(100000000, 1000000);
+        CHECK(histogram.count == 100);
+        CHECK(histogram.GetMin() == 1000000);
+        CHECK(histogram.max == 100000000);
+        CHECK(histogram.GetMean() == doctest::Approx(50500000.0));
+    }
+
+    SUBCASE("事后校正与记录时校正一致")
+    {
+        LatencyHistogram raw;
+        LatencyHistogram corrected;
+        for (uint64_t value : {1000, 1000, 1000, 1000, 250000, 1000, 1000})
+        {
+            raw.Record(value);
+            corrected.RecordCorrected(value, 10000);
+        }
+
+        const LatencyHistogram copy = raw.CopyCorrected(10000);
+        CHECK(copy.count == corrected.count);
+        CHECK(copy.count == 7 + 24);
+        for (double percentile : {50.0, 75.0, 90.0, 99.0})
+        {
+            CHECK(copy.GetPercentile(percentile) == corrected.GetPercentile(percentile));
+        }
+    }
+}
+
+TEST_CASE("合并")
+{
+    LatencyHistogram first;
+    LatencyHistogram second;
+    first.Record(10);
+    first.Record(20);
+    second.Record(5);
+    second.Record(3000, 3);
+
+    first.Merge(second);
+    CHECK(first.count == 6);
+    CHECK(first.GetMin() == 5);
+    CHECK(first.max == 3000);
+    CHECK(first.GetMean() == doctest::Approx((10 + 20 + 5 + 3000 * 3) / 6.0));
+    CHECK(first.GetPercentile(50) == 20);
+
+    // 与空直方图合并不改变最小值
+    LatencyHistogram empty;
+    first.Merge(empty);
+    CHECK(first.GetMin() == 5);
+}
@@ -14,4 +14,11 @@ int main()
     Log::Warn("{}", Util::StringTo<double>("3.13").value_or(0));
     Log::Warn("{}", Util::StringTo<bool>("3.13").value_or(0));
     Log::Warn("{}", Util::StringTo<float>("3.13").value_or(0));
+
+    // 模块等级高于调用等级时宏不会对参数求值
+    Log::CLogger::GetLogger().SetModuleLevel(Log::LogModule::Database, 2);
+    LOG_DEBUG(Database, "不会输出 {}", Util::GetCurrentThreadIdString());
+    LOG_INFO(Database, "模块日志 {}", a);
+
+    Log::Debug<Log::LogModule::Net>("延迟求值 {:>4}", Log::Lazy([a]() { return a * 2; }));
 }
\ No newline at end of file
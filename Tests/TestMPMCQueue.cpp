@@ -0,0 +1,206 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Util/MPMCQueue.hpp"
+#include "Common/Util/ProducerConsumerQueue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("MPMCQueue - FIFO")
+{
+    MPMCQueue<int> queue(5);
+    CHECK(queue.GetCapacity() == 8);
+    CHECK(queue.Empty());
+
+    int value = 0;
+    CHECK_FALSE(queue.TryPop(value));
+
+    // 多轮填满再取空，覆盖序号回绕
+    for (int round = 0; round < 3; ++round)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            CHECK(queue.TryPush(i));
+        }
+        CHECK_FALSE(queue.TryPush(8));
+        CHECK(queue.Size() == 8);
+
+        for (int i = 0; i < 8; ++i)
+        {
+            REQUIRE(queue.TryPop(value));
+            CHECK(value == i);
+        }
+        CHECK(queue.Empty());
+    }
+}
+
+TEST_CASE("MPMCQueue - Move only")
+{
+    MPMCQueue<std::unique_ptr<std::string>> queue(4);
+    auto                                    pValue = std::make_unique<std::string>("hello");
+    CHECK(queue.TryPush(std::move(pValue)));
+    CHECK(pValue == nullptr);
+
+    // 队列满时入队失败，值不被移走
+    for (int i = 0; i < 3; ++i)
+    {
+        CHECK(queue.TryPush(std::make_unique<std::string>("fill")));
+    }
+    auto pRejected = std::make_unique<std::string>("rejected");
+    CHECK_FALSE(queue.TryPush(std::move(pRejected)));
+    REQUIRE(pRejected != nullptr);
+    CHECK(*pRejected == "rejected");
+
+    std::unique_ptr<std::string> pResult;
+    REQUIRE(queue.TryPop(pResult));
+    CHECK(*pResult == "hello");
+
+    // 剩余元素由析构函数释放
+}
+
+TEST_CASE("MPMCQueue - Batch")
+{
+    MPMCQueue<int>   queue(8);
+    std::vector<int> input {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    CHECK(queue.TryPushBatch(input.begin(), input.end()) == 8);
+
+    std::vector<int> output;
+    CHECK(queue.TryPopBatch(std::back_inserter(output), 5) == 5);
+    CHECK(queue.TryPopBatch(std::back_inserter(output), 5) == 3);
+    CHECK((output == std::vector<int> {1, 2, 3, 4, 5, 6, 7, 8}));
+}
+
+TEST_CASE("MPMCQueue - Multi producer multi consumer")
+{
+    constexpr int PRODUCER_COUNT     = 4;
+    constexpr int CONSUMER_COUNT     = 4;
+    constexpr int COUNT_PER_PRODUCER = 20000;
+    constexpr int TOTAL_COUNT        = PRODUCER_COUNT * COUNT_PER_PRODUCER;
+
+    MPMCQueue<int>       queue(64);
+    std::atomic<int64_t> sum {0};
+    std::atomic<int>     popCount {0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < PRODUCER_COUNT; ++p)
+    {
+        threads.emplace_back([&queue] {
+            for (int i = 1; i <= COUNT_PER_PRODUCER; ++i)
+            {
+                CHECK(queue.WaitAndPush(i));
+            }
+        });
+    }
+    for (int c = 0; c < CONSUMER_COUNT; ++c)
+    {
+        threads.emplace_back([&] {
+            int value = 0;
+            while (queue.WaitAndPop(value))
+            {
+                sum.fetch_add(value, std::memory_order_relaxed);
+                if (popCount.fetch_add(1, std::memory_order_relaxed) + 1 == TOTAL_COUNT)
+                {
+                    queue.Shutdown();
+                }
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    CHECK(popCount.load() == TOTAL_COUNT);
+    CHECK(sum.load() == int64_t {PRODUCER_COUNT} * COUNT_PER_PRODUCER * (COUNT_PER_PRODUCER + 1) / 2);
+}
+
+TEST_CASE("MPMCQueue - Blocking wait")
+{
+    MPMCQueue<int> queue(2);
+    CHECK(queue.TryPush(1));
+    CHECK(queue.TryPush(2));
+
+    // 队列满时生产者等待，取出一个元素后被唤醒
+    std::thread producer([&queue] {
+        CHECK(queue.WaitAndPush(3));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    int value = 0;
+    CHECK(queue.WaitAndPop(value));
+    CHECK(value == 1);
+    producer.join();
+
+    CHECK(queue.WaitAndPop(value));
+    CHECK(value == 2);
+    CHECK(queue.WaitAndPop(value));
+    CHECK(value == 3);
+
+    // 队列空时消费者等待，入队后被唤醒
+    std::thread consumer([&queue] {
+        int result = 0;
+        CHECK(queue.WaitAndPop(result));
+        CHECK(result == 4);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(queue.WaitAndPush(4));
+    consumer.join();
+}
+
+TEST_CASE("MPMCQueue - Shutdown wakes waiters")
+{
+    MPMCQueue<int> emptyQueue(2);
+    std::thread    consumer([&emptyQueue] {
+        int value = 0;
+        CHECK_FALSE(emptyQueue.WaitAndPop(value));
+    });
+
+    MPMCQueue<int> fullQueue(2);
+    CHECK(fullQueue.TryPush(1));
+    CHECK(fullQueue.TryPush(2));
+    std::thread producer([&fullQueue] {
+        CHECK_FALSE(fullQueue.WaitAndPush(3));
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    emptyQueue.Shutdown();
+    fullQueue.Shutdown();
+    consumer.join();
+    producer.join();
+
+    // 关闭前入队的元素仍可取出
+    int value = 0;
+    CHECK(fullQueue.WaitAndPop(value));
+    CHECK(value == 1);
+    CHECK_FALSE(emptyQueue.WaitAndPush(4));
+}
+
+TEST_CASE("ProducerConsumerQueue")
+{
+    ProducerConsumerQueue<std::string> queue(2);
+    CHECK(queue.Push("a"));
+    const std::string value = "b";
+    CHECK(queue.Push(value));
+    CHECK_FALSE(queue.Push("c"));
+    CHECK(queue.Size() == 2);
+
+    std::thread consumer([&queue] {
+        std::string result;
+        CHECK(queue.WaitAndPop(result));
+        CHECK(result == "a");
+        CHECK(queue.WaitAndPop() == "b");
+    });
+    consumer.join();
+    CHECK(queue.Empty());
+
+    CHECK(queue.Push("d"));
+    queue.Clear();
+    std::string result;
+    CHECK_FALSE(queue.Pop(result));
+    CHECK_FALSE(queue.WaitAndPop(result));
+}
@@ -0,0 +1,135 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Util/MPSCQueue.hpp"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("MPSCQueue - FIFO")
+{
+    MPSCQueue<int> queue;
+    CHECK(queue.Empty());
+
+    int value = 0;
+    CHECK_FALSE(queue.Pop(value));
+
+    for (int i = 0; i < 10; ++i)
+    {
+        queue.Push(i);
+    }
+    CHECK_FALSE(queue.Empty());
+
+    for (int i = 0; i < 10; ++i)
+    {
+        REQUIRE(queue.Pop(value));
+        CHECK(value == i);
+    }
+    CHECK(queue.Empty());
+    CHECK_FALSE(queue.Pop(value));
+}
+
+TEST_CASE("MPSCQueue - Move only")
+{
+    MPSCQueue<std::unique_ptr<std::string>> queue;
+    queue.Push(std::make_unique<std::string>("hello"));
+
+    std::unique_ptr<std::string> pValue;
+    REQUIRE(queue.Pop(pValue));
+    REQUIRE(pValue != nullptr);
+    CHECK(*pValue == "hello");
+
+    // 析构时释放未取出的元素
+    queue.Push(std::make_unique<std::string>("left"));
+}
+
+TEST_CASE("MPSCQueue - Node pool")
+{
+    MPSCQueue<std::unique_ptr<std::string>> queue(4);
+    std::unique_ptr<std::string>            pValue;
+
+    // 节点出队后归还到池中，反复入队出队
+    for (int round = 0; round < 100; ++round)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            queue.Push(std::make_unique<std::string>(std::to_string(round * 4 + i)));
+        }
+
+        for (int i = 0; i < 4; ++i)
+        {
+            REQUIRE(queue.Pop(pValue));
+            CHECK(*pValue == std::to_string(round * 4 + i));
+        }
+        CHECK(queue.Empty());
+    }
+
+    // 超出容量时从堆上分配，顺序不变
+    for (int i = 0; i < 10; ++i)
+    {
+        queue.Push(std::make_unique<std::string>(std::to_string(i)));
+    }
+
+    for (int i = 0; i < 10; ++i)
+    {
+        REQUIRE(queue.Pop(pValue));
+        CHECK(*pValue == std::to_string(i));
+    }
+
+    // 析构时释放池中与堆上未取出的元素
+    for (int i = 0; i < 6; ++i)
+    {
+        queue.Push(std::make_unique<std::string>("left"));
+    }
+}
+
+TEST_CASE("MPSCQueue - Multi producer")
+{
+    constexpr int producerCount    = 4;
+    constexpr int countPerProducer = 20000;
+
+    // 池比并发入队的元素少，同时覆盖池中节点与堆上节点
+    MPSCQueue<std::pair<int, int>> queue(64);
+    std::vector<std::thread>       producers;
+    for (int p = 0; p < producerCount; ++p)
+    {
+        producers.emplace_back([&queue, p]() {
+            for (int i = 0; i < countPerProducer; ++i)
+            {
+                queue.Push(std::make_pair(p, i));
+            }
+        });
+    }
+
+    // 同一生产者的元素保持入队顺序
+    std::vector<int>    nextExpected(producerCount, 0);
+    std::pair<int, int> item;
+    int                 received = 0;
+    bool                bOrdered = true;
+    while (received < producerCount * countPerProducer)
+    {
+        if (!queue.Pop(item))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        bOrdered                 = bOrdered && (item.second == nextExpected[item.first]);
+        nextExpected[item.first] = item.second + 1;
+        ++received;
+    }
+
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+
+    CHECK(bOrdered);
+    CHECK(queue.Empty());
+    for (int p = 0; p < producerCount; ++p)
+    {
+        CHECK(nextExpected[p] == countPerProducer);
+    }
+}
@@ -0,0 +1,172 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Util/Metrics.h"
+
+#include <thread>
+#include <vector>
+
+TEST_CASE("Metrics - Counter")
+{
+    Metrics::Counter &counter = Metrics::GetCounter("test_counter_total", "计数");
+    CHECK(&counter == &Metrics::GetCounter("test_counter_total", "计数"));
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i)
+    {
+        threads.emplace_back([&counter]() {
+            for (int j = 0; j < 10000; ++j)
+            {
+                counter.Increment();
+            }
+        });
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    CHECK(counter.GetValue() == 80000);
+}
+
+TEST_CASE("Metrics - Gauge")
+{
+    Metrics::Gauge &gauge = Metrics::GetGauge("test_gauge", "瞬时值", R"(kind="a")");
+    CHECK(&gauge != &Metrics::GetGauge("test_gauge", "瞬时值", R"(kind="b")"));
+
+    gauge.Set(10);
+    gauge.Add(5);
+    gauge.Sub(20);
+    CHECK(gauge.GetValue() == -5);
+}
+
+TEST_CASE("Metrics - Histogram buckets")
+{
+    for (uint32_t i = 0; i + 1 < Metrics::HISTOGRAM_BUCKET_COUNT; ++i)
+    {
+        const uint64_t upperBound = Metrics::Histogram::GetBucketUpperBound(i);
+        CHECK(Metrics::Histogram::GetBucketIndex(upperBound) == i);
+        CHECK(Metrics::Histogram::GetBucketIndex(upperBound + 1) == i + 1);
+    }
+
+    CHECK(Metrics::Histogram::GetBucketIndex(0) == 0);
+    CHECK(Metrics::Histogram::GetBucketIndex(UINT64_MAX) == Metrics::HISTOGRAM_BUCKET_COUNT - 1);
+
+    Metrics::Histogram histogram(Metrics::MICROSECOND_UNIT);
+    histogram.Record(std::chrono::microseconds(5));
+    histogram.Record(std::chrono::milliseconds(3));
+
+    const auto snapshot = histogram.GetSnapshot();
+    CHECK(snapshot.count == 2);
+    CHECK(snapshot.sum == 3005);
+    CHECK(snapshot.GetMin() == 5);
+    CHECK(snapshot.max == 3000);
+    CHECK(snapshot.buckets[Metrics::Histogram::GetBucketIndex(5)] == 1);
+    CHECK(snapshot.buckets[Metrics::Histogram::GetBucketIndex(3000)] == 1);
+}
+
+TEST_CASE("Metrics - Histogram percentile")
+{
+    Metrics::Histogram histogram(Metrics::MICROSECOND_UNIT);
+    CHECK(histogram.GetSnapshot().GetPercentile(90) == 0);
+
+    for (uint64_t value = 1; value <= 100000; ++value)
+    {
+        histogram.Record(value);
+    }
+
+    // 相对误差不超过1/SUB_BUCKET_COUNT，且不超出最小值、最大值
+    const auto snapshot = histogram.GetSnapshot();
+    for (const double percentile : {1.0, 50.0, 90.0, 99.0, 99.9})
+    {
+        const auto expected = static_cast<double>(snapshot.count) * percentile / 100.0;
+        const auto actual   = static_cast<double>(snapshot.GetPercentile(percentile));
+        CHECK(actual >= expected);
+        CHECK(actual <= expected * (1.0 + 1.0 / Metrics::Histogram::SUB_BUCKET_COUNT));
+    }
+    CHECK(snapshot.GetPercentile(0) == 1);
+    CHECK(snapshot.GetPercentile(100) == 100000);
+    CHECK(snapshot.GetMean() == doctest::Approx(50000.5));
+
+    // 所有样本相同时分位数即为该值，不取桶上界
+    Metrics::Histogram same(Metrics::MICROSECOND_UNIT);
+    same.Record(std::chrono::microseconds(19000));
+    CHECK(same.GetSnapshot().GetPercentile(90) == 19000);
+}
+
+TEST_CASE("Metrics - Histogram take and merge")
+{
+    Metrics::Histogram histogram(Metrics::MICROSECOND_UNIT);
+    histogram.Record(100);
+    histogram.Record(50000);
+
+    // 取出后清零，合并后计数与最值一并合并
+    Metrics::HistogramSnapshot taken = histogram.TakeSnapshot();
+    CHECK(taken.count == 2);
+    CHECK(histogram.GetSnapshot().count == 0);
+    CHECK(histogram.GetSnapshot().GetMin() == 0);
+
+    histogram.Record(10);
+    taken.Merge(histogram.TakeSnapshot());
+    CHECK(taken.count == 3);
+    CHECK(taken.sum == 50110);
+    CHECK(taken.GetMin() == 10);
+    CHECK(taken.max == 50000);
+    CHECK(taken.GetPercentile(50) == 100);
+}
+
+TEST_CASE("Metrics - Histogram concurrent record")
+{
+    constexpr int THREAD_COUNT = 4;
+    constexpr int RECORD_COUNT = 10000;
+
+    Metrics::Histogram       histogram(Metrics::MICROSECOND_UNIT);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREAD_COUNT; ++i)
+    {
+        threads.emplace_back([&histogram] {
+            for (int j = 0; j < RECORD_COUNT; ++j)
+            {
+                histogram.Record(std::chrono::microseconds(j));
+            }
+        });
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    const auto snapshot = histogram.GetSnapshot();
+    CHECK(snapshot.count == THREAD_COUNT * RECORD_COUNT);
+    CHECK(snapshot.GetMin() == 0);
+    CHECK(snapshot.max == RECORD_COUNT - 1);
+}
+
+TEST_CASE("Metrics - Prometheus export")
+{
+    Metrics::GetCounter("test_export_total", "导出\n计数", R"(dir="in")").Increment(3);
+    Metrics::GetHistogram("test_export_seconds", "耗时").Record(std::chrono::microseconds(5));
+
+    const std::string text = Metrics::ExportPrometheus();
+    CHECK(text.find("# HELP test_export_total 导出\\n计数\n") != std::string::npos);
+    CHECK(text.find("# TYPE test_export_total counter\n") != std::string::npos);
+    CHECK(text.find("test_export_total{dir=\"in\"} 3\n") != std::string::npos);
+    CHECK(text.find("# TYPE test_export_seconds histogram\n") != std::string::npos);
+    CHECK(text.find("test_export_seconds_bucket{le=\"4e-06\"} 0\n") != std::string::npos);
+    CHECK(text.find("test_export_seconds_bucket{le=\"8e-06\"} 1\n") != std::string::npos);
+    CHECK(text.find("test_export_seconds_bucket{le=\"+Inf\"} 1\n") != std::string::npos);
+
+    // 空桶也导出，桶集合固定，每个2的幂区间取4个桶边界
+    std::size_t bucketCount = 0;
+    std::size_t pos         = text.find("test_export_seconds_bucket{");
+    while (pos != std::string::npos)
+    {
+        ++bucketCount;
+        pos = text.find("test_export_seconds_bucket{", pos + 1);
+    }
+    CHECK(bucketCount == Metrics::HISTOGRAM_BUCKET_COUNT / Metrics::HISTOGRAM_EXPORT_STRIDE);
+    CHECK(text.find("test_export_seconds_sum 5e-06\n") != std::string::npos);
+    CHECK(text.find("test_export_seconds_count 1\n") != std::string::npos);
+}
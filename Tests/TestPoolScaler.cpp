@@ -0,0 +1,89 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Database/PoolScaler.h"
+
+using namespace Database;
+using namespace std::chrono_literals;
+
+static Metrics::HistogramSnapshot MakeWaitTime(std::chrono::microseconds latency, uint32_t count)
+{
+    Metrics::Histogram histogram(Metrics::MICROSECOND_UNIT);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        histogram.Record(latency);
+    }
+
+    return histogram.TakeSnapshot();
+}
+
+TEST_CASE("PoolScaler - Grow on queue depth and wait time")
+{
+    DatabasePoolConfig config;
+    config.growQueueDepth = 4;
+    config.growWaitTime   = 20ms;
+
+    PoolScaler scaler(2, 4, config);
+    const auto now = std::chrono::steady_clock::now();
+
+    // 低于下限时补足
+    CHECK(scaler.Evaluate({1, 0, {}}, now) == ScaleDecision::Grow);
+
+    CHECK(scaler.Evaluate({2, 4, {}}, now) == ScaleDecision::Keep);
+    CHECK(scaler.Evaluate({2, 8, {}}, now) == ScaleDecision::Grow);
+    CHECK(scaler.Evaluate({2, 0, MakeWaitTime(30ms, 10)}, now) == ScaleDecision::Grow);
+
+    // 达到上限后不再扩容
+    CHECK(scaler.Evaluate({4, 100, MakeWaitTime(30ms, 10)}, now) == ScaleDecision::Keep);
+}
+
+TEST_CASE("PoolScaler - Shrink after idle time")
+{
+    DatabasePoolConfig config;
+    config.growWaitTime   = 20ms;
+    config.shrinkIdleTime = 60s;
+
+    PoolScaler scaler(1, 4, config);
+    const auto begin = std::chrono::steady_clock::now();
+
+    CHECK(scaler.Evaluate({3, 0, {}}, begin + 30s) == ScaleDecision::Keep);
+
+    // 仍有负载时重新计时
+    CHECK(scaler.Evaluate({3, 1, {}}, begin + 50s) == ScaleDecision::Keep);
+    CHECK(scaler.Evaluate({3, 0, {}}, begin + 100s) == ScaleDecision::Keep);
+    CHECK(scaler.Evaluate({3, 0, MakeWaitTime(10ms, 10)}, begin + 120s) == ScaleDecision::Keep);
+
+    CHECK(scaler.Evaluate({3, 0, {}}, begin + 180s) == ScaleDecision::Shrink);
+
+    // 每次缩容后重新计时，逐个缩容
+    CHECK(scaler.Evaluate({2, 0, {}}, begin + 200s) == ScaleDecision::Keep);
+    CHECK(scaler.Evaluate({2, 0, {}}, begin + 240s) == ScaleDecision::Shrink);
+
+    // 不低于下限
+    CHECK(scaler.Evaluate({1, 0, {}}, begin + 400s) == ScaleDecision::Keep);
+}
+
+TEST_CASE("PoolScaler - Wait time near the thresholds")
+{
+    DatabasePoolConfig config;
+    config.growWaitTime   = 20ms;
+    config.shrinkIdleTime = 60s;
+
+    // 90%的请求等待指定时长，其余等待更久，p90落在前者所在的桶
+    const auto makeWaitTime = [](std::chrono::microseconds p90) {
+        Metrics::HistogramSnapshot waitTime = MakeWaitTime(p90, 90);
+        waitTime.Merge(MakeWaitTime(50ms, 10));
+        return waitTime;
+    };
+
+    PoolScaler scaler(1, 4, config);
+    const auto begin = std::chrono::steady_clock::now();
+
+    // 扩容阈值为20ms
+    CHECK(scaler.Evaluate({2, 0, makeWaitTime(19ms)}, begin) == ScaleDecision::Keep);
+    CHECK(scaler.Evaluate({2, 0, makeWaitTime(21ms)}, begin) == ScaleDecision::Grow);
+
+    // 等待p90达到扩容阈值的1/4即5ms时视为仍有负载，不缩容
+    CHECK(scaler.Evaluate({2, 0, makeWaitTime(5250us)}, begin + 60s) == ScaleDecision::Keep);
+    CHECK(scaler.Evaluate({2, 0, makeWaitTime(4750us)}, begin + 120s) == ScaleDecision::Shrink);
+}
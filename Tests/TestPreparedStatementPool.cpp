@@ -0,0 +1,175 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Database/PreparedStatement.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+using namespace Database;
+
+// 统计当前线程的堆分配次数，用于验证热路径无分配
+static thread_local std::size_t t_allocCount = 0;
+
+void *operator new(std::size_t size)
+{
+    ++t_allocCount;
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+    {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+static const SqlStmtData g_testStmt("select id from account where email = ? and age > ?",
+                                    {SqlArgType::String, SqlArgType::Uint32},
+                                    MySqlConnectionType::Sync);
+
+TEST_CASE("PreparedStatementPool - SerialValue assigns each slot")
+{
+    PreparedStatementPtr pStmt = PreparedStatementPool::Acquire(1, 2);
+    pStmt->SerialValue(g_testStmt, "123456@qq.com", uint32_t(18));
+
+    const auto &params = pStmt->GetParameters();
+    REQUIRE(params.size() == 2);
+    CHECK(std::get<std::string>(params[0].data) == "123456@qq.com");
+    CHECK(std::get<uint32_t>(params[1].data) == 18);
+}
+
+TEST_CASE("PreparedStatementPool - Reuse released object")
+{
+    PreparedStatementBase *pRaw = nullptr;
+    {
+        PreparedStatementPtr pStmt = PreparedStatementPool::Acquire(1, 2);
+        pRaw                       = pStmt.get();
+    }
+
+    const std::size_t createdCount = PreparedStatementPool::GetCreatedCount();
+
+    PreparedStatementPtr pStmt = PreparedStatementPool::Acquire(3, 1);
+    CHECK(pStmt.get() == pRaw);
+    CHECK(pStmt->GetIndex() == 3);
+    CHECK(pStmt->GetParameters().size() == 1);
+    CHECK(PreparedStatementPool::GetCreatedCount() == createdCount);
+}
+
+TEST_CASE("PreparedStatementPool - Recycled object has no stale parameters")
+{
+    {
+        PreparedStatementPtr pStmt = PreparedStatementPool::Acquire(1, 2);
+        pStmt->SerialValue(g_testStmt, "123456@qq.com", uint32_t(18));
+    }
+
+    // 字符串参数清空但保留类型与容量，其余参数恢复为默认值
+    PreparedStatementPtr pStmt  = PreparedStatementPool::Acquire(1, 2);
+    const auto          &params = pStmt->GetParameters();
+    REQUIRE(params.size() == 2);
+    CHECK(std::get<std::string>(params[0].data).empty());
+    CHECK(params[1].data.index() == PreparedStatementData {}.data.index());
+    CHECK(std::get<bool>(params[1].data) == false);
+}
+
+TEST_CASE("PreparedStatementPool - No heap allocation on hot path")
+{
+    // 超出短字符串优化的长度，回收后仍复用上一个使用者的字符串容量
+    const std::string email(64, 'a');
+    REQUIRE(email.size() > std::string().capacity());
+
+    // 预热，使对象就绪
+    {
+        PreparedStatementPtr pStmt = PreparedStatementPool::Acquire(1, 2);
+        pStmt->SerialValue(g_testStmt, email, uint32_t(1));
+    }
+
+    const std::size_t allocCount = t_allocCount;
+    for (uint32_t i = 0; i < 10000; ++i)
+    {
+        PreparedStatementPtr pStmt = PreparedStatementPool::Acquire(1, 2);
+        pStmt->SerialValue(g_testStmt, email, i);
+    }
+
+    CHECK(t_allocCount == allocCount);
+}
+
+TEST_CASE("PreparedStatementPool - Cross thread stress without leak")
+{
+    constexpr int         THREAD_COUNT  = 4;
+    constexpr uint32_t    LOOP_COUNT    = 20000;
+    constexpr std::size_t MAX_IN_FLIGHT = 256;
+
+    // 生产线程获取对象，消费线程释放，模拟异步请求在数据库线程上归还
+    std::mutex                        mutex;
+    std::vector<PreparedStatementPtr> pending;
+    std::atomic<int>                  producerCount {THREAD_COUNT};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREAD_COUNT; ++i)
+    {
+        threads.emplace_back([&]() {
+            for (uint32_t n = 0; n < LOOP_COUNT; ++n)
+            {
+                PreparedStatementPtr pStmt = PreparedStatementPool::Acquire(1, 2);
+                pStmt->SerialValue(g_testStmt, "123456@qq.com", n);
+
+                while (true)
+                {
+                    std::unique_lock lock(mutex);
+                    if (pending.size() < MAX_IN_FLIGHT)
+                    {
+                        pending.emplace_back(std::move(pStmt));
+                        break;
+                    }
+
+                    lock.unlock();
+                    std::this_thread::yield();
+                }
+            }
+
+            --producerCount;
+        });
+
+        threads.emplace_back([&]() {
+            std::vector<PreparedStatementPtr> stmts;
+            while (true)
+            {
+                const bool bProducing = producerCount > 0;
+                {
+                    std::scoped_lock lock(mutex);
+                    stmts.swap(pending);
+                }
+
+                if (stmts.empty() && !bProducing)
+                {
+                    break;
+                }
+
+                stmts.clear();
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    // 所有对象都应回到池中，创建数量只与同时在途的数量及各线程缓存有关
+    CHECK(PreparedStatementPool::GetFreeCount() == PreparedStatementPool::GetCreatedCount());
+    CHECK(PreparedStatementPool::GetCreatedCount() < 2048);
+}
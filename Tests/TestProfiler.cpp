@@ -0,0 +1,108 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Util/Profiler.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace
+{
+    const Profiler::ProfileScopeStats *FindStats(const std::vector<Profiler::ProfileScopeStats> &stats,
+                                                 std::string_view                                name)
+    {
+        auto iter = std::find_if(stats.begin(), stats.end(), [name](const Profiler::ProfileScopeStats &item) {
+            return item.name == name;
+        });
+        return iter == stats.end() ? nullptr : &*iter;
+    }
+
+    void ProfiledWork()
+    {
+        PROFILE_SCOPE("ProfiledWork");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+} // namespace
+
+TEST_CASE("Profiler - RegisterScope")
+{
+    const uint32_t first  = Profiler::RegisterScope("First", __FILE__, __LINE__);
+    const uint32_t second = Profiler::RegisterScope("Second", __FILE__, __LINE__);
+    CHECK(first != Profiler::INVALID_PROFILE_SCOPE);
+    CHECK(second == first + 1);
+}
+
+TEST_CASE("Profiler - Scope stats")
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        ProfiledWork();
+    }
+
+    std::thread worker([]() {
+        Profiler::SetThreadName("Worker");
+        ProfiledWork();
+    });
+    worker.join();
+
+    const auto  stats  = Profiler::GetScopeStats();
+    const auto *pStats = FindStats(stats, "ProfiledWork");
+    REQUIRE(pStats != nullptr);
+    CHECK(pStats->count == 4);
+    CHECK(pStats->max >= std::chrono::milliseconds(1));
+    CHECK(pStats->total >= pStats->max);
+}
+
+TEST_CASE("Profiler - Disabled")
+{
+    const auto before = FindStats(Profiler::GetScopeStats(), "ProfiledWork")->count;
+
+    Profiler::SetEnabled(false);
+    ProfiledWork();
+    Profiler::SetEnabled(true);
+
+    CHECK(FindStats(Profiler::GetScopeStats(), "ProfiledWork")->count == before);
+}
+
+TEST_CASE("Profiler - Chrome trace")
+{
+    {
+        PROFILE_SCOPE("Trace \"quoted\"");
+    }
+
+    const std::string trace = Profiler::ExportChromeTrace();
+    CHECK(trace.starts_with(R"({"displayTimeUnit":"ms","traceEvents":[)"));
+    CHECK(trace.ends_with("]}"));
+    CHECK(trace.find(R"("name":"ProfiledWork")") != std::string::npos);
+    CHECK(trace.find(R"("name":"Trace \"quoted\"")") != std::string::npos);
+    CHECK(trace.find(R"("args":{"name":"Worker"})") != std::string::npos);
+    CHECK(trace.find(R"("ph":"X")") != std::string::npos);
+}
+
+TEST_CASE("Profiler - Exited thread buffer is reused")
+{
+    auto countThreads = []() {
+        const std::string trace = Profiler::ExportChromeTrace();
+        std::size_t       count = 0;
+        std::size_t       pos   = trace.find("thread_name");
+        while (pos != std::string::npos)
+        {
+            ++count;
+            pos = trace.find("thread_name", pos + 1);
+        }
+        return count;
+    };
+
+    const std::size_t before = countThreads();
+    for (int i = 0; i < 8; ++i)
+    {
+        std::thread worker([]() {
+            ProfiledWork();
+        });
+        worker.join();
+    }
+
+    // 依次退出的线程共用同一个记录区，累计计数仍然保留
+    CHECK(countThreads() <= before + 1);
+    CHECK(FindStats(Profiler::GetScopeStats(), "ProfiledWork")->count >= 12);
+}
@@ -0,0 +1,424 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Database/MySqlTypeHack.h"
+#include "Common/Database/QueryResult.h"
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace Database;
+
+namespace
+{
+    // 内存中的结果集，代替服务器返回的数据，NULL值为空
+    struct FakeResult
+    {
+        std::vector<MYSQL_FIELD>                             fields;
+        std::vector<std::string>                             names;
+        std::vector<std::vector<std::optional<std::string>>> rows;
+        std::size_t                                          position {0};
+        MYSQL_BIND                                          *pBinds {nullptr};
+        std::vector<char *>                                  textRow;     // 文本协议当前行
+        std::vector<unsigned long>                           textLengths; // 文本协议当前行各列长度
+
+        void AddField(std::string name, enum_field_types type, unsigned int flags = 0)
+        {
+            MYSQL_FIELD field {};
+            field.type  = type;
+            field.flags = flags;
+            fields.emplace_back(field);
+            names.emplace_back(std::move(name));
+        }
+
+        void AddRow(std::vector<std::optional<std::string>> row)
+        {
+            for (std::size_t i = 0; i < row.size(); ++i)
+            {
+                if (row[i].has_value())
+                {
+                    fields[i].max_length = (std::max)(fields[i].max_length, row[i]->size());
+                }
+            }
+            rows.emplace_back(std::move(row));
+        }
+
+        // 名称的存储在添加完字段后才固定
+        void BindNames()
+        {
+            for (std::size_t i = 0; i < fields.size(); ++i)
+            {
+                fields[i].name = fields[i].org_name = names[i].data();
+                fields[i].table = fields[i].org_table = const_cast<char *>("account");
+            }
+        }
+
+        MYSQL_STMT *GetStmt()
+        {
+            BindNames();
+            return reinterpret_cast<MYSQL_STMT *>(this);
+        }
+
+        MYSQL_RES *GetResult()
+        {
+            return reinterpret_cast<MYSQL_RES *>(this);
+        }
+
+        MYSQL_FIELD *GetFields()
+        {
+            BindNames();
+            return fields.data();
+        }
+
+        [[nodiscard]] uint32_t GetFieldCount() const
+        {
+            return static_cast<uint32_t>(fields.size());
+        }
+    };
+
+    FakeResult &FromStmt(MYSQL_STMT *pStmt)
+    {
+        return *reinterpret_cast<FakeResult *>(pStmt);
+    }
+
+    template <typename T>
+    std::optional<std::string> Bytes(T value)
+    {
+        return std::string(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+} // namespace
+
+// 以下函数替换libmysql中的同名函数，按FakeResult的数据模拟文本与二进制协议，测试不需要连接MySql
+extern "C"
+{
+    MYSQL_ROW STDCALL mysql_fetch_row(MYSQL_RES *pResult)
+    {
+        FakeResult &fake = *reinterpret_cast<FakeResult *>(pResult);
+        if (fake.position >= fake.rows.size())
+        {
+            return nullptr;
+        }
+
+        auto &row = fake.rows[fake.position++];
+        fake.textRow.assign(row.size(), nullptr);
+        fake.textLengths.assign(row.size(), 0);
+        for (std::size_t i = 0; i < row.size(); ++i)
+        {
+            if (row[i].has_value())
+            {
+                fake.textRow[i]     = row[i]->data();
+                fake.textLengths[i] = row[i]->size();
+            }
+        }
+        return fake.textRow.data();
+    }
+
+    unsigned long *STDCALL mysql_fetch_lengths(MYSQL_RES *pResult)
+    {
+        return reinterpret_cast<FakeResult *>(pResult)->textLengths.data();
+    }
+
+    MYSQL_FIELD *STDCALL mysql_fetch_fields(MYSQL_RES *pResult)
+    {
+        return reinterpret_cast<FakeResult *>(pResult)->fields.data();
+    }
+
+    // 释放后元数据中的名称不再有效，覆盖其内容使仍引用它们的结果集读到错误的值
+    void STDCALL mysql_free_result(MYSQL_RES *pResult)
+    {
+        for (std::string &name : reinterpret_cast<FakeResult *>(pResult)->names)
+        {
+            std::ranges::fill(name, '#');
+        }
+    }
+
+    int STDCALL mysql_stmt_store_result(MYSQL_STMT *)
+    {
+        return 0;
+    }
+
+    uint64_t STDCALL mysql_stmt_num_rows(MYSQL_STMT *pStmt)
+    {
+        return FromStmt(pStmt).rows.size();
+    }
+
+    bool STDCALL mysql_stmt_free_result(MYSQL_STMT *)
+    {
+        return false;
+    }
+
+    bool STDCALL mysql_stmt_bind_result(MYSQL_STMT *pStmt, MYSQL_BIND *pBinds)
+    {
+        FromStmt(pStmt).pBinds = pBinds;
+        return false;
+    }
+
+    unsigned int STDCALL mysql_stmt_errno(MYSQL_STMT *)
+    {
+        return 0;
+    }
+
+    const char *STDCALL mysql_stmt_error(MYSQL_STMT *)
+    {
+        return "";
+    }
+
+    int STDCALL mysql_stmt_fetch(MYSQL_STMT *pStmt)
+    {
+        FakeResult &fake = FromStmt(pStmt);
+        if (fake.position >= fake.rows.size())
+        {
+            return MYSQL_NO_DATA;
+        }
+
+        int         ret = 0;
+        const auto &row = fake.rows[fake.position++];
+        for (std::size_t i = 0; i < row.size(); ++i)
+        {
+            MYSQL_BIND &bind = fake.pBinds[i];
+            *bind.is_null    = !row[i].has_value();
+            if (!row[i].has_value())
+            {
+                continue;
+            }
+
+            *bind.length = row[i]->size();
+            std::memcpy(bind.buffer, row[i]->data(), (std::min)(row[i]->size(), bind.buffer_length));
+            if (row[i]->size() > bind.buffer_length)
+            {
+                ret = MYSQL_DATA_TRUNCATED;
+            }
+        }
+        return ret;
+    }
+
+    int STDCALL mysql_stmt_fetch_column(MYSQL_STMT   *pStmt,
+                                        MYSQL_BIND   *pBind,
+                                        unsigned int  column,
+                                        unsigned long offset)
+    {
+        const FakeResult  &fake  = FromStmt(pStmt);
+        const std::string &value = *fake.rows[fake.position - 1][column];
+        const std::size_t  size  = (std::min)(value.size() - offset, pBind->buffer_length);
+        std::memcpy(pBind->buffer, value.data() + offset, size);
+        *pBind->length = value.size();
+        return 0;
+    }
+}
+
+TEST_CASE("PreparedQueryResultSet - Column-wise storage")
+{
+    FakeResult fake;
+    fake.AddField("id", MYSQL_TYPE_LONG, UNSIGNED_FLAG);
+    fake.AddField("email", MYSQL_TYPE_VAR_STRING);
+    fake.AddField("balance", MYSQL_TYPE_LONGLONG);
+    fake.AddRow({Bytes<uint32_t>(1), "a@qq.com", Bytes<int64_t>(-5)});
+    fake.AddRow({Bytes<uint32_t>(2), std::nullopt, Bytes<int64_t>(100)});
+    fake.AddRow({Bytes<uint32_t>(3), "long.name@example.com", std::nullopt});
+
+    PreparedQueryResultSet result(fake.GetStmt(), fake.GetResult(), 0, fake.GetFieldCount());
+    REQUIRE(result.GetRowCount() == 3);
+    REQUIRE(result.GetFieldCount() == 3);
+
+    // 定长列连续存放，NULL值对应位置为0
+    const std::span<const uint32_t> ids = result.GetColumn<uint32_t>(0);
+    REQUIRE(ids.size() == 3);
+    CHECK(ids[0] == 1);
+    CHECK(ids[1] == 2);
+    CHECK(ids[2] == 3);
+
+    const std::span<const int64_t> balances = result.GetColumn<int64_t>(2);
+    CHECK(balances[0] == -5);
+    CHECK(balances[1] == 100);
+    CHECK(balances[2] == 0);
+
+    // 变长列按偏移读取
+    CHECK(result.GetColumnString(0, 1) == "a@qq.com");
+    CHECK(result.GetColumnString(1, 1).empty());
+    CHECK(result.GetColumnString(2, 1) == "long.name@example.com");
+
+    CHECK_FALSE(result.IsNull(0, 1));
+    CHECK(result.IsNull(1, 1));
+    CHECK(result.IsNull(2, 2));
+    CHECK_FALSE(result.IsNull(2, 0));
+}
+
+TEST_CASE("PreparedQueryResultSet - Row cursor over columns")
+{
+    FakeResult fake;
+    fake.AddField("id", MYSQL_TYPE_LONG, UNSIGNED_FLAG);
+    fake.AddField("email", MYSQL_TYPE_VAR_STRING);
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        fake.AddRow({Bytes<uint32_t>(i), std::string(i % 7, 'x')});
+    }
+
+    PreparedQueryResultSet result(fake.GetStmt(), fake.GetResult(), 0, fake.GetFieldCount());
+    REQUIRE(result.GetRowCount() == 100);
+
+    // 当前行的Field指向列存储，逐行移动
+    uint32_t rowIndex = 0;
+    do
+    {
+        Field   *pRow = result.Fetch();
+        uint32_t id   = pRow[0];
+        CHECK(id == rowIndex);
+        CHECK(pRow[1].GetStringView() == std::string(rowIndex % 7, 'x'));
+        ++rowIndex;
+    } while (result.NextRow());
+
+    CHECK(rowIndex == 100);
+}
+
+TEST_CASE("PreparedQueryResultSet - Streamed batch outlives the stream")
+{
+    FakeResult fake;
+    fake.AddField("id", MYSQL_TYPE_LONG, UNSIGNED_FLAG);
+    fake.AddField("email", MYSQL_TYPE_VAR_STRING);
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        // 超过流式模式的默认绑定大小，单独拉取整列
+        fake.AddRow({Bytes<uint32_t>(i), std::string(300 + i, static_cast<char>('a' + i))});
+    }
+
+    // 流式模式下服务器不返回max_length
+    for (MYSQL_FIELD &field : fake.fields)
+    {
+        field.max_length = 0;
+    }
+
+    // 与IMySqlConnection::StreamQuery相同：逐批拉取，结束后释放元数据，回调保留了所有批
+    constexpr uint32_t                     batchSize = 2;
+    std::vector<PreparedQueryResultSetPtr> batches;
+    while (true)
+    {
+        PreparedQueryResultSetPtr pBatch = MakePreparedQueryResultSetPtr(
+            fake.GetStmt(), fake.GetResult(), batchSize, fake.GetFieldCount(), true);
+        const uint64_t fetchedCount = pBatch->GetRowCount();
+        if (fetchedCount > 0)
+        {
+            batches.emplace_back(std::move(pBatch));
+        }
+
+        if (fetchedCount < batchSize)
+        {
+            break;
+        }
+    }
+    mysql_free_result(fake.GetResult());
+
+    REQUIRE(batches.size() == 3);
+    CHECK(batches[2]->GetRowCount() == 1);
+    CHECK(batches[0]->GetFieldMetadata(0).name == "id");
+    CHECK(batches[2]->GetFieldMetadata(1).alias == "email");
+    CHECK(batches[2]->GetFieldMetadata(1).tableName == "account");
+
+    uint32_t expectedID = 0;
+    for (const PreparedQueryResultSetPtr &pBatch : batches)
+    {
+        do
+        {
+            Field   *pRow = pBatch->Fetch();
+            uint32_t id   = pRow[0];
+            CHECK(id == expectedID);
+            CHECK(pRow[1].GetStringView() == std::string(300 + id, static_cast<char>('a' + id)));
+            ++expectedID;
+        } while (pBatch->NextRow());
+    }
+    CHECK(expectedID == 5);
+}
+
+TEST_CASE("PreparedQueryResultSet - Empty result")
+{
+    FakeResult fake;
+    fake.AddField("id", MYSQL_TYPE_LONG, UNSIGNED_FLAG);
+
+    PreparedQueryResultSet result(fake.GetStmt(), fake.GetResult(), 0, fake.GetFieldCount());
+    CHECK(result.GetRowCount() == 0);
+    CHECK(result.GetColumn<uint32_t>(0).empty());
+    CHECK_FALSE(result.NextRow());
+}
+
+TEST_CASE("QueryResultSet - Text protocol decoding")
+{
+    FakeResult fake;
+    fake.AddField("id", MYSQL_TYPE_LONG, UNSIGNED_FLAG);
+    fake.AddField("balance", MYSQL_TYPE_LONGLONG);
+    fake.AddField("email", MYSQL_TYPE_VAR_STRING);
+    fake.AddField("price", MYSQL_TYPE_NEWDECIMAL);
+    fake.AddRow({"42", "-7", "a@qq.com", "12.30"});
+    fake.AddRow({"4294967295", std::nullopt, std::nullopt, std::nullopt});
+
+    QueryResultSet result(fake.GetResult(), fake.GetFields(), fake.rows.size(), fake.GetFieldCount());
+    REQUIRE(result.NextRow());
+
+    // 数值列在拉取时解析为本机字节，按列类型读取与二进制协议相同
+    Field   *pRow    = result.Fetch();
+    uint32_t id      = pRow[0];
+    int64_t  balance = pRow[1];
+    CHECK(id == 42);
+    CHECK(balance == -7);
+
+    // 更宽的类型经转换读取
+    uint64_t wideID = pRow[0];
+    CHECK(wideID == 42);
+
+    // 字符串与定点数列直接引用行数据，不拷贝
+    const std::string_view email = pRow[2].GetStringView();
+    CHECK(email == "a@qq.com");
+    CHECK(email.data() == fake.rows[0][2]->data());
+    CHECK(pRow[3].GetStringView() == "12.30");
+    CHECK(pRow[2].GetBinary().size() == email.size());
+
+    // 下一行覆盖解析结果，NULL的数值为0，字符串为空
+    REQUIRE(result.NextRow());
+    pRow = result.Fetch();
+    id   = pRow[0];
+    CHECK(id == 4294967295u);
+    balance = pRow[1];
+    CHECK(balance == 0);
+    CHECK(pRow[2].GetStringView().data() == nullptr);
+    CHECK(pRow[3].GetStringView().empty());
+    CHECK(pRow[2].GetBinary().empty());
+
+    CHECK_FALSE(result.NextRow());
+}
+
+TEST_CASE("PreparedQueryResultSet - Field getters")
+{
+    FakeResult fake;
+    fake.AddField("id", MYSQL_TYPE_LONG, UNSIGNED_FLAG);
+    fake.AddField("data", MYSQL_TYPE_BLOB, BINARY_FLAG);
+    fake.AddRow({Bytes<uint32_t>(7), std::string("\x01\x00\x02", 3)});
+    fake.AddRow({std::nullopt, std::nullopt});
+
+    PreparedQueryResultSet result(fake.GetStmt(), fake.GetResult(), 0, fake.GetFieldCount());
+    REQUIRE(result.GetRowCount() == 2);
+
+    // 类型一致时直接读取，更宽的类型经转换读取
+    Field   *pRow   = result.Fetch();
+    uint32_t id     = pRow[0];
+    uint64_t wideID = pRow[0];
+    int64_t  signID = pRow[0];
+    CHECK(id == 7);
+    CHECK(wideID == 7);
+    CHECK(signID == 7);
+
+    // 二进制内容含0字节，按长度读取
+    const std::span<const std::byte> data = pRow[1].GetBinary();
+    REQUIRE(data.size() == 3);
+    CHECK(data[0] == std::byte {1});
+    CHECK(data[1] == std::byte {0});
+    CHECK(data[2] == std::byte {2});
+    CHECK(pRow[1].GetStringView().size() == 3);
+
+    REQUIRE(result.NextRow());
+    pRow = result.Fetch();
+    id   = pRow[0];
+    CHECK(id == 0);
+    CHECK(pRow[1].GetBinary().empty());
+    CHECK(pRow[1].GetStringView().empty());
+}
@@ -0,0 +1,146 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Database/PreparedStatement.h"
+#include "Common/Database/QueryResult.h"
+#include "Common/Database/QueryResultCache.h"
+
+#include <thread>
+
+using namespace Database;
+using namespace std::chrono_literals;
+
+enum TestStmtID : uint32_t
+{
+    TEST_SEL_ACCOUNT,
+    TEST_SEL_REALM,
+    TEST_UPD_ACCOUNT,
+};
+
+static PreparedStatementPtr MakeStmt(uint32_t stmtID, std::string_view email)
+{
+    PreparedStatementPtr pStmt = PreparedStatementPool::Acquire(stmtID, 1);
+    pStmt->SetValue(0, SqlArgType::String, email);
+    return pStmt;
+}
+
+// 不关联MySql的空结果集，只用于验证缓存命中的是同一个快照
+static PreparedQueryResultSnapshot MakeResult()
+{
+    return std::make_shared<PreparedQueryResultSet>(nullptr, nullptr, 0, 0);
+}
+
+TEST_CASE("QueryResultCache - Hit and miss")
+{
+    QueryResultCache cache;
+    cache.EnableStatement(TEST_SEL_ACCOUNT, 10s);
+
+    PreparedStatementPtr pStmt      = MakeStmt(TEST_SEL_ACCOUNT, "a@qq.com");
+    uint64_t             generation = 0;
+    CHECK(cache.Get(pStmt.get(), generation) == nullptr);
+
+    PreparedQueryResultSnapshot pResult = MakeResult();
+    cache.Put(pStmt.get(), generation, pResult);
+    CHECK(cache.Get(pStmt.get(), generation) == pResult);
+
+    // 参数不同不能命中
+    PreparedStatementPtr pOther = MakeStmt(TEST_SEL_ACCOUNT, "b@qq.com");
+    CHECK(cache.Get(pOther.get(), generation) == nullptr);
+
+    // 未开启缓存的语句既不写入也不统计
+    PreparedStatementPtr pRealm = MakeStmt(TEST_SEL_REALM, "a@qq.com");
+    cache.Put(pRealm.get(), generation, MakeResult());
+    CHECK(cache.Get(pRealm.get(), generation) == nullptr);
+
+    QueryCacheStats stats = cache.GetStats();
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 2);
+    CHECK(stats.size == 1);
+}
+
+TEST_CASE("QueryResultCache - TTL expiration")
+{
+    QueryResultCache cache;
+    cache.EnableStatement(TEST_SEL_ACCOUNT, 20ms);
+
+    PreparedStatementPtr pStmt      = MakeStmt(TEST_SEL_ACCOUNT, "a@qq.com");
+    uint64_t             generation = 0;
+    cache.Get(pStmt.get(), generation);
+    cache.Put(pStmt.get(), generation, MakeResult());
+    CHECK(cache.Get(pStmt.get(), generation) != nullptr);
+
+    std::this_thread::sleep_for(50ms);
+    CHECK(cache.Get(pStmt.get(), generation) == nullptr);
+    CHECK(cache.GetStats().expirations == 1);
+    CHECK(cache.GetStats().size == 0);
+}
+
+TEST_CASE("QueryResultCache - LRU eviction")
+{
+    QueryResultCache cache(2);
+    cache.EnableStatement(TEST_SEL_ACCOUNT, 10s);
+
+    PreparedStatementPtr pStmt1     = MakeStmt(TEST_SEL_ACCOUNT, "1@qq.com");
+    PreparedStatementPtr pStmt2     = MakeStmt(TEST_SEL_ACCOUNT, "2@qq.com");
+    PreparedStatementPtr pStmt3     = MakeStmt(TEST_SEL_ACCOUNT, "3@qq.com");
+    uint64_t             generation = 0;
+    cache.Get(pStmt1.get(), generation);
+
+    cache.Put(pStmt1.get(), generation, MakeResult());
+    cache.Put(pStmt2.get(), generation, MakeResult());
+
+    // 访问1之后，2成为最久未使用的条目
+    CHECK(cache.Get(pStmt1.get(), generation) != nullptr);
+    cache.Put(pStmt3.get(), generation, MakeResult());
+
+    CHECK(cache.Get(pStmt1.get(), generation) != nullptr);
+    CHECK(cache.Get(pStmt2.get(), generation) == nullptr);
+    CHECK(cache.Get(pStmt3.get(), generation) != nullptr);
+    CHECK(cache.GetStats().evictions == 1);
+}
+
+TEST_CASE("QueryResultCache - Invalidation by write statement")
+{
+    QueryResultCache cache;
+    cache.EnableStatement(TEST_SEL_ACCOUNT, 10s);
+    cache.AddInvalidation(TEST_UPD_ACCOUNT, TEST_SEL_ACCOUNT);
+    CHECK(cache.HasInvalidation(TEST_UPD_ACCOUNT));
+    CHECK_FALSE(cache.HasInvalidation(TEST_SEL_ACCOUNT));
+
+    PreparedStatementPtr pStmt      = MakeStmt(TEST_SEL_ACCOUNT, "a@qq.com");
+    uint64_t             generation = 0;
+    cache.Get(pStmt.get(), generation);
+    cache.Put(pStmt.get(), generation, MakeResult());
+
+    cache.OnExecute(TEST_UPD_ACCOUNT);
+    uint64_t newGeneration = 0;
+    CHECK(cache.Get(pStmt.get(), newGeneration) == nullptr);
+    CHECK(newGeneration != generation);
+
+    // 查询期间发生失效，旧版本号的结果不能写入
+    cache.Put(pStmt.get(), generation, MakeResult());
+    CHECK(cache.Get(pStmt.get(), newGeneration) == nullptr);
+
+    cache.Put(pStmt.get(), newGeneration, MakeResult());
+    CHECK(cache.Get(pStmt.get(), newGeneration) != nullptr);
+    CHECK(cache.GetStats().invalidations == 1);
+}
+
+TEST_CASE("QueryResultCache - Shared result has its own cursor")
+{
+    PreparedQueryResultSnapshot pResult = MakeResult();
+
+    // 每个读者得到独立的结果集对象，共享同一份数据，共享者再次共享时引用的仍是数据的持有者
+    auto pFirst  = std::make_shared<PreparedQueryResultSet>(pResult);
+    auto pSecond = std::make_shared<PreparedQueryResultSet>(pFirst);
+    CHECK(pFirst.get() != pResult.get());
+    CHECK(pSecond.get() != pFirst.get());
+    CHECK(pSecond->GetRowCount() == pResult->GetRowCount());
+    CHECK(pSecond->GetFieldCount() == pResult->GetFieldCount());
+    CHECK(pResult.use_count() == 3);
+
+    CHECK_FALSE(pFirst->NextRow());
+    pFirst.reset();
+    pSecond.reset();
+    CHECK(pResult.use_count() == 1);
+}
@@ -0,0 +1,103 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Database/ReplicaBalancer.h"
+
+#include <thread>
+#include <vector>
+
+using namespace Database;
+using namespace std::chrono_literals;
+
+TEST_CASE("ReplicaBalancer - Select lowest latency")
+{
+    ReplicaBalancer balancer(5s);
+    const std::size_t first  = balancer.AddReplica();
+    const std::size_t second = balancer.AddReplica();
+
+    // 未探测到复制延迟之前不可用
+    CHECK_FALSE(balancer.SelectReplica().has_value());
+
+    balancer.UpdateLag(first, 0s);
+    balancer.UpdateLag(second, 1s);
+    balancer.RecordLatency(first, 2ms);
+    balancer.RecordLatency(second, 1ms);
+    CHECK(balancer.SelectReplica() == second);
+
+    // 平滑后单次慢查询不会立即切换
+    balancer.RecordLatency(second, 4ms);
+    CHECK(balancer.SelectReplica() == second);
+
+    for (int i = 0; i < 32; ++i)
+    {
+        balancer.RecordLatency(second, 4ms);
+    }
+
+    CHECK(balancer.SelectReplica() == first);
+
+    const std::vector<ReplicaStats> stats = balancer.GetStats();
+    REQUIRE(stats.size() == 2);
+    CHECK(stats[first].selectCount == 1);
+    CHECK(stats[second].selectCount == 2);
+    CHECK(stats[second].lag == 1s);
+}
+
+TEST_CASE("ReplicaBalancer - Fall back to primary on lag")
+{
+    ReplicaBalancer balancer(5s);
+    const std::size_t first  = balancer.AddReplica();
+    const std::size_t second = balancer.AddReplica();
+
+    balancer.UpdateLag(first, 0s);
+    balancer.UpdateLag(second, 0s);
+    balancer.RecordLatency(first, 1ms);
+    balancer.RecordLatency(second, 3ms);
+    CHECK(balancer.SelectReplica() == first);
+
+    // 延迟超限的从库不再选择
+    balancer.UpdateLag(first, 10s);
+    CHECK(balancer.SelectReplica() == second);
+
+    // 复制中断
+    balancer.UpdateLag(second, std::nullopt);
+    CHECK_FALSE(balancer.SelectReplica().has_value());
+    CHECK_FALSE(balancer.GetStats()[second].lag.has_value());
+
+    balancer.SetMaxLag(10s);
+    CHECK(balancer.SelectReplica() == first);
+}
+
+TEST_CASE("ReadSession - Sticky after write")
+{
+    ReadSession session;
+    CHECK_FALSE(session.IsSticky(DEFAULT_STICKY_WINDOW));
+
+    session.OnWrite();
+    CHECK(session.IsSticky(DEFAULT_STICKY_WINDOW));
+
+    std::this_thread::sleep_for(20ms);
+    CHECK_FALSE(session.IsSticky(10ms));
+}
+
+TEST_CASE("ParseReplicaLag - Status row")
+{
+    std::optional<std::chrono::seconds> lag;
+
+    // 8.0.22起的列名
+    const std::vector<std::string_view>                names {"Replica_IO_State", "Seconds_Behind_Source"};
+    const std::vector<std::optional<std::string_view>> values {"Waiting for source", "3"};
+    CHECK(ParseReplicaLag(names, values, lag));
+    CHECK(lag == 3s);
+
+    // 旧版本的列名，复制线程未运行时为NULL
+    const std::vector<std::string_view>                legacyNames {"Seconds_Behind_Master"};
+    const std::vector<std::optional<std::string_view>> nullValues {std::nullopt};
+    CHECK(ParseReplicaLag(legacyNames, nullValues, lag));
+    CHECK_FALSE(lag.has_value());
+
+    // 没有延迟列时不能当作复制中断
+    const std::vector<std::string_view>                otherNames {"Replica_IO_State", "Last_Error"};
+    const std::vector<std::optional<std::string_view>> otherValues {"Waiting for source", ""};
+    CHECK_FALSE(ParseReplicaLag(otherNames, otherValues, lag));
+    CHECK_FALSE(lag.has_value());
+}
@@ -0,0 +1,47 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Database/DatabaseEnv.h"
+#include "Common/Database/SqlPipeline.h"
+
+#include <string>
+#include <vector>
+
+using namespace Database;
+
+TEST_CASE("SqlPipeline - Multi-statement sql is not pipelined")
+{
+    CHECK(IsPipelineSql("update account set age = 1 where id = 1"));
+    CHECK(IsPipelineSql("update account set age = 1 where id = 1; \r\n"));
+    CHECK_FALSE(IsPipelineSql("update account set age = 1; drop table account"));
+    CHECK_FALSE(IsPipelineSql("insert into account values ('a;b')"));
+
+    // 不能合并的语句截断合并范围，开头即不能合并时逐条执行
+    const std::vector<std::string> sqls {"delete from a",
+                                         "delete from b",
+                                         "delete from c; delete from d",
+                                         "delete from e"};
+    CHECK(CountPipelineSql(sqls) == 2);
+    CHECK(CountPipelineSql(std::span(sqls).subspan(2)) == 0);
+    CHECK(CountPipelineSql(std::span(sqls).subspan(3)) == 1);
+}
+
+TEST_CASE("SqlPipeline - Count and byte limits")
+{
+    const std::vector<std::string> sqls(MAX_SQL_PIPELINE_SIZE + 10, "delete from account where id = 1");
+    CHECK(CountPipelineSql(sqls) == MAX_SQL_PIPELINE_SIZE);
+
+    // 超过字节上限的语句单独成批，不会一直无法执行
+    const std::vector<std::string> largeSqls(3, std::string(MAX_SQL_PIPELINE_BYTES / 2, 'x'));
+    CHECK(CountPipelineSql(largeSqls) == 1);
+
+    const std::vector<std::string> hugeSqls(2, std::string(MAX_SQL_PIPELINE_BYTES + 1, 'x'));
+    CHECK(CountPipelineSql(hugeSqls) == 1);
+}
+
+TEST_CASE("SqlPipeline - Build request")
+{
+    const std::vector<std::string> sqls {"delete from a;", "delete from b ;\n", "delete from c"};
+    CHECK(BuildPipelineSql(sqls) == "delete from a;delete from b;delete from c;");
+    CHECK(BuildPipelineSql({}).empty());
+}
@@ -0,0 +1,49 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Database/StatementMetrics.h"
+
+using namespace Database;
+using namespace std::chrono_literals;
+
+TEST_CASE("StatementMetrics - Record per statement")
+{
+    StatementMetrics metrics(4);
+    metrics.RecordExecute(1, 3ms);
+    metrics.RecordExecute(1, 100us);
+    metrics.RecordDecode(1, 50us);
+    metrics.RecordQueueWait(3, 1ms);
+
+    // 越界的索引直接忽略
+    metrics.RecordExecute(4, 1ms);
+
+    std::vector<StatementLatencySnapshot> snapshots;
+    metrics.MergeInto(snapshots);
+    REQUIRE(snapshots.size() == 2);
+    CHECK(snapshots[0].index == 1);
+    CHECK(snapshots[0].execute.count == 2);
+    CHECK(snapshots[0].decode.count == 1);
+    CHECK(snapshots[0].queueWait.count == 0);
+    CHECK(snapshots[0].execute.GetPercentile(50) == 100);
+    CHECK(snapshots[0].execute.GetPercentile(100) == 3000);
+    CHECK(snapshots[1].index == 3);
+    CHECK(snapshots[1].queueWait.count == 1);
+}
+
+TEST_CASE("StatementMetrics - Merge connections")
+{
+    StatementMetrics first(3);
+    StatementMetrics second(3);
+    first.RecordExecute(2, 1ms);
+    second.RecordExecute(0, 1ms);
+    second.RecordExecute(2, 1ms);
+
+    std::vector<StatementLatencySnapshot> snapshots;
+    first.MergeInto(snapshots);
+    second.MergeInto(snapshots);
+    REQUIRE(snapshots.size() == 2);
+    CHECK(snapshots[0].index == 0);
+    CHECK(snapshots[0].execute.count == 1);
+    CHECK(snapshots[1].index == 2);
+    CHECK(snapshots[1].execute.count == 2);
+}
@@ -0,0 +1,255 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Util/StringUtil.h"
+
+#include <charconv>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Util;
+
+namespace
+{
+    // 逐字节的参考实现，覆盖各种长度与对齐时与快速实现逐一比较
+    bool ReferenceEqualIgnoreCase(std::string_view left, std::string_view right)
+    {
+        if (left.length() != right.length())
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < left.length(); ++i)
+        {
+            if (ToLowerAscii(left[i]) != ToLowerAscii(right[i]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    template <typename T>
+    std::optional<T> ReferenceParse(std::string_view str)
+    {
+        T value {};
+        auto [ptr, errc] = std::from_chars(str.data(), str.data() + str.length(), value);
+        if (errc == std::errc {} && ptr == str.data() + str.length())
+        {
+            return value;
+        }
+
+        return std::nullopt;
+    }
+
+    template <typename T>
+    void CheckParse(std::string_view str)
+    {
+        INFO(str);
+        CHECK(ParseDecimal<T>(str) == ReferenceParse<T>(str));
+    }
+
+    std::string RandomString(std::mt19937 &rng, size_t length, std::string_view alphabet)
+    {
+        std::string str(length, ' ');
+        for (char &chr : str)
+        {
+            chr = alphabet[rng() % alphabet.length()];
+        }
+
+        return str;
+    }
+} // namespace
+
+TEST_CASE("ToLowerAscii")
+{
+    CHECK(ToLowerAscii('A') == 'a');
+    CHECK(ToLowerAscii('Z') == 'z');
+    CHECK(ToLowerAscii('a') == 'a');
+    CHECK(ToLowerAscii('@') == '@');
+    CHECK(ToLowerAscii('[') == '[');
+    CHECK(ToLowerAscii('\xC1') == '\xC1');
+}
+
+TEST_CASE("EqualIgnoreCaseAscii")
+{
+    CHECK(EqualIgnoreCaseAscii("", ""));
+    CHECK(EqualIgnoreCaseAscii("Content-Length", "content-length"));
+    CHECK(EqualIgnoreCaseAscii("UPGRADE-INSECURE-REQUESTS", "upgrade-insecure-requests"));
+    CHECK_FALSE(EqualIgnoreCaseAscii("Content-Length", "Content-Lengt"));
+    CHECK_FALSE(EqualIgnoreCaseAscii("Content-Length", "Content_Length"));
+    // 只有字母忽略大小写，'@'与'`'、'['与'{'只差0x20但不相等
+    CHECK_FALSE(EqualIgnoreCaseAscii("@[\\]^", "`{|}~"));
+    // 非ASCII字节原样比较
+    CHECK_FALSE(EqualIgnoreCaseAscii("\xC1\xC1\xC1\xC1\xC1\xC1\xC1\xC1", "\xE1\xE1\xE1\xE1\xE1\xE1\xE1\xE1"));
+
+    std::mt19937 rng(42);
+    for (size_t length = 0; length <= 70; ++length)
+    {
+        for (int round = 0; round < 50; ++round)
+        {
+            const std::string left  = RandomString(rng, length, "aAbBzZ@`[{-\x80\xFF");
+            std::string       right = left;
+            for (char &chr : right)
+            {
+                if (rng() % 2 == 0 && chr >= 'a' && chr <= 'z')
+                {
+                    chr = static_cast<char>(chr - 0x20);
+                }
+            }
+
+            if (length > 0 && rng() % 2 == 0)
+            {
+                right[rng() % length] = "aAbBzZ@`[{-\x80\xFF"[rng() % 13];
+            }
+
+            INFO(length);
+            CHECK(EqualIgnoreCaseAscii(left, right) == ReferenceEqualIgnoreCase(left, right));
+            if (EqualIgnoreCaseAscii(left, right))
+            {
+                CHECK(HashIgnoreCaseAscii(left) == HashIgnoreCaseAscii(right));
+            }
+        }
+    }
+}
+
+TEST_CASE("HashIgnoreCaseAscii")
+{
+    CHECK(HashIgnoreCaseAscii("Content-Type") == HashIgnoreCaseAscii("content-type"));
+    CHECK(HashIgnoreCaseAscii("Host") != HashIgnoreCaseAscii("Hosts"));
+    CHECK(HashIgnoreCaseAscii("a") != HashIgnoreCaseAscii(std::string_view("a\0", 2)));
+    CHECK(IgnoreCaseAsciiHash {}("ETag") == IgnoreCaseAsciiHash {}("etag"));
+    CHECK(IgnoreCaseAsciiEqual {}("ETag", "etag"));
+}
+
+TEST_CASE("FindFirstOf")
+{
+    CHECK(FindFirstOf("", '=', '&') == std::string_view::npos);
+    CHECK(FindFirstOf("a=1&b=2", '=', '&') == 1);
+    CHECK(FindFirstOf("a=1&b=2", '=', '&', 2) == 3);
+    CHECK(FindFirstOf("a=1&b=2", '=', '&', 6) == std::string_view::npos);
+    CHECK(FindFirstOf("a=1", '=', '&', 10) == std::string_view::npos);
+
+    std::mt19937 rng(7);
+    for (size_t length = 0; length <= 70; ++length)
+    {
+        for (int round = 0; round < 20; ++round)
+        {
+            const std::string str = RandomString(rng, length, "abcdefghijklmnopqrstuvwxyz=&");
+            for (size_t pos = 0; pos <= length; ++pos)
+            {
+                CHECK(FindFirstOf(str, '=', '&', pos) == std::string_view(str).find_first_of("=&", pos));
+            }
+        }
+    }
+}
+
+TEST_CASE("FindFirstNotOf/FindLastNotOf/TrimSpace")
+{
+    CHECK(FindFirstNotOf("", ' ') == std::string_view::npos);
+    CHECK(FindLastNotOf("", ' ') == std::string_view::npos);
+    CHECK(TrimSpace("").empty());
+    CHECK(TrimSpace("    ").empty());
+    CHECK(TrimSpace("  key ") == "key");
+    CHECK(TrimSpace("key") == "key");
+    CHECK(TrimSpace(" a b ") == "a b");
+
+    std::mt19937 rng(11);
+    for (size_t length = 0; length <= 70; ++length)
+    {
+        for (int round = 0; round < 50; ++round)
+        {
+            // 大部分为空格，非空格字符出现在随机位置
+            const std::string      str  = RandomString(rng, length, "        x");
+            const std::string_view view = str;
+            INFO(str);
+            CHECK(FindFirstNotOf(view, ' ') == view.find_first_not_of(' '));
+            CHECK(FindLastNotOf(view, ' ') == view.find_last_not_of(' '));
+
+            const size_t     begin    = view.find_first_not_of(' ');
+            std::string_view expected = begin == std::string_view::npos
+                                            ? std::string_view {}
+                                            : view.substr(begin, view.find_last_not_of(' ') - begin + 1);
+            CHECK(TrimSpace(view) == expected);
+        }
+    }
+}
+
+TEST_CASE("ParseDecimal")
+{
+    CHECK(ParseDecimal<int>("0") == 0);
+    CHECK(ParseDecimal<int>("123") == 123);
+    CHECK(ParseDecimal<int>("-123") == -123);
+    CHECK(ParseDecimal<uint64_t>("18446744073709551615") == UINT64_MAX);
+    CHECK(ParseDecimal<int64_t>("-9223372036854775808") == INT64_MIN);
+    CHECK(ParseDecimal<int64_t>("0000000000000000000000000042") == 42);
+    CHECK(ParseDecimal<int32_t>("-000000000000000000000000") == 0);
+
+    CHECK_FALSE(ParseDecimal<int>("").has_value());
+    CHECK_FALSE(ParseDecimal<int>("-").has_value());
+    CHECK_FALSE(ParseDecimal<int>("+1").has_value());
+    CHECK_FALSE(ParseDecimal<int>(" 1").has_value());
+    CHECK_FALSE(ParseDecimal<int>("1 ").has_value());
+    CHECK_FALSE(ParseDecimal<int>("12345678a").has_value());
+    CHECK_FALSE(ParseDecimal<unsigned>("-1").has_value());
+    CHECK_FALSE(ParseDecimal<uint8_t>("256").has_value());
+    CHECK_FALSE(ParseDecimal<int8_t>("-129").has_value());
+    CHECK_FALSE(ParseDecimal<uint64_t>("18446744073709551616").has_value());
+    CHECK_FALSE(ParseDecimal<int64_t>("9223372036854775808").has_value());
+    CHECK_FALSE(ParseDecimal<int64_t>("99999999999999999999").has_value());
+
+    const std::vector<std::string> edges = {"127",
+                                            "128",
+                                            "-128",
+                                            "255",
+                                            "32767",
+                                            "-32769",
+                                            "65535",
+                                            "2147483647",
+                                            "-2147483648",
+                                            "2147483648",
+                                            "4294967295",
+                                            "4294967296",
+                                            "9223372036854775807",
+                                            "-9223372036854775809",
+                                            "12345678",
+                                            "1234567/",
+                                            "1234567:",
+                                            "0000000000000000000",
+                                            "00000000000000000000"};
+    for (const std::string &edge : edges)
+    {
+        CheckParse<int8_t>(edge);
+        CheckParse<uint8_t>(edge);
+        CheckParse<int16_t>(edge);
+        CheckParse<uint16_t>(edge);
+        CheckParse<int32_t>(edge);
+        CheckParse<uint32_t>(edge);
+        CheckParse<int64_t>(edge);
+        CheckParse<uint64_t>(edge);
+    }
+
+    std::mt19937 rng(3);
+    for (size_t length = 1; length <= 24; ++length)
+    {
+        for (int round = 0; round < 200; ++round)
+        {
+            std::string str = RandomString(rng, length, "0123456789");
+            if (rng() % 8 == 0)
+            {
+                str[rng() % length] = "-+ /:x"[rng() % 6];
+            }
+            else if (rng() % 4 == 0)
+            {
+                str.insert(str.begin(), '-');
+            }
+
+            CheckParse<int32_t>(str);
+            CheckParse<uint32_t>(str);
+            CheckParse<int64_t>(str);
+            CheckParse<uint64_t>(str);
+        }
+    }
+}
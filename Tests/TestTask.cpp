@@ -0,0 +1,120 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Coroutine/ThreadPool.h"
+#include "Common/Coroutine/WhenAll.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+using namespace Coroutine;
+
+namespace
+{
+    Task<int> Add(int lhs, int rhs)
+    {
+        co_return lhs + rhs;
+    }
+
+    Task<int> Throw()
+    {
+        throw std::runtime_error("task error");
+        co_return 0;
+    }
+
+    Task<int> Chain(int depth)
+    {
+        int sum = 0;
+        for (int i = 0; i < depth; ++i)
+        {
+            sum += co_await Add(i, 1);
+        }
+        co_return sum;
+    }
+
+    Task<std::thread::id> GetThreadId(ThreadPool &pool)
+    {
+        co_await pool.Schedule();
+        co_return std::this_thread::get_id();
+    }
+
+    Task<int> Square(ThreadPool &pool, int value)
+    {
+        co_await pool.Schedule();
+        co_return value * value;
+    }
+
+    Task<int> Sleep(ThreadPool &pool, int value, std::chrono::milliseconds duration, CancellationToken token)
+    {
+        co_await pool.Schedule();
+        const auto deadline = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            token.ThrowIfCancellationRequested();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        co_return value;
+    }
+} // namespace
+
+TEST_CASE("Task - SyncWait")
+{
+    CHECK(SyncWait(Add(1, 2)) == 3);
+    CHECK(SyncWait(Chain(10000)) == 50005000);
+    CHECK_THROWS_AS(SyncWait(Throw()), std::runtime_error);
+}
+
+TEST_CASE("Task - ThreadPool schedule")
+{
+    ThreadPool pool(2);
+    CHECK(pool.GetThreadCount() == 2);
+    CHECK_FALSE(pool.IsInPool());
+    CHECK(SyncWait(GetThreadId(pool)) != std::this_thread::get_id());
+}
+
+TEST_CASE("Task - WhenAll")
+{
+    ThreadPool pool(4);
+
+    std::vector<Task<int>> tasks;
+    for (int i = 0; i < 100; ++i)
+    {
+        tasks.emplace_back(Square(pool, i));
+    }
+
+    const std::vector<int> results = SyncWait(WhenAll(std::move(tasks)));
+    REQUIRE(results.size() == 100);
+    for (int i = 0; i < 100; ++i)
+    {
+        CHECK(results[i] == i * i);
+    }
+
+    std::vector<Task<int>> failed;
+    failed.emplace_back(Square(pool, 2));
+    failed.emplace_back(Throw());
+    CHECK_THROWS_AS(SyncWait(WhenAll(std::move(failed))), std::runtime_error);
+
+    CHECK(SyncWait(WhenAll(std::vector<Task<int>> {})).empty());
+}
+
+TEST_CASE("Task - WhenAny")
+{
+    ThreadPool         pool(4);
+    CancellationSource source;
+
+    std::vector<Task<int>> tasks;
+    tasks.emplace_back(Sleep(pool, 1, std::chrono::seconds(5), source.GetToken()));
+    tasks.emplace_back(Sleep(pool, 2, std::chrono::milliseconds(10), source.GetToken()));
+    tasks.emplace_back(Sleep(pool, 3, std::chrono::seconds(5), source.GetToken()));
+
+    const auto beginTime      = std::chrono::steady_clock::now();
+    const auto [index, value] = SyncWait(WhenAny(std::move(tasks), source));
+    CHECK(index == 1);
+    CHECK(value == 2);
+    CHECK(source.IsCancellationRequested());
+
+    // 其余任务检查令牌后提前结束，线程池析构时无需等待5秒
+    pool.Shutdown();
+    CHECK(std::chrono::steady_clock::now() - beginTime < std::chrono::seconds(2));
+}
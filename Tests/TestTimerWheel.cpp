@@ -0,0 +1,169 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Util/TimerWheel.h"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace std::chrono_literals;
+using TimeUtil::TimerWheel;
+
+namespace
+{
+    const auto START_TIME = std::chrono::steady_clock::time_point {} + 1h;
+
+    std::chrono::steady_clock::time_point At(std::chrono::milliseconds offset)
+    {
+        return START_TIME + offset;
+    }
+} // namespace
+
+TEST_CASE("TimerWheel - 按时到期")
+{
+    TimerWheel       wheel(START_TIME);
+    std::vector<int> fired;
+    wheel.Schedule(5ms, [&] { fired.push_back(5); });
+    wheel.Schedule(1ms, [&] { fired.push_back(1); });
+    wheel.Schedule(0ms, [&] { fired.push_back(0); });
+    wheel.Schedule(300ms, [&] { fired.push_back(300); });
+    wheel.Schedule(20000ms, [&] { fired.push_back(20000); });
+    CHECK(wheel.GetTimerCount() == 5);
+
+    CHECK(wheel.Advance(At(1ms)) == 2);
+    CHECK((fired == std::vector<int> {1, 0}));
+    CHECK(wheel.Advance(At(4ms)) == 0);
+    CHECK(wheel.Advance(At(5ms)) == 1);
+    CHECK(wheel.Advance(At(299ms)) == 0);
+    CHECK(wheel.Advance(At(300ms)) == 1);
+    CHECK(wheel.Advance(At(19999ms)) == 0);
+    CHECK(wheel.Advance(At(20000ms)) == 1);
+    CHECK(fired.back() == 20000);
+    CHECK(wheel.GetTimerCount() == 0);
+}
+
+TEST_CASE("TimerWheel - 取消与重新设置")
+{
+    TimerWheel wheel(START_TIME);
+    int        count = 0;
+    auto       id    = wheel.Schedule(10ms, [&] { ++count; });
+    CHECK(wheel.Cancel(id));
+    CHECK_FALSE(wheel.Cancel(id));
+    wheel.Advance(At(20ms));
+    CHECK(count == 0);
+
+    // 空闲超时：有活动时推迟
+    id = wheel.Schedule(10ms, [&] { ++count; });
+    wheel.Advance(At(25ms));
+    CHECK(wheel.Reschedule(id, 10ms));
+    wheel.Advance(At(34ms));
+    CHECK(count == 0);
+    wheel.Advance(At(35ms));
+    CHECK(count == 1);
+    CHECK_FALSE(wheel.Reschedule(id, 10ms));
+
+    // 节点复用后旧id失效
+    const auto newId = wheel.Schedule(10ms, [] {});
+    CHECK(newId != id);
+    CHECK_FALSE(wheel.Cancel(id));
+    CHECK(wheel.Cancel(newId));
+}
+
+TEST_CASE("TimerWheel - 周期定时器与回调中的操作")
+{
+    TimerWheel wheel(START_TIME);
+    int        tickCount  = 0;
+    int        otherCount = 0;
+
+    TimerWheel::TimerId otherId    = TimerWheel::INVALID_TIMER_ID;
+    TimerWheel::TimerId periodicId = wheel.Schedule(
+        10ms,
+        [&] {
+            ++tickCount;
+            // 同一tick中的其他定时器可被取消
+            wheel.Cancel(otherId);
+            if (tickCount == 3)
+            {
+                CHECK(wheel.Cancel(periodicId));
+            }
+        },
+        10ms);
+    otherId = wheel.Schedule(10ms, [&] { ++otherCount; });
+
+    wheel.Advance(At(100ms));
+    CHECK(tickCount == 3);
+    CHECK(otherCount == 0);
+    CHECK(wheel.GetTimerCount() == 0);
+
+    // 回调中添加的定时器在之后的tick执行
+    int chained = 0;
+    wheel.Schedule(1ms, [&] {
+        wheel.Schedule(0ms, [&] { ++chained; });
+    });
+    wheel.Advance(At(101ms));
+    CHECK(chained == 0);
+    wheel.Advance(At(102ms));
+    CHECK(chained == 1);
+}
+
+TEST_CASE("TimerWheel - 随机定时器与逐个比较")
+{
+    TimerWheel                         wheel(START_TIME);
+    std::mt19937_64                    random(42);
+    std::multimap<uint64_t, int>       expected;
+    std::vector<int>                   fired;
+    std::map<int, TimerWheel::TimerId> ids;
+
+    uint64_t now = 0;
+    for (int i = 0; i < 5000; ++i)
+    {
+        // 覆盖各层范围，包括超出时间轮范围的延时
+        const int      bits  = static_cast<int>(random() % 34);
+        const uint64_t delay = 1 + (random() & ((uint64_t {1} << bits) - 1));
+        ids[i]               = wheel.Schedule(std::chrono::milliseconds(delay), [&fired, i] {
+            fired.push_back(i);
+        });
+        expected.emplace(now + delay, i);
+
+        if (random() % 4 == 0)
+        {
+            const int victim = static_cast<int>(random() % (i + 1));
+            if (wheel.Cancel(ids[victim]))
+            {
+                for (auto it = expected.begin(); it != expected.end(); ++it)
+                {
+                    if (it->second == victim)
+                    {
+                        expected.erase(it);
+                        break;
+                    }
+                }
+            }
+        }
+
+        now += random() % 50;
+        // 逐tick推进，检查每个定时器恰好在到期的tick执行
+        while (wheel.GetElapsedTicks() < now)
+        {
+            wheel.Advance(At(std::chrono::milliseconds(wheel.GetElapsedTicks() + 1)));
+            auto [first, last] = expected.equal_range(wheel.GetElapsedTicks());
+            CHECK(static_cast<std::size_t>(std::distance(first, last)) == fired.size());
+            for (int id : fired)
+            {
+                auto it = std::find_if(first, last, [id](const auto &entry) { return entry.second == id; });
+                REQUIRE(it != last);
+                if (it == first)
+                {
+                    ++first;
+                }
+                expected.erase(it);
+            }
+            fired.clear();
+        }
+    }
+
+    CHECK(wheel.GetTimerCount() == expected.size());
+}
@@ -0,0 +1,185 @@
+﻿#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "Common/Database/MySqlPreparedStatement.h"
+#include "Common/Database/MySqlTypeHack.h"
+#include "Common/Database/TypedStatement.h"
+
+#include <vector>
+
+using namespace Database;
+
+namespace
+{
+    enum TestStmtID : uint32_t
+    {
+        TEST_SEL_ACCOUNT,
+    };
+
+    using SelAccount = Stmt<TEST_SEL_ACCOUNT,
+                            Params<uint32_t, std::string_view, double, bool, std::vector<uint8_t>>,
+                            Row<uint32_t, std::string>>;
+
+    // 完全一致，或无损的拓宽、字符串视图转换
+    static_assert(StmtInvocable<SelAccount, uint32_t, std::string, double, bool, std::vector<uint8_t>>);
+    static_assert(StmtInvocable<SelAccount, uint16_t &, const char *, float, bool, std::vector<uint8_t> &>);
+    static_assert(
+        StmtInvocable<SelAccount, const uint32_t &, const char (&)[4], double, bool, std::vector<uint8_t>>);
+
+    // 个数不一致
+    static_assert(!StmtInvocable<SelAccount, uint32_t, std::string, double, bool>);
+
+    // 缩窄、有符号与无符号互转、浮点转整数、整数转浮点
+    static_assert(!StmtInvocable<SelAccount, uint64_t, std::string, double, bool, std::vector<uint8_t>>);
+    static_assert(!StmtInvocable<SelAccount, int32_t, std::string, double, bool, std::vector<uint8_t>>);
+    static_assert(!StmtInvocable<SelAccount, double, std::string, double, bool, std::vector<uint8_t>>);
+    static_assert(!StmtInvocable<SelAccount, uint32_t, std::string, int32_t, bool, std::vector<uint8_t>>);
+
+    // bool只与bool对应，字符串与二进制参数不接受数值
+    static_assert(!StmtInvocable<SelAccount, bool, std::string, double, bool, std::vector<uint8_t>>);
+    static_assert(!StmtInvocable<SelAccount, uint32_t, std::string, double, int32_t, std::vector<uint8_t>>);
+    static_assert(!StmtInvocable<SelAccount, uint32_t, char, double, bool, std::vector<uint8_t>>);
+    static_assert(!StmtInvocable<SelAccount, uint32_t, std::string, double, bool, uint8_t>);
+
+    struct Account
+    {
+        uint32_t    id;
+        std::string email;
+
+        Account(uint32_t id, std::string email) : id(id), email(std::move(email)) {}
+    };
+
+    static_assert(StmtRowMappable<SelAccount, SelAccount::RowType>);
+    static_assert(StmtRowMappable<SelAccount, Account>);
+    static_assert(!StmtRowMappable<SelAccount, uint32_t>);
+
+    // 预处理得到的参数个数与结果元数据
+    struct FakeStatement
+    {
+        unsigned long            paramCount {0};
+        std::vector<MYSQL_FIELD> fields;
+
+        void AddField(enum_field_types type, unsigned int flags = 0)
+        {
+            MYSQL_FIELD field {};
+            field.name  = const_cast<char *>("column");
+            field.type  = type;
+            field.flags = flags;
+            fields.emplace_back(field);
+        }
+
+        MYSQL_STMT *GetStmt()
+        {
+            return reinterpret_cast<MYSQL_STMT *>(this);
+        }
+    };
+
+    FakeStatement &FromStmt(MYSQL_STMT *pStmt)
+    {
+        return *reinterpret_cast<FakeStatement *>(pStmt);
+    }
+
+    template <typename ParamList, typename RowList>
+    bool CheckTypedStatement(FakeStatement &fake)
+    {
+        using StmtType = Stmt<TEST_SEL_ACCOUNT, ParamList, RowList>;
+
+        MySqlPreparedStatement stmt(fake.GetStmt(), "select id, email from account where id = ?");
+        return stmt.CheckTypedStatement(StmtType::PARAM_TYPES, StmtType::COLUMN_TYPES);
+    }
+} // namespace
+
+// 以下函数替换libmysql中的同名函数，按FakeStatement返回预处理结果，测试不需要连接MySql
+extern "C"
+{
+    unsigned long STDCALL mysql_stmt_param_count(MYSQL_STMT *pStmt)
+    {
+        return FromStmt(pStmt).paramCount;
+    }
+
+    unsigned int STDCALL mysql_stmt_field_count(MYSQL_STMT *pStmt)
+    {
+        return static_cast<unsigned int>(FromStmt(pStmt).fields.size());
+    }
+
+    bool STDCALL mysql_stmt_attr_set(MYSQL_STMT *, enum enum_stmt_attr_type, const void *)
+    {
+        return false;
+    }
+
+    bool STDCALL mysql_stmt_close(MYSQL_STMT *)
+    {
+        return false;
+    }
+
+    MYSQL_RES *STDCALL mysql_stmt_result_metadata(MYSQL_STMT *pStmt)
+    {
+        return FromStmt(pStmt).fields.empty() ? nullptr : reinterpret_cast<MYSQL_RES *>(pStmt);
+    }
+
+    MYSQL_FIELD *STDCALL mysql_fetch_fields(MYSQL_RES *pResult)
+    {
+        return reinterpret_cast<FakeStatement *>(pResult)->fields.data();
+    }
+
+    void STDCALL mysql_free_result(MYSQL_RES *) {}
+}
+
+TEST_CASE("TypedStatement - Bind values reference the arguments")
+{
+    const std::tuple<uint32_t, std::string_view, std::vector<uint8_t>> params {7, "a@qq.com", {1, 2, 3}};
+    const auto bindValues = Detail::MakeBindValues(params);
+
+    CHECK(bindValues[0].type == SqlArgType::Uint32);
+    CHECK(bindValues[0].pData == &std::get<0>(params));
+    CHECK(bindValues[0].length == sizeof(uint32_t));
+
+    CHECK(bindValues[1].type == SqlArgType::String);
+    CHECK(bindValues[1].pData == std::get<1>(params).data());
+    CHECK(bindValues[1].length == 8);
+
+    CHECK(bindValues[2].type == SqlArgType::Binary);
+    CHECK(bindValues[2].pData == std::get<2>(params).data());
+    CHECK(bindValues[2].length == 3);
+
+    SelAccount::RowType row;
+    const auto          resultBinds = Detail::MakeResultBinds(row);
+    CHECK(resultBinds[0].type == SqlArgType::Uint32);
+    CHECK(resultBinds[0].pData == &std::get<0>(row));
+    CHECK(resultBinds[1].type == SqlArgType::String);
+    CHECK(resultBinds[1].pData == &std::get<1>(row));
+}
+
+TEST_CASE("TypedStatement - Checked against the prepared statement")
+{
+    FakeStatement fake;
+    fake.paramCount = 1;
+    fake.AddField(MYSQL_TYPE_LONG, UNSIGNED_FLAG);
+    fake.AddField(MYSQL_TYPE_VAR_STRING);
+
+    using OneParam = Params<uint32_t>;
+    CHECK((CheckTypedStatement<OneParam, Row<uint32_t, std::string>>(fake)));
+
+    // 有符号列更宽时可以容纳无符号值
+    CHECK((CheckTypedStatement<OneParam, Row<int64_t, std::string>>(fake)));
+
+    // 参数个数与预处理结果不一致
+    CHECK_FALSE((CheckTypedStatement<Params<>, Row<uint32_t, std::string>>(fake)));
+    CHECK_FALSE((CheckTypedStatement<Params<uint32_t, uint32_t>, Row<uint32_t, std::string>>(fake)));
+
+    // 列数不一致、列宽更窄、同宽的有符号类型、数值列按字符串读取
+    CHECK_FALSE((CheckTypedStatement<OneParam, Row<uint32_t>>(fake)));
+    CHECK_FALSE((CheckTypedStatement<OneParam, Row<uint16_t, std::string>>(fake)));
+    CHECK_FALSE((CheckTypedStatement<OneParam, Row<int32_t, std::string>>(fake)));
+    CHECK_FALSE((CheckTypedStatement<OneParam, Row<std::string, std::string>>(fake)));
+}
+
+TEST_CASE("TypedStatement - Statement without result set")
+{
+    FakeStatement fake;
+    fake.paramCount = 2;
+
+    using TwoParams = Params<uint32_t, std::string_view>;
+    CHECK((CheckTypedStatement<TwoParams, Row<>>(fake)));
+    CHECK_FALSE((CheckTypedStatement<TwoParams, Row<uint32_t>>(fake)));
+}
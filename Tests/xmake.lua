@@ -28,6 +28,106 @@ target("TestBuffer")
     add_rules("TestRule", "CommonRule")
     add_files("TestBuffer.cpp")
 
+target("TestPreparedStatementPool")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestPreparedStatementPool.cpp")
+
+target("TestQueryResult")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestQueryResult.cpp")
+
+target("TestTypedStatement")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestTypedStatement.cpp")
+
+target("TestQueryResultCache")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestQueryResultCache.cpp")
+
+target("TestPoolScaler")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestPoolScaler.cpp")
+
+target("TestReplicaBalancer")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestReplicaBalancer.cpp")
+
+target("TestSqlPipeline")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestSqlPipeline.cpp")
+
+target("TestStatementMetrics")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestStatementMetrics.cpp")
+
+target("TestBulkLoader")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestBulkLoader.cpp")
+
+target("TestMPSCQueue")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestMPSCQueue.cpp")
+
+target("TestMPMCQueue")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestMPMCQueue.cpp")
+
+target("TestBinaryLog")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestBinaryLog.cpp")
+
+target("TestProfiler")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestProfiler.cpp")
+
+target("TestMetrics")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestMetrics.cpp")
+
+target("TestTask")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestTask.cpp")
+
+target("TestFrameAllocator")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestFrameAllocator.cpp")
+
+target("TestTimerWheel")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestTimerWheel.cpp")
+
+target("TestCachedClock")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestCachedClock.cpp")
+
+target("TestStringUtil")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestStringUtil.cpp")
+
+target("TestLoadGenHistogram")
+    set_kind("binary")
+    add_rules("TestRule", "CommonRule")
+    add_files("TestLoadGenHistogram.cpp")
+
 target("TestCoroutine")
     set_kind("binary")
     add_rules("CommonRule", "TestRule")
@@ -14,8 +14,18 @@ if is_plat("windows") then
     end)
 end
 
+option("log_level")
+    set_default("trace")
+    set_showmenu(true)
+    set_values("trace", "debug", "info", "warn", "error", "critical", "off")
+    set_description("编译期保留的最低日志等级，低于该等级的日志调用被移除")
+option_end()
+
 rule("CommonRule")
     on_load(function (target) 
+        local logLevels = {trace = 0, debug = 1, info = 2, warn = 3, error = 4, critical = 5, off = 6}
+        target:add("defines", "LOG_ACTIVE_LEVEL=" .. logLevels[get_config("log_level") or "trace"])
+
         if is_mode("debug") then
             target:add("defines", "DEBUG", "ENABLE_PERFORMANCE_DECT")
             target:set("symbols", "debug")
@@ -35,5 +45,8 @@ rule_end()
 includes("3rdParty")
 includes("Src/Common")
 includes("Src/Servers")
+includes("Src/Tools")
+
+includes("Benchmarks")
 
 includes("Tests")
\ No newline at end of file